@@ -0,0 +1,82 @@
+import 'dart:convert';
+import 'dart:io';
+
+/// Compares two input benchmark reports and fails on regressions.
+///
+/// ```bash
+/// dart run benchmark/compare.dart baseline.json build/input_benchmark.json
+/// dart run benchmark/compare.dart --tolerance=0.5 baseline.json current.json
+/// ```
+///
+/// A benchmark regresses when its ns/event grows by more than the tolerance
+/// (20 % by default), or when it allocates more objects per event than the
+/// baseline did. Allocation counts are exact, so any increase is reported.
+/// Exits with status 1 if anything regressed.
+void main(List<String> arguments) {
+  var tolerance = 0.2;
+  final files = <String>[];
+  for (final argument in arguments) {
+    if (argument.startsWith('--tolerance=')) {
+      tolerance = double.parse(argument.substring('--tolerance='.length));
+    } else {
+      files.add(argument);
+    }
+  }
+  if (files.length != 2) {
+    stderr.writeln('usage: compare.dart [--tolerance=0.2] '
+        '<baseline.json> <current.json>');
+    exit(64);
+  }
+
+  final baseline = _load(files[0]);
+  final current = _load(files[1]);
+  final regressions = <String>[];
+
+  for (final MapEntry(key: name, value: now) in current.entries) {
+    final before = baseline[name];
+    if (before == null) {
+      stdout.writeln('${name.padRight(44)} new');
+      continue;
+    }
+
+    final nsBefore = (before['nsPerEvent']! as num).toDouble();
+    final nsNow = (now['nsPerEvent']! as num).toDouble();
+    final change = nsBefore == 0 ? 0.0 : nsNow / nsBefore - 1;
+    stdout.writeln(
+      '${name.padRight(44)} ${nsBefore.toStringAsFixed(1).padLeft(9)} -> '
+      '${nsNow.toStringAsFixed(1).padLeft(9)} ns/event '
+      '(${change >= 0 ? '+' : ''}${(change * 100).toStringAsFixed(1)} %)',
+    );
+    if (change > tolerance) {
+      regressions.add('$name: ${nsNow.toStringAsFixed(1)} ns/event, '
+          'baseline ${nsBefore.toStringAsFixed(1)}');
+    }
+
+    final allocationsBefore = before['allocationsPerEvent'] as num?;
+    final allocationsNow = now['allocationsPerEvent'] as num?;
+    if (allocationsBefore != null &&
+        allocationsNow != null &&
+        allocationsNow > allocationsBefore) {
+      regressions.add('$name: $allocationsNow allocations/event, '
+          'baseline $allocationsBefore');
+    }
+  }
+
+  if (regressions.isEmpty) {
+    stdout.writeln('No regressions.');
+    return;
+  }
+  stdout.writeln('\n${regressions.length} regressions:');
+  regressions.forEach(stdout.writeln);
+  exit(1);
+}
+
+/// Results of the report at [path], by benchmark name.
+Map<String, Map<String, Object?>> _load(String path) {
+  final report =
+      jsonDecode(File(path).readAsStringSync()) as Map<String, Object?>;
+  return {
+    for (final result in report['results']! as List<Object?>)
+      (result! as Map<String, Object?>)['name']! as String: result,
+  };
+}
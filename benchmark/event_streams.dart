@@ -0,0 +1,204 @@
+import 'dart:math' as math;
+import 'dart:typed_data';
+
+import 'package:keyboard_playground/platform/compact_input_event.dart';
+import 'package:keyboard_playground/platform/input_capture.dart';
+import 'package:keyboard_playground/platform/input_events.dart';
+
+/// A deterministic input stream in every form the Dart side receives.
+class EventStream {
+  EventStream._(this.name, this.maps)
+      : events = maps.map(InputCapture().parseEvent).toList(),
+        batches = _pack(maps);
+
+  /// Typing at about 12 keys a second, with Shift for capitals.
+  factory EventStream.keyBurst() {
+    final builder = _StreamBuilder();
+    const text = 'The Quick Brown Fox Jumps Over The Lazy Dog. ';
+    for (var repeat = 0; repeat < 4; repeat++) {
+      for (final char in text.split('')) {
+        final upper = char.toUpperCase() == char && char != char.toLowerCase();
+        if (upper) builder.key('Shift', 0xffe1, down: true);
+        final modifiers = upper ? const ['shift'] : const <String>[];
+        builder
+          ..key(char, char.codeUnitAt(0), down: true, modifiers: modifiers)
+          ..advance(40)
+          ..key(char, char.codeUnitAt(0), down: false, modifiers: modifiers);
+        if (upper) builder.key('Shift', 0xffe1, down: false);
+        builder.advance(40);
+      }
+    }
+    return EventStream._('key_burst', builder.maps);
+  }
+
+  /// Two seconds of 1000 Hz pointer motion sweeping across the screen.
+  factory EventStream.motion1000Hz() {
+    final builder = _StreamBuilder();
+    for (var i = 0; i < 2000; i++) {
+      final t = i / 2000 * 2 * math.pi;
+      builder
+        ..move(960 + 900 * math.sin(3 * t), 540 + 500 * math.sin(2 * t))
+        ..advance(1);
+    }
+    return EventStream._('motion_1000hz', builder.maps);
+  }
+
+  /// A child mashing the keyboard: several keys down at once, releases in
+  /// random order, held modifiers, clicks and wiggles in between.
+  factory EventStream.mashStorm() {
+    final builder = _StreamBuilder();
+    final random = math.Random(42);
+    const keys = 'qwertyuiopasdfghjklzxcvbnm1234567890';
+    const named = {'Left': 0xff51, 'Up': 0xff52, 'Return': 0xff0d};
+
+    while (builder.maps.length < 5000) {
+      final held = <(String, int)>[];
+      final count = 3 + random.nextInt(6);
+      for (var i = 0; i < count; i++) {
+        if (random.nextInt(8) == 0) {
+          final entry = named.entries.elementAt(random.nextInt(named.length));
+          held.add((entry.key, entry.value));
+        } else {
+          final char = keys[random.nextInt(keys.length)];
+          held.add((char, char.codeUnitAt(0)));
+        }
+      }
+      final modifiers =
+          random.nextInt(4) == 0 ? const ['control'] : const <String>[];
+
+      for (final (key, keysym) in held) {
+        builder
+          ..key(key, keysym, down: true, modifiers: modifiers)
+          ..advance(random.nextInt(6));
+      }
+      held.shuffle(random);
+      for (final (key, keysym) in held) {
+        builder
+          ..key(key, keysym, down: false, modifiers: modifiers)
+          ..advance(random.nextInt(6));
+      }
+
+      if (random.nextInt(3) == 0) {
+        final x = random.nextDouble() * 1920;
+        final y = random.nextDouble() * 1080;
+        for (var i = 0; i < 20; i++) {
+          builder
+            ..move(x + random.nextInt(40) - 20, y + random.nextInt(40) - 20)
+            ..advance(1);
+        }
+        builder
+          ..button(x, y, down: true)
+          ..advance(30)
+          ..button(x, y, down: false);
+      }
+      builder.advance(20 + random.nextInt(60));
+    }
+    return EventStream._('mash_storm', builder.maps);
+  }
+
+  /// Every stream, in report order.
+  static List<EventStream> all() => [
+        EventStream.keyBurst(),
+        EventStream.motion1000Hz(),
+        EventStream.mashStorm(),
+      ];
+
+  /// Stream name in the report.
+  final String name;
+
+  /// Events as sent on the map event channel.
+  final List<Map<String, Object>> maps;
+
+  /// Events parsed from [maps].
+  final List<InputEvent> events;
+
+  /// Events packed into native batches of up to 64 records.
+  final List<Uint8List> batches;
+
+  /// Number of events.
+  int get length => maps.length;
+
+  static List<Uint8List> _pack(List<Map<String, Object>> maps) {
+    const perBatch = 64;
+    final batches = <Uint8List>[];
+    for (var start = 0; start < maps.length; start += perBatch) {
+      final end = math.min(start + perBatch, maps.length);
+      final batch = Uint8List((end - start) * kCompactEventSize);
+      final data = ByteData.sublistView(batch);
+      for (var i = start; i < end; i++) {
+        _packRecord(data, (i - start) * kCompactEventSize, maps[i]);
+      }
+      batches.add(batch);
+    }
+    return batches;
+  }
+
+  static void _packRecord(ByteData data, int offset, Map<String, Object> map) {
+    final type = InputEventType.values.byName(map['type']! as String);
+    var x = 0;
+    var y = 0;
+    var code = 0;
+    var modifiers = 0;
+    if (map.containsKey('x')) {
+      x = (map['x']! as num).round();
+      y = (map['y']! as num).round();
+    }
+    if (map['button'] != null) {
+      code = 1;
+    }
+    for (final name in map['modifiers'] as List<String>? ?? const []) {
+      modifiers |= KeyModifier.values.byName(name).mask;
+    }
+    data
+      ..setInt64(offset, (map['timestamp']! as int) * 1000, Endian.little)
+      ..setUint32(offset + 8, map['keysym'] as int? ?? 0, Endian.little)
+      ..setInt32(offset + 12, x, Endian.little)
+      ..setInt32(offset + 16, y, Endian.little)
+      ..setUint16(offset + 20, code, Endian.little)
+      ..setUint8(offset + 22, type.index)
+      ..setUint8(offset + 23, modifiers);
+  }
+}
+
+/// Appends events as the native side would send them.
+class _StreamBuilder {
+  final List<Map<String, Object>> maps = [];
+  int _timeMs = 1700000000000;
+  double _x = 960;
+  double _y = 540;
+
+  void advance(int ms) => _timeMs += ms;
+
+  void key(
+    String key,
+    int keysym, {
+    required bool down,
+    List<String> modifiers = const [],
+  }) {
+    maps.add({
+      'type': down ? 'keyDown' : 'keyUp',
+      'timestamp': _timeMs,
+      'keyCode': keysym & 0xff,
+      'keysym': keysym,
+      'key': key,
+      'modifiers': modifiers,
+    });
+  }
+
+  void move(double x, double y) {
+    _x = x;
+    _y = y;
+    maps.add({'type': 'mouseMove', 'timestamp': _timeMs, 'x': x, 'y': y});
+  }
+
+  void button(double x, double y, {required bool down}) {
+    if (x != _x || y != _y) move(x, y);
+    maps.add({
+      'type': down ? 'mouseDown' : 'mouseUp',
+      'timestamp': _timeMs,
+      'button': 'left',
+      'x': x,
+      'y': y,
+    });
+  }
+}
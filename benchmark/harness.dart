@@ -0,0 +1,218 @@
+import 'dart:developer';
+import 'dart:isolate';
+
+import 'package:vm_service/vm_service.dart';
+import 'package:vm_service/vm_service_io.dart';
+
+/// One benchmark: a pass over a stream of [events] events.
+class InputBenchmark {
+  /// Creates a benchmark named [name] that handles [events] events per
+  /// call of [run].
+  ///
+  /// [setUp] and [tearDown] run around every pass and are not timed, e.g.
+  /// to resume a game and drop the letters the pass spawned.
+  const InputBenchmark(
+    this.name, {
+    required this.events,
+    required this.run,
+    this.setUp,
+    this.tearDown,
+  });
+
+  /// Name in the report, `<subject>/<stream>`.
+  final String name;
+
+  /// Events handled per pass.
+  final int events;
+
+  /// Handles every event once.
+  final void Function() run;
+
+  /// Runs before every pass.
+  final void Function()? setUp;
+
+  /// Runs after every pass.
+  final void Function()? tearDown;
+}
+
+/// Measurements of one [InputBenchmark].
+class BenchmarkResult {
+  /// Creates a result.
+  const BenchmarkResult({
+    required this.name,
+    required this.events,
+    required this.passes,
+    required this.nsPerEvent,
+    this.allocationsPerPass,
+    this.bytesPerPass,
+  });
+
+  /// Benchmark name.
+  final String name;
+
+  /// Events per pass.
+  final int events;
+
+  /// Timed passes.
+  final int passes;
+
+  /// Mean time per event, in nanoseconds.
+  final double nsPerEvent;
+
+  /// Objects allocated by one pass, or `null` without the VM service.
+  final int? allocationsPerPass;
+
+  /// Bytes allocated by one pass, or `null` without the VM service.
+  final int? bytesPerPass;
+
+  /// Machine-readable form for the report.
+  Map<String, Object?> toJson() => {
+        'name': name,
+        'events': events,
+        'passes': passes,
+        'nsPerEvent': double.parse(nsPerEvent.toStringAsFixed(1)),
+        'allocationsPerPass': allocationsPerPass,
+        'allocationsPerEvent': allocationsPerPass == null
+            ? null
+            : double.parse((allocationsPerPass! / events).toStringAsFixed(3)),
+        'bytesPerPass': bytesPerPass,
+      };
+
+  @override
+  String toString() {
+    final allocations = allocationsPerPass == null
+        ? 'n/a'
+        : (allocationsPerPass! / events).toStringAsFixed(2);
+    return '${name.padRight(44)} ${nsPerEvent.toStringAsFixed(1).padLeft(10)}'
+        ' ns/event  ${allocations.padLeft(8)} allocs/event';
+  }
+}
+
+/// Counts the objects the current isolate allocates, via the VM service.
+class AllocationCounter {
+  AllocationCounter._(this._service, this._isolateId);
+
+  final VmService _service;
+  final String _isolateId;
+
+  /// Connects to the VM service of this process, starting it if needed.
+  ///
+  /// Returns `null` where the service cannot be reached (e.g. `flutter test`
+  /// without `--enable-vmservice`); allocations are then not reported.
+  static Future<AllocationCounter?> connect() async {
+    try {
+      var info = await Service.getInfo();
+      if (info.serverWebSocketUri == null) {
+        info = await Service.controlWebServer(enable: true);
+      }
+      final uri = info.serverWebSocketUri;
+      final isolateId = Service.getIsolateId(Isolate.current);
+      if (uri == null || isolateId == null) return null;
+      return AllocationCounter._(
+        await vmServiceConnectUri(uri.toString()),
+        isolateId,
+      );
+      // The service is optional; any failure just disables counting.
+      // ignore: avoid_catches_without_on_clauses
+    } catch (_) {
+      return null;
+    }
+  }
+
+  /// Resets the per-class allocation accumulators.
+  Future<void> reset() =>
+      _service.getAllocationProfile(_isolateId, reset: true);
+
+  /// Objects and bytes allocated since the last [reset].
+  Future<(int, int)> read() async {
+    final profile = await _service.getAllocationProfile(_isolateId);
+    var instances = 0;
+    var bytes = 0;
+    for (final stats in profile.members ?? const <ClassHeapStats>[]) {
+      instances += stats.instancesAccumulated ?? 0;
+      bytes += stats.accumulatedSize ?? 0;
+    }
+    return (instances, bytes);
+  }
+
+  /// Closes the connection.
+  Future<void> dispose() => _service.dispose();
+}
+
+/// Runs [InputBenchmark]s.
+///
+/// Each benchmark is warmed up for [warmupPasses] passes (so the JIT has
+/// optimized the handlers), then timed over as many passes as fit into
+/// [minDuration]. Allocations are counted over one extra pass, minus those
+/// of an empty pass, which covers the measuring itself.
+class BenchmarkRunner {
+  /// Creates a runner.
+  BenchmarkRunner({
+    this.allocations,
+    this.warmupPasses = 20,
+    this.minDuration = const Duration(milliseconds: 500),
+  });
+
+  /// Allocation counter, or `null` to skip counting.
+  final AllocationCounter? allocations;
+
+  /// Untimed passes before measuring.
+  final int warmupPasses;
+
+  /// Minimum total time of the timed passes.
+  final Duration minDuration;
+
+  int? _overheadInstances;
+  int? _overheadBytes;
+
+  /// Measures [benchmark].
+  Future<BenchmarkResult> measure(InputBenchmark benchmark) async {
+    for (var i = 0; i < warmupPasses; i++) {
+      _pass(benchmark);
+    }
+
+    final stopwatch = Stopwatch();
+    var passes = 0;
+    while (stopwatch.elapsed < minDuration) {
+      benchmark.setUp?.call();
+      stopwatch.start();
+      benchmark.run();
+      stopwatch.stop();
+      benchmark.tearDown?.call();
+      passes++;
+    }
+    final ns = stopwatch.elapsedTicks * 1e9 / stopwatch.frequency;
+
+    int? instances;
+    int? bytes;
+    final counter = allocations;
+    if (counter != null) {
+      if (_overheadInstances == null) {
+        await counter.reset();
+        (_overheadInstances, _overheadBytes) = await counter.read();
+      }
+      benchmark.setUp?.call();
+      await counter.reset();
+      benchmark.run();
+      final (total, totalBytes) = await counter.read();
+      benchmark.tearDown?.call();
+      instances = (total - _overheadInstances!).clamp(0, total);
+      bytes = (totalBytes - _overheadBytes!).clamp(0, totalBytes);
+    }
+
+    return BenchmarkResult(
+      name: benchmark.name,
+      events: benchmark.events,
+      passes: passes,
+      nsPerEvent: ns / (passes * benchmark.events),
+      allocationsPerPass: instances,
+      bytesPerPass: bytes,
+    );
+  }
+
+  void _pass(InputBenchmark benchmark) {
+    benchmark.setUp?.call();
+    benchmark.run();
+    benchmark.tearDown?.call();
+  }
+}
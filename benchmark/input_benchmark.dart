@@ -0,0 +1,228 @@
+import 'dart:async';
+import 'dart:convert';
+import 'dart:io';
+import 'dart:typed_data';
+
+import 'package:flutter/foundation.dart';
+import 'package:flutter_test/flutter_test.dart';
+import 'package:keyboard_playground/core/exit_handler.dart';
+import 'package:keyboard_playground/core/game_manager.dart';
+import 'package:keyboard_playground/core/lazy_game.dart';
+import 'package:keyboard_playground/games/exploding_letters/exploding_letters_game.dart';
+import 'package:keyboard_playground/games/keyboard_visualizer_game.dart';
+import 'package:keyboard_playground/games/mouse_visualizer_game.dart';
+import 'package:keyboard_playground/games/placeholder_game.dart';
+import 'package:keyboard_playground/platform/compact_input_event.dart';
+import 'package:keyboard_playground/platform/input_capture.dart';
+
+import 'event_streams.dart';
+import 'harness.dart';
+
+/// Microbenchmarks of the Dart side of the input path.
+///
+/// Every consumer is measured over the same deterministic streams (see
+/// [EventStream]): a typing burst, two seconds of 1000 Hz motion and a
+/// mash storm. Batched consumers get the packed records the Linux plugin
+/// sends and run with `supportsEventBatches`, so they take the same path as
+/// in the app.
+///
+/// | Benchmark                            | Measures                          |
+/// |--------------------------------------|-----------------------------------|
+/// | `parseEvent/<stream>`                | Map channel event parsing         |
+/// | `decodeBatches/<stream>`             | Packed batch decoding alone       |
+/// | `exitHandler/<stream>`               | Exit sequence tracking            |
+/// | `handleInputEvent/<game>/<stream>`   | `GameManager.handleInputEvent`    |
+/// | `compact/<game>/<stream>`            | Batches through `listenCompact`   |
+///
+/// Run with `make bench`. Results are written as JSON to
+/// `build/input_benchmark.json` (or `$INPUT_BENCHMARK_OUTPUT`); compare two
+/// runs with `dart run benchmark/compare.dart`.
+void main() {
+  TestWidgetsFlutterBinding.ensureInitialized();
+
+  test(
+    'input consumer path',
+    () async {
+      debugDefaultTargetPlatformOverride = TargetPlatform.linux;
+      final allocations = await AllocationCounter.connect();
+      final runner = BenchmarkRunner(allocations: allocations);
+      final results = <BenchmarkResult>[];
+
+      for (final stream in EventStream.all()) {
+        final benchmarks = [
+          _parseEvent(stream),
+          _decodeBatches(stream),
+          _exitHandler(stream),
+          for (final id in _games) _handleInputEvent(id, stream),
+          for (final id in _games) _compact(id, stream),
+        ];
+        for (final benchmark in benchmarks) {
+          final result = await runner.measure(benchmark);
+          stdout.writeln(result);
+          results.add(result);
+        }
+      }
+
+      await allocations?.dispose();
+      debugDefaultTargetPlatformOverride = null;
+      _writeReport(results, allocationsCounted: allocations != null);
+    },
+    timeout: Timeout.none,
+  );
+}
+
+/// Keeps results alive so the compiler cannot drop the measured work.
+Object? _sink;
+
+const _games = [
+  'placeholder',
+  'exploding_letters',
+  'keyboard_visualizer',
+  'mouse_visualizer',
+];
+
+InputBenchmark _parseEvent(EventStream stream) {
+  final capture = InputCapture();
+  return InputBenchmark(
+    'parseEvent/${stream.name}',
+    events: stream.length,
+    run: () {
+      for (final map in stream.maps) {
+        _sink = capture.parseEvent(map);
+      }
+    },
+  );
+}
+
+InputBenchmark _decodeBatches(EventStream stream) {
+  final decoder = CompactEventDecoder();
+  var count = 0;
+  void onEvent(CompactInputEvent event) => count += event.code;
+  return InputBenchmark(
+    'decodeBatches/${stream.name}',
+    events: stream.length,
+    run: () {
+      for (final batch in stream.batches) {
+        decoder.decode(batch, onEvent);
+      }
+      _sink = count;
+    },
+  );
+}
+
+InputBenchmark _exitHandler(EventStream stream) {
+  final capture = _ReplayInputCapture();
+  _sink = ExitHandler(inputCapture: capture);
+  return InputBenchmark(
+    'exitHandler/${stream.name}',
+    events: stream.length,
+    run: () => capture.replay(stream.batches),
+  );
+}
+
+InputBenchmark _handleInputEvent(String id, EventStream stream) {
+  final manager = _managerWith(id);
+  return InputBenchmark(
+    'handleInputEvent/$id/${stream.name}',
+    events: stream.length,
+    setUp: () => manager.switchGame(id),
+    run: () {
+      for (final event in stream.events) {
+        manager.handleInputEvent(event);
+      }
+    },
+    tearDown: manager.stopCurrentGame,
+  );
+}
+
+InputBenchmark _compact(String id, EventStream stream) {
+  final manager = _managerWith(id);
+  final capture = _ReplayInputCapture();
+  StreamSubscription<Object>? subscription;
+  return InputBenchmark(
+    'compact/$id/${stream.name}',
+    events: stream.length,
+    setUp: () {
+      manager.switchGame(id);
+      subscription = capture.listenCompact(
+        manager.handleCompactEvent,
+        filter: manager.currentGame!.inputFilter,
+      );
+    },
+    run: () => capture.replay(stream.batches),
+    tearDown: () {
+      unawaited(subscription?.cancel());
+      manager.stopCurrentGame();
+    },
+  );
+}
+
+GameManager _managerWith(String id) {
+  final LazyGame game;
+  switch (id) {
+    case PlaceholderGame.gameId:
+      game = LazyGame(
+        id: PlaceholderGame.gameId,
+        name: PlaceholderGame.gameName,
+        description: PlaceholderGame.gameDescription,
+        create: PlaceholderGame.new,
+      );
+    case ExplodingLettersGame.gameId:
+      game = LazyGame(
+        id: ExplodingLettersGame.gameId,
+        name: ExplodingLettersGame.gameName,
+        description: ExplodingLettersGame.gameDescription,
+        create: ExplodingLettersGame.new,
+      );
+    case KeyboardVisualizerGame.gameId:
+      game = LazyGame(
+        id: KeyboardVisualizerGame.gameId,
+        name: KeyboardVisualizerGame.gameName,
+        description: KeyboardVisualizerGame.gameDescription,
+        create: KeyboardVisualizerGame.new,
+      );
+    case MouseVisualizerGame.gameId:
+      game = LazyGame(
+        id: MouseVisualizerGame.gameId,
+        name: MouseVisualizerGame.gameName,
+        description: MouseVisualizerGame.gameDescription,
+        create: MouseVisualizerGame.new,
+      );
+    default:
+      throw ArgumentError.value(id, 'id', 'unknown game');
+  }
+  return GameManager()..registerGame(game);
+}
+
+/// Delivers packed batches synchronously, as the batch channel does.
+class _ReplayInputCapture extends InputCapture {
+  final StreamController<Uint8List> _batches =
+      StreamController<Uint8List>.broadcast(sync: true);
+
+  @override
+  Stream<Uint8List> get eventBatches => _batches.stream;
+
+  void replay(List<Uint8List> batches) {
+    batches.forEach(_batches.add);
+  }
+}
+
+void _writeReport(
+  List<BenchmarkResult> results, {
+  required bool allocationsCounted,
+}) {
+  final path = Platform.environment['INPUT_BENCHMARK_OUTPUT'] ??
+      'build/input_benchmark.json';
+  final report = {
+    'suite': 'input_consumer_path',
+    'schema': 1,
+    'timestamp': DateTime.now().toUtc().toIso8601String(),
+    'dart': Platform.version.split(' ').first,
+    'allocationsCounted': allocationsCounted,
+    'results': [for (final result in results) result.toJson()],
+  };
+  File(path)
+    ..createSync(recursive: true)
+    ..writeAsStringSync(const JsonEncoder.withIndent('  ').convert(report));
+  stdout.writeln('Wrote ${results.length} results to $path');
+}
@@ -0,0 +1,154 @@
+import 'dart:io';
+import 'dart:ui';
+
+import 'package:flutter/scheduler.dart';
+import 'package:flutter_test/flutter_test.dart';
+import 'package:integration_test/integration_test.dart';
+import 'package:keyboard_playground/core/game_manager.dart';
+import 'package:keyboard_playground/core/quality_controller.dart';
+import 'package:keyboard_playground/main.dart';
+import 'package:keyboard_playground/platform/input_capture.dart';
+import 'package:keyboard_playground/ui/app_shell.dart';
+
+import 'perf/frame_baselines.dart';
+import 'perf/frame_metrics.dart';
+
+/// Per-game frame performance regression suite.
+///
+/// Boots the real app (on Linux under Xvfb in CI), switches to every game
+/// and replays stored session journals through the native replay path, so
+/// events take the same route as live input. Games run on virtual frame
+/// time during the replay, so every run animates the same frames. Build and
+/// raster percentiles of the frames rendered during each replay are
+/// compared against [kFrameBaselines].
+///
+/// Run with:
+/// ```bash
+/// xvfb-run -a -s "-screen 0 1920x1080x24" flutter drive --profile -d linux \
+///   --driver=test_driver/frame_performance_driver.dart \
+///   --target=integration_test/frame_performance_test.dart
+/// ```
+void main() {
+  final binding = IntegrationTestWidgetsFlutterBinding.ensureInitialized()
+    ..framePolicy = LiveTestWidgetsFlutterBindingFramePolicy.fullyLive;
+
+  testWidgets('games stay within frame baselines during replay',
+      (tester) async {
+    final gameManager = GameManager();
+    await tester.pumpWidget(KeyboardPlaygroundApp(gameManager: gameManager));
+    await _waitForAppShell(tester);
+
+    // Baselines are for full effects; adaptive quality would hide
+    // regressions by rendering less.
+    QualityController.instance.pin(QualityLevel.high);
+
+    final capture = InputCapture();
+    final report = <String, Object>{};
+    final failures = <String>[];
+
+    for (final gameId in _games) {
+      expect(gameManager.switchGame(gameId), isTrue, reason: gameId);
+
+      for (final scenario in _scenarios) {
+        final key = '$gameId/${scenario.name}';
+
+        // Let the switch settle so its first frames are not attributed to
+        // the replay.
+        await Future<void>.delayed(_settleTime);
+
+        final metrics = await _measureFrames(() async {
+          final replayed = await capture.replayJournal(
+            _journalPath(scenario.journal),
+            rate: scenario.rate,
+            virtualTime: true,
+          );
+          expect(replayed, isNotNull, reason: '$key: replay failed');
+        });
+        report[key] = metrics.toJson();
+
+        final baseline = kFrameBaselines[key];
+        if (baseline == null) {
+          failures.add('$key: no baseline (measured ${metrics.toJson()})');
+          continue;
+        }
+        for (final regression
+            in baseline.regressions(metrics, tolerance: _tolerance)) {
+          failures.add('$key: $regression');
+        }
+      }
+    }
+
+    binding.reportData = {'frame_performance': report};
+    expect(failures, isEmpty, reason: failures.join('\n'));
+  });
+}
+
+/// Games under test, by id.
+const List<String> _games = [
+  'exploding_letters',
+  'keyboard_visualizer',
+  'mouse_visualizer',
+  'placeholder',
+];
+
+/// A journal replayed at a given speed.
+class _Scenario {
+  const _Scenario(this.name, this.journal, {required this.rate});
+
+  final String name;
+  final String journal;
+  final double rate;
+}
+
+const List<_Scenario> _scenarios = [
+  // Normal play: typing with a 125 Hz mouse.
+  _Scenario('typing', 'typing.kpj', rate: 1),
+  // Worst realistic input: 1000 Hz mouse while mashing several keys.
+  _Scenario('mash', 'mash.kpj', rate: 1),
+  // Headroom check: the same input four times faster.
+  _Scenario('mash_4x', 'mash.kpj', rate: 4),
+];
+
+/// Directory holding the replay journals, relative to the project root.
+const String _journalDir = String.fromEnvironment(
+  'PERF_JOURNAL_DIR',
+  defaultValue: 'integration_test/journals',
+);
+
+/// Allowed regression over a baseline, as a fraction.
+final double _tolerance =
+    double.tryParse(const String.fromEnvironment('PERF_TOLERANCE')) ?? 0.2;
+
+const Duration _settleTime = Duration(milliseconds: 500);
+
+/// Frame timings are reported in batches; wait long enough after the
+/// replay for the last batch to arrive.
+const Duration _timingsFlushTime = Duration(milliseconds: 1500);
+
+const Duration _startupTimeout = Duration(seconds: 30);
+
+String _journalPath(String name) => File('$_journalDir/$name').absolute.path;
+
+Future<void> _waitForAppShell(WidgetTester tester) async {
+  final deadline = DateTime.now().add(_startupTimeout);
+  while (find.byType(AppShell).evaluate().isEmpty) {
+    if (DateTime.now().isAfter(deadline)) {
+      fail('App did not finish initializing within $_startupTimeout');
+    }
+    await tester.pump(const Duration(milliseconds: 100));
+  }
+}
+
+Future<FrameMetrics> _measureFrames(Future<void> Function() action) async {
+  final timings = <FrameTiming>[];
+  void onTimings(List<FrameTiming> batch) => timings.addAll(batch);
+
+  SchedulerBinding.instance.addTimingsCallback(onTimings);
+  try {
+    await action();
+    await Future<void>.delayed(_timingsFlushTime);
+  } finally {
+    SchedulerBinding.instance.removeTimingsCallback(onTimings);
+  }
+  return FrameMetrics.fromTimings(timings);
+}
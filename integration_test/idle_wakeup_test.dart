@@ -0,0 +1,134 @@
+import 'dart:io';
+
+import 'package:flutter/foundation.dart';
+import 'package:flutter_test/flutter_test.dart';
+import 'package:integration_test/integration_test.dart';
+import 'package:keyboard_playground/core/game_manager.dart';
+import 'package:keyboard_playground/main.dart';
+import 'package:keyboard_playground/platform/input_capture.dart';
+import 'package:keyboard_playground/ui/app_shell.dart';
+
+/// Idle wakeup budget of the native input threads.
+///
+/// Boots the real app (on Linux under Xvfb in CI, where no input arrives),
+/// lets capture go idle and counts the context switches of the plugin's
+/// own threads (named `kp-*`) in `/proc/self/task/*/status` over an idle
+/// interval. A thread blocked without a timeout does not switch at all, so
+/// any count above [_budget] is a timer or poll loop that keeps an unused
+/// kiosk from reaching deep CPU idle states.
+///
+/// Run with:
+/// ```bash
+/// xvfb-run -a -s "-screen 0 1920x1080x24" \
+///   flutter test integration_test/idle_wakeup_test.dart -d linux
+/// ```
+void main() {
+  IntegrationTestWidgetsFlutterBinding.ensureInitialized();
+
+  testWidgets(
+    'native input threads do not wake up while idle',
+    (tester) async {
+      await tester.pumpWidget(
+        KeyboardPlaygroundApp(gameManager: GameManager()),
+      );
+      await _waitForAppShell(tester);
+      expect(
+        await InputCapture().isCapturing(),
+        isTrue,
+        reason: 'capture must run for the budget to mean anything',
+      );
+
+      // Past the point where the server probe and power polling pause for
+      // lack of input.
+      await Future<void>.delayed(_settleTime);
+
+      final before = _threadSwitches();
+      await Future<void>.delayed(_idleTime);
+      final after = _threadSwitches();
+
+      expect(
+        before.values.map((thread) => thread.name),
+        containsAll(_expectedThreads),
+      );
+
+      final wakeups = <String, int>{
+        for (final entry in after.entries)
+          entry.key:
+              entry.value.switches - (before[entry.key]?.switches ?? 0),
+      };
+      final total = wakeups.values.fold(0, (sum, count) => sum + count);
+      final report = [
+        for (final entry in wakeups.entries)
+          '${after[entry.key]!.name} (${entry.key}): ${entry.value}',
+      ].join('\n');
+      debugPrint('Context switches over $_idleTime of idle:\n$report');
+
+      expect(
+        total,
+        lessThanOrEqualTo(_budget),
+        reason: 'native threads woke up while idle:\n$report',
+      );
+    },
+    skip: kIsWeb || !Platform.isLinux,
+  );
+}
+
+/// Threads that exist while capturing; without them the test would
+/// measure nothing.
+const List<String> _expectedThreads = ['kp-capture', 'kp-merge', 'kp-probe'];
+
+/// Context switches allowed over [_idleTime], summed over all plugin
+/// threads.
+final int _budget =
+    int.tryParse(const String.fromEnvironment('IDLE_WAKEUP_BUDGET')) ?? 0;
+
+const Duration _settleTime = Duration(seconds: 10);
+const Duration _idleTime = Duration(seconds: 10);
+const Duration _startupTimeout = Duration(seconds: 30);
+
+/// Name and context switch count of one thread.
+class _ThreadSwitches {
+  const _ThreadSwitches(this.name, this.switches);
+
+  final String name;
+  final int switches;
+}
+
+/// Voluntary plus involuntary context switches of the plugin threads, by
+/// thread id. Snapshots are keyed by id, so a thread started during the
+/// interval counts in full.
+Map<String, _ThreadSwitches> _threadSwitches() {
+  final switches = <String, _ThreadSwitches>{};
+  for (final task in Directory('/proc/self/task').listSync()) {
+    final id = task.uri.pathSegments.lastWhere((s) => s.isNotEmpty);
+    final String name;
+    final List<String> status;
+    try {
+      name = File('${task.path}/comm').readAsStringSync().trim();
+      if (!name.startsWith('kp-')) continue;
+      status = File('${task.path}/status').readAsLinesSync();
+    } on FileSystemException {
+      // The thread exited while listing.
+      continue;
+    }
+    var count = 0;
+    for (final line in status) {
+      if (line.startsWith('voluntary_ctxt_switches:') ||
+          line.startsWith('nonvoluntary_ctxt_switches:')) {
+        count += int.parse(line.split(':').last.trim());
+      }
+    }
+    switches[id] = _ThreadSwitches(name, count);
+  }
+  return switches;
+}
+
+Future<void> _waitForAppShell(WidgetTester tester) async {
+  final deadline = DateTime.now().add(_startupTimeout);
+  while (find.byType(AppShell).evaluate().isEmpty) {
+    if (DateTime.now().isAfter(deadline)) {
+      fail('App did not finish initializing within $_startupTimeout');
+    }
+    await tester.pump(const Duration(milliseconds: 100));
+  }
+}
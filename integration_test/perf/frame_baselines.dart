@@ -0,0 +1,40 @@
+import 'frame_metrics.dart';
+
+/// Stored frame baselines, keyed by `<game id>/<scenario>`.
+///
+/// Values are for `flutter drive --profile` on the CI runner under Xvfb.
+/// The initial numbers encode PRD-013's 60 FPS target: p90 well inside the
+/// 16.7 ms budget, p99 at the budget for realistic input and 1.5x it for
+/// the stress scenarios. Tighten them from the `frame_performance.json`
+/// report once a few CI runs are in; every new game or scenario needs an
+/// entry here or the suite fails.
+const Map<String, FrameBaseline> kFrameBaselines = {
+  'exploding_letters/typing': _realistic,
+  'exploding_letters/mash': _worstCase,
+  'exploding_letters/mash_4x': _worstCase,
+  'keyboard_visualizer/typing': _realistic,
+  'keyboard_visualizer/mash': _worstCase,
+  'keyboard_visualizer/mash_4x': _worstCase,
+  'mouse_visualizer/typing': _realistic,
+  'mouse_visualizer/mash': _worstCase,
+  'mouse_visualizer/mash_4x': _worstCase,
+  'placeholder/typing': _realistic,
+  'placeholder/mash': _worstCase,
+  'placeholder/mash_4x': _worstCase,
+};
+
+const FrameBaseline _realistic = FrameBaseline(
+  buildP90Ms: 8,
+  buildP99Ms: 16.7,
+  rasterP90Ms: 8,
+  rasterP99Ms: 16.7,
+  jankPercent: 1,
+);
+
+const FrameBaseline _worstCase = FrameBaseline(
+  buildP90Ms: 12,
+  buildP99Ms: 25,
+  rasterP90Ms: 12,
+  rasterP99Ms: 25,
+  jankPercent: 5,
+);
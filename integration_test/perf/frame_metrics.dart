@@ -0,0 +1,141 @@
+import 'dart:math' as math;
+import 'dart:ui';
+
+/// Frame budget for 60 FPS, the target from PRD-013.
+const Duration kFrameBudget = Duration(microseconds: 16667);
+
+/// Build and raster percentiles of a series of frames.
+class FrameMetrics {
+  /// Summarises [timings]. A frame counts as janky when its build or raster
+  /// phase alone exceeded [budget].
+  factory FrameMetrics.fromTimings(
+    List<FrameTiming> timings, {
+    Duration budget = kFrameBudget,
+  }) {
+    final build = timings.map((t) => _ms(t.buildDuration)).toList()..sort();
+    final raster = timings.map((t) => _ms(t.rasterDuration)).toList()..sort();
+    final jank = timings
+        .where((t) => t.buildDuration > budget || t.rasterDuration > budget)
+        .length;
+
+    return FrameMetrics(
+      frameCount: timings.length,
+      buildP50Ms: _percentile(build, 0.5),
+      buildP90Ms: _percentile(build, 0.9),
+      buildP99Ms: _percentile(build, 0.99),
+      rasterP50Ms: _percentile(raster, 0.5),
+      rasterP90Ms: _percentile(raster, 0.9),
+      rasterP99Ms: _percentile(raster, 0.99),
+      jankFrames: jank,
+    );
+  }
+
+  /// Creates metrics from already computed values.
+  const FrameMetrics({
+    required this.frameCount,
+    required this.buildP50Ms,
+    required this.buildP90Ms,
+    required this.buildP99Ms,
+    required this.rasterP50Ms,
+    required this.rasterP90Ms,
+    required this.rasterP99Ms,
+    required this.jankFrames,
+  });
+
+  /// Number of frames measured.
+  final int frameCount;
+
+  /// UI thread build time percentiles, in milliseconds.
+  final double buildP50Ms;
+
+  /// 90th percentile build time, in milliseconds.
+  final double buildP90Ms;
+
+  /// 99th percentile build time, in milliseconds.
+  final double buildP99Ms;
+
+  /// Raster thread time percentiles, in milliseconds.
+  final double rasterP50Ms;
+
+  /// 90th percentile raster time, in milliseconds.
+  final double rasterP90Ms;
+
+  /// 99th percentile raster time, in milliseconds.
+  final double rasterP99Ms;
+
+  /// Frames that missed the budget.
+  final int jankFrames;
+
+  /// Share of janky frames, in percent.
+  double get jankPercent =>
+      frameCount == 0 ? 0 : 100 * jankFrames / frameCount;
+
+  /// Machine-readable form for the driver report.
+  Map<String, Object> toJson() => {
+        'frames': frameCount,
+        'buildP50Ms': buildP50Ms,
+        'buildP90Ms': buildP90Ms,
+        'buildP99Ms': buildP99Ms,
+        'rasterP50Ms': rasterP50Ms,
+        'rasterP90Ms': rasterP90Ms,
+        'rasterP99Ms': rasterP99Ms,
+        'jankFrames': jankFrames,
+        'jankPercent': jankPercent,
+      };
+
+  static double _ms(Duration d) => d.inMicroseconds / 1000;
+
+  static double _percentile(List<double> sorted, double q) {
+    if (sorted.isEmpty) return 0;
+    final rank = (q * sorted.length).ceil() - 1;
+    return sorted[math.max(0, math.min(rank, sorted.length - 1))];
+  }
+}
+
+/// Upper bounds a game must stay under for one replay scenario.
+class FrameBaseline {
+  /// Creates a baseline.
+  const FrameBaseline({
+    required this.buildP90Ms,
+    required this.buildP99Ms,
+    required this.rasterP90Ms,
+    required this.rasterP99Ms,
+    required this.jankPercent,
+  });
+
+  /// Maximum 90th percentile build time, in milliseconds.
+  final double buildP90Ms;
+
+  /// Maximum 99th percentile build time, in milliseconds.
+  final double buildP99Ms;
+
+  /// Maximum 90th percentile raster time, in milliseconds.
+  final double rasterP90Ms;
+
+  /// Maximum 99th percentile raster time, in milliseconds.
+  final double rasterP99Ms;
+
+  /// Maximum share of janky frames, in percent.
+  final double jankPercent;
+
+  /// Describes every metric that exceeds this baseline by more than
+  /// [tolerance] (a fraction, 0.2 = 20 %). Empty when [metrics] pass.
+  List<String> regressions(FrameMetrics metrics, {double tolerance = 0.2}) {
+    final failures = <String>[];
+    void check(String name, double value, double limit) {
+      if (value > limit * (1 + tolerance)) {
+        failures.add(
+          '$name ${value.toStringAsFixed(2)} > '
+          '${limit.toStringAsFixed(2)} (+${(tolerance * 100).round()}%)',
+        );
+      }
+    }
+
+    check('build p90 ms', metrics.buildP90Ms, buildP90Ms);
+    check('build p99 ms', metrics.buildP99Ms, buildP99Ms);
+    check('raster p90 ms', metrics.rasterP90Ms, rasterP90Ms);
+    check('raster p99 ms', metrics.rasterP99Ms, rasterP99Ms);
+    check('jank %', metrics.jankPercent, jankPercent);
+    return failures;
+  }
+}
@@ -7,7 +7,8 @@ library;
 
 import 'dart:async';
 
-import 'package:flutter/foundation.dart';
+import 'package:keyboard_playground/core/log.dart';
+import 'package:keyboard_playground/platform/compact_input_event.dart';
 import 'package:keyboard_playground/platform/input_capture.dart';
 import 'package:keyboard_playground/platform/input_events.dart';
 
@@ -146,6 +147,14 @@ class ExitHandler {
     _setupListeners();
   }
 
+  static const _tag = 'ExitHandler';
+
+  /// Only presses advance a sequence; pointer motion is filtered out before
+  /// it is decoded.
+  static const _inputFilter = CompactEventFilter(
+    types: {InputEventType.keyDown, InputEventType.mouseDown},
+  );
+
   final InputCapture _inputCapture;
   final ExitSequence _keyboardSequence;
   final ExitSequence _mouseSequence;
@@ -172,7 +181,7 @@ class ExitHandler {
   DateTime? _keyboardSequenceStartTime;
   DateTime? _mouseSequenceStartTime;
 
-  StreamSubscription<InputEvent>? _inputSubscription;
+  StreamSubscription<Object>? _inputSubscription;
 
   late double _actualScreenWidth;
   late double _actualScreenHeight;
@@ -195,13 +204,17 @@ class ExitHandler {
   int get currentMouseStep => _currentMouseStep;
 
   void _setupListeners() {
-    _inputSubscription = _inputCapture.events.listen((event) {
-      if (event is KeyEvent && event.isDown) {
-        _handleKeyEvent(event);
-      } else if (event is MouseButtonEvent && event.isDown) {
-        _handleMouseEvent(event);
-      }
-    });
+    _inputSubscription = _inputCapture.listenCompact(
+      (compact) {
+        final event = compact.toInputEvent();
+        if (event is KeyEvent) {
+          _handleKeyEvent(event);
+        } else if (event is MouseButtonEvent) {
+          _handleMouseEvent(event);
+        }
+      },
+      filter: _inputFilter,
+    );
   }
 
   void _handleKeyEvent(KeyEvent event) {
@@ -213,9 +226,10 @@ class ExitHandler {
     final expectedKey = _keyboardSequence.steps[_currentKeyboardStep];
 
     if (event.key == expectedKey) {
-      debugPrint(
-        'Key ${event.key} step '
-        '$_currentKeyboardStep/${_keyboardSequence.steps.length}',
+      Log.trace(
+        _tag,
+        () => 'Key ${event.key} step '
+            '$_currentKeyboardStep/${_keyboardSequence.steps.length}',
       );
       // Correct key pressed
       _currentKeyboardStep++;
@@ -249,16 +263,17 @@ class ExitHandler {
     }
 
     final corner = _getCorner(event.x, event.y);
-    debugPrint(
-      'Mouse (${event.x},${event.y}) corner $corner exp '
-      '${_mouseSequence.steps[_currentMouseStep]} step '
-      '$_currentMouseStep/${_mouseSequence.steps.length}',
+    Log.trace(
+      _tag,
+      () => 'Mouse (${event.x},${event.y}) corner $corner exp '
+          '${_mouseSequence.steps[_currentMouseStep]} step '
+          '$_currentMouseStep/${_mouseSequence.steps.length}',
     );
 
     if (corner == null) {
       // Click was not near any corner
       if (_currentMouseStep > 0) {
-        debugPrint('Click not near corner, resetting sequence');
+        Log.trace(_tag, () => 'Click not near corner, resetting sequence');
         _resetMouse();
       }
       return;
@@ -269,7 +284,10 @@ class ExitHandler {
     if (corner == expectedCorner) {
       // Correct corner clicked
       _currentMouseStep++;
-      debugPrint('Correct corner! Advanced to step $_currentMouseStep');
+      Log.debug(
+        _tag,
+        () => 'Correct corner! Advanced to step $_currentMouseStep',
+      );
 
       // Start or reset the timer
       if (_currentMouseStep == 1) {
@@ -284,7 +302,10 @@ class ExitHandler {
       }
     } else {
       // Wrong corner clicked, reset sequence
-      debugPrint('Wrong corner! Expected $expectedCorner, got $corner');
+      Log.trace(
+        _tag,
+        () => 'Wrong corner! Expected $expectedCorner, got $corner',
+      );
       if (_currentMouseStep > 0) {
         _resetMouse();
       }
@@ -298,14 +319,10 @@ class ExitHandler {
   void updateScreenSize(double width, double height) {
     _actualScreenWidth = width;
     _actualScreenHeight = height;
-    debugPrint('ExitHandler size: ${width}x$height'); // Short summary
-    debugPrint('Corners TL(0-$cornerThreshold,0-$cornerThreshold)');
-    debugPrint('TR(${width - cornerThreshold}-$width,0-$cornerThreshold)');
-    debugPrint(
-      'BR(${width - cornerThreshold}-$width,'
-      '${height - cornerThreshold}-$height)',
+    Log.debug(
+      _tag,
+      () => 'Screen ${width}x$height, corner threshold $cornerThreshold',
     );
-    debugPrint('BL(0-$cornerThreshold,${height - cornerThreshold}-$height)');
   }
 
   /// Determines which corner (if any) the given coordinates are near.
@@ -0,0 +1,163 @@
+/// Shared per-frame time source for games.
+///
+/// Animations read the time many times per frame (every particle, every
+/// trail point). Reading the wall clock for each of them is expensive and
+/// gives slightly different answers within one frame, which also makes
+/// replays non-deterministic. [FrameClock] hands out one timestamp per
+/// frame instead, and can be switched to virtual time for journal replay
+/// and benchmarks.
+library;
+
+import 'package:flutter/scheduler.dart';
+
+/// Frame step used for virtual time: one 60 FPS frame.
+const Duration kVirtualFrameStep = Duration(microseconds: 16667);
+
+/// Hands out the current animation time, one value per frame.
+///
+/// In real-time mode the time of a frame is derived from the engine's vsync
+/// timestamp (mapped onto the wall clock), so every read during that frame
+/// returns the same value. Outside of a frame, e.g. in input handlers, the
+/// wall clock is used.
+///
+/// The vsync timestamp is the only time source: there is no native frame
+/// clock to read, and the native event timestamps are not fed in. Input
+/// handlers that need the time an event happened use the event's own
+/// `timestamp`, which carries the native capture time.
+///
+/// In virtual mode time only moves when [advance] is called, or by a fixed
+/// step per rendered frame, so animation state is reproducible frame for
+/// frame regardless of how fast frames are actually produced.
+///
+/// Example usage:
+/// ```dart
+/// // At startup:
+/// FrameClock.instance.attach(SchedulerBinding.instance);
+///
+/// // In a painter:
+/// final now = FrameClock.instance.now;
+/// ```
+class FrameClock {
+  FrameClock._();
+
+  /// The clock shared by all games.
+  static final FrameClock instance = FrameClock._();
+
+  /// If the vsync-derived time drifts further than this from the wall
+  /// clock, the mapping between the two is re-established.
+  static const Duration _maxDrift = Duration(milliseconds: 100);
+
+  SchedulerBinding? _binding;
+
+  // Real-time mapping from vsync timestamps to wall-clock microseconds.
+  int? _anchorUs;
+  Duration? _frameStamp;
+  DateTime _frameNow = DateTime.fromMicrosecondsSinceEpoch(0);
+
+  // Virtual time.
+  bool _virtual = false;
+  DateTime _virtualNow = DateTime.fromMicrosecondsSinceEpoch(0);
+  Duration? _virtualFrameStep;
+
+  /// Whether the clock currently runs on virtual time.
+  bool get isVirtual => _virtual;
+
+  /// Connects the clock to the scheduler so it can tell frames apart.
+  ///
+  /// Without a binding (e.g. in plain unit tests) real-time mode falls back
+  /// to the wall clock on every read.
+  void attach(SchedulerBinding binding) {
+    _binding = binding;
+    _frameStamp = null;
+  }
+
+  /// Disconnects the clock from the scheduler.
+  void detach() {
+    _binding = null;
+    _frameStamp = null;
+  }
+
+  /// The current animation time.
+  DateTime get now {
+    final stamp = _currentFrameStamp();
+
+    if (_virtual) {
+      if (stamp != null && stamp != _frameStamp) {
+        // Advance by one step per new frame, except for the first frame
+        // after switching to virtual time.
+        final step = _virtualFrameStep;
+        if (_frameStamp != null && step != null) {
+          _virtualNow = _virtualNow.add(step);
+        }
+        _frameStamp = stamp;
+      }
+      return _virtualNow;
+    }
+
+    if (stamp == null) {
+      return DateTime.now();
+    }
+    if (stamp != _frameStamp) {
+      _frameStamp = stamp;
+      _frameNow = _mapFrameStamp(stamp);
+    }
+    return _frameNow;
+  }
+
+  /// Switches to virtual time starting at [start] (default: the current
+  /// time).
+  ///
+  /// With a [frameStep], time advances by that amount for every rendered
+  /// frame; otherwise it only moves through [advance].
+  void useVirtualTime({DateTime? start, Duration? frameStep}) {
+    _virtualNow = start ?? now;
+    _virtualFrameStep = frameStep;
+    _virtual = true;
+    _frameStamp = null;
+  }
+
+  /// Moves virtual time forward by [duration].
+  void advance(Duration duration) {
+    assert(_virtual, 'advance() requires virtual time');
+    _virtualNow = _virtualNow.add(duration);
+  }
+
+  /// Returns to real time.
+  void useRealTime() {
+    _virtual = false;
+    _virtualFrameStep = null;
+    _frameStamp = null;
+  }
+
+  /// Raw vsync timestamp of the frame being produced, or `null` when called
+  /// outside of a frame.
+  Duration? _currentFrameStamp() {
+    final binding = _binding;
+    if (binding == null) return null;
+
+    switch (binding.schedulerPhase) {
+      case SchedulerPhase.transientCallbacks:
+      case SchedulerPhase.midFrameMicrotasks:
+      case SchedulerPhase.persistentCallbacks:
+        return binding.currentSystemFrameTimeStamp;
+      case SchedulerPhase.idle:
+      case SchedulerPhase.postFrameCallbacks:
+        return null;
+    }
+  }
+
+  /// Maps a vsync timestamp onto the wall clock. Costs one wall clock read
+  /// per frame to correct drift between the two clocks.
+  DateTime _mapFrameStamp(Duration stamp) {
+    final wallUs = DateTime.now().microsecondsSinceEpoch;
+    var anchorUs = _anchorUs;
+    if (anchorUs == null ||
+        (anchorUs + stamp.inMicroseconds - wallUs).abs() >
+            _maxDrift.inMicroseconds) {
+      anchorUs = _anchorUs = wallUs - stamp.inMicroseconds;
+    }
+    return DateTime.fromMicrosecondsSinceEpoch(
+      anchorUs + stamp.inMicroseconds,
+    );
+  }
+}
@@ -5,8 +5,11 @@ library;
 
 import 'dart:async';
 
+import 'package:keyboard_playground/core/lazy_game.dart';
 import 'package:keyboard_playground/games/base_game.dart';
+import 'package:keyboard_playground/platform/compact_input_event.dart';
 import 'package:keyboard_playground/platform/input_events.dart';
+import 'package:keyboard_playground/platform/pointer_gesture.dart';
 
 /// Manages the collection of available games and the current active game.
 ///
@@ -14,7 +17,11 @@ import 'package:keyboard_playground/platform/input_events.dart';
 /// - Register and maintain list of available games
 /// - Switch between games
 /// - Forward input events to the active game
-/// - Manage game lifecycle (initialization, disposal)
+/// - Manage game lifecycle (construction, suspend/resume, disposal)
+///
+/// Games registered as [LazyGame] are only constructed when first switched
+/// to (or prewarmed with [prewarmGame]), so startup cost does not grow with
+/// the number of games.
 ///
 /// Example usage:
 /// ```dart
@@ -22,7 +29,14 @@ import 'package:keyboard_playground/platform/input_events.dart';
 ///
 /// // Register games
 /// gameManager.registerGame(ExplodingLettersGame());
-/// gameManager.registerGame(KeyboardVisualizerGame());
+/// gameManager.registerGame(
+///   LazyGame(
+///     id: 'keyboard_visualizer',
+///     name: 'Keyboard Visualizer',
+///     description: 'See which keys you press!',
+///     create: KeyboardVisualizerGame.new,
+///   ),
+/// );
 ///
 /// // Switch to a game
 /// gameManager.switchGame('exploding_letters');
@@ -54,6 +68,7 @@ class GameManager {
   /// Registers a game to make it available for play.
   ///
   /// If a game with the same ID is already registered, it will be replaced.
+  /// Pass a [LazyGame] to defer construction until the game is needed.
   ///
   /// Example:
   /// ```dart
@@ -91,9 +106,11 @@ class GameManager {
 
   /// Switches to the game with the given ID.
   ///
-  /// If a game is currently active, it will be stopped before switching.
-  /// Returns true if the game was successfully switched, false if no game
-  /// with that ID exists.
+  /// If a game is currently active, it will be stopped (suspended) before
+  /// switching. The new game is constructed if needed and resumed. Switching
+  /// to the game that is already active does nothing, so it keeps its state.
+  /// Returns true if the game was successfully switched or already active,
+  /// false if no game with that ID exists.
   ///
   /// Example:
   /// ```dart
@@ -108,6 +125,9 @@ class GameManager {
     if (!_games.containsKey(gameId)) {
       return false;
     }
+    if (_currentGame?.id == gameId) {
+      return true;
+    }
 
     // Stop current game if any
     if (_currentGame != null) {
@@ -115,24 +135,43 @@ class GameManager {
     }
 
     // Switch to new game
-    _currentGame = _games[gameId];
-    _currentGameController.add(_currentGame);
+    final game = _games[gameId]!..onResume();
+    _currentGame = game;
+    _currentGameController.add(game);
 
     return true;
   }
 
   /// Stops the current game and clears the current game state.
   ///
-  /// The game remains registered and can be switched to again later.
+  /// The game is suspended so it can release heavy resources, but remains
+  /// registered and can be switched to again later.
   void stopCurrentGame() {
     if (_currentGame != null) {
       // Note: We don't dispose the game here since it's still registered
       // and may be played again. Only dispose when unregistering.
+      _currentGame!.onSuspend();
       _currentGame = null;
       _currentGameController.add(null);
     }
   }
 
+  /// Constructs a lazily registered game ahead of its first use.
+  ///
+  /// Called when a game gets focus in the selection menu so that switching
+  /// to it is instant. Does nothing for games that are already constructed.
+  /// Returns false if no game with that ID exists.
+  bool prewarmGame(String gameId) {
+    final game = _games[gameId];
+    if (game == null) {
+      return false;
+    }
+    if (game is LazyGame) {
+      game.prewarm();
+    }
+    return true;
+  }
+
   /// Gets a game by its ID.
   ///
   /// Returns null if no game with that ID is registered.
@@ -182,6 +221,26 @@ class GameManager {
     }
   }
 
+  /// Forwards a compact event to the current game.
+  ///
+  /// The game gets the first chance to handle [event] through
+  /// [BaseGame.onCompactEvent]; otherwise it is converted and forwarded
+  /// like [handleInputEvent]. Does nothing if no game is currently active.
+  void handleCompactEvent(CompactInputEvent event) {
+    final game = _currentGame;
+    if (game == null || game.onCompactEvent(event)) {
+      return;
+    }
+    handleInputEvent(event.toInputEvent());
+  }
+
+  /// Forwards a recognized pointer gesture to the current game.
+  ///
+  /// Does nothing if no game is currently active.
+  void handleGesture(PointerGestureEvent gesture) {
+    _currentGame?.onGesture(gesture);
+  }
+
   /// Disposes of all resources used by the game manager.
   ///
   /// This will dispose of all registered games and close all streams.
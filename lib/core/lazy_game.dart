@@ -0,0 +1,111 @@
+/// Deferred game construction.
+///
+/// Lets the game catalogue grow without adding to startup time: only the
+/// metadata needed by the selection menu exists until a game is played.
+library;
+
+import 'package:flutter/widgets.dart';
+import 'package:keyboard_playground/games/base_game.dart';
+import 'package:keyboard_playground/platform/compact_input_event.dart';
+import 'package:keyboard_playground/platform/input_events.dart' as events;
+import 'package:keyboard_playground/platform/pointer_gesture.dart';
+
+/// Creates a game instance.
+typedef GameFactory = BaseGame Function();
+
+/// A registered game that is only constructed when it is first needed.
+///
+/// Forwards everything to the real game, which is built by [create] on first
+/// use or ahead of time through [prewarm].
+///
+/// Example usage:
+/// ```dart
+/// gameManager.registerGame(
+///   LazyGame(
+///     id: ExplodingLettersGame.gameId,
+///     name: ExplodingLettersGame.gameName,
+///     description: ExplodingLettersGame.gameDescription,
+///     create: ExplodingLettersGame.new,
+///   ),
+/// );
+/// ```
+class LazyGame extends BaseGame {
+  /// Creates a lazily constructed game with the given metadata.
+  ///
+  /// The metadata must match what the constructed game reports; take it
+  /// from the game's static constants rather than repeating it.
+  LazyGame({
+    required this.id,
+    required this.name,
+    required this.description,
+    required GameFactory create,
+  }) : _create = create;
+
+  @override
+  final String id;
+
+  @override
+  final String name;
+
+  @override
+  final String description;
+
+  final GameFactory _create;
+  BaseGame? _game;
+
+  /// Whether the game has been constructed.
+  bool get isCreated => _game != null;
+
+  /// The constructed game, building it if necessary.
+  BaseGame get game {
+    final existing = _game;
+    if (existing != null) return existing;
+
+    final created = _create();
+    assert(
+      created.id == id &&
+          created.name == name &&
+          created.description == description,
+      'LazyGame "$id" ($name) created a game with different metadata: '
+      '"${created.id}" (${created.name})',
+    );
+    return _game = created;
+  }
+
+  /// Constructs the game ahead of time, e.g. while it is highlighted in the
+  /// selection menu, so switching to it does not stall a frame.
+  void prewarm() => game;
+
+  @override
+  Widget buildUI() => game.buildUI();
+
+  @override
+  void onKeyEvent(events.KeyEvent event) => _game?.onKeyEvent(event);
+
+  @override
+  void onMouseEvent(events.InputEvent event) => _game?.onMouseEvent(event);
+
+  @override
+  bool onCompactEvent(CompactInputEvent event) =>
+      _game?.onCompactEvent(event) ?? true;
+
+  @override
+  CompactEventFilter get inputFilter =>
+      _game?.inputFilter ?? CompactEventFilter.all;
+
+  @override
+  void onGesture(PointerGestureEvent gesture) => _game?.onGesture(gesture);
+
+  @override
+  void onResume() => game.onResume();
+
+  @override
+  void onSuspend() => _game?.onSuspend();
+
+  @override
+  void dispose() {
+    _game?.dispose();
+    _game = null;
+    super.dispose();
+  }
+}
@@ -0,0 +1,209 @@
+/// Level-gated logging with an in-memory ring.
+///
+/// Messages are passed as closures, so a disabled level costs one compare
+/// and never builds its string. Levels below [Log.compiledLevel] are
+/// compiled out of release builds entirely: the check folds to `false` and
+/// the inlined call disappears with its closure.
+///
+/// Every enabled message goes to a fixed-size ring that [Log.dump] can read
+/// back after a problem; only messages at [Log.consoleLevel] or above are
+/// also printed.
+library;
+
+import 'package:flutter/foundation.dart';
+
+/// Severity of a log message.
+///
+/// The order mirrors `LogLevel` in linux/log.h.
+enum LogLevel {
+  /// Per-event detail, e.g. every click seen by the exit handler.
+  trace,
+
+  /// Diagnostics useful while developing.
+  debug,
+
+  /// Noteworthy state changes, e.g. startup steps.
+  info,
+
+  /// Something went wrong but the app carries on.
+  warning,
+
+  /// Something failed.
+  error,
+
+  /// Disables logging.
+  off,
+}
+
+/// Builds a log message. Only called when the level is enabled.
+typedef LogMessage = String Function();
+
+/// A recorded log message.
+@immutable
+class LogRecord {
+  /// Creates a log record.
+  const LogRecord({
+    required this.sequence,
+    required this.timeUs,
+    required this.level,
+    required this.tag,
+    required this.message,
+  });
+
+  /// Creates a log record from a map sent by the native log ring.
+  factory LogRecord.fromNativeMap(Map<Object?, Object?> map) {
+    final index = map['level'] as int? ?? LogLevel.info.index;
+    return LogRecord(
+      sequence: map['sequence'] as int? ?? 0,
+      timeUs: map['timeUs'] as int? ?? 0,
+      level: LogLevel.values[index.clamp(0, LogLevel.values.length - 1)],
+      tag: 'native',
+      message: map['message'] as String? ?? '',
+    );
+  }
+
+  /// Position in its log; increases by one per message.
+  final int sequence;
+
+  /// Wall-clock time of the message, in microseconds since the epoch.
+  final int timeUs;
+
+  /// Severity of the message.
+  final LogLevel level;
+
+  /// Component that logged the message.
+  final String tag;
+
+  /// The message text.
+  final String message;
+
+  @override
+  String toString() {
+    final time = DateTime.fromMicrosecondsSinceEpoch(timeUs).toIso8601String();
+    return '$time ${level.name.toUpperCase()} [$tag] $message';
+  }
+}
+
+/// A fixed-size ring of the most recent [LogRecord]s.
+///
+/// Adding overwrites the oldest record once full; nothing is allocated
+/// besides the record itself.
+class LogRing {
+  /// Creates a ring holding up to [capacity] records.
+  LogRing(this.capacity) : _records = List<LogRecord?>.filled(capacity, null);
+
+  /// Maximum number of records kept.
+  final int capacity;
+
+  final List<LogRecord?> _records;
+  int _next = 0;
+
+  /// Number of records added so far, including overwritten ones.
+  int get written => _next;
+
+  /// Adds [record], overwriting the oldest one if the ring is full.
+  void add(LogRecord record) {
+    _records[_next % capacity] = record;
+    _next++;
+  }
+
+  /// The records in the ring, oldest first.
+  List<LogRecord> toList() {
+    final count = _next < capacity ? _next : capacity;
+    return [
+      for (var i = _next - count; i < _next; i++) _records[i % capacity]!,
+    ];
+  }
+
+  /// Removes all records.
+  void clear() {
+    _records.fillRange(0, capacity, null);
+    _next = 0;
+  }
+}
+
+/// Process-wide logger.
+///
+/// Example usage:
+/// ```dart
+/// Log.debug('exit', () => 'Mouse at $x,$y');
+///
+/// // After a problem:
+/// Log.dump().forEach(debugPrint);
+/// ```
+class Log {
+  Log._();
+
+  /// Lowest level compiled into this build.
+  static const LogLevel compiledLevel =
+      kReleaseMode ? LogLevel.info : LogLevel.trace;
+
+  /// Lowest level recorded at runtime. Levels below [compiledLevel] stay
+  /// disabled.
+  static LogLevel level = kReleaseMode ? LogLevel.info : LogLevel.debug;
+
+  /// Lowest level also printed with [debugPrint].
+  static LogLevel consoleLevel = LogLevel.info;
+
+  /// The most recent messages.
+  static final LogRing ring = LogRing(512);
+
+  /// Whether messages at [messageLevel] are recorded.
+  @pragma('vm:prefer-inline')
+  static bool isEnabled(LogLevel messageLevel) =>
+      messageLevel.index >= compiledLevel.index &&
+      messageLevel.index >= level.index;
+
+  /// Logs a [LogLevel.trace] message.
+  @pragma('vm:prefer-inline')
+  static void trace(String tag, LogMessage message) {
+    if (kReleaseMode) return;
+    if (isEnabled(LogLevel.trace)) _write(LogLevel.trace, tag, message());
+  }
+
+  /// Logs a [LogLevel.debug] message.
+  @pragma('vm:prefer-inline')
+  static void debug(String tag, LogMessage message) {
+    if (kReleaseMode) return;
+    if (isEnabled(LogLevel.debug)) _write(LogLevel.debug, tag, message());
+  }
+
+  /// Logs a [LogLevel.info] message.
+  @pragma('vm:prefer-inline')
+  static void info(String tag, LogMessage message) {
+    if (isEnabled(LogLevel.info)) _write(LogLevel.info, tag, message());
+  }
+
+  /// Logs a [LogLevel.warning] message.
+  static void warning(String tag, LogMessage message) {
+    if (isEnabled(LogLevel.warning)) _write(LogLevel.warning, tag, message());
+  }
+
+  /// Logs a [LogLevel.error] message, with an optional [stackTrace].
+  static void error(String tag, LogMessage message, [StackTrace? stackTrace]) {
+    if (!isEnabled(LogLevel.error)) return;
+    _write(
+      LogLevel.error,
+      tag,
+      stackTrace == null ? message() : '${message()}\n$stackTrace',
+    );
+  }
+
+  /// The messages in [ring], oldest first.
+  static List<LogRecord> dump() => ring.toList();
+
+  static void _write(LogLevel messageLevel, String tag, String message) {
+    ring.add(
+      LogRecord(
+        sequence: ring.written,
+        timeUs: DateTime.now().microsecondsSinceEpoch,
+        level: messageLevel,
+        tag: tag,
+        message: message,
+      ),
+    );
+    if (messageLevel.index >= consoleLevel.index) {
+      debugPrint('[$tag] $message');
+    }
+  }
+}
@@ -0,0 +1,198 @@
+/// Frame-time-driven rendering quality.
+///
+/// The same build runs on fast desktops and on old low-power kiosks. Rather
+/// than tuning effects for the slowest machine, [QualityController] watches
+/// how long frames actually take to build and rasterize and publishes a
+/// [QualityLevel] that games use to scale particle counts, trail lengths and
+/// background animation.
+library;
+
+import 'dart:math';
+import 'dart:ui' show FrameTiming;
+
+import 'package:flutter/foundation.dart';
+import 'package:flutter/scheduler.dart';
+
+/// Rendering quality published by [QualityController].
+enum QualityLevel {
+  /// Minimal effects for machines that cannot keep up otherwise.
+  low(0.3),
+
+  /// Reduced effects.
+  medium(0.6),
+
+  /// Full effects.
+  high(1);
+
+  const QualityLevel(this.detail);
+
+  /// Fraction of the full effect budget to use at this level, e.g. for
+  /// particle counts or trail lengths.
+  final double detail;
+
+  /// Scales [full] by [detail], keeping at least [min].
+  int scale(int full, {int min = 1}) => max(min, (full * detail).round());
+}
+
+/// Publishes a [QualityLevel] based on recent frame times.
+///
+/// Frames are judged in windows of [windowFrames]. The cost of a frame is
+/// the larger of its build and raster time (the two run in parallel on
+/// different threads, so the slower one limits the frame rate). The 90th
+/// percentile cost of each window is compared with [frameBudget]:
+///
+/// - above [downgradeThreshold] of the budget, quality drops one level
+///   immediately;
+/// - below [upgradeThreshold] of the budget for [upgradeWindows] windows in
+///   a row, quality rises one level.
+///
+/// The gap between the two thresholds and the longer upgrade delay are the
+/// hysteresis: a machine that only just holds the budget at one level does
+/// not flip back and forth between two levels.
+///
+/// A [limit] caps the level from outside, e.g. when the machine is about
+/// to throttle thermally although frames are still on time.
+///
+/// Example usage:
+/// ```dart
+/// // At startup:
+/// QualityController.instance.attach(SchedulerBinding.instance);
+///
+/// // In a game:
+/// final count = QualityController.instance.level.value.scale(25);
+/// ```
+class QualityController {
+  /// Creates a controller. Most code should use [instance].
+  QualityController({
+    this.frameBudget = const Duration(microseconds: 16667),
+    this.windowFrames = 60,
+    this.downgradeThreshold = 0.9,
+    this.upgradeThreshold = 0.5,
+    this.upgradeWindows = 5,
+    QualityLevel initial = QualityLevel.high,
+  })  : assert(upgradeThreshold < downgradeThreshold, 'no hysteresis band'),
+        _adaptive = initial,
+        _level = ValueNotifier<QualityLevel>(initial);
+
+  /// The controller shared by all games.
+  static final QualityController instance = QualityController();
+
+  /// Target time per frame (60 FPS by default).
+  final Duration frameBudget;
+
+  /// Number of frames judged together.
+  final int windowFrames;
+
+  /// Fraction of [frameBudget] above which quality is lowered.
+  final double downgradeThreshold;
+
+  /// Fraction of [frameBudget] below which quality may be raised.
+  final double upgradeThreshold;
+
+  /// Number of consecutive fast windows required before raising quality.
+  final int upgradeWindows;
+
+  final ValueNotifier<QualityLevel> _level;
+  final List<int> _window = [];
+  int _fastWindows = 0;
+  QualityLevel _adaptive;
+  QualityLevel? _ceiling;
+  QualityLevel? _pinned;
+  SchedulerBinding? _binding;
+
+  /// The current quality level.
+  ValueListenable<QualityLevel> get level => _level;
+
+  /// Starts watching the frame timings reported by [binding].
+  void attach(SchedulerBinding binding) {
+    detach();
+    _binding = binding..addTimingsCallback(addTimings);
+  }
+
+  /// Stops watching frame timings.
+  void detach() {
+    _binding?.removeTimingsCallback(addTimings);
+    _binding = null;
+    _window.clear();
+    _fastWindows = 0;
+  }
+
+  /// Fixes quality at [level], or resumes adapting when `null`.
+  ///
+  /// Used for benchmarks that must render the same effects on every run.
+  void pin(QualityLevel? level) {
+    _pinned = level;
+    _window.clear();
+    _fastWindows = 0;
+    if (level != null) {
+      _level.value = level;
+    } else {
+      _adaptive = _level.value;
+      limit(_ceiling);
+    }
+  }
+
+  /// Caps quality at [ceiling], or removes the cap when `null`.
+  ///
+  /// Adapting continues below the cap. When the cap is raised, quality
+  /// climbs back one level at a time as frame times allow.
+  void limit(QualityLevel? ceiling) {
+    _ceiling = ceiling;
+    if (ceiling != null && _adaptive.index > ceiling.index) {
+      _adaptive = ceiling;
+      _fastWindows = 0;
+    }
+    _publish();
+  }
+
+  /// The current cap set with [limit], if any.
+  QualityLevel? get ceiling => _ceiling;
+
+  void _publish() {
+    if (_pinned != null) return;
+    _level.value = _adaptive;
+  }
+
+  /// Records frame timings as reported by the engine.
+  void addTimings(List<FrameTiming> timings) {
+    for (final timing in timings) {
+      recordFrame(
+        build: timing.buildDuration,
+        raster: timing.rasterDuration,
+      );
+    }
+  }
+
+  /// Records the cost of one frame.
+  void recordFrame({required Duration build, required Duration raster}) {
+    if (_pinned != null) return;
+
+    _window.add(max(build.inMicroseconds, raster.inMicroseconds));
+    if (_window.length < windowFrames) return;
+
+    _window.sort();
+    final p90 = _window[((_window.length - 1) * 0.9).round()];
+    _window.clear();
+
+    final budgetUs = frameBudget.inMicroseconds;
+    final current = _adaptive;
+    final highest = _ceiling?.index ?? QualityLevel.values.length - 1;
+    if (p90 > budgetUs * downgradeThreshold) {
+      _fastWindows = 0;
+      if (current.index > 0) {
+        _adaptive = QualityLevel.values[current.index - 1];
+        _publish();
+      }
+    } else if (p90 < budgetUs * upgradeThreshold) {
+      _fastWindows++;
+      if (_fastWindows >= upgradeWindows && current.index < highest) {
+        _fastWindows = 0;
+        _adaptive = QualityLevel.values[current.index + 1];
+        _publish();
+      }
+    } else {
+      // Inside the hysteresis band: the current level fits.
+      _fastWindows = 0;
+    }
+  }
+}
@@ -1,5 +1,7 @@
 import 'package:flutter/widgets.dart';
+import 'package:keyboard_playground/platform/compact_input_event.dart';
 import 'package:keyboard_playground/platform/input_events.dart' as events;
+import 'package:keyboard_playground/platform/pointer_gesture.dart';
 
 /// Base interface for all games in Keyboard Playground.
 ///
@@ -35,6 +37,40 @@ abstract class BaseGame {
     // Games can override to handle mouse input
   }
 
+  /// Fast path for input delivered as [CompactInputEvent]s.
+  ///
+  /// [event] is reused for every event and only valid during this call.
+  /// Return `true` if the event was handled (or deliberately ignored).
+  /// Otherwise it is converted and delivered to [onKeyEvent] or
+  /// [onMouseEvent] as usual. Games that receive high-rate pointer motion
+  /// should handle it here to avoid allocating an event per sample.
+  bool onCompactEvent(CompactInputEvent event) => false;
+
+  /// Events this game needs while it is the active game.
+  ///
+  /// Events that do not pass are dropped before they are decoded, on a
+  /// background isolate where available. Games that ignore pointer input
+  /// should return [CompactEventFilter.keys].
+  CompactEventFilter get inputFilter => CompactEventFilter.all;
+
+  /// Called when a pointer gesture (circle, shake, scribble or swipe) is
+  /// recognized in the captured motion.
+  ///
+  /// The motion itself is still delivered as regular mouse events.
+  void onGesture(PointerGestureEvent gesture) {}
+
+  /// Called right before the game becomes the active game, including the
+  /// first time it is shown.
+  ///
+  /// Recreate anything released in [onSuspend] here.
+  void onResume() {}
+
+  /// Called when the game stops being the active game.
+  ///
+  /// The game stays registered and may be resumed later, so keep only
+  /// cheap state: release particle pools, caches and timers here.
+  void onSuspend() {}
+
   /// Called when the game is being disposed.
   ///
   /// Clean up any resources here.
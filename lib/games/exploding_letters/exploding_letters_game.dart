@@ -11,7 +11,10 @@ import 'dart:math';
 
 import 'package:flutter/material.dart';
 import 'package:flutter/scheduler.dart';
+import 'package:keyboard_playground/core/frame_clock.dart';
+import 'package:keyboard_playground/core/quality_controller.dart';
 import 'package:keyboard_playground/games/base_game.dart';
+import 'package:keyboard_playground/platform/compact_input_event.dart';
 import 'package:keyboard_playground/platform/input_events.dart' as events;
 
 /// Main game class for the Exploding Letters game.
@@ -37,6 +40,10 @@ class ExplodingLettersGame extends BaseGame {
   /// Letter scale growth rate multiplier.
   static const int letterScaleRate = 2;
 
+  /// Particles per explosion at full quality. Scaled down by the current
+  /// [QualityLevel].
+  static const int maxParticles = 25;
+
   final List<LetterEntity> _activeLetters = [];
   final Random _random = Random();
   final ValueNotifier<int> _updateNotifier = ValueNotifier<int>(0);
@@ -44,14 +51,25 @@ class ExplodingLettersGame extends BaseGame {
   bool _isScheduled = false;
   Size _screenSize = const Size(1920, 1080); // Default, updated from layout
 
+  /// Identifier of this game. The metadata is static so the game can be
+  /// listed and registered lazily without constructing it.
+  static const String gameId = 'exploding_letters';
+
+  /// Display name of this game.
+  static const String gameName = 'Exploding Letters';
+
+  /// Short description of this game.
+  static const String gameDescription =
+      'Letters explode with each key press!';
+
   @override
-  String get id => 'exploding_letters';
+  String get id => gameId;
 
   @override
-  String get name => 'Exploding Letters';
+  String get name => gameName;
 
   @override
-  String get description => 'Letters explode with each key press!';
+  String get description => gameDescription;
 
   @override
   Widget buildUI() {
@@ -111,7 +129,11 @@ class ExplodingLettersGame extends BaseGame {
       character: character,
       position: _randomPosition(),
       color: _randomColor(),
-      createdAt: DateTime.now(),
+      createdAt: FrameClock.instance.now,
+      particleCount: QualityController.instance.level.value.scale(
+        maxParticles,
+        min: 6,
+      ),
     );
 
     _activeLetters.add(letter);
@@ -212,7 +234,7 @@ class ExplodingLettersGame extends BaseGame {
     if (_activeLetters.isEmpty) return;
 
     // Clean up old letters (single cleanup mechanism)
-    final now = DateTime.now();
+    final now = FrameClock.instance.now;
     _activeLetters.removeWhere((letter) {
       final age = now.difference(letter.createdAt).inMilliseconds;
       return age > animationDurationMs;
@@ -224,6 +246,25 @@ class ExplodingLettersGame extends BaseGame {
 
   bool _disposed = false;
 
+  @override
+  CompactEventFilter get inputFilter => CompactEventFilter.keys;
+
+  @override
+  bool onCompactEvent(CompactInputEvent event) {
+    // Only key presses spawn letters; drop pointer input without building an
+    // event.
+    return event.type != events.InputEventType.keyDown &&
+        event.type != events.InputEventType.keyUp;
+  }
+
+  @override
+  void onSuspend() {
+    // Drop in-flight explosions and their particles; the frame loop stops by
+    // itself once no letters are left.
+    _activeLetters.clear();
+    _updateNotifier.value++;
+  }
+
   @override
   void dispose() {
     if (_disposed) return;
@@ -252,10 +293,11 @@ class LetterEntity {
     required this.position,
     required this.color,
     required this.createdAt,
+    int particleCount = ExplodingLettersGame.maxParticles,
   }) {
     // Generate particles for explosion
     final random = Random();
-    for (var i = 0; i < 25; i++) {
+    for (var i = 0; i < particleCount; i++) {
       // Random angle and speed
       final angle = random.nextDouble() * 2 * pi;
       final speed = 100 + random.nextDouble() * 200; // pixels per second
@@ -328,9 +370,12 @@ class LetterEntity {
     return _cachedTextPainter!;
   }
 
-  /// Gets the progress of the animation (0.0 to 1.0).
-  double getProgress() {
-    final age = DateTime.now().difference(createdAt).inMilliseconds;
+  /// Gets the progress of the animation (0.0 to 1.0) at [now], which
+  /// defaults to the current frame time.
+  double getProgress({DateTime? now}) {
+    final age = (now ?? FrameClock.instance.now)
+        .difference(createdAt)
+        .inMilliseconds;
     return (age / ExplodingLettersGame.animationDurationMs).clamp(0.0, 1.0);
   }
 }
@@ -364,9 +409,13 @@ class Particle {
   /// Gravity constant (pixels per second squared).
   static const double gravity = 300;
 
-  /// Gets the current position of the particle based on elapsed time.
-  Offset getCurrentPosition() {
-    final elapsed = DateTime.now().difference(createdAt).inMilliseconds / 1000;
+  /// Gets the position of the particle at [now], which defaults to the
+  /// current frame time.
+  Offset getCurrentPosition({DateTime? now}) {
+    final elapsedUs = (now ?? FrameClock.instance.now)
+        .difference(createdAt)
+        .inMicroseconds;
+    final elapsed = max(0, elapsedUs) / 1000000;
 
     // Apply physics: position = initial + velocity * time +
     // 0.5 * gravity * time^2
@@ -376,9 +425,11 @@ class Particle {
     );
   }
 
-  /// Gets the opacity of the particle based on age (fades out).
-  double getOpacity() {
-    final age = DateTime.now().difference(createdAt).inMilliseconds;
+  /// Gets the opacity of the particle at [now] based on age (fades out).
+  double getOpacity({DateTime? now}) {
+    final age = (now ?? FrameClock.instance.now)
+        .difference(createdAt)
+        .inMilliseconds;
     final progress =
         (age / ExplodingLettersGame.animationDurationMs).clamp(0.0, 1.0);
 
@@ -399,8 +450,11 @@ class ExplodingLettersPainter extends CustomPainter {
 
   @override
   void paint(Canvas canvas, Size size) {
+    // One timestamp for the whole frame.
+    final now = FrameClock.instance.now;
+
     for (final letter in letters) {
-      final progress = letter.getProgress();
+      final progress = letter.getProgress(now: now);
 
       // Draw the letter (visible for first portion of animation)
       if (progress < ExplodingLettersGame.letterVisibilityThreshold) {
@@ -408,7 +462,7 @@ class ExplodingLettersPainter extends CustomPainter {
       }
 
       // Draw particles (visible throughout animation)
-      _drawParticles(canvas, letter);
+      _drawParticles(canvas, letter, now);
     }
   }
 
@@ -436,10 +490,10 @@ class ExplodingLettersPainter extends CustomPainter {
   }
 
   /// Draws all particles for a letter.
-  void _drawParticles(Canvas canvas, LetterEntity letter) {
+  void _drawParticles(Canvas canvas, LetterEntity letter, DateTime now) {
     for (final particle in letter.particles) {
-      final position = particle.getCurrentPosition();
-      final opacity = particle.getOpacity();
+      final position = particle.getCurrentPosition(now: now);
+      final opacity = particle.getOpacity(now: now);
 
       if (opacity <= 0) continue;
 
@@ -8,6 +8,7 @@ library;
 
 import 'package:flutter/material.dart';
 import 'package:keyboard_playground/games/base_game.dart';
+import 'package:keyboard_playground/platform/compact_input_event.dart';
 import 'package:keyboard_playground/platform/input_events.dart' as events;
 import 'package:keyboard_playground/ui/app_theme.dart';
 
@@ -47,15 +48,26 @@ class KeyboardVisualizerGame extends BaseGame {
     });
   }
 
+  /// Identifier of this game. The metadata is static so the game can be
+  /// listed and registered lazily without constructing it.
+  static const String gameId = 'keyboard_visualizer';
+
+  /// Display name of this game.
+  static const String gameName = 'Keyboard Visualizer';
+
+  /// Short description of this game.
+  static const String gameDescription =
+      'Watch your keyboard light up as you type! '
+      'See which keys are pressed in real-time.';
+
   @override
-  String get id => 'keyboard_visualizer';
+  String get id => gameId;
 
   @override
-  String get name => 'Keyboard Visualizer';
+  String get name => gameName;
 
   @override
-  String get description => 'Watch your keyboard light up as you type! '
-      'See which keys are pressed in real-time.';
+  String get description => gameDescription;
 
   @override
   Widget buildUI() {
@@ -248,6 +260,16 @@ class KeyboardVisualizerGame extends BaseGame {
     _stateNotifier.value++;
   }
 
+  @override
+  CompactEventFilter get inputFilter => CompactEventFilter.keys;
+
+  @override
+  bool onCompactEvent(CompactInputEvent event) {
+    // Pointer input is not shown; drop it without building an event.
+    return event.type != events.InputEventType.keyDown &&
+        event.type != events.InputEventType.keyUp;
+  }
+
   bool _isGenericModifier(String key) {
     return key == 'Shift' || key == 'Control' || key == 'Alt' || key == 'Meta';
   }
@@ -263,6 +285,14 @@ class KeyboardVisualizerGame extends BaseGame {
     return key;
   }
 
+  @override
+  void onSuspend() {
+    // Key releases are not delivered while suspended; forget held keys so
+    // none stay lit on resume.
+    _keyStates.clear();
+    _stateNotifier.value++;
+  }
+
   @override
   void dispose() {
     _stateNotifier.dispose();
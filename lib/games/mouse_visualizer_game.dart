@@ -5,13 +5,19 @@
 /// - Trail effect following mouse movement (up to 30 positions within 1 second)
 /// - Expanding ripple animations on clicks
 /// - Button state indicators (L/R/M) showing which buttons are pressed
+/// - A big burst and a label when a circle, shake, scribble or swipe is
+///   recognized
 library;
 
 import 'dart:async';
 
 import 'package:flutter/material.dart';
+import 'package:keyboard_playground/core/frame_clock.dart';
+import 'package:keyboard_playground/core/quality_controller.dart';
 import 'package:keyboard_playground/games/base_game.dart';
+import 'package:keyboard_playground/platform/compact_input_event.dart';
 import 'package:keyboard_playground/platform/input_events.dart' as events;
+import 'package:keyboard_playground/platform/pointer_gesture.dart';
 
 /// A visualizer that shows mouse position, trails, clicks, and button states.
 ///
@@ -20,6 +26,7 @@ import 'package:keyboard_playground/platform/input_events.dart' as events;
 /// - Fading trail showing up to 30 mouse positions within 1 second
 /// - Click ripple animations with different colors per button
 /// - Real-time button state indicators in corners
+/// - Gesture bursts for recognized pointer gestures
 class MouseVisualizerGame extends BaseGame {
   /// Creates a new mouse visualizer game.
   MouseVisualizerGame() {
@@ -35,10 +42,15 @@ class MouseVisualizerGame extends BaseGame {
   static const double _maxTrailSize = 20;
   static const double _rippleStartSize = 20;
   static const double _rippleMaxSize = 220;
+  static const double _burstMaxSize = 480;
+
+  /// Gestures below this confidence are ignored.
+  static const double _minGestureConfidence = 0.5;
 
   Offset _mousePosition = Offset.zero;
   final List<_TrailPoint> _trail = [];
   final List<_ClickRipple> _ripples = [];
+  final List<_GestureBurst> _bursts = [];
   final Map<events.MouseButton, bool> _buttonStates = {
     events.MouseButton.left: false,
     events.MouseButton.right: false,
@@ -49,15 +61,25 @@ class MouseVisualizerGame extends BaseGame {
   bool _disposed = false;
   Timer? _animationTimer;
 
+  /// Identifier of this game. The metadata is static so the game can be
+  /// listed and registered lazily without constructing it.
+  static const String gameId = 'mouse_visualizer';
+
+  /// Display name of this game.
+  static const String gameName = 'Mouse Visualizer';
+
+  /// Short description of this game.
+  static const String gameDescription =
+      'Real-time visualization of mouse position and button states';
+
   @override
-  String get id => 'mouse_visualizer';
+  String get id => gameId;
 
   @override
-  String get name => 'Mouse Visualizer';
+  String get name => gameName;
 
   @override
-  String get description =>
-      'Real-time visualization of mouse position and button states';
+  String get description => gameDescription;
 
   /// Schedules the next animation frame using a timer.
   void _scheduleNextFrame() {
@@ -72,7 +94,7 @@ class MouseVisualizerGame extends BaseGame {
       }
 
       // Stop animation if no active elements
-      if (_trail.isEmpty && _ripples.isEmpty) {
+      if (_trail.isEmpty && _ripples.isEmpty && _bursts.isEmpty) {
         timer.cancel();
         _animationTimer = null;
         return;
@@ -85,7 +107,7 @@ class MouseVisualizerGame extends BaseGame {
   @override
   Widget buildUI() {
     // Capture current time once per frame for all calculations
-    final now = DateTime.now();
+    final now = FrameClock.instance.now;
 
     return Container(
       decoration: const BoxDecoration(
@@ -112,7 +134,9 @@ class MouseVisualizerGame extends BaseGame {
               // Instructions
               _buildInstructions(),
 
-              // Ripples (drawn first, behind cursor and trail)
+              // Gesture bursts and ripples (drawn first, behind cursor and
+              // trail)
+              ..._buildGestureBursts(now),
               ..._buildRipples(now),
 
               // Trail (drawn before cursor)
@@ -235,6 +259,59 @@ class MouseVisualizerGame extends BaseGame {
     return widgets;
   }
 
+  List<Widget> _buildGestureBursts(DateTime now) {
+    _bursts.removeWhere((burst) {
+      return now.difference(burst.timestamp).inMilliseconds >
+          _animationDurationMs;
+    });
+
+    final widgets = <Widget>[];
+    for (final burst in _bursts) {
+      final age = now.difference(burst.timestamp).inMilliseconds;
+      final progress = (age / _animationDurationMs).clamp(0.0, 1.0);
+      final size =
+          _rippleStartSize + (progress * (_burstMaxSize - _rippleStartSize));
+      final opacity = (1.0 - progress).clamp(0.0, 1.0);
+
+      widgets
+        ..add(
+          Positioned(
+            left: burst.position.dx - size / 2,
+            top: burst.position.dy - size / 2,
+            child: Container(
+              width: size,
+              height: size,
+              decoration: BoxDecoration(
+                shape: BoxShape.circle,
+                color: burst.color.withValues(alpha: opacity * 0.25),
+                border: Border.all(
+                  color: burst.color.withValues(alpha: opacity),
+                  width: 6,
+                ),
+              ),
+            ),
+          ),
+        )
+        ..add(
+          Positioned(
+            left: burst.position.dx - 150,
+            top: burst.position.dy - 30 - progress * 60,
+            width: 300,
+            child: Text(
+              burst.label,
+              textAlign: TextAlign.center,
+              style: TextStyle(
+                fontSize: 40,
+                fontWeight: FontWeight.bold,
+                color: burst.color.withValues(alpha: opacity),
+              ),
+            ),
+          ),
+        );
+    }
+    return widgets;
+  }
+
   Widget _buildButtonIndicators() {
     return Positioned(
       top: 40,
@@ -347,20 +424,96 @@ class MouseVisualizerGame extends BaseGame {
     _notifyUpdate();
   }
 
+  @override
+  bool onCompactEvent(CompactInputEvent event) {
+    // Motion arrives at up to 1000 Hz; take it straight from the compact
+    // event. Everything else goes through onMouseEvent.
+    if (event.type != events.InputEventType.mouseMove) {
+      return false;
+    }
+    _moveTo(event.x, event.y);
+    _notifyUpdate();
+    return true;
+  }
+
+  @override
+  void onGesture(PointerGestureEvent gesture) {
+    if (gesture.confidence < _minGestureConfidence) return;
+
+    _bursts.add(
+      _GestureBurst(
+        position: Offset(gesture.x, gesture.y),
+        label: _gestureLabel(gesture),
+        color: _gestureColor(gesture.gesture),
+        timestamp: FrameClock.instance.now,
+      ),
+    );
+    _scheduleNextFrame();
+    _notifyUpdate();
+  }
+
+  /// Labels of the gesture bursts currently on screen, oldest first.
+  @visibleForTesting
+  List<String> get gestureLabels => [for (final b in _bursts) b.label];
+
+  String _gestureLabel(PointerGestureEvent gesture) {
+    switch (gesture.gesture) {
+      case PointerGesture.circle:
+        return 'Circle!';
+      case PointerGesture.shake:
+        return 'Shake!';
+      case PointerGesture.scribble:
+        return 'Scribble!';
+      case PointerGesture.swipe:
+        switch (gesture.direction) {
+          case SwipeDirection.right:
+            return 'Swipe →';
+          case SwipeDirection.down:
+            return 'Swipe ↓';
+          case SwipeDirection.left:
+            return 'Swipe ←';
+          case SwipeDirection.up:
+            return 'Swipe ↑';
+          case null:
+            return 'Swipe!';
+        }
+    }
+  }
+
+  Color _gestureColor(PointerGesture gesture) {
+    switch (gesture) {
+      case PointerGesture.circle:
+        return const Color(0xFFA855F7); // Purple
+      case PointerGesture.shake:
+        return const Color(0xFFF59E0B); // Orange
+      case PointerGesture.scribble:
+        return const Color(0xFFEC4899); // Pink
+      case PointerGesture.swipe:
+        return const Color(0xFF22D3EE); // Cyan
+    }
+  }
+
   void _handleMouseMove(events.MouseMoveEvent event) {
-    _mousePosition = Offset(event.x, event.y);
+    _moveTo(event.x, event.y);
+  }
+
+  void _moveTo(double x, double y) {
+    _mousePosition = Offset(x, y);
 
     // Add to trail
     _trail.add(
       _TrailPoint(
         position: _mousePosition,
-        timestamp: DateTime.now(),
+        timestamp: FrameClock.instance.now,
       ),
     );
 
-    // Keep only last N points (time-based cleanup happens in buildUI)
-    if (_trail.length > _maxTrailPoints) {
-      _trail.removeAt(0);
+    // Keep only last N points (time-based cleanup happens in buildUI). N
+    // shrinks with the current quality level.
+    final maxPoints =
+        QualityController.instance.level.value.scale(_maxTrailPoints, min: 8);
+    if (_trail.length > maxPoints) {
+      _trail.removeRange(0, _trail.length - maxPoints);
     }
 
     // Restart ticker if it was stopped
@@ -377,7 +530,7 @@ class MouseVisualizerGame extends BaseGame {
         _ClickRipple(
           position: Offset(event.x, event.y),
           color: _getButtonColor(event.button),
-          timestamp: DateTime.now(),
+          timestamp: FrameClock.instance.now,
         ),
       );
 
@@ -403,6 +556,19 @@ class MouseVisualizerGame extends BaseGame {
     _updateNotifier.value = (_updateNotifier.value + 1) % 1000;
   }
 
+  @override
+  void onSuspend() {
+    // Nothing is visible while suspended: stop the animation timer and drop
+    // the trail and ripples. Button states reset since releases are missed.
+    _animationTimer?.cancel();
+    _animationTimer = null;
+    _trail.clear();
+    _ripples.clear();
+    _bursts.clear();
+    _buttonStates.updateAll((_, __) => false);
+    _notifyUpdate();
+  }
+
   @override
   void dispose() {
     _disposed = true;
@@ -412,6 +578,7 @@ class MouseVisualizerGame extends BaseGame {
     // Clear all animation state
     _trail.clear();
     _ripples.clear();
+    _bursts.clear();
     _updateNotifier.dispose();
     super.dispose();
   }
@@ -441,6 +608,21 @@ class _ClickRipple {
   final DateTime timestamp;
 }
 
+/// Represents the burst shown for a recognized gesture.
+class _GestureBurst {
+  _GestureBurst({
+    required this.position,
+    required this.label,
+    required this.color,
+    required this.timestamp,
+  });
+
+  final Offset position;
+  final String label;
+  final Color color;
+  final DateTime timestamp;
+}
+
 /// Custom painter for the background grid.
 class _GridPainter extends CustomPainter {
   @override
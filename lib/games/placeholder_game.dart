@@ -35,14 +35,25 @@ class PlaceholderGame extends BaseGame {
   final ValueNotifier<List<String>> _eventsNotifier =
       ValueNotifier<List<String>>([]);
 
+  /// Identifier of this game. The metadata is static so the game can be
+  /// listed and registered lazily without constructing it.
+  static const String gameId = 'placeholder';
+
+  /// Display name of this game.
+  static const String gameName = 'Input Display';
+
+  /// Short description of this game.
+  static const String gameDescription =
+      'Shows keyboard and mouse events in real-time';
+
   @override
-  String get id => 'placeholder';
+  String get id => gameId;
 
   @override
-  String get name => 'Input Display';
+  String get name => gameName;
 
   @override
-  String get description => 'Shows keyboard and mouse events in real-time';
+  String get description => gameDescription;
 
   @override
   Widget buildUI() {
@@ -3,16 +3,24 @@ import 'dart:async';
 import 'package:flutter/material.dart';
 import 'package:flutter/services.dart';
 import 'package:keyboard_playground/core/exit_handler.dart';
+import 'package:keyboard_playground/core/frame_clock.dart';
 import 'package:keyboard_playground/core/game_manager.dart';
+import 'package:keyboard_playground/core/lazy_game.dart';
+import 'package:keyboard_playground/core/log.dart';
+import 'package:keyboard_playground/core/quality_controller.dart';
 import 'package:keyboard_playground/games/exploding_letters/exploding_letters_game.dart';
 import 'package:keyboard_playground/games/keyboard_visualizer_game.dart';
 import 'package:keyboard_playground/games/mouse_visualizer_game.dart';
+import 'package:keyboard_playground/games/base_game.dart';
 import 'package:keyboard_playground/games/placeholder_game.dart';
+import 'package:keyboard_playground/platform/compact_input_event.dart';
 import 'package:keyboard_playground/platform/input_capture.dart';
-import 'package:keyboard_playground/platform/input_events.dart';
+import 'package:keyboard_playground/platform/pointer_gesture.dart';
+import 'package:keyboard_playground/platform/power_status.dart';
 import 'package:keyboard_playground/platform/window_control.dart';
 import 'package:keyboard_playground/ui/app_shell.dart';
 import 'package:keyboard_playground/ui/app_theme.dart';
+import 'package:keyboard_playground/widgets/perf_hud.dart';
 
 void main() async {
   // Run app with error zone
@@ -24,15 +32,17 @@ void main() async {
       // Setup global error handling
       FlutterError.onError = (details) {
         FlutterError.presentError(details);
-        debugPrint('Flutter Error: ${details.exception}');
-        debugPrint(details.stack.toString());
+        Log.error(
+          'app',
+          () => 'Flutter Error: ${details.exception}',
+          details.stack,
+        );
       };
 
       runApp(const KeyboardPlaygroundApp());
     },
     (error, stack) {
-      debugPrint('Uncaught Error: $error');
-      debugPrint(stack.toString());
+      Log.error('app', () => 'Uncaught Error: $error', stack);
     },
   );
 }
@@ -40,21 +50,35 @@ void main() async {
 /// The main application widget that handles initialization and lifecycle.
 class KeyboardPlaygroundApp extends StatefulWidget {
   /// Creates the main application.
-  const KeyboardPlaygroundApp({super.key});
+  ///
+  /// [gameManager] replaces the internally created manager; integration
+  /// tests pass one in to switch games directly.
+  const KeyboardPlaygroundApp({this.gameManager, super.key});
+
+  /// Game manager to register the games with, or `null` to create one.
+  final GameManager? gameManager;
 
   @override
   State<KeyboardPlaygroundApp> createState() => _KeyboardPlaygroundAppState();
 }
 
 class _KeyboardPlaygroundAppState extends State<KeyboardPlaygroundApp> {
+  static const _tag = 'startup';
+
   late final InputCapture _inputCapture;
   late final GameManager _gameManager;
   late final ExitHandler _exitHandler;
 
+  bool _componentsCreated = false;
+  bool _gamesRegistered = false;
   bool _isInitialized = false;
   String? _errorMessage;
   StreamSubscription<void>? _exitSubscription;
-  StreamSubscription<InputEvent>? _inputEventsSubscription;
+  StreamSubscription<Object>? _inputEventsSubscription;
+  CompactEventFilter? _inputFilter;
+  StreamSubscription<BaseGame?>? _gameSubscription;
+  StreamSubscription<PointerGestureEvent>? _gestureSubscription;
+  StreamSubscription<PowerStatus>? _powerSubscription;
   bool _isExiting = false;
 
   @override
@@ -65,57 +89,63 @@ class _KeyboardPlaygroundAppState extends State<KeyboardPlaygroundApp> {
 
   Future<void> _initialize() async {
     try {
-      debugPrint('=== Keyboard Playground Initialization ===');
-
-      // Step 1: Initialize core components
-      debugPrint('Step 1: Initializing core components...');
-      _inputCapture = InputCapture();
-      _gameManager = GameManager();
-      _exitHandler = ExitHandler(inputCapture: _inputCapture);
-
-      // Step 2: Check and request permissions
-      debugPrint('Step 2: Checking permissions...');
-      final hasPermissions = await _inputCapture.checkPermissions();
-      debugPrint('Permissions status: $hasPermissions');
-
-      // Check platform-specific permission keys
-      // macOS uses 'accessibility', Linux uses 'x11_record'
-      final permissionGranted = (hasPermissions['accessibility'] ?? false) ||
-          (hasPermissions['x11_record'] ?? false);
-
-      if (!permissionGranted) {
-        debugPrint('Requesting permissions...');
-        await _inputCapture.requestPermissions();
+      Log.info(_tag, () => 'Initializing');
+
+      // Step 1: Initialize core components. A retry after an error keeps
+      // them.
+      if (!_componentsCreated) {
+        Log.debug(_tag, () => 'Step 1: Initializing core components');
+        FrameClock.instance.attach(WidgetsBinding.instance);
+        QualityController.instance.attach(WidgetsBinding.instance);
+        // Filter pointer motion away from key-only games off the UI
+        // isolate. Pointer games are served on the UI isolate.
+        _inputCapture = InputCapture(decodeInBackground: true);
+        _gameManager = widget.gameManager ?? GameManager();
+        _exitHandler = ExitHandler(inputCapture: _inputCapture);
+        _componentsCreated = true;
+      }
 
-        // Wait a moment for user to grant permissions
-        await Future<void>.delayed(const Duration(seconds: 2));
+      // Step 2: Start the session. Where supported, the permission check,
+      // fullscreen request and capture start are one native round trip.
+      // Capture starts with the fastest capture loop for this machine; the
+      // plugin measures it once, on the first run, before capture starts.
+      Log.debug(_tag, () => 'Step 2: Initializing session');
+      final session = await _inputCapture.initializeSession(
+        selectBackend: true,
+      );
+      Log.info(_tag, () => 'Session: $session');
+      var capturing = session.capturing;
 
-        final recheckPermissions = await _inputCapture.checkPermissions();
-        final recheckGranted = (recheckPermissions['accessibility'] ?? false) ||
-            (recheckPermissions['x11_record'] ?? false);
+      if (!session.permissionsGranted) {
+        // Leave fullscreen so the permission dialog is not hidden.
+        if (session.fullscreen) {
+          await WindowControl.exitFullscreen();
+        }
 
-        if (!recheckGranted) {
+        Log.info(_tag, () => 'Requesting permissions');
+        final granted = await _inputCapture.requestPermissions() ||
+            await _waitForPermissions();
+        if (!granted) {
           setState(() {
             _errorMessage = 'Permissions required.\n\n'
                 'Please grant permissions in System Settings and restart.';
           });
           return;
         }
-      }
 
-      // Step 3: Enter fullscreen
-      debugPrint('Step 3: Entering fullscreen...');
-      final fullscreenSuccess = await WindowControl.enterFullscreen();
-      if (!fullscreenSuccess) {
-        debugPrint(
-          'Warning: Failed to enter fullscreen (may not be supported)',
+        final results = await Future.wait([
+          WindowControl.enterFullscreen(),
+          _inputCapture.startCapture(),
+        ]);
+        capturing = results[1];
+      } else if (!session.fullscreen) {
+        Log.warning(
+          _tag,
+          () => 'Failed to enter fullscreen (may not be supported)',
         );
       }
 
-      // Step 4: Start input capture
-      debugPrint('Step 4: Starting input capture...');
-      final captureSuccess = await _inputCapture.startCapture();
-      if (!captureSuccess) {
+      if (!capturing) {
         setState(() {
           _errorMessage = 'Failed to start input capture.\n\n'
               'Check permissions and try again.';
@@ -123,39 +153,106 @@ class _KeyboardPlaygroundAppState extends State<KeyboardPlaygroundApp> {
         return;
       }
 
-      // Step 5: Setup event routing
-      debugPrint('Step 5: Setting up event routing...');
-      _setupEventRouting();
+      // Step 3: Register games, only once there is a session to play in.
+      // Games are constructed on first use, so only the initial one is
+      // built here.
+      if (!_gamesRegistered) {
+        Log.debug(_tag, () => 'Step 3: Registering games');
+        _registerGames();
+        _gamesRegistered = true;
+      }
 
-      // Step 6: Register games
-      debugPrint('Step 6: Registering games...');
-      _gameManager
-        ..registerGame(PlaceholderGame())
-        ..registerGame(ExplodingLettersGame())
-        ..registerGame(KeyboardVisualizerGame())
-        ..registerGame(MouseVisualizerGame())
-        ..switchGame('keyboard_visualizer');
+      // Step 4: Setup event routing
+      Log.debug(_tag, () => 'Step 4: Setting up event routing');
+      _setupEventRouting();
 
       setState(() {
         _isInitialized = true;
       });
 
-      debugPrint('=== Initialization Complete! ===');
-      debugPrint('Available games: ${_gameManager.gameCount}');
-      debugPrint('Current game: ${_gameManager.currentGame?.name}');
+      Log.info(
+        _tag,
+        () => 'Initialized with ${_gameManager.gameCount} games, '
+            'current: ${_gameManager.currentGame?.name}',
+      );
     } catch (e, stack) {
-      debugPrint('Initialization error: $e');
-      debugPrint(stack.toString());
+      Log.error(_tag, () => 'Initialization error: $e', stack);
       setState(() {
         _errorMessage = 'Initialization failed:\n\n$e';
       });
     }
   }
 
+  /// Waits for the user to grant the capture permissions.
+  ///
+  /// Only macOS asks the user; elsewhere the first answer is final. The
+  /// check is repeated as soon as the app is resumed, which is when the
+  /// user comes back from System Settings.
+  Future<bool> _waitForPermissions() async {
+    if (defaultTargetPlatform != TargetPlatform.macOS) return false;
+
+    final resumed = StreamController<void>();
+    final listener = AppLifecycleListener(onResume: () => resumed.add(null));
+    try {
+      return await _inputCapture.waitForPermissions(recheck: resumed.stream);
+    } finally {
+      listener.dispose();
+      await resumed.close();
+    }
+  }
+
+  void _registerGames() {
+    _gameManager
+      ..registerGame(
+        LazyGame(
+          id: PlaceholderGame.gameId,
+          name: PlaceholderGame.gameName,
+          description: PlaceholderGame.gameDescription,
+          create: PlaceholderGame.new,
+        ),
+      )
+      ..registerGame(
+        LazyGame(
+          id: ExplodingLettersGame.gameId,
+          name: ExplodingLettersGame.gameName,
+          description: ExplodingLettersGame.gameDescription,
+          create: ExplodingLettersGame.new,
+        ),
+      )
+      ..registerGame(
+        LazyGame(
+          id: KeyboardVisualizerGame.gameId,
+          name: KeyboardVisualizerGame.gameName,
+          description: KeyboardVisualizerGame.gameDescription,
+          create: KeyboardVisualizerGame.new,
+        ),
+      )
+      ..registerGame(
+        LazyGame(
+          id: MouseVisualizerGame.gameId,
+          name: MouseVisualizerGame.gameName,
+          description: MouseVisualizerGame.gameDescription,
+          create: MouseVisualizerGame.new,
+        ),
+      )
+      ..switchGame(KeyboardVisualizerGame.gameId);
+  }
+
   void _setupEventRouting() {
-    // Route all input events to the game manager
-    _inputEventsSubscription = _inputCapture.events.listen((event) {
-      _gameManager.handleInputEvent(event);
+    // Route input events to the game manager. The compact path lets games
+    // take pointer motion without allocating an event per sample, and only
+    // the events the current game needs are decoded.
+    _routeInputToCurrentGame();
+    _gameSubscription = _gameManager.currentGameStream
+        .listen((_) => _routeInputToCurrentGame());
+    _gestureSubscription =
+        _inputCapture.gestures.listen(_gameManager.handleGesture);
+
+    // Back off rendering before the machine throttles thermally or drains
+    // its battery. The native side adjusts capture on its own.
+    _powerSubscription = _inputCapture.powerStatus.listen((status) {
+      Log.debug(_tag, () => '$status');
+      QualityController.instance.limit(status.tier.qualityCeiling);
     });
 
     // Listen for exit trigger
@@ -164,20 +261,43 @@ class _KeyboardPlaygroundAppState extends State<KeyboardPlaygroundApp> {
     });
   }
 
+  void _routeInputToCurrentGame() {
+    final filter =
+        _gameManager.currentGame?.inputFilter ?? CompactEventFilter.all;
+    if (filter == _inputFilter) return;
+
+    // Subscribe before cancelling, so the channel stays open and no
+    // events are lost in between.
+    final previous = _inputEventsSubscription;
+    _inputFilter = filter;
+    _inputEventsSubscription = _inputCapture.listenCompact(
+      _gameManager.handleCompactEvent,
+      filter: filter,
+    );
+    unawaited(previous?.cancel());
+  }
+
   Future<void> _handleExit() async {
     if (_isExiting) {
       return; // Prevent re-entrancy
     }
     _isExiting = true;
-    debugPrint('Exit triggered, beginning graceful shutdown...');
+    Log.info(_tag, () => 'Exit triggered, beginning graceful shutdown');
 
     try {
       // 1. Cancel event routing first to avoid new events during teardown
+      await _gameSubscription?.cancel();
+      _gameSubscription = null;
       await _inputEventsSubscription?.cancel();
       _inputEventsSubscription = null;
+      await _gestureSubscription?.cancel();
+      _gestureSubscription = null;
+      await _powerSubscription?.cancel();
+      _powerSubscription = null;
 
       // 2. Stop input capture thread
       await _inputCapture.stopCapture();
+      _inputCapture.dispose();
 
       // 3. Dispose games and exit handler resources before engine shutdown
       await _gameManager.dispose();
@@ -193,9 +313,9 @@ class _KeyboardPlaygroundAppState extends State<KeyboardPlaygroundApp> {
       if (mounted) {
         await SystemChannels.platform.invokeMethod<void>('SystemNavigator.pop');
       }
-      debugPrint('Graceful shutdown complete.');
+      Log.info(_tag, () => 'Graceful shutdown complete');
     } catch (e) {
-      debugPrint('Error during exit: $e');
+      Log.error(_tag, () => 'Error during exit: $e');
       // Fallback attempt: still try to pop navigator if mounted
       if (mounted) {
         try {
@@ -209,10 +329,15 @@ class _KeyboardPlaygroundAppState extends State<KeyboardPlaygroundApp> {
   @override
   void dispose() {
     _exitSubscription?.cancel();
+    _gameSubscription?.cancel();
     _inputEventsSubscription?.cancel();
-    if (_isInitialized) {
+    _gestureSubscription?.cancel();
+    _powerSubscription?.cancel();
+    if (_componentsCreated) {
       // Ensure disposal order mirrors graceful exit
-      _inputCapture.stopCapture();
+      _inputCapture
+        ..stopCapture()
+        ..dispose();
       _gameManager.dispose();
       _exitHandler.dispose();
     }
@@ -373,9 +498,12 @@ class _KeyboardPlaygroundAppState extends State<KeyboardPlaygroundApp> {
       title: 'Keyboard Playground',
       theme: AppTheme.kidFriendlyTheme,
       debugShowCheckedModeBanner: false,
-      home: AppShell(
-        gameManager: _gameManager,
-        exitHandler: _exitHandler,
+      home: PerfHud(
+        toggles: _inputCapture.hudToggles,
+        child: AppShell(
+          gameManager: _gameManager,
+          exitHandler: _exitHandler,
+        ),
       ),
     );
   }
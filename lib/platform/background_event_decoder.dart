@@ -0,0 +1,168 @@
+/// Filtering of packed event batches on a background isolate.
+///
+/// Platform channel messages can only be received on the UI isolate, so
+/// every batch arrives there first. [BackgroundEventDecoder] hands it to a
+/// worker isolate, which applies each consumer's [CompactEventFilter] and
+/// sends back only the records that consumer needs. During motion-heavy
+/// play a keyboard game then gets nothing back at all, and the UI isolate
+/// does no per-event work for it.
+///
+/// Only filtering moves off the UI isolate: the records that pass are
+/// still decoded there, by the consumer. The worker therefore only pays
+/// off for consumers that reject pointer motion; a pointer game such as
+/// MouseVisualizer would decode as much on the UI isolate as without it
+/// and only add the round trip, so `InputCapture.listenCompact` keeps
+/// such consumers off the worker.
+///
+/// Batches cross the isolate boundary as [TransferableTypedData]. Building
+/// one with `fromList` copies the batch on the sending side; the receiving
+/// side then takes the bytes over with `materialize` without copying them
+/// again. Each batch is therefore copied once on the way to the worker and
+/// once more on the way back.
+library;
+
+import 'dart:async';
+import 'dart:isolate';
+import 'dart:typed_data';
+
+import 'package:keyboard_playground/platform/compact_input_event.dart';
+
+/// Called with the records of a batch that passed a consumer's filter.
+typedef FilteredBatchCallback = void Function(Uint8List batch);
+
+/// Filters packed event batches for several consumers on a worker isolate.
+///
+/// Example usage:
+/// ```dart
+/// final worker = BackgroundEventDecoder(onProcessed: grantCredit);
+/// final decoder = CompactEventDecoder();
+/// worker.addConsumer(
+///   CompactEventFilter.keys,
+///   (batch) => decoder.decode(batch, onKey),
+/// );
+/// eventBatches.listen(worker.add);
+/// ```
+class BackgroundEventDecoder {
+  /// Starts the worker isolate.
+  ///
+  /// [onProcessed] is called once for every batch passed to [add], after
+  /// its results have been delivered, so callers can pace the producer.
+  BackgroundEventDecoder({void Function()? onProcessed})
+      : _onProcessed = onProcessed {
+    _replies.listen(_handleReply);
+    _isolate =
+        Isolate.spawn(_run, _replies.sendPort, debugName: 'input-decoder');
+  }
+
+  final void Function()? _onProcessed;
+  final ReceivePort _replies = ReceivePort();
+  late final Future<Isolate> _isolate;
+  final Map<int, FilteredBatchCallback> _consumers = {};
+  SendPort? _commands;
+  List<Object>? _pending = [];
+  int _nextId = 0;
+  int _inFlight = 0;
+
+  /// Whether any consumers are registered.
+  bool get hasConsumers => _consumers.isNotEmpty;
+
+  /// Number of batches passed to [add] that have not been processed yet.
+  int get inFlight => _inFlight;
+
+  /// Registers a consumer and returns its id for [removeConsumer].
+  ///
+  /// Batches passed to [add] from now on are filtered with [filter];
+  /// batches with at least one passing record are delivered to [onBatch].
+  int addConsumer(CompactEventFilter filter, FilteredBatchCallback onBatch) {
+    final id = _nextId++;
+    _consumers[id] = onBatch;
+    _send(_ConsumerChange(id, filter));
+    return id;
+  }
+
+  /// Unregisters the consumer [id].
+  void removeConsumer(int id) {
+    if (_consumers.remove(id) != null) {
+      _send(_ConsumerChange(id, null));
+    }
+  }
+
+  /// Filters [batch] for every consumer.
+  void add(Uint8List batch) {
+    _inFlight++;
+    _send(TransferableTypedData.fromList([batch]));
+  }
+
+  /// Stops the worker isolate. Batches still in flight are dropped.
+  void close() {
+    _consumers.clear();
+    _replies.close();
+    unawaited(_isolate.then((isolate) => isolate.kill()));
+  }
+
+  void _send(Object message) {
+    final pending = _pending;
+    if (pending != null) {
+      pending.add(message);
+    } else {
+      _commands!.send(message);
+    }
+  }
+
+  void _handleReply(Object? message) {
+    if (message is SendPort) {
+      _commands = message;
+      _pending!.forEach(message.send);
+      _pending = null;
+      return;
+    }
+
+    // One reply per batch: consumer ids alternating with their records.
+    final results = message! as List<Object?>;
+    for (var i = 0; i < results.length; i += 2) {
+      final consumer = _consumers[results[i]! as int];
+      final data = results[i + 1]! as TransferableTypedData;
+      consumer?.call(data.materialize().asUint8List());
+    }
+    _inFlight--;
+    _onProcessed?.call();
+  }
+}
+
+/// Adds (with a filter) or removes (without) a consumer on the worker.
+class _ConsumerChange {
+  const _ConsumerChange(this.id, this.filter);
+
+  final int id;
+  final CompactEventFilter? filter;
+}
+
+/// Entry point of the worker isolate.
+void _run(SendPort replies) {
+  final commands = ReceivePort();
+  final filters = <int, CompactEventFilter>{};
+  replies.send(commands.sendPort);
+
+  commands.listen((message) {
+    if (message is TransferableTypedData) {
+      final batch = message.materialize().asUint8List();
+      final results = <Object?>[];
+      filters.forEach((id, filter) {
+        final passed = filter.apply(batch);
+        if (passed.isNotEmpty) {
+          results
+            ..add(id)
+            ..add(TransferableTypedData.fromList([passed]));
+        }
+      });
+      replies.send(results);
+    } else if (message is _ConsumerChange) {
+      final filter = message.filter;
+      if (filter == null) {
+        filters.remove(message.id);
+      } else {
+        filters[message.id] = filter;
+      }
+    }
+  });
+}
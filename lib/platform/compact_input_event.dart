@@ -0,0 +1,395 @@
+/// Allocation-light input event model for high-rate consumers.
+///
+/// Turning a platform channel map into an [InputEvent] allocates the map,
+/// its strings, a [DateTime], a modifier set and the event itself for every
+/// pointer motion sample. [CompactInputEvent] carries the same data in plain
+/// fields, and [CompactEventDecoder] walks packed native event batches with
+/// a single reused instance, so decoding motion allocates nothing per event.
+library;
+
+import 'dart:typed_data';
+
+import 'package:keyboard_playground/platform/input_events.dart';
+
+/// Size of one packed event record in a native event batch, in bytes.
+///
+/// Layout (little-endian), written by the Linux input capture plugin:
+///
+/// | Offset | Type   | Field                                     |
+/// |--------|--------|-------------------------------------------|
+/// | 0      | int64  | wall-clock timestamp in microseconds      |
+/// | 8      | uint32 | keysym (key events, 0 otherwise)          |
+/// | 12     | int32  | x (pointer position or scroll delta)      |
+/// | 16     | int32  | y (pointer position or scroll delta)      |
+/// | 20     | uint16 | key code or button number                 |
+/// | 22     | uint8  | [InputEventType] index                    |
+/// | 23     | uint8  | modifier bitmask (see [KeyModifierMask])  |
+const int kCompactEventSize = 24;
+
+/// Called for every event decoded by [CompactEventDecoder].
+typedef CompactEventCallback = void Function(CompactInputEvent event);
+
+/// Bitmask values of [KeyModifier]s in [CompactInputEvent.modifiers].
+extension KeyModifierMask on KeyModifier {
+  /// The bit representing this modifier.
+  int get mask => 1 << index;
+}
+
+/// An input event stored in plain fields.
+///
+/// Instances handed out by [CompactEventDecoder] and
+/// `InputCapture.listenCompact` are reused for every event, so they are only
+/// valid during the callback. Use [CompactInputEvent.copy] or
+/// [toInputEvent] to keep an event.
+class CompactInputEvent {
+  /// Creates an empty event, to be filled in by a decoder.
+  CompactInputEvent();
+
+  /// Creates a standalone copy of [other].
+  CompactInputEvent.copy(CompactInputEvent other)
+      : type = other.type,
+        timestampUs = other.timestampUs,
+        code = other.code,
+        keysym = other.keysym,
+        x = other.x,
+        y = other.y,
+        modifiers = other.modifiers,
+        _key = other._key;
+
+  /// Type of this event.
+  InputEventType type = InputEventType.mouseMove;
+
+  /// When this event occurred, in microseconds since the epoch.
+  int timestampUs = 0;
+
+  /// Platform key code for key events, button number for button events
+  /// (1 left, 2 middle, 3 right).
+  int code = 0;
+
+  /// X11 keysym for key events, if known; 0 otherwise.
+  int keysym = 0;
+
+  /// Pointer position for move and button events, horizontal delta for
+  /// scroll events.
+  double x = 0;
+
+  /// Pointer position for move and button events, vertical delta for scroll
+  /// events.
+  double y = 0;
+
+  /// Bitwise OR of the [KeyModifierMask.mask] of each held modifier.
+  int modifiers = 0;
+
+  /// Key name for events that did not come with a keysym.
+  String? _key;
+
+  /// Logical key name, as in [KeyEvent.key].
+  String get key => _key ?? keyNameForKeysym(keysym);
+
+  /// Whether this is a key or button press.
+  bool get isDown =>
+      type == InputEventType.keyDown || type == InputEventType.mouseDown;
+
+  /// Button of a mouse button event.
+  MouseButton get button {
+    switch (code) {
+      case 1:
+        return MouseButton.left;
+      case 2:
+        return MouseButton.middle;
+      case 3:
+        return MouseButton.right;
+      default:
+        return MouseButton.other;
+    }
+  }
+
+  /// Whether [modifier] was held.
+  bool hasModifier(KeyModifier modifier) => modifiers & modifier.mask != 0;
+
+  /// When this event occurred.
+  DateTime get timestamp => DateTime.fromMicrosecondsSinceEpoch(timestampUs);
+
+  /// Overwrites this event with the contents of [event].
+  ///
+  /// Used where the platform delivers regular [InputEvent]s instead of
+  /// packed batches.
+  void setFrom(InputEvent event) {
+    type = event.type;
+    timestampUs = event.timestamp.microsecondsSinceEpoch;
+    code = 0;
+    keysym = 0;
+    x = 0;
+    y = 0;
+    modifiers = 0;
+    _key = null;
+
+    if (event is KeyEvent) {
+      code = event.keyCode;
+      _key = event.key;
+      for (final modifier in event.modifiers) {
+        modifiers |= modifier.mask;
+      }
+    } else if (event is MouseMoveEvent) {
+      x = event.x;
+      y = event.y;
+    } else if (event is MouseButtonEvent) {
+      code = _buttonCodes[event.button.index];
+      x = event.x;
+      y = event.y;
+    } else if (event is MouseScrollEvent) {
+      x = event.deltaX;
+      y = event.deltaY;
+    }
+  }
+
+  /// Converts this event to a standalone [InputEvent].
+  InputEvent toInputEvent() {
+    switch (type) {
+      case InputEventType.keyDown:
+      case InputEventType.keyUp:
+        return KeyEvent(
+          keyCode: code,
+          key: key,
+          modifiers: {
+            for (final modifier in KeyModifier.values)
+              if (hasModifier(modifier)) modifier,
+          },
+          isDown: isDown,
+          timestamp: timestamp,
+        );
+      case InputEventType.mouseMove:
+        return MouseMoveEvent(x: x, y: y, timestamp: timestamp);
+      case InputEventType.mouseDown:
+      case InputEventType.mouseUp:
+        return MouseButtonEvent(
+          button: button,
+          x: x,
+          y: y,
+          isDown: isDown,
+          timestamp: timestamp,
+        );
+      case InputEventType.mouseScroll:
+        return MouseScrollEvent(deltaX: x, deltaY: y, timestamp: timestamp);
+    }
+  }
+
+  @override
+  String toString() => 'CompactInputEvent(${type.name}, t: $timestampUs, '
+      'code: $code, keysym: $keysym, x: $x, y: $y, modifiers: $modifiers)';
+}
+
+/// Decodes packed native event batches.
+///
+/// Example usage:
+/// ```dart
+/// final decoder = CompactEventDecoder();
+/// decoder.decode(batch, (event) {
+///   if (event.type == InputEventType.mouseMove) {
+///     trail.add(event.x, event.y, event.timestampUs);
+///   }
+/// });
+/// ```
+class CompactEventDecoder {
+  /// The instance handed to every callback.
+  final CompactInputEvent _event = CompactInputEvent();
+
+  /// Calls [onEvent] for each record in [batch], in order.
+  ///
+  /// The same [CompactInputEvent] instance is passed for every record.
+  /// Records of unknown type are skipped. Returns the number of events
+  /// decoded.
+  int decode(Uint8List batch, CompactEventCallback onEvent) {
+    final data = ByteData.sublistView(batch);
+    final event = _event.._key = null;
+    const types = InputEventType.values;
+    var count = 0;
+
+    for (var offset = 0;
+        offset + kCompactEventSize <= data.lengthInBytes;
+        offset += kCompactEventSize) {
+      final type = data.getUint8(offset + 22);
+      if (type >= types.length) {
+        continue;
+      }
+      event
+        ..timestampUs = data.getInt64(offset, Endian.little)
+        ..keysym = data.getUint32(offset + 8, Endian.little)
+        ..x = data.getInt32(offset + 12, Endian.little).toDouble()
+        ..y = data.getInt32(offset + 16, Endian.little).toDouble()
+        ..code = data.getUint16(offset + 20, Endian.little)
+        ..type = types[type]
+        ..modifiers = data.getUint8(offset + 23);
+      onEvent(event);
+      count++;
+    }
+    return count;
+  }
+
+  /// Decodes [batch] into standalone [InputEvent]s.
+  List<InputEvent> decodeEvents(Uint8List batch) {
+    final events = <InputEvent>[];
+    decode(batch, (event) => events.add(event.toInputEvent()));
+    return events;
+  }
+}
+
+/// Selects the records of a packed event batch that a consumer needs.
+///
+/// Filtering happens before decoding, so events a consumer would ignore
+/// anyway (pointer motion for a keyboard game) are never decoded for it.
+/// With background decoding (see `InputCapture.decodeInBackground`) they
+/// do not even reach the UI isolate.
+class CompactEventFilter {
+  /// Creates a filter passing events of [types].
+  const CompactEventFilter({
+    this.types = _allTypes,
+    this.coalesceMotion = false,
+  });
+
+  /// Passes every event.
+  static const all = CompactEventFilter();
+
+  /// Passes key presses and releases only.
+  static const keys = CompactEventFilter(
+    types: {InputEventType.keyDown, InputEventType.keyUp},
+  );
+
+  static const _allTypes = {
+    InputEventType.keyDown,
+    InputEventType.keyUp,
+    InputEventType.mouseMove,
+    InputEventType.mouseDown,
+    InputEventType.mouseUp,
+    InputEventType.mouseScroll,
+  };
+
+  /// Event types to pass.
+  final Set<InputEventType> types;
+
+  /// Whether consecutive pointer motion records within a batch are reduced
+  /// to the last one. Only applies to packed batches.
+  final bool coalesceMotion;
+
+  /// Whether this filter passes every record unchanged.
+  bool get passesEverything =>
+      !coalesceMotion && types.length == InputEventType.values.length;
+
+  /// Whether events of [type] pass.
+  bool accepts(InputEventType type) => types.contains(type);
+
+  /// Returns the records of [batch] this filter passes, in order.
+  ///
+  /// Returns [batch] itself when every record passes, and an empty list
+  /// when none does.
+  Uint8List apply(Uint8List batch) {
+    if (passesEverything) {
+      return batch;
+    }
+    var mask = 0;
+    for (final type in types) {
+      mask |= 1 << type.index;
+    }
+    final move = InputEventType.mouseMove.index;
+    final length =
+        batch.lengthInBytes - batch.lengthInBytes % kCompactEventSize;
+
+    Uint8List? out;
+    var written = 0;
+    for (var offset = 0; offset < length; offset += kCompactEventSize) {
+      final type = batch[offset + 22];
+      if (type >= InputEventType.values.length || mask & (1 << type) == 0) {
+        continue;
+      }
+      if (coalesceMotion &&
+          type == move &&
+          offset + kCompactEventSize < length &&
+          batch[offset + kCompactEventSize + 22] == move) {
+        continue;
+      }
+      (out ??= Uint8List(length))
+          .setRange(written, written + kCompactEventSize, batch, offset);
+      written += kCompactEventSize;
+    }
+
+    if (out == null) {
+      return Uint8List(0);
+    }
+    return written == batch.lengthInBytes
+        ? batch
+        : Uint8List.sublistView(out, 0, written);
+  }
+
+  @override
+  bool operator ==(Object other) =>
+      other is CompactEventFilter &&
+      other.coalesceMotion == coalesceMotion &&
+      other.types.length == types.length &&
+      other.types.containsAll(types);
+
+  @override
+  int get hashCode => Object.hash(
+        coalesceMotion,
+        types.fold<int>(0, (mask, type) => mask | 1 << type.index),
+      );
+
+  @override
+  String toString() => 'CompactEventFilter(${types.map((t) => t.name)}, '
+      'coalesceMotion: $coalesceMotion)';
+}
+
+/// Returns the logical key name for an X11 [keysym].
+///
+/// Matches the names the native capture sends on the map event channel,
+/// with arrow keys already normalized to `Arrow*`. Names are cached, so
+/// repeated lookups do not allocate.
+String keyNameForKeysym(int keysym) {
+  if (keysym >= 0x20 && keysym <= 0x7e) {
+    return _printableNames[keysym - 0x20] ??= String.fromCharCode(keysym);
+  }
+  return _namedKeys[keysym] ??
+      _unnamedKeys.putIfAbsent(keysym, () => 'Key$keysym');
+}
+
+/// Button numbers by [MouseButton] index, as reported by X11.
+const List<int> _buttonCodes = [1, 3, 2, 0];
+
+final List<String?> _printableNames = List<String?>.filled(0x7f - 0x20, null);
+
+final Map<int, String> _unnamedKeys = {};
+
+const Map<int, String> _namedKeys = {
+  0xff0d: 'Return',
+  0xff09: 'Tab',
+  0xff08: 'Backspace',
+  0xff1b: 'Escape',
+  0xffff: 'Delete',
+  0xff50: 'Home',
+  0xff57: 'End',
+  0xff55: 'PageUp',
+  0xff56: 'PageDown',
+  0xff51: 'ArrowLeft',
+  0xff53: 'ArrowRight',
+  0xff52: 'ArrowUp',
+  0xff54: 'ArrowDown',
+  0xffbe: 'F1',
+  0xffbf: 'F2',
+  0xffc0: 'F3',
+  0xffc1: 'F4',
+  0xffc2: 'F5',
+  0xffc3: 'F6',
+  0xffc4: 'F7',
+  0xffc5: 'F8',
+  0xffc6: 'F9',
+  0xffc7: 'F10',
+  0xffc8: 'F11',
+  0xffc9: 'F12',
+  0xffe1: 'Shift',
+  0xffe2: 'Shift',
+  0xffe3: 'Control',
+  0xffe4: 'Control',
+  0xffe9: 'Alt',
+  0xffea: 'Alt',
+  0xffeb: 'Meta',
+  0xffec: 'Meta',
+};
@@ -0,0 +1,169 @@
+/// Configuration and timing of the native event processing stages.
+///
+/// On Linux every captured or replayed event runs through an ordered
+/// chain of native stages after merging. Filtering stages come first and
+/// are off by default; a deployment that, say, only needs keyboard events
+/// enables the type filter and the later stages never see pointer events.
+/// While timing is on ([InputCapture.setPipelineTiming]), each stage
+/// reports how many events it saw and dropped and how long it took, see
+/// [InputCapture.getPipeline].
+library;
+
+import 'package:flutter/foundation.dart';
+import 'package:keyboard_playground/platform/input_capture.dart';
+import 'package:keyboard_playground/platform/input_events.dart';
+
+/// Stages of the native event pipeline, in the order events pass them.
+enum EventPipelineStage {
+  /// Passes only the selected event types, see [EventStageConfig.types].
+  /// Off by default.
+  filter('filter'),
+
+  /// Drops presses of keys that are already down (auto-repeat). Off by
+  /// default.
+  repeatCollapse('repeat_collapse'),
+
+  /// Updates the polled input state and the pipeline statistics.
+  analytics('analytics'),
+
+  /// Detects the HUD chord and pointer gestures.
+  pattern('pattern'),
+
+  /// Thins pointer motion to one event per interval, see
+  /// [EventStageConfig.motionInterval]. Off by default. Runs after
+  /// [analytics] and [pattern], so only what Dart receives is thinned.
+  coalesce('coalesce'),
+
+  /// Encodes events for the event channels and sends them.
+  deliver('deliver');
+
+  const EventPipelineStage(this.id);
+
+  /// Name of the stage on the native side.
+  final String id;
+
+  /// The stage named [id], or `null` for stages this version does not
+  /// know.
+  static EventPipelineStage? fromId(String id) {
+    for (final stage in values) {
+      if (stage.id == id) return stage;
+    }
+    return null;
+  }
+}
+
+/// Changes to one stage's configuration.
+@immutable
+class EventStageConfig {
+  /// Creates a configuration change. `null` [enabled] keeps the stage's
+  /// current state; [options] not given keep their values.
+  const EventStageConfig({this.enabled, this.options = const {}});
+
+  /// Enables the type filter, passing only [types].
+  factory EventStageConfig.types(Set<InputEventType> types) {
+    var mask = 0;
+    for (final type in types) {
+      mask |= 1 << type.index;
+    }
+    return EventStageConfig(enabled: true, options: {'types': mask});
+  }
+
+  /// Enables motion coalescing with at most one motion event per
+  /// [interval].
+  factory EventStageConfig.motionInterval(Duration interval) =>
+      EventStageConfig(
+        enabled: true,
+        options: {'intervalUs': interval.inMicroseconds},
+      );
+
+  /// Whether the stage runs, or `null` to leave it as is.
+  final bool? enabled;
+
+  /// Stage specific options.
+  final Map<String, int> options;
+
+  /// Encodes the change for the method channel.
+  Map<String, Object> toMap() => {
+        if (enabled != null) 'enabled': enabled!,
+        ...options,
+      };
+
+  @override
+  bool operator ==(Object other) =>
+      other is EventStageConfig &&
+      other.enabled == enabled &&
+      mapEquals(other.options, options);
+
+  @override
+  int get hashCode => Object.hash(
+        enabled,
+        Object.hashAllUnordered(
+          options.entries.map((entry) => Object.hash(entry.key, entry.value)),
+        ),
+      );
+}
+
+/// One stage's configuration and timing, as reported by native code.
+class EventStageInfo {
+  /// Creates a stage description.
+  const EventStageInfo({
+    required this.name,
+    this.enabled = false,
+    this.options = const {},
+    this.calls = 0,
+    this.dropped = 0,
+    this.totalNs = 0,
+    this.maxNs = 0,
+  });
+
+  /// Creates a stage description from the map sent by native code.
+  factory EventStageInfo.fromMap(Map<Object?, Object?> map) {
+    final options = map['options'] as Map<Object?, Object?>? ?? const {};
+    return EventStageInfo(
+      name: map['name'] as String? ?? '',
+      enabled: map['enabled'] as bool? ?? false,
+      options: {
+        for (final entry in options.entries)
+          entry.key! as String: (entry.value as num?)?.toInt() ?? 0,
+      },
+      calls: (map['calls'] as num?)?.toInt() ?? 0,
+      dropped: (map['dropped'] as num?)?.toInt() ?? 0,
+      totalNs: (map['totalNs'] as num?)?.toInt() ?? 0,
+      maxNs: (map['maxNs'] as num?)?.toInt() ?? 0,
+    );
+  }
+
+  /// Native name of the stage.
+  final String name;
+
+  /// The stage, or `null` if this version does not know it.
+  EventPipelineStage? get stage => EventPipelineStage.fromId(name);
+
+  /// Whether the stage runs.
+  final bool enabled;
+
+  /// Current stage specific options.
+  final Map<String, int> options;
+
+  /// Events the stage processed while timing was on, since the timing was
+  /// last reset.
+  final int calls;
+
+  /// Events the stage dropped.
+  final int dropped;
+
+  /// Total time spent in the stage, in nanoseconds.
+  final int totalNs;
+
+  /// Longest time spent on one event, in nanoseconds.
+  final int maxNs;
+
+  /// Average time per event, in nanoseconds.
+  double get meanNs => calls == 0 ? 0 : totalNs / calls;
+
+  @override
+  String toString() => 'EventStageInfo($name, '
+      '${enabled ? 'enabled' : 'disabled'}, options: $options, '
+      'calls: $calls, dropped: $dropped, mean: ${meanNs.round()} ns, '
+      'max: $maxNs ns)';
+}
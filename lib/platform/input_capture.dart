@@ -7,10 +7,86 @@
 library;
 
 import 'dart:async';
+import 'dart:collection';
 
 import 'package:flutter/foundation.dart';
 import 'package:flutter/services.dart' hide KeyEvent;
+import 'package:keyboard_playground/core/frame_clock.dart';
+import 'package:keyboard_playground/core/log.dart';
+import 'package:keyboard_playground/platform/background_event_decoder.dart';
+import 'package:keyboard_playground/platform/compact_input_event.dart';
+import 'package:keyboard_playground/platform/event_pipeline.dart';
 import 'package:keyboard_playground/platform/input_events.dart';
+import 'package:keyboard_playground/platform/pointer_gesture.dart';
+import 'package:keyboard_playground/platform/power_status.dart';
+import 'package:keyboard_playground/platform/session_info.dart';
+import 'package:keyboard_playground/platform/window_control.dart';
+
+/// Compression applied to each block of a session journal.
+enum JournalCompression {
+  /// Blocks are stored as delta/varint-packed events only.
+  none,
+
+  /// LZ4 block compression (fast, moderate ratio).
+  lz4,
+
+  /// zstd block compression (slower, best ratio).
+  zstd,
+}
+
+/// Summary of a session journal, returned by [InputCapture.stopJournal].
+class JournalStats {
+  /// Creates journal statistics.
+  const JournalStats({
+    required this.events,
+    required this.dropped,
+    required this.blocks,
+    required this.rawBytes,
+    required this.fileBytes,
+    this.error,
+  });
+
+  /// Creates journal statistics from the map sent by native code.
+  factory JournalStats.fromMap(Map<Object?, Object?> map) {
+    return JournalStats(
+      events: map['events'] as int? ?? 0,
+      dropped: map['dropped'] as int? ?? 0,
+      blocks: map['blocks'] as int? ?? 0,
+      rawBytes: map['rawBytes'] as int? ?? 0,
+      fileBytes: map['fileBytes'] as int? ?? 0,
+      error: map['error'] as String?,
+    );
+  }
+
+  /// Number of events written.
+  final int events;
+
+  /// Number of events dropped because the writer thread fell behind.
+  final int dropped;
+
+  /// Number of blocks in the journal.
+  final int blocks;
+
+  /// Size of the encoded events before compression.
+  final int rawBytes;
+
+  /// Size of the journal file, including headers and index.
+  final int fileBytes;
+
+  /// Why writing the journal failed, or `null` if every block was written.
+  ///
+  /// A failed journal is cut back to its last complete block; events after
+  /// the failure are counted in [dropped].
+  final String? error;
+
+  /// Whether writing the journal failed; see [error].
+  bool get failed => error != null;
+
+  @override
+  String toString() => 'JournalStats(events: $events, dropped: $dropped, '
+      'blocks: $blocks, bytes: $fileBytes'
+      '${error != null ? ', error: $error' : ''})';
+}
 
 /// Captures keyboard and mouse input at the OS level.
 ///
@@ -44,6 +120,24 @@ import 'package:keyboard_playground/platform/input_events.dart';
 /// await capture.stopCapture();
 /// ```
 class InputCapture {
+  /// Creates an input capture interface.
+  ///
+  /// With [decodeInBackground], [listenCompact] filters packed batches for
+  /// listeners that take no pointer motion on a worker isolate instead of
+  /// the UI isolate.
+  InputCapture({this.decodeInBackground = false});
+
+  /// Whether [listenCompact] filters packed batches on a worker isolate
+  /// for listeners whose filter rejects pointer motion.
+  ///
+  /// The UI isolate then only forwards each batch once, and a keyboard
+  /// game decodes nothing during motion-heavy play. Listeners that take
+  /// pointer motion are served on the UI isolate as without the worker:
+  /// the worker only filters, so their records would still be decoded on
+  /// the UI isolate, after a round trip. Only has an effect where
+  /// [supportsEventBatches] is `true`.
+  final bool decodeInBackground;
+
   /// Method channel for controlling the capture (start, stop, permissions).
   static const MethodChannel _methodChannel =
       MethodChannel('com.keyboardplayground/input_capture');
@@ -52,21 +146,304 @@ class InputCapture {
   static const EventChannel _eventChannel =
       EventChannel('com.keyboardplayground/input_events');
 
+  /// Event channel for receiving packed event batches from native code.
+  static const EventChannel _batchChannel =
+      EventChannel('com.keyboardplayground/input_event_batches');
+
+  /// Event channel for receiving recognized pointer gestures.
+  static const EventChannel _gestureChannel =
+      EventChannel('com.keyboardplayground/input_gestures');
+
+  /// Event channel for receiving thermal and power status updates.
+  static const EventChannel _powerChannel =
+      EventChannel('com.keyboardplayground/power_status');
+
+  /// Event channel for receiving performance HUD toggles.
+  static const EventChannel _hudChannel =
+      EventChannel('com.keyboardplayground/hud_toggles');
+
   /// Cached event stream.
   Stream<InputEvent>? _eventStream;
 
+  /// Cached HUD toggle stream.
+  Stream<void>? _hudToggles;
+
+  /// Cached power status stream.
+  Stream<PowerStatus>? _powerStream;
+
+  /// Cached gesture stream.
+  Stream<PointerGestureEvent>? _gestureStream;
+
+  /// Number of batches the native side may send ahead of the batches Dart
+  /// has finished processing.
+  ///
+  /// One credit is granted back after every processed batch. While Dart is
+  /// out of credits, native code coalesces pointer motion and scrolling
+  /// instead of queueing, so a slow UI isolate sees fewer, fresher events
+  /// rather than a growing backlog.
+  static const int eventBatchCredits = 4;
+
+  /// Fans batches out to all listeners synchronously, so a batch has been
+  /// processed by everyone when the credit for it is returned.
+  StreamController<Uint8List>? _batchController;
+
+  /// Worker filtering batches for [listenCompact] when
+  /// [decodeInBackground] is set. Started with the first listener that
+  /// takes no pointer motion.
+  BackgroundEventDecoder? _backgroundDecoder;
+
+  /// Forwards batches to [_backgroundDecoder] while it has consumers.
+  StreamSubscription<Uint8List>? _backgroundForwarding;
+
+  /// Subscription to the batch channel while [eventBatches] has listeners.
+  StreamSubscription<dynamic>? _batchSubscription;
+
+  /// Listen generation of [_batchSubscription], sent with every credit
+  /// grant so native code can ignore grants that were still in flight for
+  /// an earlier listen.
+  int _batchGeneration = 0;
+
+  /// Last listen generation handed out; instances share the channel, so
+  /// generations are unique across them.
+  static int _lastBatchGeneration = 0;
+
+  /// Generations of the batches forwarded to [_backgroundDecoder] that it
+  /// has not finished yet, oldest first.
+  final Queue<int> _forwardedGenerations = Queue<int>();
+
   /// Stream of all input events.
   ///
   /// Events will only be emitted when capture is active (after [startCapture]).
   /// The stream is a broadcast stream, so multiple listeners can subscribe.
+  ///
+  /// Every event is a separate object. High-rate consumers should use
+  /// [listenCompact] instead.
   Stream<InputEvent> get events {
-    _eventStream ??= _eventChannel
-        .receiveBroadcastStream()
-        .map(parseEvent)
-        .cast<InputEvent>();
+    _eventStream ??= supportsEventBatches
+        ? eventBatches.expand(CompactEventDecoder().decodeEvents)
+        : _eventChannel
+            .receiveBroadcastStream()
+            .map(parseEvent)
+            .cast<InputEvent>();
     return _eventStream!;
   }
 
+  /// Whether the native side delivers packed event batches.
+  ///
+  /// Only the Linux plugin does; other platforms send one map per event.
+  bool get supportsEventBatches => _hasLinuxPlugin;
+
+  /// Whether the Linux plugin is the native side.
+  ///
+  /// It is the only one with packed batches, gestures and one-call session
+  /// start, so the `supports*` getters all delegate here.
+  static bool get _hasLinuxPlugin =>
+      !kIsWeb && defaultTargetPlatform == TargetPlatform.linux;
+
+  /// Stream of packed event batches, see [kCompactEventSize] for the layout.
+  ///
+  /// Delivery is flow controlled with [eventBatchCredits]. Listeners must
+  /// process each batch synchronously. Only available when
+  /// [supportsEventBatches] is `true`.
+  Stream<Uint8List> get eventBatches {
+    _batchController ??= StreamController<Uint8List>.broadcast(
+      sync: true,
+      onListen: _listenToBatches,
+      onCancel: _cancelBatches,
+    );
+    return _batchController!.stream;
+  }
+
+  void _listenToBatches() {
+    final controller = _batchController!;
+    final generation = _batchGeneration = ++_lastBatchGeneration;
+    _batchSubscription = _batchChannel.receiveBroadcastStream({
+      'credits': eventBatchCredits,
+      'generation': generation,
+    }).listen(
+      (batch) {
+        controller.add(batch as Uint8List);
+        // Batches forwarded to the background decoder are credited once it
+        // has delivered its results.
+        if (_backgroundForwarding == null) {
+          unawaited(_grantEventCredits(1, generation));
+        }
+      },
+      onError: controller.addError,
+    );
+  }
+
+  Future<void> _cancelBatches() async {
+    await _batchSubscription?.cancel();
+    _batchSubscription = null;
+  }
+
+  /// Lets the native side send [batches] more event batches, for the
+  /// listen [generation] they were received in.
+  Future<void> _grantEventCredits(int batches, int generation) async {
+    try {
+      await _methodChannel.invokeMethod<void>(
+        'grantEventCredits',
+        {'batches': batches, 'generation': generation},
+      );
+    } on PlatformException {
+      // The listener is gone; the next one starts with fresh credits.
+    }
+  }
+
+  /// Whether the native side recognizes pointer gestures.
+  ///
+  /// Only the Linux plugin does.
+  bool get supportsGestures => _hasLinuxPlugin;
+
+  /// Stream of pointer gestures (circles, shakes, scribbles and swipes)
+  /// recognized in the captured motion.
+  ///
+  /// Recognition runs natively, and only while this stream has listeners.
+  /// Empty where [supportsGestures] is `false`.
+  Stream<PointerGestureEvent> get gestures {
+    if (!supportsGestures) {
+      return const Stream<PointerGestureEvent>.empty();
+    }
+    _gestureStream ??= _gestureChannel
+        .receiveBroadcastStream()
+        .map((data) => PointerGestureEvent.fromMap(data as Map))
+        .where((gesture) => gesture != null)
+        .cast<PointerGestureEvent>();
+    return _gestureStream!;
+  }
+
+  /// Stream of thermal and power status updates.
+  ///
+  /// A status is sent when listening starts and whenever the tier, battery
+  /// state or temperature (by at least 1 °C) changes. The native side also
+  /// uses the tier itself: from [PerformanceTier.reduced] on, pointer
+  /// motion is coalesced before it is sent, and at
+  /// [PerformanceTier.minimal] batches are sent at most about 30 times a
+  /// second. Empty where [supportsEventBatches] is `false`.
+  Stream<PowerStatus> get powerStatus {
+    if (!supportsEventBatches) {
+      return const Stream<PowerStatus>.empty();
+    }
+    _powerStream ??= _powerChannel
+        .receiveBroadcastStream()
+        .map((data) => PowerStatus.fromMap(data as Map));
+    return _powerStream!;
+  }
+
+  /// Emits whenever the performance HUD chord is pressed.
+  ///
+  /// The chord is detected natively in the captured input, so it works
+  /// whatever has focus, and only while this stream has listeners. It is
+  /// Control+Alt+Shift+F12 unless set by the `KEYBOARD_PLAYGROUND_HUD_CHORD`
+  /// environment variable (e.g. `Control+Alt+H`) or [setHudChord]. Empty
+  /// where [supportsEventBatches] is `false`.
+  Stream<void> get hudToggles {
+    if (!supportsEventBatches) {
+      return const Stream<void>.empty();
+    }
+    return _hudToggles ??=
+        _hudChannel.receiveBroadcastStream().map<void>((_) {});
+  }
+
+  /// Sets the chord that emits on [hudToggles]: the X keysym name [key]
+  /// (`F12`, `h`) pressed while exactly [modifiers] are held.
+  ///
+  /// Returns `false` if the key is unknown or the platform has no HUD
+  /// chord.
+  Future<bool> setHudChord(
+    String key, {
+    Set<KeyModifier> modifiers = const {},
+  }) async {
+    try {
+      final result = await _methodChannel.invokeMethod<bool>('setHudChord', {
+        'key': key,
+        'modifiers': [for (final modifier in modifiers) modifier.name],
+      });
+      return result ?? false;
+    } on PlatformException {
+      return false;
+    }
+  }
+
+  /// Samples the thermal and power state now.
+  ///
+  /// Returns `null` where the platform does not report it.
+  Future<PowerStatus?> getPowerStatus() async {
+    try {
+      final result = await _methodChannel.invokeMapMethod<Object?, Object?>(
+        'getPowerStatus',
+      );
+      return result == null ? null : PowerStatus.fromMap(result);
+    } on PlatformException {
+      return null;
+    }
+  }
+
+  /// Calls [onEvent] for every input event passing [filter], without
+  /// allocating per event.
+  ///
+  /// The [CompactInputEvent] passed to [onEvent] is reused for every event
+  /// and is only valid during the call. Where the platform does not deliver
+  /// packed batches, events from [events] are copied into the reused
+  /// instance instead, and motion is not coalesced.
+  ///
+  /// With [decodeInBackground] and a [filter] that rejects pointer motion,
+  /// [filter] runs on a worker isolate, so events that do not pass it
+  /// never reach the UI isolate.
+  ///
+  /// Cancel the returned subscription to stop listening.
+  StreamSubscription<Object> listenCompact(
+    CompactEventCallback onEvent, {
+    CompactEventFilter filter = CompactEventFilter.all,
+  }) {
+    if (supportsEventBatches) {
+      final decoder = CompactEventDecoder();
+      void decode(Uint8List batch) => decoder.decode(batch, onEvent);
+      if (decodeInBackground && !filter.accepts(InputEventType.mouseMove)) {
+        return _listenInBackground(filter, decode);
+      }
+      return eventBatches.listen((batch) => decode(filter.apply(batch)));
+    }
+    final event = CompactInputEvent();
+    return events
+        .where((e) => filter.accepts(e.type))
+        .listen((e) => onEvent(event..setFrom(e)));
+  }
+
+  StreamSubscription<Uint8List> _listenInBackground(
+    CompactEventFilter filter,
+    FilteredBatchCallback onBatch,
+  ) {
+    final worker = _backgroundDecoder ??= BackgroundEventDecoder(
+      onProcessed: () {
+        final generation = _forwardedGenerations.removeFirst();
+        if (_batchSubscription != null) {
+          unawaited(_grantEventCredits(1, generation));
+        }
+      },
+    );
+    final results = StreamController<Uint8List>(sync: true);
+    late final int id;
+    results
+      ..onListen = () {
+        id = worker.addConsumer(filter, results.add);
+        _backgroundForwarding ??= eventBatches.listen((batch) {
+          _forwardedGenerations.add(_batchGeneration);
+          worker.add(batch);
+        });
+      }
+      ..onCancel = () async {
+        worker.removeConsumer(id);
+        if (!worker.hasConsumers) {
+          final forwarding = _backgroundForwarding;
+          _backgroundForwarding = null;
+          await forwarding?.cancel();
+        }
+      };
+    return results.stream.listen(onBatch);
+  }
+
   /// Starts capturing input events.
   ///
   /// Returns `true` if capture started successfully, `false` otherwise.
@@ -99,6 +476,15 @@ class InputCapture {
     }
   }
 
+  /// Stops the background decoder, if one was started.
+  ///
+  /// Listeners from [listenCompact] receive nothing afterwards.
+  void dispose() {
+    _backgroundDecoder?.close();
+    _backgroundDecoder = null;
+    _forwardedGenerations.clear();
+  }
+
   /// Checks if currently capturing input events.
   Future<bool> isCapturing() async {
     try {
@@ -152,6 +538,389 @@ class InputCapture {
     }
   }
 
+  /// Whether [permissions] (from [checkPermissions]) allow capturing.
+  ///
+  /// macOS reports `accessibility`, Linux `x11_record`.
+  static bool grantsCapture(Map<String, bool> permissions) =>
+      (permissions['accessibility'] ?? false) ||
+      (permissions['x11_record'] ?? false);
+
+  /// Waits until the user grants the capture permissions.
+  ///
+  /// Permissions are checked again whenever [recheck] fires (e.g. when the
+  /// app is resumed after the user visited System Settings) and, until it
+  /// first fires, every [interval] as a fallback. Completes with `true` as
+  /// soon as they are granted, or with `false` after [timeout].
+  Future<bool> waitForPermissions({
+    Stream<void>? recheck,
+    Duration interval = const Duration(seconds: 1),
+    Duration timeout = const Duration(seconds: 30),
+  }) async {
+    final granted = Completer<bool>();
+    var checking = false;
+
+    Future<void> check() async {
+      if (checking || granted.isCompleted) return;
+      checking = true;
+      final permissions = await checkPermissions();
+      checking = false;
+      if (grantsCapture(permissions) && !granted.isCompleted) {
+        granted.complete(true);
+      }
+    }
+
+    final poll = Timer.periodic(interval, (_) => unawaited(check()));
+    final deadline = Timer(timeout, () {
+      if (!granted.isCompleted) granted.complete(false);
+    });
+    final subscription = recheck?.listen((_) {
+      // Rechecks arrive, so polling is no longer needed.
+      poll.cancel();
+      unawaited(check());
+    });
+    unawaited(check());
+
+    try {
+      return await granted.future;
+    } finally {
+      poll.cancel();
+      deadline.cancel();
+      await subscription?.cancel();
+    }
+  }
+
+  /// Whether the native side starts a session in one call.
+  ///
+  /// Only the Linux plugin does; elsewhere [initializeSession] makes the
+  /// separate calls.
+  bool get supportsSessionInitialization => _hasLinuxPlugin;
+
+  /// Describes what the native backend supports.
+  Future<InputCapabilities> getCapabilities() async {
+    if (supportsSessionInitialization) {
+      try {
+        final result = await _methodChannel.invokeMapMethod<Object?, Object?>(
+          'getCapabilities',
+        );
+        if (result != null) return InputCapabilities.fromMap(result);
+      } on PlatformException {
+        // Fall back to what is known on the Dart side.
+      }
+    }
+    return InputCapabilities(
+      eventBatches: supportsEventBatches,
+      gestures: supportsGestures,
+    );
+  }
+
+  /// Checks permissions, enters fullscreen (if [fullscreen]) and starts
+  /// capture, as far as the permissions allow.
+  ///
+  /// Where [supportsSessionInitialization] is `true` this is a single
+  /// native call. Elsewhere the permission check and the fullscreen request
+  /// run concurrently and capture starts once both are done. Either way,
+  /// [SessionInfo.timings] reports the time taken by each step.
+  ///
+  /// With [selectBackend], capture starts with the fastest capture loop
+  /// for this machine, as picked by [selectCaptureBackend] and cached.
+  /// Only the first run on a machine and X server measures; this call then
+  /// waits a second or more for it, as capture must not start before the
+  /// probes are done. The platform thread keeps running meanwhile. Only
+  /// the Linux plugin has a choice; elsewhere this is ignored.
+  Future<SessionInfo> initializeSession({
+    bool fullscreen = true,
+    bool selectBackend = false,
+  }) async {
+    if (supportsSessionInitialization) {
+      try {
+        final result = await _methodChannel.invokeMapMethod<Object?, Object?>(
+          'initializeSession',
+          {'fullscreen': fullscreen, 'selectBackend': selectBackend},
+        );
+        if (result != null) return SessionInfo.fromMap(result);
+      } on PlatformException {
+        // Fall back to the separate calls.
+      }
+    }
+
+    final total = Stopwatch()..start();
+    final timings = <String, Duration>{};
+    Future<T> timed<T>(String step, Future<T> Function() run) async {
+      final stopwatch = Stopwatch()..start();
+      final result = await run();
+      timings[step] = stopwatch.elapsed;
+      return result;
+    }
+
+    final permissionsFuture = timed('probe', checkPermissions);
+    final fullscreenFuture = fullscreen
+        ? timed('fullscreen', WindowControl.enterFullscreen)
+        : Future.value(false);
+    final permissions = await permissionsFuture;
+    final inFullscreen = await fullscreenFuture;
+    final capturing =
+        grantsCapture(permissions) && await timed('capture', startCapture);
+    timings['total'] = total.elapsed;
+
+    return SessionInfo(
+      permissions: permissions,
+      capabilities: InputCapabilities(
+        eventBatches: supportsEventBatches,
+        gestures: supportsGestures,
+      ),
+      fullscreen: inFullscreen,
+      capturing: capturing,
+      timings: timings,
+    );
+  }
+
+  /// Starts recording every captured event into a session journal at [path].
+  ///
+  /// Journals are compact (delta-encoded, varint-packed blocks) and indexed
+  /// by time, so they can be replayed from any point with [replayJournal].
+  /// Without [compression] the most compact codec in the native build is
+  /// used; uncompressed journals take roughly 21 MB per hour of 1000 Hz
+  /// motion. If [compression] is not available in the native build, blocks
+  /// are stored uncompressed. Any journal that is already open is closed
+  /// first.
+  ///
+  /// Returns `true` if the journal was created.
+  Future<bool> startJournal(
+    String path, {
+    JournalCompression? compression,
+  }) async {
+    try {
+      final result = await _methodChannel.invokeMethod<bool>(
+        'startJournal',
+        {
+          'path': path,
+          if (compression != null) 'compression': compression.name,
+        },
+      );
+      return result ?? false;
+    } on PlatformException {
+      return false;
+    }
+  }
+
+  /// Stops recording and closes the current session journal.
+  ///
+  /// Returns the journal statistics, or `null` if no journal was open.
+  Future<JournalStats?> stopJournal() async {
+    try {
+      final result = await _methodChannel.invokeMapMethod<Object?, Object?>(
+        'stopJournal',
+      );
+      if (result == null || result.isEmpty) {
+        return null;
+      }
+      return JournalStats.fromMap(result);
+    } on PlatformException {
+      return null;
+    }
+  }
+
+  /// Replays a session journal through the regular event stream.
+  ///
+  /// Replayed events are delivered on [events] exactly like live input,
+  /// stamped with the time they are re-emitted. Playback starts [from] the
+  /// beginning of the journal (seeking through the block index, so any
+  /// starting point is instant) and runs at [rate] times the recorded speed;
+  /// a [rate] of zero or less replays as fast as possible.
+  ///
+  /// With [virtualTime], [FrameClock] runs on virtual time for the duration
+  /// of the replay, advancing one 60 FPS step per rendered frame, so the
+  /// animation state of every frame is reproducible from run to run.
+  ///
+  /// Completes when the replay has finished or was stopped with
+  /// [stopReplay]. Returns the number of replayed events, or `null` if the
+  /// journal could not be replayed.
+  Future<int?> replayJournal(
+    String path, {
+    Duration from = Duration.zero,
+    double rate = 1.0,
+    bool virtualTime = false,
+  }) async {
+    final clock = FrameClock.instance;
+    if (virtualTime) {
+      clock.useVirtualTime(frameStep: kVirtualFrameStep);
+    }
+    try {
+      final result = await _methodChannel.invokeMapMethod<String, Object?>(
+        'replayJournal',
+        {'path': path, 'fromUs': from.inMicroseconds, 'rate': rate},
+      );
+      return result?['events'] as int?;
+    } on PlatformException {
+      return null;
+    } finally {
+      if (virtualTime) {
+        clock.useRealTime();
+      }
+    }
+  }
+
+  /// Stops a running journal replay.
+  ///
+  /// Returns `true` if a replay was running.
+  Future<bool> stopReplay() async {
+    try {
+      final result = await _methodChannel.invokeMethod<bool>('stopReplay');
+      return result ?? false;
+    } on PlatformException {
+      return false;
+    }
+  }
+
+  /// Sets how long the native side holds an event back while waiting for a
+  /// lagging input source.
+  ///
+  /// Live capture and journal replay can run at the same time (e.g. a
+  /// "ghost" demo over live play). Their events are merged into one stream
+  /// in timestamp order, which means holding an event until every other
+  /// source has caught up with it. [window] bounds that wait, so a stalled
+  /// source delays the others by at most [window]. With a single source
+  /// events are never held. The default is 8 ms.
+  ///
+  /// Returns the window in effect, or `null` where the platform does not
+  /// merge sources.
+  Future<Duration?> setMergeWindow(Duration window) async {
+    try {
+      final result = await _methodChannel.invokeMethod<int>(
+        'setMergeWindow',
+        {'us': window.inMicroseconds},
+      );
+      return result == null ? null : Duration(microseconds: result);
+    } on PlatformException {
+      return null;
+    }
+  }
+
+  /// Applies [stages] to the native event pipeline and returns all stages
+  /// in order, or `null` where there is no configurable pipeline or a
+  /// stage or option is invalid. Valid changes are applied even then.
+  ///
+  /// Example, for a keyboard-only deployment:
+  /// ```dart
+  /// await inputCapture.configurePipeline({
+  ///   EventPipelineStage.filter: EventStageConfig.types(
+  ///     {InputEventType.keyDown, InputEventType.keyUp},
+  ///   ),
+  /// });
+  /// ```
+  Future<List<EventStageInfo>?> configurePipeline(
+    Map<EventPipelineStage, EventStageConfig> stages,
+  ) async {
+    try {
+      final result = await _methodChannel.invokeListMethod<Object?>(
+        'configurePipeline',
+        {
+          'stages': {
+            for (final entry in stages.entries)
+              entry.key.id: entry.value.toMap(),
+          },
+        },
+      );
+      return result == null ? null : _parseStages(result);
+    } on PlatformException {
+      return null;
+    }
+  }
+
+  /// Turns timing of the native event pipeline stages on or off and
+  /// returns whether it is on. Turning it on starts the timing over.
+  ///
+  /// Off by default: timing reads the clock after every stage of every
+  /// event, so turn it off again once [getPipeline] is no longer polled.
+  /// Returns `false` where there is no configurable pipeline.
+  Future<bool> setPipelineTiming(bool enabled) async {
+    try {
+      final result = await _methodChannel.invokeMethod<bool>(
+        'setPipelineTiming',
+        {'enabled': enabled},
+      );
+      return result ?? false;
+    } on PlatformException {
+      return false;
+    }
+  }
+
+  /// The native event pipeline stages in order, with their configuration
+  /// and timing. With [resetTimings], timing starts over afterwards.
+  ///
+  /// Stages are only timed while [setPipelineTiming] is on; otherwise the
+  /// counts and times stay zero. Returns an empty list where there is no
+  /// configurable pipeline.
+  Future<List<EventStageInfo>> getPipeline({bool resetTimings = false}) async {
+    try {
+      final result = await _methodChannel.invokeListMethod<Object?>(
+        'getPipeline',
+        {'resetTimings': resetTimings},
+      );
+      return result == null ? const [] : _parseStages(result);
+    } on PlatformException {
+      return const [];
+    }
+  }
+
+  static List<EventStageInfo> _parseStages(List<Object?> stages) => [
+        for (final stage in stages.whereType<Map<Object?, Object?>>())
+          EventStageInfo.fromMap(stage),
+      ];
+
+  /// Picks the fastest native capture loop for this machine by injecting
+  /// a few probe events and timing their delivery.
+  ///
+  /// The decision is cached per machine and X server; [rerun] measures
+  /// again regardless, which takes a second or more. The native side
+  /// measures on a thread of its own and the next capture start uses the
+  /// selection. Must be called while not capturing. Returns the
+  /// selection, or `null` where the platform has no choice, capture is
+  /// running or a selection is already in progress.
+  Future<CaptureBackendInfo?> selectCaptureBackend({bool rerun = false}) async {
+    try {
+      final result = await _methodChannel.invokeMapMethod<Object?, Object?>(
+        'selectCaptureBackend',
+        {'rerun': rerun},
+      );
+      return result == null ? null : CaptureBackendInfo.fromMap(result);
+    } on PlatformException {
+      return null;
+    }
+  }
+
+  /// Sets the lowest [level] the native log records and, optionally, the
+  /// lowest level it also prints to stderr ([console]).
+  ///
+  /// Native trace and debug messages are compiled out of release builds
+  /// and stay disabled whatever the level.
+  Future<void> setNativeLogLevel(LogLevel level, {LogLevel? console}) async {
+    try {
+      await _methodChannel.invokeMethod<int>('setLogLevel', {
+        'level': level.index,
+        if (console != null) 'console': console.index,
+      });
+    } on PlatformException {
+      // Not supported on this platform.
+    }
+  }
+
+  /// Reads back the native in-memory log, oldest message first.
+  ///
+  /// Returns an empty list where the platform has no native log.
+  Future<List<LogRecord>> dumpNativeLog() async {
+    try {
+      final result =
+          await _methodChannel.invokeListMethod<Object?>('dumpLog') ?? [];
+      return [
+        for (final entry in result)
+          LogRecord.fromNativeMap(entry! as Map<Object?, Object?>),
+      ];
+    } on PlatformException {
+      return const [];
+    }
+  }
+
   /// Parses a raw event map from the event channel into a typed [InputEvent].
   @visibleForTesting
   InputEvent parseEvent(dynamic data) {
@@ -0,0 +1,156 @@
+/// Latest-state input polling through FFI.
+///
+/// Many consumers only need the current pointer position, held buttons and
+/// held keys at frame time, not every event that led there. The Linux
+/// capture plugin keeps that state in a seqlock-protected native struct;
+/// [InputStateReader] copies it in a single FFI call, so polling costs the
+/// same however fast input arrives and nothing is sent over a channel.
+library;
+
+import 'dart:ffi';
+
+import 'package:flutter/foundation.dart';
+import 'package:keyboard_playground/platform/input_events.dart';
+
+/// Native `InputStateSnapshot` (linux/input_state.h). 64 bytes.
+final class NativeInputState extends Struct {
+  /// Number of events applied so far. Changes whenever the state does.
+  @Uint64()
+  external int sequence;
+
+  /// Wall-clock time of the last applied event, in microseconds since the
+  /// epoch.
+  @Int64()
+  external int lastEventTimeUs;
+
+  /// Last known pointer position in screen coordinates.
+  @Int32()
+  external int pointerX;
+
+  /// Last known pointer position in screen coordinates.
+  @Int32()
+  external int pointerY;
+
+  /// Held mouse buttons: bit n-1 is set while button n is down.
+  @Uint32()
+  external int buttons;
+
+  /// Held modifiers, as `KeyModifierMask.mask` bits.
+  @Uint32()
+  external int modifiers;
+
+  /// Held keys: bit k of the 256-bit map is set while key code k is down.
+  @Array(4)
+  external Array<Uint64> keys;
+}
+
+typedef _NewNative = Pointer<NativeInputState> Function();
+typedef _FreeNative = Void Function(Pointer<NativeInputState>);
+typedef _FreeDart = void Function(Pointer<NativeInputState>);
+typedef _ReadNative = Void Function(Pointer<NativeInputState>);
+typedef _ReadDart = void Function(Pointer<NativeInputState>);
+
+/// Polls the native input state.
+///
+/// Example usage:
+/// ```dart
+/// final reader = InputStateReader.open();
+///
+/// // Once per frame:
+/// final state = reader?.poll();
+/// if (state != null && state.sequence != lastSequence) {
+///   cursor = Offset(state.pointerX.toDouble(), state.pointerY.toDouble());
+/// }
+/// ```
+class InputStateReader {
+  InputStateReader._(this._snapshot, this._read, this._free)
+      : state = _snapshot.ref;
+
+  /// Reads through [read] into [snapshot], which the caller owns, instead
+  /// of through the native runner.
+  @visibleForTesting
+  InputStateReader.withReader(
+    Pointer<NativeInputState> snapshot,
+    void Function(Pointer<NativeInputState>) read,
+  ) : this._(snapshot, read, (_) {});
+
+  /// Connects to the native input state.
+  ///
+  /// Returns `null` where it is not available (platforms other than Linux,
+  /// or tests without the native runner).
+  static InputStateReader? open() {
+    if (kIsWeb || defaultTargetPlatform != TargetPlatform.linux) {
+      return null;
+    }
+    try {
+      final library = DynamicLibrary.executable();
+      final create = library.lookupFunction<_NewNative, _NewNative>(
+        'keyboard_playground_input_state_new',
+      );
+      final free = library.lookupFunction<_FreeNative, _FreeDart>(
+        'keyboard_playground_input_state_free',
+      );
+      final read = library.lookupFunction<_ReadNative, _ReadDart>(
+        'keyboard_playground_read_input_state',
+        isLeaf: true,
+      );
+      return InputStateReader._(create(), read, free);
+    } on ArgumentError {
+      // Symbol not exported by this executable.
+      return null;
+    }
+  }
+
+  final Pointer<NativeInputState> _snapshot;
+  final _ReadDart _read;
+  final _FreeDart _free;
+  bool _disposed = false;
+
+  /// The state copied by the last [poll]. Updated in place.
+  final NativeInputState state;
+
+  /// Copies the latest native state into [state] and returns it.
+  NativeInputState poll() {
+    assert(!_disposed, 'InputStateReader used after dispose');
+    _read(_snapshot);
+    return state;
+  }
+
+  /// Whether key code [keyCode] was held at the last [poll].
+  bool isKeyDown(int keyCode) {
+    if (keyCode < 0 || keyCode > 255) return false;
+    return (state.keys[keyCode >> 6] >> (keyCode & 63)) & 1 != 0;
+  }
+
+  /// Number of keys held at the last [poll].
+  int get heldKeyCount {
+    var count = 0;
+    for (var i = 0; i < 4; i++) {
+      for (var word = state.keys[i]; word != 0; word &= word - 1) {
+        count++;
+      }
+    }
+    return count;
+  }
+
+  /// Whether [button] was held at the last [poll].
+  bool isButtonDown(MouseButton button) {
+    switch (button) {
+      case MouseButton.left:
+        return state.buttons & 0x1 != 0;
+      case MouseButton.middle:
+        return state.buttons & 0x2 != 0;
+      case MouseButton.right:
+        return state.buttons & 0x4 != 0;
+      case MouseButton.other:
+        return state.buttons & ~0x7 != 0;
+    }
+  }
+
+  /// Releases the native snapshot. The reader must not be used afterwards.
+  void dispose() {
+    if (_disposed) return;
+    _disposed = true;
+    _free(_snapshot);
+  }
+}
@@ -0,0 +1,194 @@
+/// Live native input pipeline statistics through FFI.
+///
+/// The performance HUD shows what the capture pipeline is doing while the
+/// app runs. Streaming statistics over a channel would add messages to the
+/// very queues being measured, so the Linux plugin keeps them in a native
+/// struct instead and [PipelineStatsReader] copies it in one FFI call,
+/// once per displayed frame.
+library;
+
+import 'dart:ffi';
+
+import 'package:flutter/foundation.dart';
+import 'package:keyboard_playground/platform/input_events.dart';
+
+/// Stages of the native input pipeline whose latency is tracked.
+///
+/// Mirrors `PipelineStage` in linux/pipeline_stats.h.
+enum PipelineStage {
+  /// X server to the capture thread, at millisecond resolution.
+  capture,
+
+  /// Capture thread to dispatch (time spent in the event merger).
+  merge,
+
+  /// Dispatch to the batch being sent to Dart.
+  flush,
+
+  /// X server round trip on a side connection, probed about once a second
+  /// while input arrives. High values mean the X server, not the app, is
+  /// slow.
+  serverRoundTrip,
+
+  /// X server to a client for the probe's own events, at millisecond
+  /// resolution: the server's share of [capture].
+  serverEvent,
+}
+
+/// Latency percentiles reported per stage, in this order.
+enum LatencyPercentile {
+  /// Median.
+  p50,
+
+  /// 95th percentile.
+  p95,
+
+  /// 99th percentile.
+  p99,
+
+  /// Largest latency seen.
+  max,
+}
+
+/// Native `PipelineStatsSnapshot` (linux/pipeline_stats.h). 224 bytes.
+final class NativePipelineStats extends Struct {
+  /// Number of reads so far, including this one.
+  @Uint64()
+  external int sequence;
+
+  /// Monotonic time of the read, in microseconds.
+  @Int64()
+  external int sampledAtUs;
+
+  /// Events dispatched since start, indexed by [InputEventType.index].
+  @Array(6)
+  external Array<Uint64> events;
+
+  /// Events per second in the last full window, indexed by
+  /// [InputEventType.index].
+  @Array(6)
+  external Array<Uint32> eventsPerSecond;
+
+  /// Records waiting for the next batch flush.
+  @Uint32()
+  external int queueDepth;
+
+  /// Events buffered in the merger.
+  @Uint32()
+  external int mergeBuffered;
+
+  /// Events merged into others for lack of credits or under power
+  /// pressure.
+  @Uint64()
+  external int coalesced;
+
+  /// Events dropped for lack of credits.
+  @Uint64()
+  external int dropped;
+
+  /// Events the merger emitted out of order.
+  @Uint64()
+  external int mergeLate;
+
+  /// Latency in microseconds, [LatencyPercentile.values.length] entries
+  /// per [PipelineStage]; see [latencyUs].
+  @Array(20)
+  external Array<Uint32> latencies;
+
+  /// CPU time used by the current capture thread, in microseconds.
+  @Int64()
+  external int captureCpuUs;
+
+  /// Resident set size of the process, in bytes.
+  @Int64()
+  external int rssBytes;
+
+  /// Capture thread CPU usage in the last window, in per mille of a core.
+  @Uint32()
+  external int captureCpuPermille;
+
+  /// Length of the window rates and percentiles are computed over.
+  @Uint32()
+  external int windowMs;
+}
+
+/// Typed accessors for [NativePipelineStats].
+extension NativePipelineStatsValues on NativePipelineStats {
+  /// Latency of [stage] at [percentile], in microseconds, or 0 without
+  /// samples.
+  int latencyUs(PipelineStage stage, LatencyPercentile percentile) =>
+      latencies[stage.index * LatencyPercentile.values.length +
+          percentile.index];
+
+  /// Events of [type] per second in the last window.
+  int eventRate(InputEventType type) => eventsPerSecond[type.index];
+}
+
+typedef _NewNative = Pointer<NativePipelineStats> Function();
+typedef _FreeNative = Void Function(Pointer<NativePipelineStats>);
+typedef _FreeDart = void Function(Pointer<NativePipelineStats>);
+typedef _ReadNative = Void Function(Pointer<NativePipelineStats>);
+typedef _ReadDart = void Function(Pointer<NativePipelineStats>);
+
+/// Reads the native pipeline statistics.
+///
+/// Example usage:
+/// ```dart
+/// final reader = PipelineStatsReader.open();
+///
+/// // Once per frame while the HUD is shown:
+/// final stats = reader?.poll();
+/// ```
+class PipelineStatsReader {
+  PipelineStatsReader._(this._snapshot, this._read, this._free)
+      : stats = _snapshot.ref;
+
+  /// Connects to the native pipeline statistics.
+  ///
+  /// Returns `null` where they are not available (platforms other than
+  /// Linux, or tests without the native runner).
+  static PipelineStatsReader? open() {
+    if (kIsWeb || defaultTargetPlatform != TargetPlatform.linux) {
+      return null;
+    }
+    try {
+      final library = DynamicLibrary.executable();
+      final create = library.lookupFunction<_NewNative, _NewNative>(
+        'keyboard_playground_pipeline_stats_new',
+      );
+      final free = library.lookupFunction<_FreeNative, _FreeDart>(
+        'keyboard_playground_pipeline_stats_free',
+      );
+      final read = library.lookupFunction<_ReadNative, _ReadDart>(
+        'keyboard_playground_read_pipeline_stats',
+        isLeaf: true,
+      );
+      return PipelineStatsReader._(create(), read, free);
+    } on ArgumentError {
+      // Symbol not exported by this executable.
+      return null;
+    }
+  }
+
+  final Pointer<NativePipelineStats> _snapshot;
+  final _ReadDart _read;
+  final _FreeDart _free;
+  bool _disposed = false;
+
+  /// The statistics copied by the last [poll]. Updated in place.
+  final NativePipelineStats stats;
+
+  /// Copies the latest native statistics into [stats] and returns them.
+  NativePipelineStats poll() {
+    assert(!_disposed, 'PipelineStatsReader used after dispose');
+    _read(_snapshot);
+    return stats;
+  }
+
+  /// Releases the native snapshot. The reader must not be used afterwards.
+  void dispose() {
+    if (_disposed) return;
+    _disposed = true;
+    _free(_snapshot);
+  }
+}
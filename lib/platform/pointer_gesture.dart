@@ -0,0 +1,101 @@
+/// Pointer gestures recognized by the native capture plugin.
+///
+/// Recognizing gestures natively means the motion stream does not have to
+/// reach Dart at full rate just to spot a circle or a shake; only the
+/// recognized gesture crosses the channel.
+library;
+
+/// Kind of a recognized pointer gesture.
+///
+/// The order mirrors `GestureKind` in linux/gesture_recognizer.h.
+enum PointerGesture {
+  /// The pointer went once around in a circle.
+  circle,
+
+  /// The pointer was shaken back and forth.
+  shake,
+
+  /// Lots of quick, tangled motion in a small area.
+  scribble,
+
+  /// A fast, straight stroke.
+  swipe,
+}
+
+/// Direction of a [PointerGesture.swipe], in screen coordinates.
+enum SwipeDirection {
+  /// Towards the right edge of the screen.
+  right,
+
+  /// Towards the bottom edge of the screen.
+  down,
+
+  /// Towards the left edge of the screen.
+  left,
+
+  /// Towards the top edge of the screen.
+  up,
+}
+
+/// A recognized pointer gesture.
+class PointerGestureEvent {
+  /// Creates a gesture event.
+  const PointerGestureEvent({
+    required this.gesture,
+    required this.confidence,
+    required this.x,
+    required this.y,
+    required this.timestamp,
+    this.direction,
+  });
+
+  /// Creates a gesture event from the map sent by native code.
+  ///
+  /// Returns `null` for gestures this version of the app does not know.
+  static PointerGestureEvent? fromMap(Map<Object?, Object?> map) {
+    final gesture = _byName(PointerGesture.values, map['gesture']);
+    if (gesture == null) return null;
+    final confidence = (map['confidence'] as num? ?? 0).toDouble();
+    return PointerGestureEvent(
+      gesture: gesture,
+      confidence: confidence.clamp(0.0, 1.0),
+      x: (map['x'] as num? ?? 0).toDouble(),
+      y: (map['y'] as num? ?? 0).toDouble(),
+      timestamp: DateTime.fromMillisecondsSinceEpoch(
+        map['timestamp'] as int? ?? 0,
+      ),
+      direction: _byName(SwipeDirection.values, map['direction']),
+    );
+  }
+
+  /// The kind of gesture.
+  final PointerGesture gesture;
+
+  /// How closely the motion matched [gesture], from 0 to 1.
+  final double confidence;
+
+  /// Where the gesture happened, in screen coordinates: the center for
+  /// circles, shakes and scribbles, the end point for swipes.
+  final double x;
+
+  /// Where the gesture happened, in screen coordinates.
+  final double y;
+
+  /// When the gesture was completed.
+  final DateTime timestamp;
+
+  /// Direction of a swipe; `null` for other gestures.
+  final SwipeDirection? direction;
+
+  static T? _byName<T extends Enum>(List<T> values, Object? name) {
+    for (final value in values) {
+      if (value.name == name) return value;
+    }
+    return null;
+  }
+
+  @override
+  String toString() => 'PointerGestureEvent(${gesture.name}'
+      '${direction == null ? '' : ' ${direction!.name}'}, '
+      'confidence: ${confidence.toStringAsFixed(2)}, at: $x, $y)';
+}
@@ -0,0 +1,78 @@
+/// Thermal and power state reported by the native capture plugin.
+///
+/// Fanless kiosks throttle under sustained effects, and the stutter that
+/// follows is worse than simply drawing less. The Linux plugin samples
+/// sysfs thermal zones, processor cooling devices and batteries and
+/// recommends a [PerformanceTier] before the hardware gets there.
+library;
+
+import 'package:keyboard_playground/core/quality_controller.dart';
+
+/// How much work the machine can take right now.
+///
+/// The order mirrors `PerformanceTier` in linux/power_monitor.h.
+enum PerformanceTier {
+  /// No thermal or power pressure.
+  full(QualityLevel.high),
+
+  /// Warm, throttling lightly, or on battery.
+  reduced(QualityLevel.medium),
+
+  /// Close to throttling, or low battery.
+  minimal(QualityLevel.low);
+
+  const PerformanceTier(this.qualityCeiling);
+
+  /// Highest [QualityLevel] to render at in this tier.
+  final QualityLevel qualityCeiling;
+}
+
+/// One sample of the thermal and power state.
+class PowerStatus {
+  /// Creates a power status.
+  const PowerStatus({
+    required this.tier,
+    this.temperature,
+    this.headroom,
+    this.throttle = 0,
+    this.onBattery = false,
+    this.batteryPercent,
+  });
+
+  /// Creates a power status from the map sent by native code.
+  factory PowerStatus.fromMap(Map<Object?, Object?> map) {
+    final tier = map['tier'] as int? ?? 0;
+    return PowerStatus(
+      tier: PerformanceTier.values[tier.clamp(0, 2)],
+      temperature: (map['temperature'] as num?)?.toDouble(),
+      headroom: (map['headroom'] as num?)?.toDouble(),
+      throttle: (map['throttle'] as num? ?? 0).toDouble(),
+      onBattery: map['onBattery'] as bool? ?? false,
+      batteryPercent: map['batteryPercent'] as int?,
+    );
+  }
+
+  /// Recommended tier, with hysteresis: it drops as soon as a sample calls
+  /// for it and recovers only after several calmer samples.
+  final PerformanceTier tier;
+
+  /// Hottest thermal zone in °C, or `null` without thermal sensors.
+  final double? temperature;
+
+  /// Distance in °C of the closest zone to its throttling trip point, or
+  /// `null` without thermal sensors.
+  final double? headroom;
+
+  /// How far the processor is already throttled, from 0 to 1.
+  final double throttle;
+
+  /// Whether the machine runs on a discharging battery.
+  final bool onBattery;
+
+  /// Battery charge in percent, or `null` without a battery.
+  final int? batteryPercent;
+
+  @override
+  String toString() => 'PowerStatus(${tier.name}, temperature: $temperature, '
+      'headroom: $headroom, throttle: $throttle, onBattery: $onBattery)';
+}
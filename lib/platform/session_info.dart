@@ -0,0 +1,246 @@
+/// Capabilities of the native capture backend and the result of starting a
+/// capture session.
+///
+/// Startup used to take a platform round trip per step (permission check,
+/// fullscreen, capture start), each waiting for the previous one. The Linux
+/// plugin does all of them in a single `initializeSession` call and reports
+/// how long each step took, so slow starts can be traced to a step.
+library;
+
+import 'package:keyboard_playground/platform/input_capture.dart';
+
+/// Self-benchmark result of one native capture loop.
+class CaptureBackendMeasurement {
+  /// Creates a measurement.
+  const CaptureBackendMeasurement({
+    required this.name,
+    this.available = false,
+    this.probes = 0,
+    this.delivered = 0,
+    this.medianLatency = Duration.zero,
+    this.p95Latency = Duration.zero,
+    this.cpuPerEvent = Duration.zero,
+  });
+
+  /// Creates a measurement from the map sent by native code.
+  factory CaptureBackendMeasurement.fromMap(Map<Object?, Object?> map) {
+    Duration us(String key) =>
+        Duration(microseconds: (map[key] as num?)?.toInt() ?? 0);
+    return CaptureBackendMeasurement(
+      name: map['name'] as String? ?? '',
+      available: map['available'] as bool? ?? false,
+      probes: (map['probes'] as num?)?.toInt() ?? 0,
+      delivered: (map['delivered'] as num?)?.toInt() ?? 0,
+      medianLatency: us('medianLatencyUs'),
+      p95Latency: us('p95LatencyUs'),
+      cpuPerEvent: us('cpuUsPerEvent'),
+    );
+  }
+
+  /// Name of the capture loop.
+  final String name;
+
+  /// Whether the loop could be set up and delivered probes.
+  final bool available;
+
+  /// Probes injected and probes delivered.
+  final int probes;
+
+  /// Probes seen by the capture loop.
+  final int delivered;
+
+  /// Median time from injecting a probe to its delivery.
+  final Duration medianLatency;
+
+  /// 95th percentile of the probe delivery time.
+  final Duration p95Latency;
+
+  /// Capture thread CPU time per delivered probe.
+  final Duration cpuPerEvent;
+
+  @override
+  String toString() => '$name(${available ? '' : 'unavailable, '}'
+      '$delivered/$probes, median: ${medianLatency.inMicroseconds}us, '
+      'p95: ${p95Latency.inMicroseconds}us, '
+      'cpu: ${cpuPerEvent.inMicroseconds}us)';
+}
+
+/// Native capture loop in use and how it was picked.
+///
+/// On Linux the plugin can measure its capture loops against each other
+/// with injected probe events and keep the fastest; the decision is
+/// cached per machine and X server, so only the first start pays for it.
+class CaptureBackendInfo {
+  /// Creates a backend description.
+  const CaptureBackendInfo({
+    required this.name,
+    this.cached = false,
+    this.measured = false,
+    this.elapsed = Duration.zero,
+    this.measurements = const [],
+  });
+
+  /// Creates a backend description from the map sent by native code.
+  factory CaptureBackendInfo.fromMap(Map<Object?, Object?> map) {
+    final measurements = map['measurements'] as List<Object?>? ?? const [];
+    return CaptureBackendInfo(
+      name: map['name'] as String? ?? '',
+      cached: map['cached'] as bool? ?? false,
+      measured: map['measured'] as bool? ?? false,
+      elapsed: Duration(microseconds: (map['elapsedUs'] as num?)?.toInt() ?? 0),
+      measurements: [
+        for (final measurement
+            in measurements.whereType<Map<Object?, Object?>>())
+          CaptureBackendMeasurement.fromMap(measurement),
+      ],
+    );
+  }
+
+  /// Name of the capture loop in use.
+  final String name;
+
+  /// Whether the decision was read from the per-machine cache.
+  final bool cached;
+
+  /// Whether the decision is based on the self-benchmark, as opposed to
+  /// the default.
+  final bool measured;
+
+  /// Time the last selection took.
+  final Duration elapsed;
+
+  /// Results of the self-benchmark, empty if it did not run.
+  final List<CaptureBackendMeasurement> measurements;
+
+  @override
+  String toString() => 'CaptureBackendInfo($name, cached: $cached, '
+      'measured: $measured, elapsed: ${elapsed.inMicroseconds}us, '
+      'measurements: $measurements)';
+}
+
+/// What the native capture backend supports.
+class InputCapabilities {
+  /// Creates a capabilities description.
+  const InputCapabilities({
+    this.recordVersion,
+    this.eventBatches = false,
+    this.gestures = false,
+    this.powerStatus = false,
+    this.journalCompression = const [],
+    this.captureBackend,
+    this.pipelineStats = false,
+    this.startupCached = false,
+  });
+
+  /// Creates capabilities from the map sent by native code.
+  factory InputCapabilities.fromMap(Map<Object?, Object?> map) {
+    final codecs = map['journalCompression'] as List<Object?>? ?? const [];
+    final backend = map['captureBackend'] as Map<Object?, Object?>?;
+    return InputCapabilities(
+      recordVersion: map['recordVersion'] as String?,
+      eventBatches: map['eventBatches'] as bool? ?? false,
+      gestures: map['gestures'] as bool? ?? false,
+      powerStatus: map['powerStatus'] as bool? ?? false,
+      journalCompression: [
+        for (final compression in JournalCompression.values)
+          if (codecs.contains(compression.name)) compression,
+      ],
+      captureBackend:
+          backend == null ? null : CaptureBackendInfo.fromMap(backend),
+      pipelineStats: map['pipelineStats'] as bool? ?? false,
+      startupCached: map['startupCached'] as bool? ?? false,
+    );
+  }
+
+  /// Version of the X11 RECORD extension, or `null` where it is not used
+  /// or not available.
+  final String? recordVersion;
+
+  /// Whether events are delivered as packed batches.
+  final bool eventBatches;
+
+  /// Whether pointer gestures are recognized natively.
+  final bool gestures;
+
+  /// Whether thermal and power status is reported.
+  final bool powerStatus;
+
+  /// Journal compressions compiled into the native build.
+  final List<JournalCompression> journalCompression;
+
+  /// Native capture loop in use, or `null` where there is no choice.
+  final CaptureBackendInfo? captureBackend;
+
+  /// Whether live pipeline statistics can be read through
+  /// `PipelineStatsReader`.
+  final bool pipelineStats;
+
+  /// Whether the extension probe and keymap came from the persistent
+  /// startup cache rather than from querying the X server.
+  final bool startupCached;
+
+  @override
+  String toString() => 'InputCapabilities(record: $recordVersion, '
+      'eventBatches: $eventBatches, gestures: $gestures, '
+      'powerStatus: $powerStatus, pipelineStats: $pipelineStats, '
+      'startupCached: $startupCached, '
+      'journalCompression: ${journalCompression.map((c) => c.name)}, '
+      'captureBackend: $captureBackend)';
+}
+
+/// Result of [InputCapture.initializeSession].
+class SessionInfo {
+  /// Creates a session result.
+  const SessionInfo({
+    required this.permissions,
+    required this.capabilities,
+    required this.fullscreen,
+    required this.capturing,
+    this.timings = const {},
+  });
+
+  /// Creates a session result from the map sent by native code.
+  factory SessionInfo.fromMap(Map<Object?, Object?> map) {
+    final permissions = map['permissions'] as Map<Object?, Object?>? ?? {};
+    final capabilities = map['capabilities'] as Map<Object?, Object?>? ?? {};
+    final timings = map['timings'] as Map<Object?, Object?>? ?? {};
+    return SessionInfo(
+      permissions: {
+        for (final entry in permissions.entries)
+          entry.key! as String: entry.value as bool? ?? false,
+      },
+      capabilities: InputCapabilities.fromMap(capabilities),
+      fullscreen: map['fullscreen'] as bool? ?? false,
+      capturing: map['capturing'] as bool? ?? false,
+      timings: {
+        for (final entry in timings.entries)
+          entry.key! as String:
+              Duration(microseconds: (entry.value as num?)?.toInt() ?? 0),
+      },
+    );
+  }
+
+  /// Permission status, as returned by [InputCapture.checkPermissions].
+  final Map<String, bool> permissions;
+
+  /// What the backend supports.
+  final InputCapabilities capabilities;
+
+  /// Whether fullscreen was requested successfully.
+  final bool fullscreen;
+
+  /// Whether capture is running.
+  final bool capturing;
+
+  /// Time taken by each step (`backend`, `probe`, `fullscreen`,
+  /// `capture`) and in `total`. Steps that were skipped are missing.
+  final Map<String, Duration> timings;
+
+  /// Whether the permissions allow capturing.
+  bool get permissionsGranted => InputCapture.grantsCapture(permissions);
+
+  @override
+  String toString() => 'SessionInfo(capturing: $capturing, '
+      'fullscreen: $fullscreen, permissions: $permissions, timings: '
+      '${timings.map((step, time) => MapEntry(step, time.inMicroseconds))})';
+}
@@ -7,6 +7,7 @@ library;
 // ignore: unnecessary_import
 import 'dart:ui' show Size;
 
+import 'package:flutter/foundation.dart';
 import 'package:flutter/services.dart';
 
 /// Controls the application window across different platforms.
@@ -37,13 +38,21 @@ class WindowControl {
   /// Returns `true` if fullscreen was successfully enabled, `false` otherwise.
   /// On platforms that don't support fullscreen, this returns `false`.
   ///
+  /// With [bypassCompositor], Linux also asks the compositor to unredirect
+  /// the window (`_NET_WM_BYPASS_COMPOSITOR`) until fullscreen is exited,
+  /// which saves a frame of latency and a full-screen copy. See
+  /// [fullscreenStatus] for whether it took effect.
+  ///
   /// Platform behavior:
   /// - **macOS**: Uses `NSWindow.toggleFullScreen()`
   /// - **Linux**: Uses X11 fullscreen protocol
   /// - **Windows**: Uses Win32 fullscreen mode
-  static Future<bool> enterFullscreen() async {
+  static Future<bool> enterFullscreen({bool bypassCompositor = true}) async {
     try {
-      final result = await _methodChannel.invokeMethod<bool>('enterFullscreen');
+      final result = await _methodChannel.invokeMethod<bool>(
+        'enterFullscreen',
+        {'bypassCompositor': bypassCompositor},
+      );
       return result ?? false;
     } on PlatformException {
       // Platform channel not implemented or error occurred
@@ -112,6 +121,37 @@ class WindowControl {
     }
   }
 
+  /// Sets which in-window input still reaches Flutter while input capture
+  /// is active.
+  ///
+  /// On Linux the runner keeps key and pointer motion events over the
+  /// window from the engine while capture runs, since they already arrive
+  /// through the input capture channels. UI that needs real Flutter input,
+  /// such as hover effects or focus-based keyboard handling, exempts [keys]
+  /// and/or [pointer] motion while it is shown. Prefer the
+  /// `ViewInputExemption` widget, which combines the needs of everything on
+  /// screen.
+  ///
+  /// Returns `true` if the runner filters view input (so the exemptions take
+  /// effect), `false` otherwise, including on other platforms.
+  static Future<bool> setViewInputExemptions({
+    bool keys = false,
+    bool pointer = false,
+  }) async {
+    try {
+      final result = await _methodChannel.invokeMethod<bool>(
+        'setViewInputExemptions',
+        {'keys': keys, 'pointer': pointer},
+      );
+      return result ?? false;
+    } on PlatformException {
+      return false;
+      // ignore: avoid_catches_without_on_clauses
+    } catch (_) {
+      return false;
+    }
+  }
+
   /// Gets whether the window is currently in fullscreen mode.
   ///
   /// Returns `true` if the window is in fullscreen, `false` otherwise.
@@ -127,4 +167,77 @@ class WindowControl {
       return false;
     }
   }
+
+  /// Gets whether the window is fullscreen and how it is presented.
+  ///
+  /// Only Linux reports the compositor state; elsewhere only
+  /// [FullscreenStatus.fullscreen] is meaningful.
+  static Future<FullscreenStatus> fullscreenStatus() async {
+    try {
+      final result = await _methodChannel.invokeMapMethod<String, bool>(
+        'isFullscreen',
+        {'details': true},
+      );
+      if (result != null) return FullscreenStatus.fromMap(result);
+    } on PlatformException {
+      // Fall through to the plain query.
+      // ignore: avoid_catches_without_on_clauses
+    } catch (_) {
+      // Platforms answering with a plain bool.
+    }
+    return FullscreenStatus(fullscreen: await isFullscreen());
+  }
+}
+
+/// Fullscreen and compositor state of the window, from
+/// [WindowControl.fullscreenStatus].
+@immutable
+class FullscreenStatus {
+  /// Creates a status.
+  const FullscreenStatus({
+    required this.fullscreen,
+    this.composited = false,
+    this.bypassCompositor = false,
+    this.unredirected = false,
+  });
+
+  /// Parses the map returned by the `isFullscreen` method with details.
+  factory FullscreenStatus.fromMap(Map<String, bool> map) => FullscreenStatus(
+        fullscreen: map['fullscreen'] ?? false,
+        composited: map['composited'] ?? false,
+        bypassCompositor: map['bypassCompositor'] ?? false,
+        unredirected: map['unredirected'] ?? false,
+      );
+
+  /// Whether the window is fullscreen.
+  final bool fullscreen;
+
+  /// Whether a compositing manager is running.
+  final bool composited;
+
+  /// Whether the window asks the compositor to unredirect it.
+  final bool bypassCompositor;
+
+  /// Whether frames reach the screen without compositing: the window is
+  /// fullscreen, and either nothing composites or the window manager
+  /// supports the bypass hint the window carries. X11 cannot confirm the
+  /// compositor's side, so this is a best inference.
+  final bool unredirected;
+
+  @override
+  bool operator ==(Object other) =>
+      other is FullscreenStatus &&
+      other.fullscreen == fullscreen &&
+      other.composited == composited &&
+      other.bypassCompositor == bypassCompositor &&
+      other.unredirected == unredirected;
+
+  @override
+  int get hashCode =>
+      Object.hash(fullscreen, composited, bypassCompositor, unredirected);
+
+  @override
+  String toString() => 'FullscreenStatus(fullscreen: $fullscreen, '
+      'composited: $composited, bypassCompositor: $bypassCompositor, '
+      'unredirected: $unredirected)';
 }
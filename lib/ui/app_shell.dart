@@ -10,10 +10,12 @@ import 'package:flutter/material.dart';
 import 'package:flutter/services.dart';
 import 'package:keyboard_playground/core/exit_handler.dart';
 import 'package:keyboard_playground/core/game_manager.dart';
+import 'package:keyboard_playground/core/log.dart';
 import 'package:keyboard_playground/games/base_game.dart';
 import 'package:keyboard_playground/platform/window_control.dart';
 import 'package:keyboard_playground/ui/game_selection_menu.dart';
 import 'package:keyboard_playground/widgets/exit_progress_indicator.dart';
+import 'package:keyboard_playground/widgets/view_input_exemption.dart';
 
 /// The main application shell that wraps all content.
 ///
@@ -75,7 +77,10 @@ class _AppShellState extends State<AppShell> {
   Future<void> _updateScreenSize() async {
     final screenSize = await WindowControl.getScreenSize();
     widget.exitHandler.updateScreenSize(screenSize.width, screenSize.height);
-    debugPrint('Screen size updated: ${screenSize.width}x${screenSize.height}');
+    Log.debug(
+      'AppShell',
+      () => 'Screen size updated: ${screenSize.width}x${screenSize.height}',
+    );
   }
 
   @override
@@ -91,7 +96,7 @@ class _AppShellState extends State<AppShell> {
       await WindowControl.enterFullscreen();
     } catch (e) {
       // Fullscreen not supported or failed
-      debugPrint('Failed to enter fullscreen: $e');
+      Log.warning('AppShell', () => 'Failed to enter fullscreen: $e');
     }
   }
 
@@ -151,13 +156,19 @@ class _AppShellState extends State<AppShell> {
           Positioned.fill(child: _buildGameContent()),
           ExitProgressIndicator(progress: _exitProgress),
           if (_showGameSelection)
-            GameSelectionMenu(
-              gameManager: widget.gameManager,
-              onGameSelected: (game) {
-                widget.gameManager.switchGame(game.id);
-                _toggleGameSelection();
-              },
-              onClose: _toggleGameSelection,
+            // The menu navigates with a focused KeyboardListener and
+            // highlights on hover, so it needs the window's own input.
+            ViewInputExemption(
+              keys: true,
+              pointer: true,
+              child: GameSelectionMenu(
+                gameManager: widget.gameManager,
+                onGameSelected: (game) {
+                  widget.gameManager.switchGame(game.id);
+                  _toggleGameSelection();
+                },
+                onClose: _toggleGameSelection,
+              ),
             ),
         ],
       ),
@@ -16,6 +16,7 @@ import 'package:keyboard_playground/games/base_game.dart';
 /// - Large touch targets
 /// - Keyboard navigation support
 /// - Close on background tap or Escape key
+/// - Prewarms the focused game so selecting it is instant
 ///
 /// Example usage:
 /// ```dart
@@ -63,9 +64,23 @@ class _GameSelectionMenuState extends State<GameSelectionMenu> {
     // Request focus when menu appears
     WidgetsBinding.instance.addPostFrameCallback((_) {
       _focusNode.requestFocus();
+      _prewarmSelected();
     });
   }
 
+  /// Moves the selection to [index] and prewarms the game there.
+  void _select(int index) {
+    setState(() => _selectedIndex = index);
+    _prewarmSelected();
+  }
+
+  void _prewarmSelected() {
+    final games = widget.gameManager.availableGames;
+    if (mounted && _selectedIndex < games.length) {
+      widget.gameManager.prewarmGame(games[_selectedIndex].id);
+    }
+  }
+
   @override
   void dispose() {
     _focusNode.dispose();
@@ -80,28 +95,18 @@ class _GameSelectionMenuState extends State<GameSelectionMenu> {
 
     switch (event.logicalKey) {
       case LogicalKeyboardKey.arrowLeft:
-        setState(() {
-          _selectedIndex = (_selectedIndex - 1) % games.length;
-          if (_selectedIndex < 0) _selectedIndex = games.length - 1;
-        });
+        _select((_selectedIndex - 1) % games.length);
 
       case LogicalKeyboardKey.arrowRight:
-        setState(() {
-          _selectedIndex = (_selectedIndex + 1) % games.length;
-        });
+        _select((_selectedIndex + 1) % games.length);
 
       case LogicalKeyboardKey.arrowUp:
         // Move up one row (assume 3 columns)
-        setState(() {
-          _selectedIndex = (_selectedIndex - 3) % games.length;
-          if (_selectedIndex < 0) _selectedIndex += games.length;
-        });
+        _select((_selectedIndex - 3) % games.length);
 
       case LogicalKeyboardKey.arrowDown:
         // Move down one row (assume 3 columns)
-        setState(() {
-          _selectedIndex = (_selectedIndex + 3) % games.length;
-        });
+        _select((_selectedIndex + 3) % games.length);
 
       case LogicalKeyboardKey.enter:
       case LogicalKeyboardKey.space:
@@ -170,9 +175,7 @@ class _GameSelectionMenuState extends State<GameSelectionMenu> {
                                 isSelected: index == _selectedIndex,
                                 onTap: () => widget.onGameSelected(game),
                                 onHover: (hovering) {
-                                  if (hovering) {
-                                    setState(() => _selectedIndex = index);
-                                  }
+                                  if (hovering) _select(index);
                                 },
                               );
                             }).toList(),
@@ -1,9 +1,68 @@
 /// Animated gradient background widget.
 ///
 /// Provides visually appealing animated backgrounds for games and UI screens.
+///
+/// Animated backgrounds hold still while [QualityController] reports
+/// [QualityLevel.low]. [AnimatedBackground] can also cross-fade between
+/// pre-rendered frames instead of repainting every frame, see
+/// [BackgroundRenderMode].
 library;
 
+import 'dart:async';
+import 'dart:math';
+import 'dart:ui' as ui;
+
+import 'package:flutter/foundation.dart';
 import 'package:flutter/material.dart';
+import 'package:keyboard_playground/core/quality_controller.dart';
+
+/// Pauses a looping background animation while quality is low.
+mixin _PausesAtLowQuality<T extends StatefulWidget> on State<T> {
+  /// Whether the loop is running.
+  bool get loopRunning;
+
+  /// Starts (or resumes) the loop.
+  void startLoop();
+
+  /// Holds the loop still.
+  void stopLoop();
+
+  @override
+  void initState() {
+    super.initState();
+    QualityController.instance.level.addListener(_onQualityChanged);
+  }
+
+  @override
+  void dispose() {
+    QualityController.instance.level.removeListener(_onQualityChanged);
+    super.dispose();
+  }
+
+  /// Starts the loop unless quality is low. Call once the loop can start.
+  void startLoopForQuality() => _onQualityChanged();
+
+  void _onQualityChanged() {
+    if (QualityController.instance.level.value == QualityLevel.low) {
+      stopLoop();
+    } else if (!loopRunning) {
+      startLoop();
+    }
+  }
+}
+
+/// How [AnimatedBackground] renders its gradient.
+enum BackgroundRenderMode {
+  /// Repaints the gradient on every frame. Smoothest, but a full-screen
+  /// repaint per frame for as long as the background is visible.
+  live,
+
+  /// Pre-renders the cycle once into a few small images, on a background
+  /// isolate, and cross-fades between them, scaled up, a few times a
+  /// second. For CPU-rendered kiosks, where the live mode's full-screen
+  /// repaints compete with the games for every frame.
+  cachedFrames,
+}
 
 /// An animated gradient background that smoothly transitions between colors.
 ///
@@ -13,6 +72,7 @@ import 'package:flutter/material.dart';
 /// - Configurable animation duration
 /// - Automatic looping
 /// - Optional direction changes
+/// - Optional cached frames ([BackgroundRenderMode.cachedFrames])
 ///
 /// Example usage:
 /// ```dart
@@ -27,6 +87,10 @@ class AnimatedBackground extends StatefulWidget {
   const AnimatedBackground({
     required this.colors,
     this.duration = const Duration(seconds: 5),
+    this.mode = BackgroundRenderMode.live,
+    this.frameCount = 8,
+    this.frameResolution = 128,
+    this.crossFadeRate = 8,
     this.child,
     super.key,
   });
@@ -40,6 +104,22 @@ class AnimatedBackground extends StatefulWidget {
   /// Duration for one complete animation cycle.
   final Duration duration;
 
+  /// How the gradient is rendered.
+  final BackgroundRenderMode mode;
+
+  /// Number of images one cycle is pre-rendered into, in
+  /// [BackgroundRenderMode.cachedFrames].
+  final int frameCount;
+
+  /// Longer edge of the pre-rendered images in pixels, in
+  /// [BackgroundRenderMode.cachedFrames]. Gradients scale up without
+  /// visible loss, so a small size is enough.
+  final int frameResolution;
+
+  /// Cross-fade steps per second in [BackgroundRenderMode.cachedFrames];
+  /// the background repaints only this often.
+  final double crossFadeRate;
+
   /// Optional child widget to display on top of the background.
   final Widget? child;
 
@@ -48,16 +128,55 @@ class AnimatedBackground extends StatefulWidget {
 }
 
 class _AnimatedBackgroundState extends State<AnimatedBackground>
-    with SingleTickerProviderStateMixin {
+    with SingleTickerProviderStateMixin, _PausesAtLowQuality {
   late AnimationController _controller;
 
+  // Cached frames mode: the pre-rendered cycle, the position in it (in
+  // frames) and the timer stepping it.
+  List<ui.Image>? _frames;
+  _FrameSpec? _frameSpec;
+  int _frameGeneration = 0;
+  final ValueNotifier<double> _phase = ValueNotifier(0);
+  Timer? _fadeTimer;
+  bool _fading = false;
+
+  bool get _cached => widget.mode == BackgroundRenderMode.cachedFrames;
+
+  @override
+  bool get loopRunning => _cached ? _fading : _controller.isAnimating;
+
+  @override
+  void startLoop() {
+    if (_cached) {
+      _fading = true;
+      _startFadeTimer();
+    } else {
+      unawaited(_controller.repeat());
+    }
+  }
+
+  @override
+  void stopLoop() {
+    _fading = false;
+    _fadeTimer?.cancel();
+    _fadeTimer = null;
+    _controller.stop();
+  }
+
   @override
   void initState() {
     super.initState();
     _controller = AnimationController(
       vsync: this,
       duration: widget.duration,
-    )..repeat();
+    );
+    startLoopForQuality();
+  }
+
+  @override
+  void didChangeDependencies() {
+    super.didChangeDependencies();
+    if (_cached) _updateFrames();
   }
 
   @override
@@ -66,44 +185,131 @@ class _AnimatedBackgroundState extends State<AnimatedBackground>
     if (oldWidget.duration != widget.duration) {
       _controller.duration = widget.duration;
     }
+    if (oldWidget.mode != widget.mode) {
+      stopLoop();
+      if (!_cached) _releaseFrames();
+      startLoopForQuality();
+    } else if (oldWidget.crossFadeRate != widget.crossFadeRate && _fading) {
+      _fadeTimer?.cancel();
+      _fadeTimer = null;
+      _startFadeTimer();
+    }
+    if (_cached) _updateFrames();
   }
 
   @override
   void dispose() {
+    stopLoop();
+    _releaseFrames();
+    _phase.dispose();
     _controller.dispose();
     super.dispose();
   }
 
+  /// Renders the frames for the current colors and screen shape, unless
+  /// they are up to date.
+  void _updateFrames() {
+    final screen = MediaQuery.maybeSizeOf(context) ?? const Size(16, 9);
+    final spec = _FrameSpec.fit(
+      colors: [for (final color in widget.colors) color.toARGB32()],
+      // Two colors do not move (see _gradientStops), so one frame will do.
+      count: widget.colors.length <= 2 ? 1 : max(1, widget.frameCount),
+      resolution: max(1, widget.frameResolution),
+      aspectRatio:
+          screen.height > 0 ? screen.width / screen.height : 16 / 9,
+    );
+    if (spec == _frameSpec) return;
+    _frameSpec = spec;
+    unawaited(_renderFrames(spec, ++_frameGeneration));
+  }
+
+  Future<void> _renderFrames(_FrameSpec spec, int generation) async {
+    final pixels = await compute(renderBackgroundFrames, spec.toList());
+    final frameBytes = spec.width * spec.height * 4;
+    final frames = <ui.Image>[];
+    for (var i = 0; i < spec.count; i++) {
+      frames.add(
+        await _decodeFrame(
+          Uint8List.sublistView(pixels, i * frameBytes, (i + 1) * frameBytes),
+          spec.width,
+          spec.height,
+        ),
+      );
+    }
+    if (!mounted || generation != _frameGeneration || !_cached) {
+      for (final frame in frames) {
+        frame.dispose();
+      }
+      return;
+    }
+    setState(() {
+      _releaseFrames();
+      _frames = frames;
+      _phase.value = _phase.value % frames.length;
+    });
+    _startFadeTimer();
+  }
+
+  void _releaseFrames() {
+    for (final frame in _frames ?? const <ui.Image>[]) {
+      frame.dispose();
+    }
+    _frames = null;
+    if (!_cached) _frameSpec = null;
+  }
+
+  /// Steps the cross-fade while fading and there is more than one frame.
+  void _startFadeTimer() {
+    final frames = _frames;
+    if (!_fading || _fadeTimer != null || frames == null || frames.length < 2) {
+      return;
+    }
+    final interval = Duration(
+      microseconds: (Duration.microsecondsPerSecond / widget.crossFadeRate)
+          .round()
+          .clamp(1, Duration.microsecondsPerMinute),
+    );
+    _fadeTimer = Timer.periodic(interval, (_) {
+      final length = _frames?.length ?? 1;
+      final step = interval.inMicroseconds /
+          max(1, widget.duration.inMicroseconds) *
+          length;
+      _phase.value = (_phase.value + step) % length;
+    });
+  }
+
   @override
   Widget build(BuildContext context) {
+    if (_cached) {
+      return Stack(
+        fit: StackFit.passthrough,
+        children: [
+          Positioned.fill(
+            child: RepaintBoundary(
+              child: CustomPaint(
+                painter: _CrossFadePainter(
+                  frames: _frames,
+                  phase: _phase,
+                  colors: widget.colors,
+                ),
+              ),
+            ),
+          ),
+          if (widget.child != null) widget.child!,
+        ],
+      );
+    }
+
     return AnimatedBuilder(
       animation: _controller,
       builder: (context, child) {
-        // Calculate gradient stops based on animation value
-        final value = _controller.value;
-        final stops = <double>[];
-
-        // Create stops for smooth gradient transition
-        if (widget.colors.length == 2) {
-          stops.addAll([0.0, 1.0]);
-        } else {
-          // For multiple colors, distribute stops evenly
-          for (var i = 0; i < widget.colors.length; i++) {
-            final baseStop = i / (widget.colors.length - 1);
-            // Offset the stop position based on animation value
-            final animatedStop = (baseStop + value) % 1.0;
-            stops.add(animatedStop);
-          }
-          stops.sort();
-        }
-
         return Container(
           decoration: BoxDecoration(
             gradient: LinearGradient(
               begin: Alignment.topLeft,
               end: Alignment.bottomRight,
               colors: widget.colors,
-              stops: stops,
+              stops: _gradientStops(widget.colors.length, _controller.value),
             ),
           ),
           child: child,
@@ -114,6 +320,200 @@ class _AnimatedBackgroundState extends State<AnimatedBackground>
   }
 }
 
+/// Gradient stops of [AnimatedBackground] for [colorCount] colors at
+/// [value] (0 to 1) of the cycle.
+List<double> _gradientStops(int colorCount, double value) {
+  // Create stops for smooth gradient transition
+  if (colorCount == 2) return const [0, 1];
+
+  // For multiple colors, distribute stops evenly, offset by the animation
+  // value
+  final stops = <double>[
+    for (var i = 0; i < colorCount; i++)
+      (i / (colorCount - 1) + value) % 1.0,
+  ]..sort();
+  return stops;
+}
+
+/// Size and content of the pre-rendered frames of an [AnimatedBackground].
+@immutable
+class _FrameSpec {
+  const _FrameSpec({
+    required this.colors,
+    required this.count,
+    required this.width,
+    required this.height,
+  });
+
+  /// Frames with the longer edge [resolution] at [aspectRatio].
+  factory _FrameSpec.fit({
+    required List<int> colors,
+    required int count,
+    required int resolution,
+    required double aspectRatio,
+  }) {
+    final landscape = aspectRatio >= 1;
+    final shorter = max(
+      1,
+      (resolution / (landscape ? aspectRatio : 1 / aspectRatio)).round(),
+    );
+    return _FrameSpec(
+      colors: colors,
+      count: count,
+      width: landscape ? resolution : shorter,
+      height: landscape ? shorter : resolution,
+    );
+  }
+
+  final List<int> colors;
+  final int count;
+  final int width;
+  final int height;
+
+  /// Arguments of [renderBackgroundFrames].
+  List<int> toList() => [count, width, height, ...colors];
+
+  @override
+  bool operator ==(Object other) =>
+      other is _FrameSpec &&
+      other.count == count &&
+      other.width == width &&
+      other.height == height &&
+      listEquals(other.colors, colors);
+
+  @override
+  int get hashCode => Object.hash(count, width, height, Object.hashAll(colors));
+}
+
+/// Renders one cycle of the [AnimatedBackground] gradient into frames.
+///
+/// [spec] is `[count, width, height, ...colors]`, colors as ARGB. Frame `i`
+/// shows the gradient at `i / count` of the cycle. Returns the frames one
+/// after another as non-premultiplied RGBA rows. Pure, so it can run on a
+/// background isolate.
+@visibleForTesting
+Uint8List renderBackgroundFrames(List<int> spec) {
+  final count = spec[0];
+  final width = spec[1];
+  final height = spec[2];
+  final colors = spec.sublist(3);
+  final pixels = Uint8List(count * width * height * 4);
+  // Top left to bottom right, as the live gradient.
+  final lengthSquared = (width * width + height * height).toDouble();
+
+  var offset = 0;
+  for (var frame = 0; frame < count; frame++) {
+    final stops = _gradientStops(colors.length, frame / count);
+    for (var y = 0; y < height; y++) {
+      for (var x = 0; x < width; x++) {
+        final t = ((x + 0.5) * width + (y + 0.5) * height) / lengthSquared;
+        final color = _gradientColor(colors, stops, t);
+        pixels[offset++] = (color >> 16) & 0xFF;
+        pixels[offset++] = (color >> 8) & 0xFF;
+        pixels[offset++] = color & 0xFF;
+        pixels[offset++] = (color >> 24) & 0xFF;
+      }
+    }
+  }
+  return pixels;
+}
+
+/// Color of a clamped linear gradient of [colors] (ARGB) at [stops] at
+/// position [t].
+int _gradientColor(List<int> colors, List<double> stops, double t) {
+  if (t <= stops.first) return colors.first;
+  if (t >= stops.last) return colors[stops.length - 1];
+  var i = 0;
+  while (t > stops[i + 1]) {
+    i++;
+  }
+  final span = stops[i + 1] - stops[i];
+  final f = span > 0 ? (t - stops[i]) / span : 0.0;
+  final a = colors[i];
+  final b = colors[i + 1];
+  var result = 0;
+  for (var shift = 0; shift < 32; shift += 8) {
+    final from = (a >> shift) & 0xFF;
+    final to = (b >> shift) & 0xFF;
+    result |= (from + (to - from) * f).round() << shift;
+  }
+  return result;
+}
+
+Future<ui.Image> _decodeFrame(Uint8List pixels, int width, int height) {
+  final completer = Completer<ui.Image>();
+  ui.decodeImageFromPixels(
+    pixels,
+    width,
+    height,
+    ui.PixelFormat.rgba8888,
+    completer.complete,
+  );
+  return completer.future;
+}
+
+/// Paints pre-rendered background frames scaled to the canvas,
+/// cross-fading from frame `phase.floor()` to the next.
+class _CrossFadePainter extends CustomPainter {
+  _CrossFadePainter({
+    required this.frames,
+    required this.phase,
+    required this.colors,
+  }) : super(repaint: phase);
+
+  /// The frames, or `null` while they are rendered.
+  final List<ui.Image>? frames;
+
+  /// Position in the cycle, in frames.
+  final ValueListenable<double> phase;
+
+  /// Colors of the gradient shown until [frames] are ready.
+  final List<Color> colors;
+
+  @override
+  void paint(Canvas canvas, Size size) {
+    final rect = Offset.zero & size;
+    final frames = this.frames;
+    if (frames == null || frames.isEmpty) {
+      canvas.drawRect(
+        rect,
+        Paint()
+          ..shader = LinearGradient(
+            begin: Alignment.topLeft,
+            end: Alignment.bottomRight,
+            colors: colors,
+            stops: _gradientStops(colors.length, 0),
+          ).createShader(rect),
+      );
+      return;
+    }
+
+    final index = phase.value.floor() % frames.length;
+    final fade = phase.value - phase.value.floor();
+    _drawFrame(canvas, frames[index], rect, 1);
+    if (fade > 0 && frames.length > 1) {
+      _drawFrame(canvas, frames[(index + 1) % frames.length], rect, fade);
+    }
+  }
+
+  void _drawFrame(Canvas canvas, ui.Image frame, Rect rect, double opacity) {
+    canvas.drawImageRect(
+      frame,
+      Rect.fromLTWH(0, 0, frame.width.toDouble(), frame.height.toDouble()),
+      rect,
+      Paint()
+        ..filterQuality = FilterQuality.low
+        ..color = Color.fromRGBO(0, 0, 0, opacity),
+    );
+  }
+
+  @override
+  bool shouldRepaint(_CrossFadePainter oldDelegate) =>
+      oldDelegate.frames != frames ||
+      oldDelegate.phase != phase ||
+      !listEquals(oldDelegate.colors, colors);
+}
+
 /// A pulsing gradient background that expands and contracts.
 ///
 /// Features:
@@ -151,17 +551,27 @@ class PulsingBackground extends StatefulWidget {
 }
 
 class _PulsingBackgroundState extends State<PulsingBackground>
-    with SingleTickerProviderStateMixin {
+    with SingleTickerProviderStateMixin, _PausesAtLowQuality {
   late AnimationController _controller;
   late Animation<double> _animation;
 
+  @override
+  bool get loopRunning => _controller.isAnimating;
+
+  @override
+  void startLoop() => unawaited(_controller.repeat(reverse: true));
+
+  @override
+  void stopLoop() => _controller.stop();
+
   @override
   void initState() {
     super.initState();
     _controller = AnimationController(
       vsync: this,
       duration: widget.duration,
-    )..repeat(reverse: true);
+    );
+    startLoopForQuality();
 
     _animation = CurvedAnimation(
       parent: _controller,
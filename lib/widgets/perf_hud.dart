@@ -0,0 +1,267 @@
+/// Toggleable overlay with live input pipeline and frame statistics.
+///
+/// Lets a technician see on the spot why a kiosk feels sluggish: input
+/// rates, queueing, drops, per-stage latency, capture CPU, frame times,
+/// memory and the current quality level.
+library;
+
+import 'dart:async';
+import 'dart:math';
+import 'dart:ui' show FrameTiming;
+
+import 'package:flutter/foundation.dart';
+import 'package:flutter/material.dart';
+import 'package:flutter/scheduler.dart';
+import 'package:keyboard_playground/core/quality_controller.dart';
+import 'package:keyboard_playground/platform/compact_input_event.dart';
+import 'package:keyboard_playground/platform/input_events.dart';
+import 'package:keyboard_playground/platform/input_state.dart';
+import 'package:keyboard_playground/platform/pipeline_stats.dart';
+
+/// Shows a statistics overlay over [child] while toggled on by [toggles].
+///
+/// While shown, the overlay reads the native pipeline statistics and the
+/// latest input state once per frame through [PipelineStatsReader] and
+/// [InputStateReader] (one FFI copy each, nothing sent over a channel) and
+/// rebuilds only itself, so it barely perturbs what it measures. While
+/// hidden it reads nothing and schedules no frames.
+///
+/// Example usage:
+/// ```dart
+/// PerfHud(
+///   toggles: inputCapture.hudToggles,
+///   child: AppShell(...),
+/// )
+/// ```
+class PerfHud extends StatefulWidget {
+  /// Creates a HUD over [child].
+  const PerfHud({
+    required this.child,
+    this.toggles,
+    this.openReader = PipelineStatsReader.open,
+    this.openInputState = InputStateReader.open,
+    this.quality,
+    this.initiallyVisible = false,
+    super.key,
+  });
+
+  /// The content under the HUD.
+  final Widget child;
+
+  /// Each event shows or hides the HUD, e.g. `InputCapture.hudToggles`.
+  final Stream<void>? toggles;
+
+  /// Connects to the native statistics when the HUD is first shown.
+  final PipelineStatsReader? Function() openReader;
+
+  /// Connects to the native input state when the HUD is first shown.
+  final InputStateReader? Function() openInputState;
+
+  /// Quality level to show; [QualityController.instance] by default.
+  final ValueListenable<QualityLevel>? quality;
+
+  /// Whether the HUD starts shown.
+  final bool initiallyVisible;
+
+  @override
+  State<PerfHud> createState() => _PerfHudState();
+}
+
+class _PerfHudState extends State<PerfHud> with SingleTickerProviderStateMixin {
+  /// Frame timings kept for the frame time percentiles.
+  static const int _maxTimings = 120;
+
+  late final Ticker _ticker = createTicker(_onTick);
+  final List<FrameTiming> _timings = [];
+  StreamSubscription<void>? _toggleSubscription;
+  PipelineStatsReader? _reader;
+  InputStateReader? _inputState;
+  bool _readerOpened = false;
+  bool _visible = false;
+
+  @override
+  void initState() {
+    super.initState();
+    _toggleSubscription = widget.toggles?.listen(_toggle);
+    if (widget.initiallyVisible) _setVisible(true);
+  }
+
+  @override
+  void didUpdateWidget(PerfHud oldWidget) {
+    super.didUpdateWidget(oldWidget);
+    if (widget.toggles != oldWidget.toggles) {
+      unawaited(_toggleSubscription?.cancel());
+      _toggleSubscription = widget.toggles?.listen(_toggle);
+    }
+  }
+
+  @override
+  void dispose() {
+    unawaited(_toggleSubscription?.cancel());
+    _setVisible(false);
+    _ticker.dispose();
+    _reader?.dispose();
+    _inputState?.dispose();
+    super.dispose();
+  }
+
+  void _toggle(void _) {
+    setState(() => _setVisible(!_visible));
+  }
+
+  void _setVisible(bool visible) {
+    if (visible == _visible) return;
+    _visible = visible;
+    if (visible) {
+      if (!_readerOpened) {
+        _readerOpened = true;
+        _reader = widget.openReader();
+        _inputState = widget.openInputState();
+      }
+      SchedulerBinding.instance.addTimingsCallback(_onTimings);
+      unawaited(_ticker.start());
+    } else {
+      _ticker.stop();
+      SchedulerBinding.instance.removeTimingsCallback(_onTimings);
+      _timings.clear();
+    }
+  }
+
+  void _onTimings(List<FrameTiming> timings) {
+    _timings.addAll(timings);
+    if (_timings.length > _maxTimings) {
+      _timings.removeRange(0, _timings.length - _maxTimings);
+    }
+  }
+
+  void _onTick(Duration elapsed) {
+    _reader?.poll();
+    _inputState?.poll();
+    setState(() {});
+  }
+
+  @override
+  Widget build(BuildContext context) {
+    return Stack(
+      textDirection: TextDirection.ltr,
+      children: [
+        Positioned.fill(child: widget.child),
+        if (_visible)
+          Positioned(
+            top: 16,
+            left: 16,
+            child: IgnorePointer(
+              child: RepaintBoundary(
+                child: Container(
+                  padding: const EdgeInsets.all(8),
+                  color: Colors.black.withValues(alpha: 0.75),
+                  child: Text(
+                    _lines().join('\n'),
+                    textDirection: TextDirection.ltr,
+                    style: const TextStyle(
+                      color: Colors.greenAccent,
+                      fontFamily: 'monospace',
+                      fontSize: 11,
+                      height: 1.3,
+                      decoration: TextDecoration.none,
+                    ),
+                  ),
+                ),
+              ),
+            ),
+          ),
+      ],
+    );
+  }
+
+  List<String> _lines() {
+    final quality = widget.quality ?? QualityController.instance.level;
+    final reader = _reader;
+    final inputState = _inputState;
+    return [
+      if (reader == null)
+        'native stats unavailable'
+      else
+        ...describePipelineStats(reader.stats),
+      if (inputState != null) describeInputState(inputState),
+      ...describeFrameTimings(_timings),
+      'quality ${quality.value.name}',
+    ];
+  }
+}
+
+/// Formats [stats] as HUD lines.
+@visibleForTesting
+List<String> describePipelineStats(NativePipelineStats stats) {
+  String rate(InputEventType type) => '${stats.eventRate(type)}';
+  String latency(PipelineStage stage) => [
+        for (final percentile in LatencyPercentile.values)
+          stats.latencyUs(stage, percentile),
+      ].join('/');
+
+  return [
+    'events/s  key ${rate(InputEventType.keyDown)}/'
+        '${rate(InputEventType.keyUp)}  '
+        'move ${rate(InputEventType.mouseMove)}  '
+        'button ${rate(InputEventType.mouseDown)}/'
+        '${rate(InputEventType.mouseUp)}  '
+        'scroll ${rate(InputEventType.mouseScroll)}',
+    'queue ${stats.queueDepth}  merger ${stats.mergeBuffered}  '
+        'coalesced ${stats.coalesced}  dropped ${stats.dropped}  '
+        'late ${stats.mergeLate}',
+    'latency us p50/p95/p99/max',
+    for (final stage in PipelineStage.values)
+      '  ${stage.name.padRight(16)}${latency(stage)}',
+    'capture cpu ${(stats.captureCpuPermille / 10).toStringAsFixed(1)}%  '
+        '${stats.captureCpuUs ~/ 1000} ms total',
+    'rss ${(stats.rssBytes / (1 << 20)).toStringAsFixed(1)} MiB',
+  ];
+}
+
+/// Formats the input state polled by [reader] as a HUD line: what the
+/// native side believes is held, which shows stuck keys at a glance.
+@visibleForTesting
+String describeInputState(InputStateReader reader) {
+  final state = reader.state;
+  final buttons = [
+    for (final button in [
+      MouseButton.left,
+      MouseButton.middle,
+      MouseButton.right,
+    ])
+      if (reader.isButtonDown(button)) button.name,
+  ];
+  final modifiers = [
+    for (final modifier in KeyModifier.values)
+      if (state.modifiers & modifier.mask != 0) modifier.name,
+  ];
+  return 'input #${state.sequence}  '
+      'pointer ${state.pointerX},${state.pointerY}  '
+      'keys ${reader.heldKeyCount}  '
+      'buttons ${buttons.isEmpty ? '-' : buttons.join('+')}  '
+      'mods ${modifiers.isEmpty ? '-' : modifiers.join('+')}';
+}
+
+/// Formats the build and raster time percentiles of [timings] as HUD
+/// lines.
+@visibleForTesting
+List<String> describeFrameTimings(List<FrameTiming> timings) {
+  if (timings.isEmpty) return const ['frames    no timings yet'];
+
+  String percentiles(Duration Function(FrameTiming) phase) {
+    final us = [for (final timing in timings) phase(timing).inMicroseconds]
+      ..sort();
+    String at(double p) {
+      final value = us[min(us.length - 1, (p * us.length).floor())];
+      return (value / 1000).toStringAsFixed(1);
+    }
+
+    return '${at(0.5)}/${at(0.9)}/${(us.last / 1000).toStringAsFixed(1)}';
+  }
+
+  return [
+    'frame ms p50/p90/max (${timings.length} frames)',
+    '  build   ${percentiles((timing) => timing.buildDuration)}',
+    '  raster  ${percentiles((timing) => timing.rasterDuration)}',
+  ];
+}
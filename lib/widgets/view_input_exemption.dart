@@ -0,0 +1,119 @@
+/// Exempts a subtree's UI from in-window input filtering during capture.
+///
+/// See [WindowControl.setViewInputExemptions].
+library;
+
+import 'dart:async';
+
+import 'package:flutter/foundation.dart';
+import 'package:flutter/widgets.dart';
+import 'package:keyboard_playground/platform/window_control.dart';
+
+/// Lets Flutter receive real key and/or pointer motion events while [child]
+/// is shown, even though input capture is active.
+///
+/// On Linux the runner keeps keys and pointer motion over the window from
+/// the engine while capture runs, so games handle each input once, through
+/// the capture channels. Widgets relying on Flutter's own input, like
+/// `KeyboardListener` focus or `MouseRegion` hover, need an exemption.
+///
+/// Exemptions from all mounted instances are combined: a kind stays exempt
+/// while any instance asks for it. Elsewhere this widget does nothing.
+///
+/// Example usage:
+/// ```dart
+/// ViewInputExemption(
+///   keys: true,
+///   pointer: true,
+///   child: GameSelectionMenu(...),
+/// )
+/// ```
+class ViewInputExemption extends StatefulWidget {
+  /// Creates an exemption for [child].
+  const ViewInputExemption({
+    required this.child,
+    this.keys = false,
+    this.pointer = false,
+    super.key,
+  });
+
+  /// Whether key events reach Flutter while [child] is shown.
+  final bool keys;
+
+  /// Whether pointer motion reaches Flutter while [child] is shown.
+  final bool pointer;
+
+  /// The exempted subtree.
+  final Widget child;
+
+  /// Number of mounted instances exempting keys.
+  static int _keyHolders = 0;
+
+  /// Number of mounted instances exempting pointer motion.
+  static int _pointerHolders = 0;
+
+  /// Exemptions last sent to the platform.
+  static (bool, bool) _applied = (false, false);
+
+  /// Whether key events are currently exempt.
+  @visibleForTesting
+  static bool get keysExempt => _keyHolders > 0;
+
+  /// Whether pointer motion is currently exempt.
+  @visibleForTesting
+  static bool get pointerExempt => _pointerHolders > 0;
+
+  static void _update({required int keys, required int pointer}) {
+    _keyHolders += keys;
+    _pointerHolders += pointer;
+
+    final wanted = (keysExempt, pointerExempt);
+    if (wanted == _applied) return;
+    _applied = wanted;
+    if (kIsWeb || defaultTargetPlatform != TargetPlatform.linux) return;
+    unawaited(
+      WindowControl.setViewInputExemptions(
+        keys: keysExempt,
+        pointer: pointerExempt,
+      ),
+    );
+  }
+
+  @override
+  State<ViewInputExemption> createState() => _ViewInputExemptionState();
+}
+
+class _ViewInputExemptionState extends State<ViewInputExemption> {
+  @override
+  void initState() {
+    super.initState();
+    ViewInputExemption._update(
+      keys: widget.keys ? 1 : 0,
+      pointer: widget.pointer ? 1 : 0,
+    );
+  }
+
+  @override
+  void didUpdateWidget(ViewInputExemption oldWidget) {
+    super.didUpdateWidget(oldWidget);
+    if (oldWidget.keys != widget.keys ||
+        oldWidget.pointer != widget.pointer) {
+      ViewInputExemption._update(
+        keys: (widget.keys ? 1 : 0) - (oldWidget.keys ? 1 : 0),
+        pointer: (widget.pointer ? 1 : 0) - (oldWidget.pointer ? 1 : 0),
+      );
+    }
+  }
+
+  @override
+  void dispose() {
+    ViewInputExemption._update(
+      keys: widget.keys ? -1 : 0,
+      pointer: widget.pointer ? -1 : 0,
+    );
+    super.dispose();
+  }
+
+  @override
+  Widget build(BuildContext context) => widget.child;
+}
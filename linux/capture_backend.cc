@@ -0,0 +1,444 @@
+#include "capture_backend.h"
+
+#include <X11/extensions/XTest.h>
+#include <poll.h>
+#include <pthread.h>
+#include <time.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <utility>
+
+#include "log.h"
+
+namespace {
+
+constexpr const char* kBackendNames[kBackendCount] = {"record_sync",
+                                                      "record_async"};
+
+/// Measured probes per backend.
+constexpr int kProbes = 32;
+
+/// How long a probe may take before it counts as lost.
+constexpr gint64 kProbeTimeoutUs = 50 * 1000;
+
+/// How long to wait for a freshly enabled context to deliver anything.
+constexpr gint64 kWarmupUs = 500 * 1000;
+
+/// Bump when the measurement changes, to invalidate cached decisions.
+constexpr int kCacheVersion = 1;
+
+constexpr char kCacheGroup[] = "capture_backend";
+
+/// One backend under measurement.
+struct Probe {
+  CaptureBackend backend;
+  Display* data = nullptr;
+  XRecordContext context = 0;
+
+  std::mutex mutex;
+  std::condition_variable cv;
+  bool waiting = false;
+  int target_x = 0;
+  int target_y = 0;
+  gint64 arrived_us = 0;
+};
+
+/// Intercept callback of the probe context: notes when the awaited pointer
+/// position arrives.
+void probe_callback(XPointer closure, XRecordInterceptData* data) {
+  Probe* probe = reinterpret_cast<Probe*>(closure);
+  if (data->category == XRecordFromServer && data->data_len >= 8 &&
+      (data->data[0] & 0x7F) == MotionNotify) {
+    const gint64 now = g_get_monotonic_time();
+    int16_t x;
+    int16_t y;
+    memcpy(&x, data->data + 20, sizeof(x));
+    memcpy(&y, data->data + 22, sizeof(y));
+
+    std::lock_guard<std::mutex> lock(probe->mutex);
+    if (probe->waiting && x == probe->target_x && y == probe->target_y) {
+      probe->waiting = false;
+      probe->arrived_us = now;
+      probe->cv.notify_one();
+    }
+  }
+  XRecordFreeData(data);
+}
+
+void* probe_thread(void* arg) {
+  Probe* probe = static_cast<Probe*>(arg);
+  pthread_setname_np(pthread_self(), "kp-bench");
+  capture_backend_run(probe->backend, probe->data, probe->context,
+                      probe_callback, reinterpret_cast<XPointer>(probe));
+  return nullptr;
+}
+
+/// Moves the pointer to (x, y) through XTest and waits for [probe] to see
+/// it. Returns the delivery latency, or -1 if it did not arrive in time.
+int64_t inject(Display* control, Probe* probe, int x, int y,
+               gint64 timeout_us) {
+  {
+    std::lock_guard<std::mutex> lock(probe->mutex);
+    probe->waiting = true;
+    probe->target_x = x;
+    probe->target_y = y;
+  }
+
+  const gint64 start_us = g_get_monotonic_time();
+  XTestFakeMotionEvent(control, -1, x, y, CurrentTime);
+  XFlush(control);
+
+  std::unique_lock<std::mutex> lock(probe->mutex);
+  if (!probe->cv.wait_for(lock, std::chrono::microseconds(timeout_us),
+                          [probe] { return !probe->waiting; })) {
+    probe->waiting = false;
+    return -1;
+  }
+  return probe->arrived_us - start_us;
+}
+
+int64_t thread_cpu_us(clockid_t clock) {
+  timespec ts;
+  if (clock_gettime(clock, &ts) != 0) return 0;
+  return static_cast<int64_t>(ts.tv_sec) * 1000000 + ts.tv_nsec / 1000;
+}
+
+/// Measures [backend] with probes moving the pointer between (x0, y0) and
+/// (x0 + dx, y0).
+BackendMeasurement measure(CaptureBackend backend, Display* control, int x0,
+                           int y0, int dx) {
+  BackendMeasurement result = {backend, false, 0, 0, 0, 0, 0};
+
+  Probe probe;
+  probe.backend = backend;
+  probe.data = XOpenDisplay(nullptr);
+  if (probe.data == nullptr) return result;
+
+  XRecordClientSpec clients = XRecordAllClients;
+  XRecordRange* range = XRecordAllocRange();
+  if (range == nullptr) {
+    XCloseDisplay(probe.data);
+    return result;
+  }
+  range->device_events.first = MotionNotify;
+  range->device_events.last = MotionNotify;
+  probe.context =
+      XRecordCreateContext(probe.data, 0, &clients, 1, &range, 1);
+  XFree(range);
+  if (probe.context == 0) {
+    XCloseDisplay(probe.data);
+    return result;
+  }
+
+  pthread_t thread;
+  pthread_create(&thread, nullptr, probe_thread, &probe);
+
+  // The context is enabled asynchronously; probe until one comes through.
+  int x = x0;
+  bool ready = false;
+  for (gint64 deadline = g_get_monotonic_time() + kWarmupUs;
+       !ready && g_get_monotonic_time() < deadline;) {
+    x = x == x0 ? x0 + dx : x0;
+    ready = inject(control, &probe, x, y0, 20 * 1000) >= 0;
+  }
+
+  if (ready) {
+    clockid_t cpu_clock;
+    const bool has_cpu_clock = pthread_getcpuclockid(thread, &cpu_clock) == 0;
+    const int64_t cpu_start = has_cpu_clock ? thread_cpu_us(cpu_clock) : 0;
+
+    std::vector<int64_t> latencies;
+    for (int i = 0; i < kProbes; i++) {
+      x = x == x0 ? x0 + dx : x0;
+      result.probes++;
+      int64_t latency = inject(control, &probe, x, y0, kProbeTimeoutUs);
+      if (latency >= 0) latencies.push_back(latency);
+    }
+
+    const int64_t cpu_us =
+        has_cpu_clock ? thread_cpu_us(cpu_clock) - cpu_start : 0;
+    result.delivered = static_cast<int>(latencies.size());
+    if (!latencies.empty()) {
+      std::sort(latencies.begin(), latencies.end());
+      const size_t n = latencies.size();
+      result.median_latency_us = latencies[n / 2];
+      result.p95_latency_us = latencies[std::min(n - 1, n * 95 / 100)];
+      result.cpu_us_per_event = cpu_us / static_cast<int64_t>(n);
+    }
+    // Mostly lost probes mean the backend does not work here (or the user
+    // moved the mouse throughout); don't trust it.
+    result.available = result.delivered * 2 > result.probes;
+  }
+
+  // Leave the pointer where it was.
+  XTestFakeMotionEvent(control, -1, x0, y0, CurrentTime);
+
+  XRecordDisableContext(control, probe.context);
+  XFlush(control);
+  pthread_join(thread, nullptr);
+  XRecordFreeContext(probe.data, probe.context);
+  XCloseDisplay(probe.data);
+  return result;
+}
+
+/// Identifies the machine and X server a decision is valid for.
+std::string cache_key(Display* display) {
+  std::string machine;
+  gchar* contents = nullptr;
+  if (g_file_get_contents("/etc/machine-id", &contents, nullptr, nullptr) ||
+      g_file_get_contents("/var/lib/dbus/machine-id", &contents, nullptr,
+                          nullptr)) {
+    machine = g_strstrip(contents);
+    g_free(contents);
+  } else {
+    machine = g_get_host_name();
+  }
+  return machine + "/" + ServerVendor(display) + "/" +
+         std::to_string(VendorRelease(display));
+}
+
+gchar* cache_path() {
+  return g_build_filename(g_get_user_cache_dir(), "keyboard_playground",
+                          "capture_backend.ini", nullptr);
+}
+
+bool load_cache(const std::string& key, BackendSelection* selection) {
+  gchar* path = cache_path();
+  GKeyFile* file = g_key_file_new();
+  bool loaded = false;
+
+  if (g_key_file_load_from_file(file, path, G_KEY_FILE_NONE, nullptr) &&
+      g_key_file_get_integer(file, kCacheGroup, "version", nullptr) ==
+          kCacheVersion) {
+    gchar* cached_key = g_key_file_get_string(file, kCacheGroup, "key",
+                                              nullptr);
+    gchar* name = g_key_file_get_string(file, kCacheGroup, "backend", nullptr);
+    CaptureBackend backend;
+    if (g_strcmp0(cached_key, key.c_str()) == 0 &&
+        capture_backend_from_name(name, &backend)) {
+      selection->backend = backend;
+      selection->measured = true;
+      for (int i = 0; i < kBackendCount; i++) {
+        const char* group = kBackendNames[i];
+        if (!g_key_file_has_group(file, group)) continue;
+        BackendMeasurement m;
+        m.backend = static_cast<CaptureBackend>(i);
+        m.available =
+            g_key_file_get_boolean(file, group, "available", nullptr);
+        m.probes = g_key_file_get_integer(file, group, "probes", nullptr);
+        m.delivered =
+            g_key_file_get_integer(file, group, "delivered", nullptr);
+        m.median_latency_us =
+            g_key_file_get_int64(file, group, "median_latency_us", nullptr);
+        m.p95_latency_us =
+            g_key_file_get_int64(file, group, "p95_latency_us", nullptr);
+        m.cpu_us_per_event =
+            g_key_file_get_int64(file, group, "cpu_us_per_event", nullptr);
+        selection->measurements.push_back(m);
+      }
+      loaded = true;
+    }
+    g_free(name);
+    g_free(cached_key);
+  }
+
+  g_key_file_free(file);
+  g_free(path);
+  return loaded;
+}
+
+void save_cache(const std::string& key, const BackendSelection& selection) {
+  gchar* path = cache_path();
+  gchar* dir = g_path_get_dirname(path);
+  GKeyFile* file = g_key_file_new();
+
+  g_key_file_set_integer(file, kCacheGroup, "version", kCacheVersion);
+  g_key_file_set_string(file, kCacheGroup, "key", key.c_str());
+  g_key_file_set_string(file, kCacheGroup, "backend",
+                        capture_backend_name(selection.backend));
+  for (const BackendMeasurement& m : selection.measurements) {
+    const char* group = capture_backend_name(m.backend);
+    g_key_file_set_boolean(file, group, "available", m.available);
+    g_key_file_set_integer(file, group, "probes", m.probes);
+    g_key_file_set_integer(file, group, "delivered", m.delivered);
+    g_key_file_set_int64(file, group, "median_latency_us",
+                         m.median_latency_us);
+    g_key_file_set_int64(file, group, "p95_latency_us", m.p95_latency_us);
+    g_key_file_set_int64(file, group, "cpu_us_per_event", m.cpu_us_per_event);
+  }
+
+  GError* error = nullptr;
+  if (g_mkdir_with_parents(dir, 0755) != 0 ||
+      !g_key_file_save_to_file(file, path, &error)) {
+    LOG_WARNING("CaptureBackend", "Could not cache the selection in %s: %s",
+                path, error != nullptr ? error->message : "no directory");
+    g_clear_error(&error);
+  }
+
+  g_key_file_free(file);
+  g_free(dir);
+  g_free(path);
+}
+
+/// State of the async capture loop, wrapping the caller's callback.
+struct AsyncLoop {
+  XRecordInterceptProc callback;
+  XPointer closure;
+
+  /// Whether the end-of-data reply arrived.
+  bool ended;
+};
+
+/// Notes the end of data and passes every reply on.
+void async_callback(XPointer closure, XRecordInterceptData* data) {
+  AsyncLoop* loop = reinterpret_cast<AsyncLoop*>(closure);
+  if (data->category == XRecordEndOfData) {
+    loop->ended = true;
+  }
+  loop->callback(loop->closure, data);
+}
+
+}  // namespace
+
+const char* capture_backend_name(CaptureBackend backend) {
+  return backend < kBackendCount ? kBackendNames[backend] : "unknown";
+}
+
+bool capture_backend_from_name(const char* name, CaptureBackend* backend) {
+  for (int i = 0; i < kBackendCount; i++) {
+    if (g_strcmp0(name, kBackendNames[i]) == 0) {
+      *backend = static_cast<CaptureBackend>(i);
+      return true;
+    }
+  }
+  return false;
+}
+
+void capture_backend_run(CaptureBackend backend, Display* data_display,
+                         XRecordContext context, XRecordInterceptProc callback,
+                         XPointer closure) {
+  if (backend != kBackendRecordAsync) {
+    // Blocks until the context is disabled.
+    XRecordEnableContext(data_display, context, callback, closure);
+    return;
+  }
+
+  AsyncLoop loop = {callback, closure, false};
+  if (!XRecordEnableContextAsync(data_display, context, async_callback,
+                                 reinterpret_cast<XPointer>(&loop))) {
+    LOG_ERROR("CaptureBackend", "Failed to enable record context");
+    return;
+  }
+
+  // Sleeps until the server sends something, without a timeout, so an
+  // idle loop never wakes. Runs until the end-of-data reply that follows
+  // disabling the context, so events the server sent before it are still
+  // delivered.
+  pollfd fd = {ConnectionNumber(data_display), POLLIN, 0};
+  while (true) {
+    // Drain what Xlib already buffered before sleeping on the socket.
+    XRecordProcessReplies(data_display);
+    if (loop.ended) {
+      break;
+    }
+    const int ready = poll(&fd, 1, -1);
+    if (ready < 0 && errno != EINTR) {
+      LOG_ERROR("CaptureBackend", "Polling the record connection failed: %s",
+                strerror(errno));
+      break;
+    }
+    if (ready > 0 && (fd.revents & (POLLERR | POLLHUP)) != 0) {
+      LOG_ERROR("CaptureBackend", "Record connection closed");
+      break;
+    }
+  }
+}
+
+BackendSelection capture_backend_default() {
+  BackendSelection selection;
+  selection.backend = kBackendRecordSync;
+  selection.cached = false;
+  selection.measured = false;
+  selection.elapsed_us = 0;
+  return selection;
+}
+
+bool capture_backend_cached(Display* display, BackendSelection* selection) {
+  const gint64 start_us = g_get_monotonic_time();
+  BackendSelection cached = capture_backend_default();
+  if (display == nullptr || !load_cache(cache_key(display), &cached)) {
+    return false;
+  }
+  cached.cached = true;
+  cached.elapsed_us = g_get_monotonic_time() - start_us;
+  *selection = std::move(cached);
+  return true;
+}
+
+BackendSelection capture_backend_select(bool rerun) {
+  const gint64 start_us = g_get_monotonic_time();
+  BackendSelection selection = capture_backend_default();
+
+  Display* control = XOpenDisplay(nullptr);
+  if (control == nullptr) {
+    return selection;
+  }
+
+  const std::string key = cache_key(control);
+  if (!rerun && capture_backend_cached(control, &selection)) {
+    XCloseDisplay(control);
+    LOG_INFO("CaptureBackend", "Using cached %s",
+             capture_backend_name(selection.backend));
+    return selection;
+  }
+
+  int event_base, error_base, major, minor;
+  if (!XTestQueryExtension(control, &event_base, &error_base, &major,
+                           &minor)) {
+    LOG_WARNING("CaptureBackend", "XTest unavailable; not measuring");
+    XCloseDisplay(control);
+    return selection;
+  }
+
+  Window root, child;
+  int x0 = 0, y0 = 0, win_x, win_y;
+  unsigned int mask;
+  XQueryPointer(control, DefaultRootWindow(control), &root, &child, &x0, &y0,
+                &win_x, &win_y, &mask);
+  const int dx = x0 > 0 ? -1 : 1;
+
+  int64_t best_score = INT64_MAX;
+  for (int i = 0; i < kBackendCount; i++) {
+    BackendMeasurement m =
+        measure(static_cast<CaptureBackend>(i), control, x0, y0, dx);
+    selection.measurements.push_back(m);
+    LOG_INFO("CaptureBackend",
+             "%s: %d/%d probes, median %lld us, p95 %lld us, cpu %lld us",
+             kBackendNames[i], m.delivered, m.probes,
+             static_cast<long long>(m.median_latency_us),
+             static_cast<long long>(m.p95_latency_us),
+             static_cast<long long>(m.cpu_us_per_event));
+
+    // CPU spent on the capture thread is latency on a single-core box, so
+    // both count.
+    const int64_t score = m.median_latency_us + m.cpu_us_per_event;
+    if (m.available && score < best_score) {
+      best_score = score;
+      selection.backend = m.backend;
+    }
+  }
+  XCloseDisplay(control);
+
+  selection.measured = true;
+  save_cache(key, selection);
+  selection.elapsed_us = g_get_monotonic_time() - start_us;
+  LOG_INFO("CaptureBackend", "Selected %s in %lld us",
+           capture_backend_name(selection.backend),
+           static_cast<long long>(selection.elapsed_us));
+  return selection;
+}
@@ -0,0 +1,102 @@
+#ifndef CAPTURE_BACKEND_H_
+#define CAPTURE_BACKEND_H_
+
+#include <X11/Xlib.h>
+#include <X11/extensions/record.h>
+#include <glib.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/// Ways of running the XRecord capture loop.
+///
+/// Both deliver the same events through the same intercept callback; they
+/// differ in how replies are read from the X connection, which makes one
+/// or the other faster depending on the X server, compositor and drivers.
+enum CaptureBackend : uint8_t {
+  /// XRecordEnableContext: libXtst blocks in the call and reads replies
+  /// one at a time.
+  kBackendRecordSync = 0,
+
+  /// XRecordEnableContextAsync: the loop polls the connection and drains
+  /// every buffered reply per wakeup with XRecordProcessReplies.
+  kBackendRecordAsync = 1,
+
+  kBackendCount = 2,
+};
+
+/// Stable name of [backend], used in the cache and reported to Dart.
+const char* capture_backend_name(CaptureBackend backend);
+
+/// Parses a name from capture_backend_name(). Returns false if unknown.
+bool capture_backend_from_name(const char* name, CaptureBackend* backend);
+
+/// Runs the capture loop of [backend] for [context] on [data_display]
+/// until the context is disabled from another connection.
+///
+/// Both loops return only after the end-of-data reply that follows the
+/// disable, so [callback] sees every event the server sent before it.
+void capture_backend_run(CaptureBackend backend, Display* data_display,
+                         XRecordContext context, XRecordInterceptProc callback,
+                         XPointer closure);
+
+/// Self-benchmark result of one backend.
+struct BackendMeasurement {
+  CaptureBackend backend;
+
+  /// Whether the backend could be set up and delivered probes at all.
+  bool available;
+
+  /// Probes injected and probes seen by the backend.
+  int probes;
+  int delivered;
+
+  /// Time from injecting a probe to its arrival in the callback.
+  int64_t median_latency_us;
+  int64_t p95_latency_us;
+
+  /// CPU time of the capture thread per delivered probe.
+  int64_t cpu_us_per_event;
+};
+
+/// The backend to capture with and how it was chosen.
+struct BackendSelection {
+  CaptureBackend backend;
+
+  /// Whether the decision came from the per-machine cache.
+  bool cached;
+
+  /// Whether the self-benchmark ran (now or when the cache was written).
+  bool measured;
+
+  /// Time the selection took now, in microseconds.
+  int64_t elapsed_us;
+
+  std::vector<BackendMeasurement> measurements;
+};
+
+/// Default selection: the synchronous loop, not measured.
+BackendSelection capture_backend_default();
+
+/// Loads the decision capture_backend_select() cached for the machine and
+/// the X server of [display] into [selection]. Only reads a small file, so
+/// it can run on the platform thread. Returns false if there is none.
+bool capture_backend_cached(Display* display, BackendSelection* selection);
+
+/// Picks the fastest backend for this machine and X server.
+///
+/// Uses the cached decision when one exists for the same machine id, X
+/// server vendor and release, unless [rerun]. Otherwise injects a few
+/// XTest pointer probes (one-pixel moves, the pointer ends where it
+/// started), measures each backend's delivery latency and capture thread
+/// CPU time, picks the lowest latency plus CPU cost, and caches the
+/// decision under the user cache directory.
+///
+/// Measuring blocks for a second or more (a 500 ms warmup per backend,
+/// then the probes, each waiting up to 50 ms), so run it on a thread of
+/// its own. The probes move the real pointer, so run it while not
+/// capturing: a capture would see them as one-pixel motion.
+BackendSelection capture_backend_select(bool rerun);
+
+#endif  // CAPTURE_BACKEND_H_
@@ -0,0 +1,55 @@
+#ifndef CAPTURED_EVENT_H_
+#define CAPTURED_EVENT_H_
+
+#include <cstdint>
+
+/// Kind of a captured input event.
+///
+/// The values mirror the order of the Dart `InputEventType` enum and are
+/// persisted in session journals, so they must never be renumbered.
+enum CapturedEventType : uint8_t {
+  kCapturedKeyDown = 0,
+  kCapturedKeyUp = 1,
+  kCapturedMouseMove = 2,
+  kCapturedMouseDown = 3,
+  kCapturedMouseUp = 4,
+  kCapturedMouseScroll = 5,
+};
+
+/// Modifier bits, in the order of the Dart `KeyModifier` enum.
+enum CapturedModifier : uint8_t {
+  kModifierShift = 1 << 0,
+  kModifierControl = 1 << 1,
+  kModifierAlt = 1 << 2,
+  kModifierMeta = 1 << 3,
+};
+
+/// A decoded input event, independent of how it is delivered or stored.
+///
+/// Produced by the capture thread from raw X11 protocol data and consumed by
+/// the event channel, the session journal and journal replay.
+struct CapturedEvent {
+  /// Monotonic capture time in microseconds (g_get_monotonic_time domain).
+  int64_t timestamp_us;
+
+  /// X server timestamp of the event in milliseconds (wraps every ~49 days).
+  uint32_t server_time_ms;
+
+  /// Keysym for key events, 0 otherwise.
+  uint32_t keysym;
+
+  /// Root coordinates for pointer events, or scroll deltas for scroll events.
+  int32_t x;
+  int32_t y;
+
+  /// X keycode for key events, button number for button events.
+  uint16_t code;
+
+  /// One of [CapturedEventType].
+  uint8_t type;
+
+  /// Bitwise OR of [CapturedModifier] values.
+  uint8_t modifiers;
+};
+
+#endif  // CAPTURED_EVENT_H_
@@ -0,0 +1,258 @@
+#include "event_merger.h"
+
+#include <pthread.h>
+
+#include <algorithm>
+#include <chrono>
+#include <utility>
+
+namespace {
+
+int64_t steady_now_us() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+}  // namespace
+
+EventMerger::EventMerger(Sink sink, Clock clock)
+    : sink_(std::move(sink)),
+      clock_(clock ? std::move(clock) : Clock(steady_now_us)),
+      next_id_(0),
+      window_us_(kDefaultWindowUs),
+      capacity_(kDefaultSourceCapacity),
+      buffered_(0),
+      last_emitted_us_(INT64_MIN),
+      stats_(),
+      stopping_(false) {
+  timer_ = std::thread(&EventMerger::timer_loop, this);
+}
+
+EventMerger::~EventMerger() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  cv_.notify_one();
+  timer_.join();
+}
+
+int EventMerger::add_source(const std::string& name, int64_t max_delay_us) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  Source source;
+  source.id = next_id_++;
+  source.name = name;
+  source.max_delay_us = std::max<int64_t>(max_delay_us, 0);
+  // Nothing older than this can arrive from a source added now, except
+  // within its declared delay.
+  source.last_us = clock_() - source.max_delay_us;
+  sources_.push_back(std::move(source));
+  return sources_.back().id;
+}
+
+void EventMerger::remove_source(int source) {
+  drain(source);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = std::find_if(sources_.begin(), sources_.end(),
+                           [source](const Source& s) { return s.id == source; });
+    if (it == sources_.end()) return;
+    buffered_ -= it->queue.size();
+    sources_.erase(it);
+  }
+  // Events that waited for the removed source may be ready now.
+  drain(-1);
+}
+
+void EventMerger::push(int source, const CapturedEvent& event,
+                       int64_t dispatch_us) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = std::find_if(sources_.begin(), sources_.end(),
+                           [source](const Source& s) { return s.id == source; });
+    if (it == sources_.end()) return;
+
+    Pending pending{event, dispatch_us};
+    // Merging relies on each source being in order; a source that steps
+    // back keeps its own order instead.
+    if (pending.event.timestamp_us < it->last_us) {
+      pending.event.timestamp_us = it->last_us;
+    }
+    it->last_us = pending.event.timestamp_us;
+    it->queue.push_back(pending);
+    buffered_++;
+    stats_.max_buffered = std::max(stats_.max_buffered, buffered_);
+  }
+
+  drain(-1);
+
+  bool waiting;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    waiting = buffered_ > 0;
+  }
+  // Only wake the timer when something waits for a deadline, so a lone
+  // source costs no extra wakeups.
+  if (waiting) cv_.notify_one();
+}
+
+void EventMerger::advance(int source, int64_t watermark_us) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (Source& s : sources_) {
+      if (s.id == source) s.last_us = std::max(s.last_us, watermark_us);
+    }
+  }
+  drain(-1);
+}
+
+void EventMerger::set_window_us(int64_t window_us) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    window_us_ = std::max<int64_t>(window_us, 0);
+  }
+  cv_.notify_one();
+  drain(-1);
+}
+
+int64_t EventMerger::window_us() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return window_us_;
+}
+
+void EventMerger::set_source_capacity(size_t capacity) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    capacity_ = std::max<size_t>(capacity, 1);
+  }
+  drain(-1);
+}
+
+size_t EventMerger::source_count() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return sources_.size();
+}
+
+EventMergerStats EventMerger::stats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  EventMergerStats stats = stats_;
+  stats.buffered = buffered_;
+  return stats;
+}
+
+EventMerger::Source* EventMerger::next_source_locked() {
+  Source* next = nullptr;
+  // Sources are in id order, so the strict comparison breaks ties by id.
+  for (Source& s : sources_) {
+    if (s.queue.empty()) continue;
+    if (next == nullptr || s.queue.front().event.timestamp_us <
+                               next->queue.front().event.timestamp_us) {
+      next = &s;
+    }
+  }
+  return next;
+}
+
+bool EventMerger::covered_locked(const Source* next, int64_t timestamp_us,
+                                 int64_t now_us) const {
+  for (const Source& s : sources_) {
+    // Buffered sources are covered by their oldest event, which is not
+    // older than the next one.
+    if (&s == next || !s.queue.empty()) continue;
+    if (std::max(s.last_us, now_us - s.max_delay_us) < timestamp_us) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void EventMerger::pop_locked(Source* source,
+                             std::vector<std::pair<Pending, int>>* out) {
+  const Pending& pending = source->queue.front();
+  const int64_t timestamp_us = pending.event.timestamp_us;
+  if (timestamp_us < last_emitted_us_) {
+    stats_.late++;
+  } else {
+    last_emitted_us_ = timestamp_us;
+  }
+  stats_.emitted++;
+  out->emplace_back(pending, source->id);
+  source->queue.pop_front();
+  buffered_--;
+}
+
+void EventMerger::take_ready_locked(
+    int64_t now_us, int flush_id, std::vector<std::pair<Pending, int>>* out) {
+  for (;;) {
+    Source* next = next_source_locked();
+    if (next == nullptr) return;
+    const int64_t timestamp_us = next->queue.front().event.timestamp_us;
+
+    bool flushing = false;
+    bool over_capacity = false;
+    for (const Source& s : sources_) {
+      flushing |= s.id == flush_id && !s.queue.empty();
+      over_capacity |= s.queue.size() > capacity_;
+    }
+
+    if (flushing || covered_locked(next, timestamp_us, now_us)) {
+      pop_locked(next, out);
+    } else if (timestamp_us + window_us_ <= now_us) {
+      stats_.expired++;
+      pop_locked(next, out);
+    } else if (over_capacity) {
+      stats_.overflowed++;
+      pop_locked(next, out);
+    } else {
+      return;
+    }
+  }
+}
+
+void EventMerger::drain(int flush_id) {
+  std::lock_guard<std::mutex> emit_lock(emit_mutex_);
+  std::vector<std::pair<Pending, int>> ready;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    take_ready_locked(clock_(), flush_id, &ready);
+  }
+  for (const auto& item : ready) {
+    sink_(item.first.event, item.first.dispatch_us, item.second);
+  }
+}
+
+void EventMerger::timer_loop() {
+  pthread_setname_np(pthread_self(), "kp-merge");
+
+  // Sleeps without a timeout while nothing is buffered, so an idle merger
+  // never wakes up.
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (!stopping_) {
+    Source* next = next_source_locked();
+    if (next == nullptr) {
+      cv_.wait(lock);
+      continue;
+    }
+
+    // The next event is ready once every idle source's watermark has
+    // passed it, or when its window runs out, whichever is first.
+    const int64_t timestamp_us = next->queue.front().event.timestamp_us;
+    int64_t covered_at = timestamp_us;
+    for (const Source& s : sources_) {
+      if (&s == next || !s.queue.empty() || s.last_us >= timestamp_us) continue;
+      covered_at = std::max(covered_at, timestamp_us + s.max_delay_us);
+    }
+    const int64_t ready_at = std::min(covered_at, timestamp_us + window_us_);
+    const int64_t wait_us = ready_at - clock_();
+
+    if (wait_us > 0) {
+      cv_.wait_for(lock, std::chrono::microseconds(wait_us));
+      continue;
+    }
+
+    lock.unlock();
+    drain(-1);
+    lock.lock();
+  }
+}
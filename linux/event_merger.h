@@ -0,0 +1,174 @@
+#ifndef EVENT_MERGER_H_
+#define EVENT_MERGER_H_
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "captured_event.h"
+
+/// Counters of an [EventMerger], for logs and diagnostics.
+struct EventMergerStats {
+  /// Events handed to the sink.
+  uint64_t emitted;
+
+  /// Events released because they waited for the full reorder window
+  /// while another source had not caught up.
+  uint64_t expired;
+
+  /// Events released early because their source's buffer was full.
+  uint64_t overflowed;
+
+  /// Events that arrived after a newer event had already been emitted and
+  /// so reached the sink out of timestamp order.
+  uint64_t late;
+
+  /// Largest number of events buffered at once.
+  size_t max_buffered;
+
+  /// Events buffered now.
+  size_t buffered;
+};
+
+/// K-way merge of input event sources into one stream in timestamp order.
+///
+/// Every source pushes events stamped on the monotonic clock
+/// (CapturedEvent::timestamp_us) in non-decreasing order. The merger emits
+/// the oldest buffered event once no source can still deliver an older one:
+/// a source with buffered events is covered by its oldest one, and an idle
+/// source by its watermark, the later of its last timestamp and `now -
+/// max_delay_us`. [max_delay_us] is how far behind the clock a source's
+/// timestamps may be when they are pushed; sources that stamp events on
+/// arrival (XRecord, replay re-emission) declare a small slack.
+///
+/// Journal replay is such a source: it re-stamps every event with the
+/// monotonic time it is re-emitted, not its recorded timestamp, which lies
+/// in the past and would make every replayed event late. Replayed and live
+/// events therefore merge by when they reach the merger; the recorded
+/// order within the replay is kept, and the X server time is passed on
+/// unchanged.
+///
+/// The reorder window bounds how long an event waits for a stalled source:
+/// once it is [window_us] old it is emitted regardless, so a stuck source
+/// delays the others by at most the window. Each source buffers at most
+/// [source_capacity] events; pushing into a full buffer releases the oldest
+/// buffered events first. Ties are broken by source id, then push order,
+/// so the same pushes always merge the same way.
+///
+/// With a single source every push is emitted immediately.
+///
+/// Thread-safe. The sink is called with no merger lock held but never
+/// concurrently, from the pushing thread or the merger's timer thread.
+class EventMerger {
+ public:
+  /// Receives merged events: the event, the dispatch time its source
+  /// supplied, and the source id.
+  using Sink = std::function<void(const CapturedEvent& event,
+                                  int64_t dispatch_us, int source)>;
+
+  /// Returns the current monotonic time in microseconds.
+  using Clock = std::function<int64_t()>;
+
+  /// Default reorder window.
+  static constexpr int64_t kDefaultWindowUs = 8 * 1000;
+
+  /// Default per-source buffer limit.
+  static constexpr size_t kDefaultSourceCapacity = 1024;
+
+  /// Creates a merger emitting to [sink]. [clock] defaults to the
+  /// steady clock, which matches g_get_monotonic_time() on Linux.
+  explicit EventMerger(Sink sink, Clock clock = Clock());
+
+  /// Stops the timer thread. Buffered events are dropped; remove sources
+  /// first to flush them.
+  ~EventMerger();
+
+  EventMerger(const EventMerger&) = delete;
+  EventMerger& operator=(const EventMerger&) = delete;
+
+  /// Adds a source and returns its id. Ids are never reused.
+  int add_source(const std::string& name, int64_t max_delay_us);
+
+  /// Removes [source], emitting its buffered events in merge order first.
+  void remove_source(int source);
+
+  /// Buffers [event] from [source] and emits whatever became ready.
+  /// [dispatch_us] is passed through to the sink unchanged.
+  void push(int source, const CapturedEvent& event, int64_t dispatch_us);
+
+  /// Declares that [source] will not push events older than
+  /// [watermark_us], letting others' events through without waiting.
+  void advance(int source, int64_t watermark_us);
+
+  /// Sets the reorder window, in microseconds (at least 0).
+  void set_window_us(int64_t window_us);
+  int64_t window_us() const;
+
+  /// Sets the per-source buffer limit (at least 1).
+  void set_source_capacity(size_t capacity);
+
+  /// Number of sources currently added.
+  size_t source_count() const;
+
+  EventMergerStats stats() const;
+
+ private:
+  struct Pending {
+    CapturedEvent event;
+    int64_t dispatch_us;
+  };
+
+  struct Source {
+    int id;
+    std::string name;
+    int64_t max_delay_us;
+    int64_t last_us;
+    std::deque<Pending> queue;
+  };
+
+  /// Moves every event that is ready at [now_us] into [out], in merge
+  /// order. With [flush], every buffered event of source [flush_id] and
+  /// older is ready too. Requires mutex_.
+  void take_ready_locked(int64_t now_us, int flush_id,
+                         std::vector<std::pair<Pending, int>>* out);
+
+  /// Source whose oldest buffered event is next in merge order, or null.
+  Source* next_source_locked();
+
+  /// Whether every other source has caught up with [timestamp_us].
+  bool covered_locked(const Source* next, int64_t timestamp_us,
+                      int64_t now_us) const;
+
+  /// Pops the next event of [source] into [out], updating the stats.
+  void pop_locked(Source* source, std::vector<std::pair<Pending, int>>* out);
+
+  /// Emits ready events. Holds emit_mutex_ across taking and emitting so
+  /// concurrent callers cannot reorder them.
+  void drain(int flush_id);
+
+  void timer_loop();
+
+  Sink sink_;
+  Clock clock_;
+
+  std::mutex emit_mutex_;
+  mutable std::mutex mutex_;
+  std::condition_variable cv_;
+  std::vector<Source> sources_;
+  int next_id_;
+  int64_t window_us_;
+  size_t capacity_;
+  size_t buffered_;
+  int64_t last_emitted_us_;
+  EventMergerStats stats_;
+  bool stopping_;
+  std::thread timer_;
+};
+
+#endif  // EVENT_MERGER_H_
@@ -0,0 +1,198 @@
+#include "event_pipeline.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace {
+
+int64_t steady_now_ns() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+// Every CapturedEventType.
+constexpr uint32_t kAllTypes = (1u << (kCapturedMouseScroll + 1)) - 1;
+
+}  // namespace
+
+EventPipeline::EventPipeline() : timing_(false) {}
+
+void EventPipeline::add_stage(std::unique_ptr<EventStage> stage,
+                              bool enabled) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  Entry entry;
+  entry.stage = std::move(stage);
+  entry.enabled = enabled;
+  entry.timing = StageTiming();
+  entries_.push_back(std::move(entry));
+}
+
+EventPipeline::Entry* EventPipeline::find_locked(const std::string& name) {
+  auto it = std::find_if(
+      entries_.begin(), entries_.end(),
+      [&name](const Entry& entry) { return entry.stage->name() == name; });
+  return it == entries_.end() ? nullptr : &*it;
+}
+
+bool EventPipeline::set_enabled(const std::string& name, bool enabled) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  Entry* entry = find_locked(name);
+  if (entry == nullptr) return false;
+  if (enabled && !entry->enabled) {
+    // State from before it was disabled is stale.
+    entry->stage->reset();
+  }
+  entry->enabled = enabled;
+  return true;
+}
+
+bool EventPipeline::configure(const std::string& name,
+                              const StageOptions& options) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  Entry* entry = find_locked(name);
+  return entry != nullptr && entry->stage->configure(options);
+}
+
+bool EventPipeline::run(CapturedEvent event, int64_t dispatch_us) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!timing_) {
+    for (Entry& entry : entries_) {
+      if (entry.enabled && !entry.stage->process(&event, dispatch_us)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  int64_t start_ns = steady_now_ns();
+  for (Entry& entry : entries_) {
+    if (!entry.enabled) continue;
+
+    const bool passed = entry.stage->process(&event, dispatch_us);
+    const int64_t end_ns = steady_now_ns();
+    const int64_t elapsed_ns = end_ns - start_ns;
+    start_ns = end_ns;
+
+    StageTiming& timing = entry.timing;
+    timing.calls++;
+    timing.total_ns += elapsed_ns;
+    timing.max_ns = std::max(timing.max_ns, elapsed_ns);
+    if (!passed) {
+      timing.dropped++;
+      return false;
+    }
+  }
+  return true;
+}
+
+void EventPipeline::reset() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (Entry& entry : entries_) {
+    entry.stage->reset();
+  }
+}
+
+void EventPipeline::set_timing(bool enabled) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (enabled && !timing_) {
+    for (Entry& entry : entries_) {
+      entry.timing = StageTiming();
+    }
+  }
+  timing_ = enabled;
+}
+
+bool EventPipeline::timing() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return timing_;
+}
+
+std::vector<StageInfo> EventPipeline::describe(bool reset_timings) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::vector<StageInfo> stages;
+  stages.reserve(entries_.size());
+  for (Entry& entry : entries_) {
+    StageInfo info;
+    info.name = entry.stage->name();
+    info.enabled = entry.enabled;
+    info.options = entry.stage->options();
+    info.timing = entry.timing;
+    stages.push_back(std::move(info));
+    if (reset_timings) entry.timing = StageTiming();
+  }
+  return stages;
+}
+
+TypeFilterStage::TypeFilterStage() : EventStage("filter"), types_(kAllTypes) {}
+
+bool TypeFilterStage::process(CapturedEvent* event, int64_t dispatch_us) {
+  return (types_ >> event->type) & 1;
+}
+
+bool TypeFilterStage::configure(const StageOptions& options) {
+  auto it = options.find("types");
+  if (it == options.end()) return true;
+  if (it->second < 0 || it->second > kAllTypes) return false;
+  types_ = static_cast<uint32_t>(it->second);
+  return true;
+}
+
+StageOptions TypeFilterStage::options() const {
+  return StageOptions{{"types", types_}};
+}
+
+RepeatCollapseStage::RepeatCollapseStage() : EventStage("repeat_collapse") {}
+
+bool RepeatCollapseStage::process(CapturedEvent* event, int64_t dispatch_us) {
+  const size_t code = event->code & 0xff;
+  switch (event->type) {
+    case kCapturedKeyDown:
+      if (held_.test(code)) return false;
+      held_.set(code);
+      return true;
+    case kCapturedKeyUp:
+      held_.reset(code);
+      return true;
+    default:
+      return true;
+  }
+}
+
+void RepeatCollapseStage::reset() { held_.reset(); }
+
+MotionCoalesceStage::MotionCoalesceStage()
+    : EventStage("coalesce"),
+      interval_us_(kDefaultIntervalUs),
+      last_us_(INT64_MIN) {}
+
+bool MotionCoalesceStage::process(CapturedEvent* event, int64_t dispatch_us) {
+  if (event->type != kCapturedMouseMove) return true;
+  if (last_us_ != INT64_MIN &&
+      event->timestamp_us - last_us_ < interval_us_) {
+    return false;
+  }
+  last_us_ = event->timestamp_us;
+  return true;
+}
+
+bool MotionCoalesceStage::configure(const StageOptions& options) {
+  auto it = options.find("intervalUs");
+  if (it == options.end()) return true;
+  if (it->second < 0) return false;
+  interval_us_ = it->second;
+  return true;
+}
+
+StageOptions MotionCoalesceStage::options() const {
+  return StageOptions{{"intervalUs", interval_us_}};
+}
+
+void MotionCoalesceStage::reset() { last_us_ = INT64_MIN; }
+
+CallbackStage::CallbackStage(std::string name, Callback callback)
+    : EventStage(std::move(name)), callback_(std::move(callback)) {}
+
+bool CallbackStage::process(CapturedEvent* event, int64_t dispatch_us) {
+  return callback_(event, dispatch_us);
+}
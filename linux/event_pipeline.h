@@ -0,0 +1,204 @@
+#ifndef EVENT_PIPELINE_H_
+#define EVENT_PIPELINE_H_
+
+#include <bitset>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "captured_event.h"
+
+/// Integer options of a stage, by name. Booleans are 0 or 1.
+using StageOptions = std::map<std::string, int64_t>;
+
+/// One step of an [EventPipeline].
+///
+/// Stages see every event that passed the stages before them, in order,
+/// on one thread at a time.
+class EventStage {
+ public:
+  explicit EventStage(std::string name) : name_(std::move(name)) {}
+  virtual ~EventStage() = default;
+
+  EventStage(const EventStage&) = delete;
+  EventStage& operator=(const EventStage&) = delete;
+
+  /// Stable name, used to configure the stage.
+  const std::string& name() const { return name_; }
+
+  /// Processes [event], which may be changed for the stages after this
+  /// one. Returns false to drop it. [dispatch_us] is the wall-clock time
+  /// the event is delivered with.
+  virtual bool process(CapturedEvent* event, int64_t dispatch_us) = 0;
+
+  /// Applies the known entries of [options]. Returns false if a value is
+  /// out of range; valid entries are still applied.
+  virtual bool configure(const StageOptions& options) { return true; }
+
+  /// Current options, for reporting.
+  virtual StageOptions options() const { return StageOptions(); }
+
+  /// Forgets state carried between events, e.g. when capture stops and
+  /// releases would be missed.
+  virtual void reset() {}
+
+ private:
+  std::string name_;
+};
+
+/// Time spent in a stage while timing was on, since the last timing
+/// reset.
+struct StageTiming {
+  /// Events the stage processed.
+  uint64_t calls;
+
+  /// Events the stage dropped.
+  uint64_t dropped;
+
+  /// Total and longest time in the stage, in nanoseconds.
+  int64_t total_ns;
+  int64_t max_ns;
+};
+
+/// A stage's configuration and timing, as reported to Dart.
+struct StageInfo {
+  std::string name;
+  bool enabled;
+  StageOptions options;
+  StageTiming timing;
+};
+
+/// Ordered chain of event processing stages.
+///
+/// Every event runs through the enabled stages in the order they were
+/// added until one drops it; disabled stages cost nothing. Stages are
+/// enabled and configured at runtime, and each reports its own timing.
+///
+/// Timing is off by default: it reads the clock after every stage, which
+/// is most of the pipeline's own cost for the cheap stages. Turn it on
+/// with [set_timing] while something reports it.
+///
+/// Thread-safe. [run] is meant to be called by one thread at a time (the
+/// event merger's sink); configuration from other threads waits for the
+/// event in progress.
+class EventPipeline {
+ public:
+  EventPipeline();
+
+  EventPipeline(const EventPipeline&) = delete;
+  EventPipeline& operator=(const EventPipeline&) = delete;
+
+  /// Appends [stage]. Names must be unique.
+  void add_stage(std::unique_ptr<EventStage> stage, bool enabled);
+
+  /// Enables or disables the stage [name]. Returns false if unknown.
+  bool set_enabled(const std::string& name, bool enabled);
+
+  /// Configures the stage [name]. Returns false if unknown or if an option
+  /// is out of range.
+  bool configure(const std::string& name, const StageOptions& options);
+
+  /// Runs [event] through the enabled stages. Returns whether it passed
+  /// all of them.
+  bool run(CapturedEvent event, int64_t dispatch_us);
+
+  /// Resets the state of every stage.
+  void reset();
+
+  /// Turns stage timing on or off. Turning it on starts the timing over.
+  void set_timing(bool enabled);
+
+  /// Whether stages are timed.
+  bool timing();
+
+  /// Current stages, in order, with their timing. With [reset_timings],
+  /// timing starts over afterwards.
+  std::vector<StageInfo> describe(bool reset_timings);
+
+ private:
+  struct Entry {
+    std::unique_ptr<EventStage> stage;
+    bool enabled;
+    StageTiming timing;
+  };
+
+  Entry* find_locked(const std::string& name);
+
+  std::mutex mutex_;
+  std::vector<Entry> entries_;
+  bool timing_;
+};
+
+/// Passes only events of the selected types.
+///
+/// Option "types": bit mask of (1 << CapturedEventType), all by default.
+class TypeFilterStage : public EventStage {
+ public:
+  TypeFilterStage();
+
+  bool process(CapturedEvent* event, int64_t dispatch_us) override;
+  bool configure(const StageOptions& options) override;
+  StageOptions options() const override;
+
+ private:
+  uint32_t types_;
+};
+
+/// Drops key presses of keys that are already down, i.e. auto-repeat,
+/// where the server reports it as repeated presses.
+class RepeatCollapseStage : public EventStage {
+ public:
+  RepeatCollapseStage();
+
+  bool process(CapturedEvent* event, int64_t dispatch_us) override;
+  void reset() override;
+
+ private:
+  std::bitset<256> held_;
+};
+
+/// Thins pointer motion to at most one event per interval.
+///
+/// Unlike the batch coalescing, which merges motion that Dart has not
+/// picked up yet, this drops it: the position catches up with the next
+/// motion, button or scroll event. For deployments that only need coarse
+/// pointer tracking.
+///
+/// Option "intervalUs": minimum time between passed motion events,
+/// 8000 by default.
+class MotionCoalesceStage : public EventStage {
+ public:
+  static constexpr int64_t kDefaultIntervalUs = 8 * 1000;
+
+  MotionCoalesceStage();
+
+  bool process(CapturedEvent* event, int64_t dispatch_us) override;
+  bool configure(const StageOptions& options) override;
+  StageOptions options() const override;
+  void reset() override;
+
+ private:
+  int64_t interval_us_;
+  int64_t last_us_;
+};
+
+/// Stage running a function, for stages that need the embedder's state.
+class CallbackStage : public EventStage {
+ public:
+  /// Returns false to drop the event.
+  using Callback = std::function<bool(CapturedEvent* event, int64_t dispatch_us)>;
+
+  CallbackStage(std::string name, Callback callback);
+
+  bool process(CapturedEvent* event, int64_t dispatch_us) override;
+
+ private:
+  Callback callback_;
+};
+
+#endif  // EVENT_PIPELINE_H_
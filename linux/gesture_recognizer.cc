@@ -0,0 +1,407 @@
+#include "gesture_recognizer.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+
+// A pause longer than this separates gestures.
+constexpr int64_t kMaxGapUs = 250 * 1000;
+
+// No new gesture for this long after one was recognized.
+constexpr int64_t kCooldownUs = 400 * 1000;
+
+// Swipe: a fast, straight stroke.
+constexpr int64_t kSwipeWindowUs = 250 * 1000;
+constexpr double kSwipeMinDistance = 300;
+constexpr double kSwipeMinStraightness = 0.95;
+
+// Circle: close to one full turn in one direction, at a steady radius.
+constexpr double kCircleMinTurn = 2 * kPi * 0.9;
+constexpr double kCircleMinRadius = 30;
+constexpr double kCircleMinRoundness = 0.65;
+
+// Shake: back and forth along one axis.
+constexpr int kShakeMinReversals = 4;
+constexpr double kShakeMinPath = 300;
+constexpr double kShakeMinAxisShare = 0.55;
+constexpr double kShakeMaxCrossExtent = 0.5;  // Of the extent along the axis.
+
+// Scribble: a path crossing over itself, turning in every direction within
+// a small area. Tangle is the path length over the half perimeter of the
+// bounding box: about 1.5 for one lap of a circle, 1 for a straight line.
+constexpr double kScribbleMinTangle = 2.5;
+constexpr double kScribbleMinTurn = 4 * kPi;
+constexpr double kScribbleMinPath = 600;
+constexpr double kScribbleMinEntropy = 0.75;
+constexpr int32_t kScribbleMaxExtent = 500;
+
+// Weight of a new segment in the smoothed heading.
+constexpr float kHeadingSmoothing = 0.35f;
+
+// A segment counts as moving along an axis if that component is at least
+// this share of its length.
+constexpr double kAxisShare = 0.3;
+
+float clamp01(double value) {
+  return static_cast<float>(std::min(1.0, std::max(0.0, value)));
+}
+
+int axis_sign(float component, float length) {
+  if (component > length * kAxisShare) return 1;
+  if (component < -length * kAxisShare) return -1;
+  return 0;
+}
+
+}  // namespace
+
+GestureRecognizer::GestureRecognizer() { reset(); }
+
+void GestureRecognizer::reset() {
+  head_ = 0;
+  count_ = 0;
+  has_anchor_ = false;
+  anchor_x_ = 0;
+  anchor_y_ = 0;
+  anchor_time_us_ = 0;
+  last_dx_ = 0;
+  last_dy_ = 0;
+  last_sign_x_ = 0;
+  last_sign_y_ = 0;
+  path_length_ = 0;
+  net_turn_ = 0;
+  abs_turn_ = 0;
+  std::fill(histogram_, histogram_ + kDirectionBins, 0.0);
+  reversals_x_ = 0;
+  reversals_y_ = 0;
+  quiet_until_us_ = 0;
+}
+
+void GestureRecognizer::restart(int32_t x, int32_t y, int64_t timestamp_us) {
+  const int64_t quiet_until = quiet_until_us_;
+  reset();
+  quiet_until_us_ = quiet_until;
+  has_anchor_ = true;
+  anchor_x_ = x;
+  anchor_y_ = y;
+  anchor_time_us_ = timestamp_us;
+}
+
+const GestureRecognizer::Segment& GestureRecognizer::segment(size_t age) const {
+  // age 0 is the newest segment.
+  return segments_[(head_ + count_ - 1 - age) % kMaxSegments];
+}
+
+void GestureRecognizer::push_segment(const Segment& segment) {
+  if (count_ == kMaxSegments) {
+    pop_oldest();
+  }
+  segments_[(head_ + count_) % kMaxSegments] = segment;
+  count_++;
+
+  path_length_ += segment.length;
+  net_turn_ += segment.turn;
+  abs_turn_ += std::fabs(segment.turn);
+  histogram_[segment.bin] += segment.length;
+  reversals_x_ += segment.reverses_x ? 1 : 0;
+  reversals_y_ += segment.reverses_y ? 1 : 0;
+}
+
+void GestureRecognizer::pop_oldest() {
+  const Segment& oldest = segments_[head_];
+  path_length_ -= oldest.length;
+  net_turn_ -= oldest.turn;
+  abs_turn_ -= std::fabs(oldest.turn);
+  histogram_[oldest.bin] -= oldest.length;
+  reversals_x_ -= oldest.reverses_x ? 1 : 0;
+  reversals_y_ -= oldest.reverses_y ? 1 : 0;
+
+  head_ = (head_ + 1) % kMaxSegments;
+  count_--;
+}
+
+void GestureRecognizer::expire(int64_t now_us) {
+  while (count_ > 0 && segments_[head_].timestamp_us < now_us - kWindowUs) {
+    pop_oldest();
+  }
+}
+
+bool GestureRecognizer::add_sample(int32_t x, int32_t y, int64_t timestamp_us,
+                                   GestureEvent* out) {
+  if (!has_anchor_ || timestamp_us - anchor_time_us_ > kMaxGapUs) {
+    restart(x, y, timestamp_us);
+    return false;
+  }
+
+  const float dx = static_cast<float>(x - anchor_x_);
+  const float dy = static_cast<float>(y - anchor_y_);
+  const float length = std::sqrt(dx * dx + dy * dy);
+  if (length < kMinSegmentPx) {
+    return false;
+  }
+
+  expire(timestamp_us);
+
+  Segment s;
+  s.timestamp_us = timestamp_us;
+  s.x = x;
+  s.y = y;
+  s.dx = dx;
+  s.dy = dy;
+  s.length = length;
+  // Turning is measured on a smoothed heading: resampled segments are only a
+  // few pixels long, so their raw directions are noisy and would add up to
+  // lots of spurious turning.
+  const float heading_dx =
+      last_dx_ * (1 - kHeadingSmoothing) + dx / length * kHeadingSmoothing;
+  const float heading_dy =
+      last_dy_ * (1 - kHeadingSmoothing) + dy / length * kHeadingSmoothing;
+  s.turn = 0;
+  if (last_dx_ != 0 || last_dy_ != 0) {
+    // Signed angle between the previous and the new heading.
+    s.turn = std::atan2(last_dx_ * heading_dy - last_dy_ * heading_dx,
+                        last_dx_ * heading_dx + last_dy_ * heading_dy);
+  }
+  const double heading = std::atan2(dy, dx) + kPi;  // 0..2pi
+  s.bin = static_cast<uint8_t>(
+      static_cast<int>(heading / (2 * kPi) * kDirectionBins) % kDirectionBins);
+
+  const int sign_x = axis_sign(dx, length);
+  const int sign_y = axis_sign(dy, length);
+  s.reverses_x = sign_x != 0 && last_sign_x_ != 0 && sign_x != last_sign_x_;
+  s.reverses_y = sign_y != 0 && last_sign_y_ != 0 && sign_y != last_sign_y_;
+  if (sign_x != 0) last_sign_x_ = sign_x;
+  if (sign_y != 0) last_sign_y_ = sign_y;
+
+  push_segment(s);
+  anchor_x_ = x;
+  anchor_y_ = y;
+  anchor_time_us_ = timestamp_us;
+  if (last_dx_ != 0 || last_dy_ != 0) {
+    last_dx_ = heading_dx;
+    last_dy_ = heading_dy;
+  } else {
+    last_dx_ = dx / length;
+    last_dy_ = dy / length;
+  }
+
+  if (timestamp_us < quiet_until_us_) {
+    return false;
+  }
+
+  // A scribble loops and reverses, so it would also pass for a circle or a
+  // shake: it is checked first, and a tangled path is never a circle.
+  if (check_swipe(out) || check_scribble(out) || check_circle(out) ||
+      check_shake(out)) {
+    out->timestamp_us = timestamp_us;
+    quiet_until_us_ = timestamp_us + kCooldownUs;
+    // Start over so the same motion is not reported twice.
+    restart(x, y, timestamp_us);
+    return true;
+  }
+  return false;
+}
+
+bool GestureRecognizer::tangled() const {
+  int32_t width;
+  int32_t height;
+  bounds(&width, &height);
+  return path_length_ >= kScribbleMinTangle * std::max(1, width + height);
+}
+
+bool GestureRecognizer::check_swipe(GestureEvent* out) const {
+  if (count_ < 3) return false;
+
+  // Straight-line distance and path length over the most recent segments.
+  const Segment& newest = segment(0);
+  double path = 0;
+  double start_x = newest.x;
+  double start_y = newest.y;
+  size_t used = 0;
+  for (size_t age = 0; age < count_; age++) {
+    const Segment& s = segment(age);
+    if (s.timestamp_us < newest.timestamp_us - kSwipeWindowUs) break;
+    path += s.length;
+    start_x = s.x - s.dx;
+    start_y = s.y - s.dy;
+    used++;
+  }
+  if (used < 3) return false;
+
+  const double dx = newest.x - start_x;
+  const double dy = newest.y - start_y;
+  const double distance = std::sqrt(dx * dx + dy * dy);
+  if (distance < kSwipeMinDistance) return false;
+  const double straightness = distance / path;
+  if (straightness < kSwipeMinStraightness) return false;
+
+  out->kind = kGestureSwipe;
+  if (std::fabs(dx) >= std::fabs(dy)) {
+    out->direction = dx > 0 ? kSwipeRight : kSwipeLeft;
+  } else {
+    out->direction = dy > 0 ? kSwipeDown : kSwipeUp;
+  }
+  out->x = newest.x;
+  out->y = newest.y;
+  out->confidence = clamp01(
+      0.5 * (straightness - kSwipeMinStraightness) / (1 - kSwipeMinStraightness) +
+      0.5 * distance / (2 * kSwipeMinDistance));
+  return true;
+}
+
+bool GestureRecognizer::check_circle(GestureEvent* out) const {
+  if (std::fabs(net_turn_) < kCircleMinTurn) return false;
+  // Loops drawn over each other.
+  if (tangled()) return false;
+  // Mostly turning one way.
+  if (abs_turn_ > std::fabs(net_turn_) * 1.5) return false;
+
+  int32_t cx;
+  int32_t cy;
+  centroid(&cx, &cy);
+
+  double sum = 0;
+  double sum_sq = 0;
+  for (size_t age = 0; age < count_; age++) {
+    const Segment& s = segment(age);
+    const double r = std::hypot(s.x - cx, s.y - cy);
+    sum += r;
+    sum_sq += r * r;
+  }
+  const double mean = sum / count_;
+  if (mean < kCircleMinRadius) return false;
+  const double variance = std::max(0.0, sum_sq / count_ - mean * mean);
+  const double roundness = 1 - std::sqrt(variance) / mean;
+  if (roundness < kCircleMinRoundness) return false;
+
+  out->kind = kGestureCircle;
+  out->direction = 0;
+  out->x = cx;
+  out->y = cy;
+  out->confidence =
+      clamp01(std::fabs(net_turn_) / (2 * kPi)) *
+      clamp01((roundness - kCircleMinRoundness) / (1 - kCircleMinRoundness) * 0.5 +
+              0.5);
+  return true;
+}
+
+bool GestureRecognizer::check_shake(GestureEvent* out) const {
+  const int reversals = std::max(reversals_x_, reversals_y_);
+  if (reversals < kShakeMinReversals || path_length_ < kShakeMinPath) {
+    return false;
+  }
+
+  // Most of the motion must lie along one axis (a pair of opposite bins).
+  double axis_share = 0;
+  int axis_bin = 0;
+  for (int bin = 0; bin < kDirectionBins / 2; bin++) {
+    const double share =
+        (histogram_[bin] + histogram_[bin + kDirectionBins / 2]) / path_length_;
+    if (share > axis_share) {
+      axis_share = share;
+      axis_bin = bin;
+    }
+  }
+  if (axis_share < kShakeMinAxisShare) return false;
+
+  // And stay close to that axis: random strokes can share a direction for a
+  // while, but they drift across it.
+  const double axis_angle = (axis_bin + 0.5) * 2 * kPi / kDirectionBins - kPi;
+  const double axis_x = std::cos(axis_angle);
+  const double axis_y = std::sin(axis_angle);
+  double min_along = 0;
+  double max_along = 0;
+  double min_across = 0;
+  double max_across = 0;
+  for (size_t age = 0; age < count_; age++) {
+    const Segment& s = segment(age);
+    const double along = s.x * axis_x + s.y * axis_y;
+    const double across = s.y * axis_x - s.x * axis_y;
+    if (age == 0 || along < min_along) min_along = along;
+    if (age == 0 || along > max_along) max_along = along;
+    if (age == 0 || across < min_across) min_across = across;
+    if (age == 0 || across > max_across) max_across = across;
+  }
+  if (max_across - min_across >
+      kShakeMaxCrossExtent * (max_along - min_along)) {
+    return false;
+  }
+
+  int32_t cx;
+  int32_t cy;
+  centroid(&cx, &cy);
+  out->kind = kGestureShake;
+  out->direction = 0;
+  out->x = cx;
+  out->y = cy;
+  out->confidence = clamp01(0.5 * reversals / (2.0 * kShakeMinReversals) +
+                            0.5 * axis_share);
+  return true;
+}
+
+bool GestureRecognizer::check_scribble(GestureEvent* out) const {
+  if (abs_turn_ < kScribbleMinTurn || path_length_ < kScribbleMinPath) {
+    return false;
+  }
+  if (!tangled()) return false;
+
+  // Normalized entropy of the direction histogram: 1 when every direction
+  // is used equally.
+  double entropy = 0;
+  for (int bin = 0; bin < kDirectionBins; bin++) {
+    const double p = histogram_[bin] / path_length_;
+    if (p > 0) entropy -= p * std::log(p);
+  }
+  entropy /= std::log(static_cast<double>(kDirectionBins));
+  if (entropy < kScribbleMinEntropy) return false;
+
+  int32_t width;
+  int32_t height;
+  bounds(&width, &height);
+  if (std::max(width, height) > kScribbleMaxExtent) return false;
+
+  int32_t cx;
+  int32_t cy;
+  centroid(&cx, &cy);
+  out->kind = kGestureScribble;
+  out->direction = 0;
+  out->x = cx;
+  out->y = cy;
+  out->confidence = clamp01(abs_turn_ / (1.5 * kScribbleMinTurn)) *
+                    clamp01(entropy);
+  return true;
+}
+
+void GestureRecognizer::centroid(int32_t* x, int32_t* y) const {
+  int64_t sum_x = 0;
+  int64_t sum_y = 0;
+  for (size_t age = 0; age < count_; age++) {
+    sum_x += segment(age).x;
+    sum_y += segment(age).y;
+  }
+  *x = count_ > 0 ? static_cast<int32_t>(sum_x / static_cast<int64_t>(count_)) : 0;
+  *y = count_ > 0 ? static_cast<int32_t>(sum_y / static_cast<int64_t>(count_)) : 0;
+}
+
+void GestureRecognizer::bounds(int32_t* width, int32_t* height) const {
+  if (count_ == 0) {
+    *width = 0;
+    *height = 0;
+    return;
+  }
+  int32_t min_x = segment(0).x;
+  int32_t max_x = min_x;
+  int32_t min_y = segment(0).y;
+  int32_t max_y = min_y;
+  for (size_t age = 1; age < count_; age++) {
+    const Segment& s = segment(age);
+    min_x = std::min(min_x, s.x);
+    max_x = std::max(max_x, s.x);
+    min_y = std::min(min_y, s.y);
+    max_y = std::max(max_y, s.y);
+  }
+  *width = max_x - min_x;
+  *height = max_y - min_y;
+}
@@ -0,0 +1,137 @@
+#ifndef GESTURE_RECOGNIZER_H_
+#define GESTURE_RECOGNIZER_H_
+
+#include <cstddef>
+#include <cstdint>
+
+/// Kind of a recognized pointer gesture.
+///
+/// The values mirror the order of the Dart `PointerGesture` enum.
+enum GestureKind : uint8_t {
+  kGestureCircle = 0,
+  kGestureShake = 1,
+  kGestureScribble = 2,
+  kGestureSwipe = 3,
+};
+
+/// Direction of a swipe, in screen coordinates.
+enum SwipeDirection : uint8_t {
+  kSwipeRight = 0,
+  kSwipeDown = 1,
+  kSwipeLeft = 2,
+  kSwipeUp = 3,
+};
+
+/// A recognized gesture.
+struct GestureEvent {
+  /// Time of the sample that completed the gesture (caller's time base).
+  int64_t timestamp_us;
+
+  /// Where the gesture happened: the center for circles, shakes and
+  /// scribbles, the end point for swipes.
+  int32_t x;
+  int32_t y;
+
+  /// How closely the motion matched the gesture, from 0 to 1.
+  float confidence;
+
+  /// One of [GestureKind].
+  uint8_t kind;
+
+  /// One of [SwipeDirection] for swipes, 0 otherwise.
+  uint8_t direction;
+};
+
+/// Streaming recognizer for kid-sized pointer gestures: circles, shakes,
+/// scribbles and fast swipes.
+///
+/// Raw motion samples are resampled into segments of at least
+/// [kMinSegmentPx] pixels, which removes sensor jitter and makes the work
+/// independent of the mouse polling rate. The segments of the last
+/// [kWindowUs] are kept in a fixed ring; path length, signed and absolute
+/// turning (curvature), a length-weighted direction histogram and axis
+/// reversals are maintained incrementally as segments enter and leave the
+/// window. Only when those running features suggest a gesture is the window
+/// scanned to check its shape, so a typical sample costs O(1) and memory is
+/// constant.
+///
+/// Not thread-safe; feed it from one thread at a time.
+class GestureRecognizer {
+ public:
+  /// Time span of motion considered for a gesture.
+  static constexpr int64_t kWindowUs = 1200 * 1000;
+
+  /// Minimum distance between resampled points.
+  static constexpr int kMinSegmentPx = 4;
+
+  /// Maximum number of segments in the window.
+  static constexpr size_t kMaxSegments = 256;
+
+  /// Number of direction histogram bins.
+  static constexpr int kDirectionBins = 8;
+
+  GestureRecognizer();
+
+  /// Feeds one pointer sample. Returns true and fills [out] if it completed
+  /// a gesture.
+  bool add_sample(int32_t x, int32_t y, int64_t timestamp_us, GestureEvent* out);
+
+  /// Forgets all motion, e.g. after a button press or when capture stops.
+  void reset();
+
+ private:
+  struct Segment {
+    int64_t timestamp_us;  // Time of the segment's end point.
+    int32_t x;             // End point.
+    int32_t y;
+    float dx;
+    float dy;
+    float length;
+    float turn;            // Signed heading change from the previous segment.
+    uint8_t bin;           // Direction histogram bin.
+    bool reverses_x;       // Horizontal direction flipped at this segment.
+    bool reverses_y;       // Vertical direction flipped at this segment.
+  };
+
+  const Segment& segment(size_t age) const;
+  void push_segment(const Segment& segment);
+  void pop_oldest();
+  void expire(int64_t now_us);
+  void restart(int32_t x, int32_t y, int64_t timestamp_us);
+
+  bool tangled() const;
+  bool check_swipe(GestureEvent* out) const;
+  bool check_circle(GestureEvent* out) const;
+  bool check_shake(GestureEvent* out) const;
+  bool check_scribble(GestureEvent* out) const;
+  void centroid(int32_t* x, int32_t* y) const;
+  void bounds(int32_t* width, int32_t* height) const;
+
+  Segment segments_[kMaxSegments];
+  size_t head_;   // Index of the oldest segment.
+  size_t count_;
+
+  // Last resampled point.
+  bool has_anchor_;
+  int32_t anchor_x_;
+  int32_t anchor_y_;
+  int64_t anchor_time_us_;
+  float last_dx_;  // Smoothed unit heading.
+  float last_dy_;
+  int last_sign_x_;
+  int last_sign_y_;
+
+  // Running features over the window. Doubles, so the add/subtract updates
+  // do not drift over long continuous motion.
+  double path_length_;
+  double net_turn_;
+  double abs_turn_;
+  double histogram_[kDirectionBins];
+  int reversals_x_;
+  int reversals_y_;
+
+  // No new gesture before this time.
+  int64_t quiet_until_us_;
+};
+
+#endif  // GESTURE_RECOGNIZER_H_
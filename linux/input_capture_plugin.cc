@@ -3,7 +3,6 @@
 #include <flutter_linux/flutter_linux.h>
 #include <gtk/gtk.h>
 #include <X11/Xlib.h>
-#include <X11/XKBlib.h>
 #include <X11/extensions/record.h>
 #include <X11/keysym.h>
 #include <pthread.h>
@@ -11,6 +10,23 @@
 #include <cstring>
 #include <map>
 #include <string>
+#include <utility>
+#include <vector>
+
+#include "capture_backend.h"
+#include "captured_event.h"
+#include "event_merger.h"
+#include "event_pipeline.h"
+#include "gesture_recognizer.h"
+#include "input_state.h"
+#include "log.h"
+#include "pipeline_stats.h"
+#include "power_monitor.h"
+#include "session_journal.h"
+#include "startup_cache.h"
+#include "view_input_filter.h"
+#include "window_control_plugin.h"
+#include "x_latency_probe.h"
 
 #define INPUT_CAPTURE_PLUGIN(obj) \
   (G_TYPE_CHECK_INSTANCE_CAST((obj), input_capture_plugin_get_type(), \
@@ -19,15 +35,133 @@
 struct _InputCapturePlugin {
   GObject parent_instance;
 
+  // View whose window "initializeSession" makes fullscreen (weak).
+  FlView* view;
+
   FlMethodChannel* method_channel;
   FlEventChannel* event_channel;
+  FlEventChannel* batch_channel;
+  FlEventChannel* gesture_channel;
+  FlEventChannel* power_channel;
+  FlEventChannel* hud_channel;
+
+  // Whether Dart is listening on each event channel. Events are only encoded
+  // for channels that have a listener.
+  gint event_listening;
+  gint batch_listening;
+  gint gesture_listening;
+  gint power_listening;
+  gint hud_listening;
+
+  // Key chord that toggles the performance HUD, checked on key presses
+  // while Dart listens on the HUD channel: an X keysym and the exact
+  // CapturedModifier bits held with it.
+  gint hud_keysym;
+  gint hud_modifiers;
+
+  // Pointer gesture recognizer, fed from the record and replay threads.
+  GMutex gesture_lock;
+  GestureRecognizer* gestures;
+
+  // Packed event records waiting for the next batch flush on the platform
+  // thread.
+  GMutex batch_lock;
+  std::vector<uint8_t>* batch;
+  bool batch_flush_scheduled;
+
+  // Batches Dart still accepts before granting more credits; -1 when the
+  // listener does not use flow control. Guarded by batch_lock, as are the
+  // counters of events merged (out of credits or under power pressure) or
+  // dropped (out of credits).
+  gint batch_credits;
+  // Listen generation sent by Dart; grants for another one were in flight
+  // across a cancel and listen and are ignored.
+  gint64 batch_generation;
+  guint64 batch_coalesced;
+  guint64 batch_dropped;
+
+  // Thermal and power monitoring, polled on the platform thread while
+  // capturing or while Dart listens for power status. [power_tier] is read
+  // by the record thread to pick the coalescing policy.
+  PowerMonitor* power_monitor;
+  guint power_timer;
+  gint power_tier;
+  PowerReadings power_sent;
+  bool power_sent_valid;
+
+  // While capturing, polling pauses after kIdlePowerPolls polls without
+  // input ([input_idle]) and the record thread resumes it on the next
+  // event. [input_seen] is set by the record thread between polls.
+  gint input_seen;
+  gint input_idle;
+  guint idle_power_polls;
 
   Display* display;
   Display* record_display;
+
+  // Extension probe and keymap of [display], from the startup cache when
+  // it is valid for this server, keymap and build.
+  StartupCache* startup_cache;
   XRecordContext record_context;
   pthread_t record_thread;
   bool is_capturing;
-  bool thread_running;
+
+  // Capture loop to run, picked by the self-benchmark or the default.
+  // Applied by start_capture; a new selection restarts a running capture.
+  BackendSelection* backend_selection;
+
+  // Capture loop of the running record thread, fixed by start_capture.
+  CaptureBackend capture_backend;
+
+  // Self-benchmark running on its own thread, so probing never blocks the
+  // platform thread. backend_selected_idle moves its result into
+  // backend_selection and answers backend_call, if a call waits for it.
+  pthread_t backend_thread;
+  bool backend_selecting;
+  bool backend_rerun;
+  BackendSelection* backend_result;
+  FlMethodCall* backend_call;
+
+  // "initializeSession" call waiting for a first-run self-benchmark, which
+  // finishes before capture starts so its probes are not captured, and
+  // the arguments to finish it with.
+  FlMethodCall* session_call;
+  bool session_fullscreen;
+  bool session_capture;
+  gint64 session_start_us;
+
+  // Times X server round trips on a side connection while capturing, so
+  // the stats separate a slow server from a slow pipeline.
+  XLatencyProbe* server_probe;
+
+  // Offset from g_get_monotonic_time() to g_get_real_time(), fixed at init.
+  gint64 realtime_offset_us;
+
+  // Session journal, appended to from the record thread.
+  GMutex journal_lock;
+  JournalWriter* journal;
+
+  // Merges live capture and replay into one timestamp-ordered stream; its
+  // sink is dispatch_event(). Source ids are -1 while inactive.
+  EventMerger* merger;
+  int live_source;
+  int replay_source;
+
+  // Stages every merged event runs through: filter, repeat_collapse,
+  // coalesce, analytics, pattern and deliver. Configured by Dart
+  // ("configurePipeline").
+  EventPipeline* pipeline;
+
+  // Journal replay, driven by its own thread.
+  pthread_t replay_thread;
+  bool replay_running;
+  gint replay_cancel;
+  gchar* replay_path;
+  gint64 replay_from_us;
+  double replay_rate;
+  guint64 replay_events;
+  gchar* replay_error;
+  FlMethodCall* replay_call;
 };
 
 G_DEFINE_TYPE(InputCapturePlugin, input_capture_plugin, g_object_get_type())
@@ -38,7 +172,51 @@ static void stop_capture(InputCapturePlugin* self);
 static void* record_thread_func(void* arg);
 static void record_event_callback(XPointer closure, XRecordInterceptData* data);
 static void send_event_to_dart(InputCapturePlugin* self, FlValue* event_data);
+static void recognize_gesture(InputCapturePlugin* self,
+                              const CapturedEvent* event, gint64 timestamp_us);
+static void dispatch_event(InputCapturePlugin* self, const CapturedEvent* event,
+                           gint64 timestamp_us);
+static void queue_event_record(InputCapturePlugin* self,
+                               const CapturedEvent* event, gint64 timestamp_us);
 static const char* keycode_to_string(KeySym keysym);
+static FlMethodResponse* start_journal(InputCapturePlugin* self, FlValue* args);
+static FlMethodResponse* stop_journal(InputCapturePlugin* self);
+static bool start_replay(InputCapturePlugin* self, FlMethodCall* method_call);
+static FlMethodResponse* grant_event_credits(InputCapturePlugin* self,
+                                             FlValue* args);
+static FlMethodResponse* set_log_level(FlValue* args);
+static FlValue* power_status_to_fl_value(InputCapturePlugin* self);
+static void update_power_polling(InputCapturePlugin* self);
+static void note_input_activity(InputCapturePlugin* self);
+static FlMethodResponse* dump_log();
+static FlValue* capabilities_to_fl_value(InputCapturePlugin* self);
+static bool record_available(InputCapturePlugin* self);
+static FlMethodResponse* initialize_session(InputCapturePlugin* self,
+                                            FlMethodCall* method_call);
+static FlMethodResponse* finish_session(InputCapturePlugin* self,
+                                        bool want_fullscreen,
+                                        bool want_capture, bool selected,
+                                        gint64 start_us);
+static FlMethodResponse* set_merge_window(InputCapturePlugin* self,
+                                          FlValue* args);
+static FlMethodResponse* set_hud_chord(InputCapturePlugin* self,
+                                       FlValue* args);
+static void check_hud_chord(InputCapturePlugin* self,
+                            const CapturedEvent* event);
+static bool parse_hud_chord(const gchar* spec, guint* keysym,
+                            guint* modifiers);
+static void build_pipeline(InputCapturePlugin* self);
+static FlValue* pipeline_to_fl_value(InputCapturePlugin* self,
+                                     bool reset_timings);
+static FlMethodResponse* configure_pipeline(InputCapturePlugin* self,
+                                            FlValue* args);
+static FlMethodResponse* set_pipeline_timing(InputCapturePlugin* self,
+                                             FlValue* args);
+static FlValue* backend_selection_to_fl_value(InputCapturePlugin* self);
+static bool start_backend_selection(InputCapturePlugin* self, bool rerun,
+                                    FlMethodCall* method_call);
+static FlMethodResponse* select_capture_backend(InputCapturePlugin* self,
+                                                FlMethodCall* method_call);
 
 // Method channel callback
 static void method_call_cb(FlMethodChannel* channel, FlMethodCall* method_call,
@@ -59,10 +237,18 @@ static void method_call_cb(FlMethodChannel* channel, FlMethodCall* method_call,
   } else if (strcmp(method, "isCapturing") == 0) {
     g_autoptr(FlValue) result = fl_value_new_bool(self->is_capturing);
     response = FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+  } else if (strcmp(method, "initializeSession") == 0) {
+    // Responds asynchronously if the self-benchmark must run first.
+    response = initialize_session(self, method_call);
+    if (response == nullptr) {
+      return;
+    }
+  } else if (strcmp(method, "getCapabilities") == 0) {
+    g_autoptr(FlValue) result = capabilities_to_fl_value(self);
+    response = FL_METHOD_RESPONSE(fl_method_success_response_new(result));
   } else if (strcmp(method, "checkPermissions") == 0) {
     // On Linux, we check if X11 RECORD extension is available
-    int major = 0, minor = 0;
-    bool has_record = XRecordQueryVersion(self->display, &major, &minor);
+    bool has_record = record_available(self);
 
     g_autoptr(FlValue) result = fl_value_new_map();
     fl_value_set_string_take(result, "x11_record",
@@ -71,10 +257,58 @@ static void method_call_cb(FlMethodChannel* channel, FlMethodCall* method_call,
   } else if (strcmp(method, "requestPermissions") == 0) {
     // On Linux, permissions are handled by the system
     // Just return true if RECORD extension is available
-    int major = 0, minor = 0;
-    bool has_record = XRecordQueryVersion(self->display, &major, &minor);
+    bool has_record = record_available(self);
     g_autoptr(FlValue) result = fl_value_new_bool(has_record);
     response = FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+  } else if (strcmp(method, "startJournal") == 0) {
+    response = start_journal(self, fl_method_call_get_args(method_call));
+  } else if (strcmp(method, "stopJournal") == 0) {
+    response = stop_journal(self);
+  } else if (strcmp(method, "replayJournal") == 0) {
+    // Responds asynchronously once the replay has finished.
+    if (start_replay(self, method_call)) {
+      return;
+    }
+    response = FL_METHOD_RESPONSE(fl_method_error_response_new(
+        "REPLAY_BUSY", "A journal replay is already running", nullptr));
+  } else if (strcmp(method, "grantEventCredits") == 0) {
+    response = grant_event_credits(self, fl_method_call_get_args(method_call));
+  } else if (strcmp(method, "getPowerStatus") == 0) {
+    self->power_monitor->update();
+    g_atomic_int_set(&self->power_tier, self->power_monitor->tier());
+    g_autoptr(FlValue) result = power_status_to_fl_value(self);
+    response = FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+  } else if (strcmp(method, "setLogLevel") == 0) {
+    response = set_log_level(fl_method_call_get_args(method_call));
+  } else if (strcmp(method, "dumpLog") == 0) {
+    response = dump_log();
+  } else if (strcmp(method, "selectCaptureBackend") == 0) {
+    // Responds asynchronously once the self-benchmark has finished.
+    response = select_capture_backend(self, method_call);
+    if (response == nullptr) {
+      return;
+    }
+  } else if (strcmp(method, "configurePipeline") == 0) {
+    response = configure_pipeline(self, fl_method_call_get_args(method_call));
+  } else if (strcmp(method, "setPipelineTiming") == 0) {
+    response = set_pipeline_timing(self, fl_method_call_get_args(method_call));
+  } else if (strcmp(method, "getPipeline") == 0) {
+    FlValue* args = fl_method_call_get_args(method_call);
+    FlValue* reset = args != nullptr && fl_value_get_type(args) == FL_VALUE_TYPE_MAP
+                         ? fl_value_lookup_string(args, "resetTimings")
+                         : nullptr;
+    g_autoptr(FlValue) result = pipeline_to_fl_value(
+        self, reset != nullptr && fl_value_get_type(reset) == FL_VALUE_TYPE_BOOL &&
+                  fl_value_get_bool(reset));
+    response = FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+  } else if (strcmp(method, "setHudChord") == 0) {
+    response = set_hud_chord(self, fl_method_call_get_args(method_call));
+  } else if (strcmp(method, "setMergeWindow") == 0) {
+    response = set_merge_window(self, fl_method_call_get_args(method_call));
+  } else if (strcmp(method, "stopReplay") == 0) {
+    g_atomic_int_set(&self->replay_cancel, 1);
+    g_autoptr(FlValue) result = fl_value_new_bool(self->replay_running);
+    response = FL_METHOD_RESPONSE(fl_method_success_response_new(result));
   } else {
     response = FL_METHOD_RESPONSE(fl_method_not_implemented_response_new());
   }
@@ -82,17 +316,192 @@ static void method_call_cb(FlMethodChannel* channel, FlMethodCall* method_call,
   fl_method_call_respond(method_call, response, nullptr);
 }
 
+// Whether the X server offers RECORD, asked now. Permission checks do not
+// use the startup cache: they must reflect the server as it is, e.g. after
+// the user was told to enable the extension and restarted it.
+static bool record_available(InputCapturePlugin* self) {
+  int major = 0;
+  int minor = 0;
+  return self->display != nullptr &&
+         XRecordQueryVersion(self->display, &major, &minor);
+}
+
+// Describes what this backend supports
+static FlValue* capabilities_to_fl_value(InputCapturePlugin* self) {
+  // Probed once per server, keymap and build; see StartupCache.
+  const StartupProbes& probes = self->startup_cache->probes();
+  const bool has_record = probes.has_record != 0;
+
+  FlValue* result = fl_value_new_map();
+  fl_value_set_string_take(result, "x11_record", fl_value_new_bool(has_record));
+  if (has_record) {
+    g_autofree gchar* version =
+        g_strdup_printf("%d.%d", probes.record_major, probes.record_minor);
+    fl_value_set_string_take(result, "recordVersion",
+                             fl_value_new_string(version));
+  }
+  fl_value_set_string_take(result, "eventBatches", fl_value_new_bool(TRUE));
+  fl_value_set_string_take(result, "gestures", fl_value_new_bool(TRUE));
+  fl_value_set_string_take(result, "powerStatus", fl_value_new_bool(TRUE));
+  fl_value_set_string_take(result, "pipelineStats", fl_value_new_bool(TRUE));
+  fl_value_set_string_take(result, "startupCached",
+                           fl_value_new_bool(self->startup_cache->hit()));
+  fl_value_set_string_take(result, "captureBackend",
+                           backend_selection_to_fl_value(self));
+
+  FlValue* codecs = fl_value_new_list();
+  static const struct {
+    JournalCodec codec;
+    const char* name;
+  } kCodecs[] = {{kJournalCodecNone, "none"},
+                 {kJournalCodecLz4, "lz4"},
+                 {kJournalCodecZstd, "zstd"}};
+  for (const auto& entry : kCodecs) {
+    if (journal_codec_available(entry.codec)) {
+      fl_value_append_take(codecs, fl_value_new_string(entry.name));
+    }
+  }
+  fl_value_set_string_take(result, "journalCompression", codecs);
+  return result;
+}
+
+// Handles "initializeSession": settles the capture backend, requests
+// fullscreen and starts capture in one round trip, timing each step.
+//
+// With "selectBackend", the backend the self-benchmark cached for this
+// machine and server is applied before capture starts. On the first run
+// there is none: the benchmark then runs on its own thread before capture
+// starts, as capture would see its probes, and the call is answered
+// asynchronously once it is done; this returns nullptr.
+static FlMethodResponse* initialize_session(InputCapturePlugin* self,
+                                            FlMethodCall* method_call) {
+  FlValue* args = fl_method_call_get_args(method_call);
+  bool want_fullscreen = true;
+  bool want_capture = true;
+  bool want_backend_selection = false;
+  if (args != nullptr && fl_value_get_type(args) == FL_VALUE_TYPE_MAP) {
+    FlValue* value = fl_value_lookup_string(args, "fullscreen");
+    if (value != nullptr && fl_value_get_type(value) == FL_VALUE_TYPE_BOOL) {
+      want_fullscreen = fl_value_get_bool(value);
+    }
+    value = fl_value_lookup_string(args, "capture");
+    if (value != nullptr && fl_value_get_type(value) == FL_VALUE_TYPE_BOOL) {
+      want_capture = fl_value_get_bool(value);
+    }
+    value = fl_value_lookup_string(args, "selectBackend");
+    if (value != nullptr && fl_value_get_type(value) == FL_VALUE_TYPE_BOOL) {
+      want_backend_selection = fl_value_get_bool(value);
+    }
+  }
+
+  if (self->session_call != nullptr) {
+    return FL_METHOD_RESPONSE(fl_method_error_response_new(
+        "BUSY", "A session is already being initialized", nullptr));
+  }
+
+  const gint64 start_us = g_get_monotonic_time();
+  const bool selected = want_backend_selection && want_capture &&
+                        !self->is_capturing && record_available(self);
+  if (selected &&
+      !capture_backend_cached(self->display, self->backend_selection)) {
+    // Joins a benchmark that selectCaptureBackend started, if one runs.
+    if (self->backend_selecting ||
+        start_backend_selection(self, false, nullptr)) {
+      self->session_call = FL_METHOD_CALL(g_object_ref(method_call));
+      self->session_fullscreen = want_fullscreen;
+      self->session_capture = want_capture;
+      self->session_start_us = start_us;
+      return nullptr;
+    }
+  }
+  return finish_session(self, want_fullscreen, want_capture, selected,
+                        start_us);
+}
+
+// Finishes "initializeSession" once the capture backend is settled. The
+// capabilities are described last, so they name the backend capture runs
+// with.
+//
+// Fullscreen is only requested here; the window manager applies it
+// asynchronously, so it completes while capture starts.
+static FlMethodResponse* finish_session(InputCapturePlugin* self,
+                                        bool want_fullscreen,
+                                        bool want_capture, bool selected,
+                                        gint64 start_us) {
+  g_autoptr(FlValue) timings = fl_value_new_map();
+  gint64 step_us = g_get_monotonic_time();
+  if (selected) {
+    fl_value_set_string_take(timings, "backend",
+                             fl_value_new_int(step_us - start_us));
+  }
+
+  const bool has_record = record_available(self);
+  gint64 now_us = g_get_monotonic_time();
+  fl_value_set_string_take(timings, "probe",
+                           fl_value_new_int(now_us - step_us));
+  step_us = now_us;
+
+  bool fullscreen = false;
+  if (want_fullscreen) {
+    fullscreen = window_control_enter_fullscreen(self->view, TRUE);
+    if (!fullscreen) {
+      LOG_WARNING("InputCapture", "No window to make fullscreen");
+    }
+    now_us = g_get_monotonic_time();
+    fl_value_set_string_take(timings, "fullscreen",
+                             fl_value_new_int(now_us - step_us));
+    step_us = now_us;
+  }
+
+  // Without RECORD there is nothing to start; Dart reports the missing
+  // permission.
+  if (want_capture && has_record) {
+    start_capture(self);
+    now_us = g_get_monotonic_time();
+    fl_value_set_string_take(timings, "capture",
+                             fl_value_new_int(now_us - step_us));
+    step_us = now_us;
+  }
+  fl_value_set_string_take(timings, "total",
+                           fl_value_new_int(step_us - start_us));
+
+  g_autoptr(FlValue) result = fl_value_new_map();
+  FlValue* permissions = fl_value_new_map();
+  fl_value_set_string_take(permissions, "x11_record",
+                           fl_value_new_bool(has_record));
+  fl_value_set_string_take(result, "permissions", permissions);
+  fl_value_set_string_take(result, "capabilities",
+                           capabilities_to_fl_value(self));
+  fl_value_set_string_take(result, "fullscreen", fl_value_new_bool(fullscreen));
+  fl_value_set_string_take(result, "capturing",
+                           fl_value_new_bool(self->is_capturing));
+  fl_value_set_string(result, "timings", timings);
+
+  LOG_INFO("InputCapture", "Session initialized in %lld us",
+           static_cast<long long>(step_us - start_us));
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+}
+
+// How far behind the monotonic clock an event's timestamp may be when it
+// reaches the merger, for sources that stamp events as they arrive (live
+// capture and replay re-emission): the time between stamping and pushing.
+static const gint64 kStampedOnArrivalDelayUs = 2000;
+
 // Start capturing input
 static void start_capture(InputCapturePlugin* self) {
   if (self->is_capturing) {
-    g_print("InputCapture: Already capturing\n");
+    LOG_DEBUG("InputCapture", "Already capturing");
     return;
   }
 
+  // The keymap table is read by the record thread; pick up layout changes
+  // made since startup before it runs.
+  self->startup_cache->refresh(self->display);
+
   // Create a separate display connection for recording
   self->record_display = XOpenDisplay(nullptr);
   if (!self->record_display) {
-    g_print("InputCapture: Failed to open display for recording\n");
+    LOG_ERROR("InputCapture", "Failed to open display for recording");
     return;
   }
 
@@ -100,7 +509,7 @@ static void start_capture(InputCapturePlugin* self) {
   XRecordClientSpec clients = XRecordAllClients;
   XRecordRange* range = XRecordAllocRange();
   if (!range) {
-    g_print("InputCapture: Failed to allocate record range\n");
+    LOG_ERROR("InputCapture", "Failed to allocate record range");
     XCloseDisplay(self->record_display);
     self->record_display = nullptr;
     return;
@@ -117,28 +526,35 @@ static void start_capture(InputCapturePlugin* self) {
   XFree(range);
 
   if (!self->record_context) {
-    g_print("InputCapture: Failed to create record context\n");
+    LOG_ERROR("InputCapture", "Failed to create record context");
     XCloseDisplay(self->record_display);
     return;
   }
 
   // Start the recording thread
+  self->live_source =
+      self->merger->add_source("xrecord", kStampedOnArrivalDelayUs);
   self->is_capturing = true;
-  self->thread_running = true;
+  self->capture_backend = self->backend_selection->backend;
   pthread_create(&self->record_thread, nullptr, record_thread_func, self);
 
-  g_print("InputCapture: Started successfully\n");
+  view_input_filter_set_capture_active(TRUE);
+  self->server_probe->start();
+  g_atomic_int_set(&self->input_idle, 0);
+  self->idle_power_polls = 0;
+  update_power_polling(self);
+  LOG_INFO("InputCapture", "Started successfully");
 }
 
 // Stop capturing input
 static void stop_capture(InputCapturePlugin* self) {
   if (!self->is_capturing) {
-    g_print("InputCapture: Not currently capturing\n");
+    LOG_DEBUG("InputCapture", "Not currently capturing");
     return;
   }
 
   self->is_capturing = false;
-  self->thread_running = false;
+  view_input_filter_set_capture_active(FALSE);
 
   // Disable the record context using the main display (thread-safe)
   // Must use a different display than the one blocked in XRecordEnableContext
@@ -147,9 +563,21 @@ static void stop_capture(InputCapturePlugin* self) {
     XFlush(self->display);
   }
 
-  // Wait for thread to finish
+  // Wait for thread to finish; it first delivers what the server sent up
+  // to the disable.
   pthread_join(self->record_thread, nullptr);
 
+  // Emit what the merger still holds from the live source.
+  self->merger->remove_source(self->live_source);
+  self->live_source = -1;
+  EventMergerStats merge = self->merger->stats();
+  LOG_DEBUG("InputCapture",
+            "Merger: %llu emitted, %llu expired, %llu overflowed, %llu late",
+            static_cast<unsigned long long>(merge.emitted),
+            static_cast<unsigned long long>(merge.expired),
+            static_cast<unsigned long long>(merge.overflowed),
+            static_cast<unsigned long long>(merge.late));
+
   // Now free the context using the record display
   if (self->record_context && self->record_display) {
     XRecordFreeContext(self->record_display, self->record_context);
@@ -162,136 +590,511 @@ static void stop_capture(InputCapturePlugin* self) {
     self->record_display = nullptr;
   }
 
-  g_print("InputCapture: Stopped successfully\n");
+  // Releases are no longer seen; don't leave keys or buttons held.
+  input_state_instance()->release_all();
+  self->pipeline->reset();
+
+  g_mutex_lock(&self->gesture_lock);
+  self->gestures->reset();
+  g_mutex_unlock(&self->gesture_lock);
+
+  XLatencyProbeSummary probe = self->server_probe->stop();
+  LOG_DEBUG("InputCapture",
+            "Server probe: %llu probes, %llu timeouts, round trip mean %lld "
+            "us, max %lld us",
+            static_cast<unsigned long long>(probe.probes),
+            static_cast<unsigned long long>(probe.timeouts),
+            static_cast<long long>(probe.mean_round_trip_us),
+            static_cast<long long>(probe.max_round_trip_us));
+
+  // Without capture there is no input to pause on.
+  g_atomic_int_set(&self->input_idle, 0);
+  update_power_polling(self);
+  LOG_INFO("InputCapture", "Stopped successfully");
 }
 
 // Thread function for recording events
 static void* record_thread_func(void* arg) {
   InputCapturePlugin* self = INPUT_CAPTURE_PLUGIN(arg);
+  pthread_setname_np(pthread_self(), "kp-capture");
 
-  // Enable the record context (this blocks until disabled)
-  XRecordEnableContext(self->record_display, self->record_context,
-                      record_event_callback, (XPointer)self);
+  // Runs the record context until it is disabled
+  capture_backend_run(self->capture_backend, self->record_display,
+                      self->record_context, record_event_callback,
+                      (XPointer)self);
 
   return nullptr;
 }
 
-// Callback for recorded events
-static void record_event_callback(XPointer closure, XRecordInterceptData* data) {
-  if (data->category != XRecordFromServer) {
-    XRecordFreeData(data);
-    return;
-  }
-
-  InputCapturePlugin* self = INPUT_CAPTURE_PLUGIN(closure);
-
-  // Parse the event
-  unsigned char* event_data = data->data;
+// Decodes a raw XRecord device event into a CapturedEvent.
+//
+// Returns false for event types that are not forwarded.
+static bool parse_record_event(InputCapturePlugin* self,
+                               const unsigned char* event_data,
+                               CapturedEvent* event) {
   int event_type = event_data[0] & 0x7F;
 
-  g_autoptr(FlValue) event_map = fl_value_new_map();
-
-  // Get timestamp
-  gint64 timestamp = g_get_real_time() / 1000; // Convert to milliseconds
-  fl_value_set_string_take(event_map, "timestamp", fl_value_new_int(timestamp));
+  memset(event, 0, sizeof(*event));
+  event->timestamp_us = g_get_monotonic_time();
+  // Server time is the CARD32 at bytes 4-7 of every device event
+  memcpy(&event->server_time_ms, event_data + 4, sizeof(uint32_t));
 
   switch (event_type) {
     case KeyPress:
     case KeyRelease: {
-      fl_value_set_string_take(event_map, "type",
-                              fl_value_new_string(event_type == KeyPress ? "keyDown" : "keyUp"));
+      event->type = event_type == KeyPress ? kCapturedKeyDown : kCapturedKeyUp;
 
       // Extract key code (byte 1)
       unsigned char keycode = event_data[1];
-      fl_value_set_string_take(event_map, "keyCode", fl_value_new_int(keycode));
+      event->code = keycode;
 
-      // Convert keycode to keysym (using XKB version to avoid deprecation)
-      KeySym keysym = XkbKeycodeToKeysym(self->display, keycode, 0, 0);
-      const char* key_string = keycode_to_string(keysym);
-      fl_value_set_string_take(event_map, "key", fl_value_new_string(key_string));
+      // Unshifted keysym, from the table loaded at startup
+      event->keysym = self->startup_cache->keysym(keycode);
 
       // Extract modifiers (byte 28-29)
       unsigned char modifier_state = event_data[28];
+      if (modifier_state & ShiftMask) event->modifiers |= kModifierShift;
+      if (modifier_state & ControlMask) event->modifiers |= kModifierControl;
+      if (modifier_state & Mod1Mask) event->modifiers |= kModifierAlt;
+      if (modifier_state & Mod4Mask) event->modifiers |= kModifierMeta;
+      return true;
+    }
+
+    case ButtonPress:
+    case ButtonRelease: {
+      // Extract button number (byte 1)
+      unsigned char button = event_data[1];
+      event->code = button;
+
+      // Handle scroll wheel (buttons 4, 5 for vertical, 6, 7 for horizontal)
+      if (button >= 4 && button <= 7 && event_type == ButtonPress) {
+        event->type = kCapturedMouseScroll;
+        if (button == 4) event->y = 1;        // Scroll up
+        else if (button == 5) event->y = -1;  // Scroll down
+        else if (button == 6) event->x = 1;   // Scroll left
+        else if (button == 7) event->x = -1;  // Scroll right
+      } else {
+        event->type =
+            event_type == ButtonPress ? kCapturedMouseDown : kCapturedMouseUp;
+        // Extract position (bytes 20-23 for root_x/root_y - absolute screen coordinates)
+        event->x = *(int16_t*)(event_data + 20);
+        event->y = *(int16_t*)(event_data + 22);
+      }
+      return true;
+    }
+
+    case MotionNotify: {
+      event->type = kCapturedMouseMove;
+      // Extract position (bytes 20-23 for root_x/root_y - absolute screen coordinates)
+      event->x = *(int16_t*)(event_data + 20);
+      event->y = *(int16_t*)(event_data + 22);
+      return true;
+    }
+  }
+
+  return false;
+}
+
+// Builds the event channel map for a captured event.
+static FlValue* event_to_fl_value(const CapturedEvent* event,
+                                  gint64 timestamp_ms) {
+  FlValue* event_map = fl_value_new_map();
+  fl_value_set_string_take(event_map, "timestamp", fl_value_new_int(timestamp_ms));
+
+  switch (event->type) {
+    case kCapturedKeyDown:
+    case kCapturedKeyUp: {
+      fl_value_set_string_take(event_map, "type",
+                              fl_value_new_string(event->type == kCapturedKeyDown ? "keyDown" : "keyUp"));
+      fl_value_set_string_take(event_map, "keyCode", fl_value_new_int(event->code));
+
+      const char* key_string = keycode_to_string(event->keysym);
+      fl_value_set_string_take(event_map, "key", fl_value_new_string(key_string));
+
       FlValue* modifiers = fl_value_new_list();
-      if (modifier_state & ShiftMask) {
+      if (event->modifiers & kModifierShift) {
         fl_value_append_take(modifiers, fl_value_new_string("shift"));
       }
-      if (modifier_state & ControlMask) {
+      if (event->modifiers & kModifierControl) {
         fl_value_append_take(modifiers, fl_value_new_string("control"));
       }
-      if (modifier_state & Mod1Mask) {  // Alt
+      if (event->modifiers & kModifierAlt) {
         fl_value_append_take(modifiers, fl_value_new_string("alt"));
       }
-      if (modifier_state & Mod4Mask) {  // Super/Meta
+      if (event->modifiers & kModifierMeta) {
         fl_value_append_take(modifiers, fl_value_new_string("meta"));
       }
       fl_value_set_string_take(event_map, "modifiers", modifiers);
+      break;
+    }
 
-      send_event_to_dart(self, event_map);
+    case kCapturedMouseScroll:
+      fl_value_set_string_take(event_map, "type", fl_value_new_string("mouseScroll"));
+      fl_value_set_string_take(event_map, "deltaX", fl_value_new_float(event->x));
+      fl_value_set_string_take(event_map, "deltaY", fl_value_new_float(event->y));
+      break;
+
+    case kCapturedMouseDown:
+    case kCapturedMouseUp: {
+      fl_value_set_string_take(event_map, "type",
+                              fl_value_new_string(event->type == kCapturedMouseDown ? "mouseDown" : "mouseUp"));
+
+      const char* button_name = "other";
+      if (event->code == 1) button_name = "left";
+      else if (event->code == 2) button_name = "middle";
+      else if (event->code == 3) button_name = "right";
+
+      fl_value_set_string_take(event_map, "button", fl_value_new_string(button_name));
+      fl_value_set_string_take(event_map, "x", fl_value_new_float(event->x));
+      fl_value_set_string_take(event_map, "y", fl_value_new_float(event->y));
       break;
     }
 
-    case ButtonPress:
-    case ButtonRelease: {
-      // Extract button number (byte 1)
-      unsigned char button = event_data[1];
+    case kCapturedMouseMove:
+      fl_value_set_string_take(event_map, "type", fl_value_new_string("mouseMove"));
+      fl_value_set_string_take(event_map, "x", fl_value_new_float(event->x));
+      fl_value_set_string_take(event_map, "y", fl_value_new_float(event->y));
+      break;
+  }
 
-      // Extract position (bytes 20-23 for root_x/root_y - absolute screen coordinates)
-      int16_t x = *(int16_t*)(event_data + 20);
-      int16_t y = *(int16_t*)(event_data + 22);
+  return event_map;
+}
 
-      // Handle scroll wheel (buttons 4, 5 for vertical, 6, 7 for horizontal)
-      if (button >= 4 && button <= 7 && event_type == ButtonPress) {
-        fl_value_set_string_take(event_map, "type", fl_value_new_string("mouseScroll"));
+// Sends a captured or replayed event to Dart, stamped with [timestamp_us]
+// (wall clock, microseconds), through the enabled pipeline stages.
+static void dispatch_event(InputCapturePlugin* self, const CapturedEvent* event,
+                           gint64 timestamp_us) {
+  LOG_TRACE("InputCapture", "event %d code %u at %d,%d", event->type,
+            event->code, event->x, event->y);
+  self->pipeline->run(*event, timestamp_us);
+}
 
-        double deltaX = 0.0;
-        double deltaY = 0.0;
-        if (button == 4) deltaY = 1.0;      // Scroll up
-        else if (button == 5) deltaY = -1.0; // Scroll down
-        else if (button == 6) deltaX = 1.0;  // Scroll left
-        else if (button == 7) deltaX = -1.0; // Scroll right
+// "analytics" stage: latest input state and pipeline statistics.
+static bool analytics_stage(const CapturedEvent* event, gint64 timestamp_us) {
+  input_state_instance()->apply(*event, timestamp_us);
 
-        fl_value_set_string_take(event_map, "deltaX", fl_value_new_float(deltaX));
-        fl_value_set_string_take(event_map, "deltaY", fl_value_new_float(deltaY));
-      } else {
-        // Regular mouse button event
-        fl_value_set_string_take(event_map, "type",
-                                fl_value_new_string(event_type == ButtonPress ? "mouseDown" : "mouseUp"));
-
-        const char* button_name = "other";
-        if (button == 1) button_name = "left";
-        else if (button == 2) button_name = "middle";
-        else if (button == 3) button_name = "right";
-
-        fl_value_set_string_take(event_map, "button", fl_value_new_string(button_name));
-        fl_value_set_string_take(event_map, "x", fl_value_new_float(x));
-        fl_value_set_string_take(event_map, "y", fl_value_new_float(y));
-      }
+  PipelineStats* stats = pipeline_stats_instance();
+  stats->count_event(event->type);
+  stats->record_latency(kStageMerge,
+                        g_get_monotonic_time() - event->timestamp_us);
+  return true;
+}
 
-      send_event_to_dart(self, event_map);
-      break;
+// "pattern" stage: the HUD chord and pointer gestures, each only while
+// Dart listens for it.
+static bool pattern_stage(InputCapturePlugin* self, const CapturedEvent* event,
+                          gint64 timestamp_us) {
+  if (event->type == kCapturedKeyDown &&
+      g_atomic_int_get(&self->hud_listening)) {
+    check_hud_chord(self, event);
+  }
+  if (g_atomic_int_get(&self->gesture_listening)) {
+    recognize_gesture(self, event, timestamp_us);
+  }
+  return true;
+}
+
+// "deliver" stage: encodes the event for the channels Dart listens on and
+// queues or sends it.
+static bool deliver_stage(InputCapturePlugin* self, const CapturedEvent* event,
+                          gint64 timestamp_us) {
+  if (g_atomic_int_get(&self->batch_listening)) {
+    queue_event_record(self, event, timestamp_us);
+  }
+  if (g_atomic_int_get(&self->event_listening)) {
+    g_autoptr(FlValue) event_map = event_to_fl_value(event, timestamp_us / 1000);
+    send_event_to_dart(self, event_map);
+  }
+  return true;
+}
+
+// Adds the pipeline stages in order. The type filter and repeat collapse
+// come first, so events they drop cost the later stages nothing. Motion
+// coalescing only thins what Dart receives: the input state and the
+// gesture recognizer still see every motion event. The filtering stages
+// are off by default.
+static void build_pipeline(InputCapturePlugin* self) {
+  EventPipeline* pipeline = self->pipeline;
+  pipeline->add_stage(std::unique_ptr<EventStage>(new TypeFilterStage()),
+                      false);
+  pipeline->add_stage(std::unique_ptr<EventStage>(new RepeatCollapseStage()),
+                      false);
+  pipeline->add_stage(
+      std::unique_ptr<EventStage>(new CallbackStage(
+          "analytics",
+          [](CapturedEvent* event, int64_t dispatch_us) {
+            return analytics_stage(event, dispatch_us);
+          })),
+      true);
+  pipeline->add_stage(
+      std::unique_ptr<EventStage>(new CallbackStage(
+          "pattern",
+          [self](CapturedEvent* event, int64_t dispatch_us) {
+            return pattern_stage(self, event, dispatch_us);
+          })),
+      true);
+  pipeline->add_stage(std::unique_ptr<EventStage>(new MotionCoalesceStage()),
+                      false);
+  pipeline->add_stage(
+      std::unique_ptr<EventStage>(new CallbackStage(
+          "deliver",
+          [self](CapturedEvent* event, int64_t dispatch_us) {
+            return deliver_stage(self, event, dispatch_us);
+          })),
+      true);
+}
+
+// Callback for recorded events
+static void record_event_callback(XPointer closure, XRecordInterceptData* data) {
+  if (data->category != XRecordFromServer) {
+    XRecordFreeData(data);
+    return;
+  }
+
+  InputCapturePlugin* self = INPUT_CAPTURE_PLUGIN(closure);
+
+  PipelineStats* stats = pipeline_stats_instance();
+  stats->sample_capture_cpu();
+
+  CapturedEvent event;
+  if (parse_record_event(self, data->data, &event)) {
+    note_input_activity(self);
+
+    // Xorg and Xwayland stamp events with the monotonic clock in ms; other
+    // servers' stamps are not comparable and are skipped by the range check.
+    const int32_t capture_ms = static_cast<int32_t>(
+        static_cast<uint32_t>(event.timestamp_us / 1000) - event.server_time_ms);
+    if (capture_ms >= 0 && capture_ms < 10000) {
+      stats->record_latency(kStageCapture, int64_t{capture_ms} * 1000);
     }
 
-    case MotionNotify: {
-      fl_value_set_string_take(event_map, "type", fl_value_new_string("mouseMove"));
+    g_mutex_lock(&self->journal_lock);
+    if (self->journal != nullptr) {
+      self->journal->append(event);
+    }
+    g_mutex_unlock(&self->journal_lock);
 
-      // Extract position (bytes 20-23 for root_x/root_y - absolute screen coordinates)
-      int16_t x = *(int16_t*)(event_data + 20);
-      int16_t y = *(int16_t*)(event_data + 22);
-      fl_value_set_string_take(event_map, "x", fl_value_new_float(x));
-      fl_value_set_string_take(event_map, "y", fl_value_new_float(y));
+    self->merger->push(self->live_source, event,
+                       event.timestamp_us + self->realtime_offset_us);
+    const EventMergerStats merge = self->merger->stats();
+    stats->set_merge(merge.buffered, merge.late);
+  }
+
+  XRecordFreeData(data);
+}
+
+// Handles the "startJournal" method call.
+//
+// Arguments: {"path": String, "compression": "none" | "lz4" | "zstd"}. Without
+// a compression the best one compiled in is used.
+static FlMethodResponse* start_journal(InputCapturePlugin* self, FlValue* args) {
+  FlValue* path_value = args != nullptr && fl_value_get_type(args) == FL_VALUE_TYPE_MAP
+                            ? fl_value_lookup_string(args, "path")
+                            : nullptr;
+  if (path_value == nullptr || fl_value_get_type(path_value) != FL_VALUE_TYPE_STRING) {
+    return FL_METHOD_RESPONSE(fl_method_error_response_new(
+        "BAD_ARGS", "startJournal requires a path", nullptr));
+  }
+
+  JournalCodec codec = journal_codec_best();
+  FlValue* codec_value = fl_value_lookup_string(args, "compression");
+  if (codec_value != nullptr && fl_value_get_type(codec_value) == FL_VALUE_TYPE_STRING) {
+    codec = journal_codec_from_name(fl_value_get_string(codec_value));
+  }
+
+  JournalWriter* writer = new JournalWriter();
+  std::string error;
+  if (!writer->open(fl_value_get_string(path_value), codec,
+                    self->realtime_offset_us, &error)) {
+    delete writer;
+    return FL_METHOD_RESPONSE(fl_method_error_response_new(
+        "JOURNAL_FAILED", error.c_str(), nullptr));
+  }
+
+  g_mutex_lock(&self->journal_lock);
+  JournalWriter* previous = self->journal;
+  self->journal = writer;
+  g_mutex_unlock(&self->journal_lock);
+
+  if (previous != nullptr) {
+    previous->close();
+    delete previous;
+  }
+
+  g_autoptr(FlValue) result = fl_value_new_bool(TRUE);
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+}
+
+// Handles the "stopJournal" method call, returning the journal statistics.
+static FlMethodResponse* stop_journal(InputCapturePlugin* self) {
+  g_mutex_lock(&self->journal_lock);
+  JournalWriter* writer = self->journal;
+  self->journal = nullptr;
+  g_mutex_unlock(&self->journal_lock);
+
+  g_autoptr(FlValue) result = fl_value_new_map();
+  if (writer != nullptr) {
+    JournalStats stats = writer->close();
+    delete writer;
+    fl_value_set_string_take(result, "events", fl_value_new_int(stats.events));
+    fl_value_set_string_take(result, "dropped", fl_value_new_int(stats.dropped));
+    fl_value_set_string_take(result, "blocks", fl_value_new_int(stats.blocks));
+    fl_value_set_string_take(result, "rawBytes", fl_value_new_int(stats.raw_bytes));
+    fl_value_set_string_take(result, "fileBytes", fl_value_new_int(stats.file_bytes));
+    if (stats.error != 0) {
+      LOG_ERROR("InputCapture", "Journal write failed: %s", strerror(stats.error));
+      fl_value_set_string_take(result, "error",
+                               fl_value_new_string(strerror(stats.error)));
+    }
+  }
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+}
+
+// Idle callback that completes a replay on the platform thread.
+static gboolean replay_finished_idle(gpointer user_data) {
+  InputCapturePlugin* self = INPUT_CAPTURE_PLUGIN(user_data);
+
+  // Already joined if dispose cancelled the replay.
+  if (self->replay_running) {
+    pthread_join(self->replay_thread, nullptr);
+  }
+  self->replay_running = false;
+  self->replay_source = -1;
+
+  g_autoptr(FlMethodResponse) response = nullptr;
+  if (self->replay_error != nullptr) {
+    response = FL_METHOD_RESPONSE(fl_method_error_response_new(
+        "REPLAY_FAILED", self->replay_error, nullptr));
+  } else {
+    g_autoptr(FlValue) result = fl_value_new_map();
+    fl_value_set_string_take(result, "events",
+                             fl_value_new_int(self->replay_events));
+    fl_value_set_string_take(
+        result, "cancelled",
+        fl_value_new_bool(g_atomic_int_get(&self->replay_cancel) != 0));
+    response = FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+  }
+  fl_method_call_respond(self->replay_call, response, nullptr);
+
+  g_clear_object(&self->replay_call);
+  g_clear_pointer(&self->replay_path, g_free);
+  g_clear_pointer(&self->replay_error, g_free);
+  g_object_unref(self);
+
+  return G_SOURCE_REMOVE;
+}
+
+// Thread function for journal replay.
+//
+// Seeks to the requested offset through the block index, then emits events
+// on the original schedule scaled by the replay rate. A rate of zero or less
+// replays as fast as possible.
+static void* replay_thread_func(void* arg) {
+  InputCapturePlugin* self = INPUT_CAPTURE_PLUGIN(arg);
+  pthread_setname_np(pthread_self(), "kp-replay");
+
+  JournalReader reader;
+  std::string error;
+  if (!reader.open(self->replay_path, &error)) {
+    self->replay_error = g_strdup(error.c_str());
+    self->merger->remove_source(self->replay_source);
+    g_idle_add(replay_finished_idle, self);
+    return nullptr;
+  }
 
-      send_event_to_dart(self, event_map);
+  const int64_t start_ts = reader.start_time_us() + self->replay_from_us;
+  const gint64 wall_start = g_get_monotonic_time();
+  std::vector<uint8_t> scratch;
+  std::vector<CapturedEvent> events;
+
+  for (size_t block = reader.find_block(start_ts);
+       block < reader.block_count() && !g_atomic_int_get(&self->replay_cancel);
+       block++) {
+    events.clear();
+    if (!reader.decode_block(block, &scratch, &events)) {
+      self->replay_error = g_strdup("journal block is corrupt");
       break;
     }
+
+    for (const CapturedEvent& event : events) {
+      if (event.timestamp_us < start_ts) continue;
+      if (g_atomic_int_get(&self->replay_cancel)) break;
+
+      if (self->replay_rate > 0) {
+        gint64 due = wall_start + static_cast<gint64>(
+            (event.timestamp_us - start_ts) / self->replay_rate);
+        gint64 wait = due - g_get_monotonic_time();
+        if (wait > 0) {
+          g_usleep(wait);
+        }
+      }
+
+      // Replayed events are stamped with the time they are re-emitted so
+      // consumers see them exactly like live input, and merge with it.
+      CapturedEvent emitted = event;
+      emitted.timestamp_us = g_get_monotonic_time();
+      self->merger->push(self->replay_source, emitted,
+                         emitted.timestamp_us + self->realtime_offset_us);
+      self->replay_events++;
+    }
   }
 
-  XRecordFreeData(data);
+  // Emit what the merger still holds before the replay call completes.
+  self->merger->remove_source(self->replay_source);
+  g_idle_add(replay_finished_idle, self);
+  return nullptr;
+}
+
+// Starts replaying a journal for the "replayJournal" method call.
+//
+// Arguments: {"path": String, "fromUs": int, "rate": double}.
+// Returns false if a replay is already running.
+static bool start_replay(InputCapturePlugin* self, FlMethodCall* method_call) {
+  if (self->replay_running) {
+    return false;
+  }
+
+  FlValue* args = fl_method_call_get_args(method_call);
+  FlValue* path_value = args != nullptr && fl_value_get_type(args) == FL_VALUE_TYPE_MAP
+                            ? fl_value_lookup_string(args, "path")
+                            : nullptr;
+  FlValue* from_value = path_value ? fl_value_lookup_string(args, "fromUs") : nullptr;
+  FlValue* rate_value = path_value ? fl_value_lookup_string(args, "rate") : nullptr;
+
+  if (path_value == nullptr || fl_value_get_type(path_value) != FL_VALUE_TYPE_STRING) {
+    g_autoptr(FlMethodResponse) response = FL_METHOD_RESPONSE(
+        fl_method_error_response_new("BAD_ARGS", "replayJournal requires a path", nullptr));
+    fl_method_call_respond(method_call, response, nullptr);
+    return true;
+  }
+
+  self->replay_path = g_strdup(fl_value_get_string(path_value));
+  self->replay_from_us =
+      from_value != nullptr && fl_value_get_type(from_value) == FL_VALUE_TYPE_INT
+          ? fl_value_get_int(from_value)
+          : 0;
+  self->replay_rate =
+      rate_value != nullptr && fl_value_get_type(rate_value) == FL_VALUE_TYPE_FLOAT
+          ? fl_value_get_float(rate_value)
+          : 1.0;
+  self->replay_events = 0;
+  self->replay_error = nullptr;
+  self->replay_call = FL_METHOD_CALL(g_object_ref(method_call));
+  g_atomic_int_set(&self->replay_cancel, 0);
+
+  // Released by replay_finished_idle.
+  g_object_ref(self);
+  self->replay_source =
+      self->merger->add_source("replay", kStampedOnArrivalDelayUs);
+  self->replay_running = true;
+  pthread_create(&self->replay_thread, nullptr, replay_thread_func, self);
+  return true;
 }
 
 // Helper structure for marshalling events to the platform thread
 typedef struct {
   InputCapturePlugin* plugin;
+  FlEventChannel* channel;
   FlValue* event;
 } EventData;
 
@@ -299,8 +1102,8 @@ typedef struct {
 static gboolean send_event_idle(gpointer user_data) {
   EventData* data = (EventData*)user_data;
 
-  if (data->plugin->event_channel) {
-    fl_event_channel_send(data->plugin->event_channel, data->event, nullptr, nullptr);
+  if (data->channel) {
+    fl_event_channel_send(data->channel, data->event, nullptr, nullptr);
   }
 
   // Clean up
@@ -316,6 +1119,7 @@ static void send_event_to_dart(InputCapturePlugin* self, FlValue* event_data) {
     // Create event data for marshalling using GLib allocation
     EventData* data = g_new(EventData, 1);
     data->plugin = self;
+    data->channel = self->event_channel;
     data->event = fl_value_ref(event_data);
 
     // Schedule send on platform thread using GLib main loop
@@ -323,6 +1127,949 @@ static void send_event_to_dart(InputCapturePlugin* self, FlValue* event_data) {
   }
 }
 
+static const char* gesture_kind_name(uint8_t kind) {
+  switch (kind) {
+    case kGestureCircle: return "circle";
+    case kGestureShake: return "shake";
+    case kGestureScribble: return "scribble";
+    case kGestureSwipe: return "swipe";
+    default: return "unknown";
+  }
+}
+
+static const char* swipe_direction_name(uint8_t direction) {
+  switch (direction) {
+    case kSwipeRight: return "right";
+    case kSwipeDown: return "down";
+    case kSwipeLeft: return "left";
+    case kSwipeUp: return "up";
+    default: return "unknown";
+  }
+}
+
+// Feeds pointer motion to the gesture recognizer and sends recognized
+// gestures on the gesture channel (from any thread).
+//
+// Gesture map: {"gesture": name, "confidence": 0..1, "x", "y",
+// "timestamp": ms, "direction": name (swipes only)}.
+static void recognize_gesture(InputCapturePlugin* self,
+                              const CapturedEvent* event, gint64 timestamp_us) {
+  GestureEvent gesture;
+  bool recognized = false;
+
+  g_mutex_lock(&self->gesture_lock);
+  switch (event->type) {
+    case kCapturedMouseMove:
+      recognized =
+          self->gestures->add_sample(event->x, event->y, timestamp_us, &gesture);
+      break;
+    case kCapturedMouseDown:
+    case kCapturedMouseUp:
+      // Dragging and clicking are not gestures.
+      self->gestures->reset();
+      break;
+    default:
+      break;
+  }
+  g_mutex_unlock(&self->gesture_lock);
+
+  if (!recognized || self->gesture_channel == nullptr) {
+    return;
+  }
+
+  FlValue* gesture_map = fl_value_new_map();
+  fl_value_set_string_take(gesture_map, "gesture",
+                           fl_value_new_string(gesture_kind_name(gesture.kind)));
+  fl_value_set_string_take(gesture_map, "confidence",
+                           fl_value_new_float(gesture.confidence));
+  fl_value_set_string_take(gesture_map, "x", fl_value_new_float(gesture.x));
+  fl_value_set_string_take(gesture_map, "y", fl_value_new_float(gesture.y));
+  fl_value_set_string_take(gesture_map, "timestamp",
+                           fl_value_new_int(gesture.timestamp_us / 1000));
+  if (gesture.kind == kGestureSwipe) {
+    fl_value_set_string_take(
+        gesture_map, "direction",
+        fl_value_new_string(swipe_direction_name(gesture.direction)));
+  }
+
+  // Takes the reference.
+  EventData* data = g_new(EventData, 1);
+  data->plugin = self;
+  data->channel = self->gesture_channel;
+  data->event = gesture_map;
+  g_idle_add(send_event_idle, data);
+}
+
+// Size of one packed event record on the batch channel.
+//
+// Layout (little-endian), mirrored by the Dart CompactEventDecoder:
+//   0  int64   wall-clock timestamp in microseconds
+//   8  uint32  keysym (key events, 0 otherwise)
+//   12 int32   x (root position, or horizontal scroll delta)
+//   16 int32   y (root position, or vertical scroll delta)
+//   20 uint16  keycode or button number
+//   22 uint8   CapturedEventType
+//   23 uint8   CapturedModifier bits
+static const size_t kEventRecordSize = 24;
+
+static void put_le(uint8_t* out, uint64_t value, size_t size) {
+  for (size_t i = 0; i < size; i++) {
+    out[i] = static_cast<uint8_t>(value >> (8 * i));
+  }
+}
+
+static uint32_t get_le32(const uint8_t* in) {
+  return static_cast<uint32_t>(in[0]) | static_cast<uint32_t>(in[1]) << 8 |
+         static_cast<uint32_t>(in[2]) << 16 | static_cast<uint32_t>(in[3]) << 24;
+}
+
+// Upper bound on records held back while Dart has no credits. Motion and
+// scrolling are coalesced long before this is reached; it only bounds a
+// flood of key and button events.
+static const size_t kMaxPendingRecords = 4096;
+
+// Schedules a batch flush unless one is pending. Must hold batch_lock.
+static void schedule_batch_flush_locked(InputCapturePlugin* self);
+
+// Publishes the batch queue state to the pipeline stats. Must hold
+// batch_lock.
+static void publish_batch_stats_locked(InputCapturePlugin* self) {
+  pipeline_stats_instance()->set_batch(self->batch->size() / kEventRecordSize,
+                                       self->batch_coalesced,
+                                       self->batch_dropped);
+}
+
+// Idle callback that sends all queued records as one batch.
+//
+// Each batch costs one credit. Without credits the records stay queued (and
+// are coalesced) until Dart grants more through "grantEventCredits".
+static gboolean flush_event_batch_idle(gpointer user_data) {
+  InputCapturePlugin* self = INPUT_CAPTURE_PLUGIN(user_data);
+
+  std::vector<uint8_t> pending;
+  g_mutex_lock(&self->batch_lock);
+  self->batch_flush_scheduled = false;
+  if (self->batch_credits != 0) {
+    pending.swap(*self->batch);
+    if (!pending.empty() && self->batch_credits > 0) {
+      self->batch_credits--;
+    }
+  }
+  publish_batch_stats_locked(self);
+  g_mutex_unlock(&self->batch_lock);
+
+  if (!pending.empty()) {
+    // Records are in order, so the first one has waited longest.
+    uint64_t oldest_us = 0;
+    for (size_t i = 0; i < 8; i++) {
+      oldest_us |= static_cast<uint64_t>(pending[i]) << (8 * i);
+    }
+    pipeline_stats_instance()->record_latency(
+        kStageFlush, g_get_real_time() - static_cast<gint64>(oldest_us));
+  }
+
+  if (!pending.empty() && self->batch_channel) {
+    g_autoptr(FlValue) batch =
+        fl_value_new_uint8_list(pending.data(), pending.size());
+    fl_event_channel_send(self->batch_channel, batch, nullptr, nullptr);
+  }
+
+  // Hand the buffer back so its capacity is reused by the next batch.
+  pending.clear();
+  g_mutex_lock(&self->batch_lock);
+  if (self->batch->empty()) {
+    self->batch->swap(pending);
+  }
+  g_mutex_unlock(&self->batch_lock);
+
+  return G_SOURCE_REMOVE;
+}
+
+// Interval between batch flushes at kTierMinimal, instead of flushing as
+// soon as the platform thread is idle.
+static const guint kThrottledFlushIntervalMs = 33;
+
+static void schedule_batch_flush_locked(InputCapturePlugin* self) {
+  if (!self->batch_flush_scheduled) {
+    self->batch_flush_scheduled = true;
+    if (g_atomic_int_get(&self->power_tier) >= kTierMinimal) {
+      g_timeout_add(kThrottledFlushIntervalMs, flush_event_batch_idle, self);
+    } else {
+      g_idle_add(flush_event_batch_idle, self);
+    }
+  }
+}
+
+// Merges [event] into the last queued record if both are motion, or both
+// are scrolling. Must hold batch_lock.
+static bool coalesce_event_record_locked(InputCapturePlugin* self,
+                                         const CapturedEvent* event,
+                                         gint64 timestamp_us) {
+  if (self->batch->size() < kEventRecordSize) {
+    return false;
+  }
+  uint8_t* last = self->batch->data() + self->batch->size() - kEventRecordSize;
+  if (last[22] != event->type) {
+    return false;
+  }
+
+  switch (event->type) {
+    case kCapturedMouseMove:
+      // Only the latest position matters.
+      put_le(last + 12, static_cast<uint32_t>(event->x), 4);
+      put_le(last + 16, static_cast<uint32_t>(event->y), 4);
+      break;
+    case kCapturedMouseScroll:
+      // Scroll deltas add up.
+      put_le(last + 12, get_le32(last + 12) + static_cast<uint32_t>(event->x), 4);
+      put_le(last + 16, get_le32(last + 16) + static_cast<uint32_t>(event->y), 4);
+      break;
+    default:
+      return false;
+  }
+  put_le(last, static_cast<uint64_t>(timestamp_us), 8);
+  last[23] = event->modifiers;
+  return true;
+}
+
+// Appends a packed record for [event] to the pending batch (from any thread).
+//
+// Everything captured until the platform thread gets to the flush is sent
+// in a single message, so a burst of pointer motion costs one channel
+// message instead of one per event. While Dart is out of credits, motion
+// and scrolling are coalesced into the last queued record instead, so
+// memory and latency stay bounded however slow the UI isolate is. Under
+// thermal or power pressure (kTierReduced and up) they are always
+// coalesced, and at kTierMinimal batches are also sent less often.
+static void queue_event_record(InputCapturePlugin* self,
+                               const CapturedEvent* event, gint64 timestamp_us) {
+  const bool constrained =
+      g_atomic_int_get(&self->power_tier) >= kTierReduced;
+
+  g_mutex_lock(&self->batch_lock);
+  if (self->batch_credits == 0 || constrained) {
+    if (coalesce_event_record_locked(self, event, timestamp_us)) {
+      self->batch_coalesced++;
+      publish_batch_stats_locked(self);
+      g_mutex_unlock(&self->batch_lock);
+      return;
+    }
+  }
+  if (self->batch_credits == 0) {
+    if (self->batch->size() >= kMaxPendingRecords * kEventRecordSize) {
+      self->batch_dropped++;
+      publish_batch_stats_locked(self);
+      g_mutex_unlock(&self->batch_lock);
+      return;
+    }
+  }
+
+  size_t offset = self->batch->size();
+  self->batch->resize(offset + kEventRecordSize);
+  uint8_t* record = self->batch->data() + offset;
+  put_le(record, static_cast<uint64_t>(timestamp_us), 8);
+  put_le(record + 8, event->keysym, 4);
+  put_le(record + 12, static_cast<uint32_t>(event->x), 4);
+  put_le(record + 16, static_cast<uint32_t>(event->y), 4);
+  put_le(record + 20, event->code, 2);
+  record[22] = event->type;
+  record[23] = event->modifiers;
+  if (self->batch_credits != 0) {
+    schedule_batch_flush_locked(self);
+  }
+  publish_batch_stats_locked(self);
+  g_mutex_unlock(&self->batch_lock);
+}
+
+// Handles the "grantEventCredits" method call.
+//
+// Arguments: {"batches": int, "generation": int}. Returns {"coalesced": int,
+// "dropped": int}, the events merged or dropped for lack of credits so far.
+// Grants for another listen generation than the current one are ignored.
+static FlMethodResponse* grant_event_credits(InputCapturePlugin* self,
+                                             FlValue* args) {
+  FlValue* batches_value =
+      args != nullptr && fl_value_get_type(args) == FL_VALUE_TYPE_MAP
+          ? fl_value_lookup_string(args, "batches")
+          : nullptr;
+  if (batches_value == nullptr ||
+      fl_value_get_type(batches_value) != FL_VALUE_TYPE_INT ||
+      fl_value_get_int(batches_value) < 0) {
+    return FL_METHOD_RESPONSE(fl_method_error_response_new(
+        "BAD_ARGS", "grantEventCredits requires a batch count", nullptr));
+  }
+
+  FlValue* generation_value = fl_value_lookup_string(args, "generation");
+
+  g_autoptr(FlValue) result = fl_value_new_map();
+  g_mutex_lock(&self->batch_lock);
+  const bool stale =
+      generation_value != nullptr &&
+      fl_value_get_type(generation_value) == FL_VALUE_TYPE_INT &&
+      fl_value_get_int(generation_value) != self->batch_generation;
+  if (self->batch_credits >= 0 && !stale) {
+    self->batch_credits += static_cast<gint>(fl_value_get_int(batches_value));
+  }
+  if (self->batch_credits != 0 && !self->batch->empty()) {
+    schedule_batch_flush_locked(self);
+  }
+  fl_value_set_string_take(result, "coalesced",
+                           fl_value_new_int(self->batch_coalesced));
+  fl_value_set_string_take(result, "dropped",
+                           fl_value_new_int(self->batch_dropped));
+  g_mutex_unlock(&self->batch_lock);
+
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+}
+
+// Describes the capture backend in use and the self-benchmark behind it.
+static FlValue* backend_selection_to_fl_value(InputCapturePlugin* self) {
+  const BackendSelection& selection = *self->backend_selection;
+  FlValue* result = fl_value_new_map();
+  fl_value_set_string_take(
+      result, "name",
+      fl_value_new_string(capture_backend_name(selection.backend)));
+  fl_value_set_string_take(result, "cached",
+                           fl_value_new_bool(selection.cached));
+  fl_value_set_string_take(result, "measured",
+                           fl_value_new_bool(selection.measured));
+  fl_value_set_string_take(result, "elapsedUs",
+                           fl_value_new_int(selection.elapsed_us));
+
+  FlValue* measurements = fl_value_new_list();
+  for (const BackendMeasurement& m : selection.measurements) {
+    FlValue* entry = fl_value_new_map();
+    fl_value_set_string_take(
+        entry, "name", fl_value_new_string(capture_backend_name(m.backend)));
+    fl_value_set_string_take(entry, "available",
+                             fl_value_new_bool(m.available));
+    fl_value_set_string_take(entry, "probes", fl_value_new_int(m.probes));
+    fl_value_set_string_take(entry, "delivered",
+                             fl_value_new_int(m.delivered));
+    fl_value_set_string_take(entry, "medianLatencyUs",
+                             fl_value_new_int(m.median_latency_us));
+    fl_value_set_string_take(entry, "p95LatencyUs",
+                             fl_value_new_int(m.p95_latency_us));
+    fl_value_set_string_take(entry, "cpuUsPerEvent",
+                             fl_value_new_int(m.cpu_us_per_event));
+    fl_value_append_take(measurements, entry);
+  }
+  fl_value_set_string_take(result, "measurements", measurements);
+  return result;
+}
+
+// Idle callback that applies a finished self-benchmark on the platform
+// thread.
+static gboolean backend_selected_idle(gpointer user_data) {
+  InputCapturePlugin* self = INPUT_CAPTURE_PLUGIN(user_data);
+
+  // Already joined if dispose ran first.
+  if (self->backend_selecting) {
+    pthread_join(self->backend_thread, nullptr);
+    self->backend_selecting = false;
+  }
+
+  if (self->backend_selection != nullptr) {
+    *self->backend_selection = std::move(*self->backend_result);
+    // Capture was started while measuring; the result would otherwise wait
+    // for a restart that may never come.
+    if (self->is_capturing &&
+        self->backend_selection->backend != self->capture_backend) {
+      LOG_INFO("InputCapture", "Restarting capture with %s",
+               capture_backend_name(self->backend_selection->backend));
+      stop_capture(self);
+      start_capture(self);
+    }
+  }
+  delete self->backend_result;
+  self->backend_result = nullptr;
+
+  if (self->session_call != nullptr) {
+    g_autoptr(FlMethodResponse) response = nullptr;
+    if (self->backend_selection != nullptr) {
+      response = finish_session(self, self->session_fullscreen,
+                                self->session_capture, true,
+                                self->session_start_us);
+    } else {
+      response = FL_METHOD_RESPONSE(fl_method_error_response_new(
+          "DISPOSED", "The plugin was disposed", nullptr));
+    }
+    fl_method_call_respond(self->session_call, response, nullptr);
+    g_clear_object(&self->session_call);
+  }
+
+  if (self->backend_call != nullptr) {
+    g_autoptr(FlMethodResponse) response = nullptr;
+    if (self->backend_selection != nullptr) {
+      g_autoptr(FlValue) result = backend_selection_to_fl_value(self);
+      response = FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+    } else {
+      response = FL_METHOD_RESPONSE(fl_method_error_response_new(
+          "DISPOSED", "The plugin was disposed", nullptr));
+    }
+    fl_method_call_respond(self->backend_call, response, nullptr);
+    g_clear_object(&self->backend_call);
+  }
+
+  g_object_unref(self);
+  return G_SOURCE_REMOVE;
+}
+
+// Thread function for the capture backend self-benchmark.
+static void* backend_thread_func(void* arg) {
+  InputCapturePlugin* self = INPUT_CAPTURE_PLUGIN(arg);
+  pthread_setname_np(pthread_self(), "kp-backend");
+
+  *self->backend_result = capture_backend_select(self->backend_rerun);
+  g_idle_add(backend_selected_idle, self);
+  return nullptr;
+}
+
+// Starts the capture backend self-benchmark on its own thread. When it is
+// done, [method_call] (if any) is answered with the selection.
+//
+// Returns false if a self-benchmark is already running.
+static bool start_backend_selection(InputCapturePlugin* self, bool rerun,
+                                    FlMethodCall* method_call) {
+  if (self->backend_selecting) {
+    return false;
+  }
+
+  self->backend_rerun = rerun;
+  self->backend_result = new BackendSelection(capture_backend_default());
+  self->backend_call =
+      method_call != nullptr ? FL_METHOD_CALL(g_object_ref(method_call))
+                             : nullptr;
+
+  // Released by backend_selected_idle.
+  g_object_ref(self);
+  self->backend_selecting = true;
+  pthread_create(&self->backend_thread, nullptr, backend_thread_func, self);
+  return true;
+}
+
+// Handles the "selectCaptureBackend" method call.
+//
+// Arguments: {"rerun": bool}, to measure again despite a cached decision.
+// Answers asynchronously, with the selection as in getCapabilities, and
+// returns nullptr. Otherwise returns the error response: while capturing,
+// as the probes would be captured, or while a self-benchmark runs.
+static FlMethodResponse* select_capture_backend(InputCapturePlugin* self,
+                                                FlMethodCall* method_call) {
+  if (self->is_capturing) {
+    return FL_METHOD_RESPONSE(fl_method_error_response_new(
+        "BUSY", "Stop capture before selecting a backend", nullptr));
+  }
+
+  FlValue* args = fl_method_call_get_args(method_call);
+  bool rerun = false;
+  if (args != nullptr && fl_value_get_type(args) == FL_VALUE_TYPE_MAP) {
+    FlValue* value = fl_value_lookup_string(args, "rerun");
+    rerun = value != nullptr && fl_value_get_type(value) == FL_VALUE_TYPE_BOOL &&
+            fl_value_get_bool(value);
+  }
+
+  if (!start_backend_selection(self, rerun, method_call)) {
+    return FL_METHOD_RESPONSE(fl_method_error_response_new(
+        "BUSY", "A backend selection is already running", nullptr));
+  }
+  return nullptr;
+}
+
+// Handles the "setMergeWindow" method call.
+//
+// Arguments: {"us": int}, how long an event may wait for a lagging source
+// before it is emitted anyway. Returns the window now in effect.
+static FlMethodResponse* set_merge_window(InputCapturePlugin* self,
+                                          FlValue* args) {
+  FlValue* value = args != nullptr && fl_value_get_type(args) == FL_VALUE_TYPE_MAP
+                       ? fl_value_lookup_string(args, "us")
+                       : nullptr;
+  if (value == nullptr || fl_value_get_type(value) != FL_VALUE_TYPE_INT) {
+    return FL_METHOD_RESPONSE(fl_method_error_response_new(
+        "BAD_ARGS", "setMergeWindow requires us", nullptr));
+  }
+
+  self->merger->set_window_us(fl_value_get_int(value));
+  g_autoptr(FlValue) result = fl_value_new_int(self->merger->window_us());
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+}
+
+// Describes the pipeline stages in order: {"name", "enabled", "options",
+// "calls", "dropped", "totalNs", "maxNs"}.
+static FlValue* pipeline_to_fl_value(InputCapturePlugin* self,
+                                     bool reset_timings) {
+  FlValue* stages = fl_value_new_list();
+  for (const StageInfo& info : self->pipeline->describe(reset_timings)) {
+    FlValue* stage = fl_value_new_map();
+    fl_value_set_string_take(stage, "name",
+                             fl_value_new_string(info.name.c_str()));
+    fl_value_set_string_take(stage, "enabled", fl_value_new_bool(info.enabled));
+    FlValue* options = fl_value_new_map();
+    for (const auto& option : info.options) {
+      fl_value_set_string_take(options, option.first.c_str(),
+                               fl_value_new_int(option.second));
+    }
+    fl_value_set_string_take(stage, "options", options);
+    fl_value_set_string_take(stage, "calls",
+                             fl_value_new_int(info.timing.calls));
+    fl_value_set_string_take(stage, "dropped",
+                             fl_value_new_int(info.timing.dropped));
+    fl_value_set_string_take(stage, "totalNs",
+                             fl_value_new_int(info.timing.total_ns));
+    fl_value_set_string_take(stage, "maxNs",
+                             fl_value_new_int(info.timing.max_ns));
+    fl_value_append_take(stages, stage);
+  }
+  return stages;
+}
+
+// Handles the "configurePipeline" method call.
+//
+// Arguments: {"stages": {name: {"enabled": bool, option: int | bool}}}.
+// Stages not mentioned keep their configuration. Returns the pipeline as
+// "getPipeline" does, or BAD_ARGS naming the first unknown stage or
+// invalid option; the valid part is applied regardless.
+static FlMethodResponse* configure_pipeline(InputCapturePlugin* self,
+                                            FlValue* args) {
+  FlValue* stages = args != nullptr && fl_value_get_type(args) == FL_VALUE_TYPE_MAP
+                        ? fl_value_lookup_string(args, "stages")
+                        : nullptr;
+  if (stages == nullptr || fl_value_get_type(stages) != FL_VALUE_TYPE_MAP) {
+    return FL_METHOD_RESPONSE(fl_method_error_response_new(
+        "BAD_ARGS", "configurePipeline requires stages", nullptr));
+  }
+
+  std::string invalid;
+  for (size_t i = 0; i < fl_value_get_length(stages); i++) {
+    FlValue* key = fl_value_get_map_key(stages, i);
+    FlValue* config = fl_value_get_map_value(stages, i);
+    if (fl_value_get_type(key) != FL_VALUE_TYPE_STRING ||
+        fl_value_get_type(config) != FL_VALUE_TYPE_MAP) {
+      continue;
+    }
+    const std::string name = fl_value_get_string(key);
+
+    bool known = true;
+    StageOptions options;
+    for (size_t j = 0; j < fl_value_get_length(config); j++) {
+      FlValue* option = fl_value_get_map_key(config, j);
+      FlValue* value = fl_value_get_map_value(config, j);
+      if (fl_value_get_type(option) != FL_VALUE_TYPE_STRING) continue;
+      const char* option_name = fl_value_get_string(option);
+      if (strcmp(option_name, "enabled") == 0 &&
+          fl_value_get_type(value) == FL_VALUE_TYPE_BOOL) {
+        known = self->pipeline->set_enabled(name, fl_value_get_bool(value));
+      } else if (fl_value_get_type(value) == FL_VALUE_TYPE_INT) {
+        options[option_name] = fl_value_get_int(value);
+      } else if (fl_value_get_type(value) == FL_VALUE_TYPE_BOOL) {
+        options[option_name] = fl_value_get_bool(value) ? 1 : 0;
+      }
+    }
+    if (!(known && self->pipeline->configure(name, options)) &&
+        invalid.empty()) {
+      invalid = name;
+    }
+  }
+
+  if (!invalid.empty()) {
+    g_autofree gchar* message =
+        g_strdup_printf("Unknown stage or invalid option: %s", invalid.c_str());
+    return FL_METHOD_RESPONSE(
+        fl_method_error_response_new("BAD_ARGS", message, nullptr));
+  }
+  g_autoptr(FlValue) result = pipeline_to_fl_value(self, false);
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+}
+
+// Handles the "setPipelineTiming" method call.
+//
+// Arguments: {"enabled": bool}. Returns whether stages are timed now.
+static FlMethodResponse* set_pipeline_timing(InputCapturePlugin* self,
+                                             FlValue* args) {
+  FlValue* value = args != nullptr && fl_value_get_type(args) == FL_VALUE_TYPE_MAP
+                       ? fl_value_lookup_string(args, "enabled")
+                       : nullptr;
+  if (value == nullptr || fl_value_get_type(value) != FL_VALUE_TYPE_BOOL) {
+    return FL_METHOD_RESPONSE(fl_method_error_response_new(
+        "BAD_ARGS", "setPipelineTiming requires enabled", nullptr));
+  }
+
+  self->pipeline->set_timing(fl_value_get_bool(value));
+  g_autoptr(FlValue) result = fl_value_new_bool(self->pipeline->timing());
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+}
+
+// Handles the "setHudChord" method call.
+//
+// Arguments: {"key": String, "modifiers": [String]}, an X keysym name
+// ("F12", "h") and the modifiers ("shift", "control", "alt", "meta") that
+// must be held, no more and no fewer. Returns false for an unknown key.
+static FlMethodResponse* set_hud_chord(InputCapturePlugin* self,
+                                       FlValue* args) {
+  FlValue* key = args != nullptr && fl_value_get_type(args) == FL_VALUE_TYPE_MAP
+                     ? fl_value_lookup_string(args, "key")
+                     : nullptr;
+  if (key == nullptr || fl_value_get_type(key) != FL_VALUE_TYPE_STRING) {
+    return FL_METHOD_RESPONSE(fl_method_error_response_new(
+        "BAD_ARGS", "setHudChord requires a key", nullptr));
+  }
+
+  const KeySym keysym = XStringToKeysym(fl_value_get_string(key));
+  if (keysym == NoSymbol) {
+    g_autoptr(FlValue) result = fl_value_new_bool(FALSE);
+    return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+  }
+
+  guint modifiers = 0;
+  FlValue* names = fl_value_lookup_string(args, "modifiers");
+  if (names != nullptr && fl_value_get_type(names) == FL_VALUE_TYPE_LIST) {
+    for (size_t i = 0; i < fl_value_get_length(names); i++) {
+      FlValue* name = fl_value_get_list_value(names, i);
+      if (fl_value_get_type(name) != FL_VALUE_TYPE_STRING) continue;
+      const gchar* modifier = fl_value_get_string(name);
+      if (strcmp(modifier, "shift") == 0) modifiers |= kModifierShift;
+      else if (strcmp(modifier, "control") == 0) modifiers |= kModifierControl;
+      else if (strcmp(modifier, "alt") == 0) modifiers |= kModifierAlt;
+      else if (strcmp(modifier, "meta") == 0) modifiers |= kModifierMeta;
+    }
+  }
+
+  g_atomic_int_set(&self->hud_keysym, static_cast<gint>(keysym));
+  g_atomic_int_set(&self->hud_modifiers, static_cast<gint>(modifiers));
+  g_autoptr(FlValue) result = fl_value_new_bool(TRUE);
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+}
+
+// Parses a chord such as "Control+Alt+Shift+F12": modifiers, then an X
+// keysym name. Returns false if the key is unknown.
+static bool parse_hud_chord(const gchar* spec, guint* keysym,
+                            guint* modifiers) {
+  g_auto(GStrv) parts = g_strsplit(spec, "+", -1);
+  const guint count = g_strv_length(parts);
+  if (count == 0) {
+    return false;
+  }
+  *modifiers = 0;
+  for (guint i = 0; i + 1 < count; i++) {
+    const gchar* modifier = g_strstrip(parts[i]);
+    if (g_ascii_strcasecmp(modifier, "shift") == 0) {
+      *modifiers |= kModifierShift;
+    } else if (g_ascii_strcasecmp(modifier, "control") == 0 ||
+               g_ascii_strcasecmp(modifier, "ctrl") == 0) {
+      *modifiers |= kModifierControl;
+    } else if (g_ascii_strcasecmp(modifier, "alt") == 0) {
+      *modifiers |= kModifierAlt;
+    } else if (g_ascii_strcasecmp(modifier, "meta") == 0 ||
+               g_ascii_strcasecmp(modifier, "super") == 0) {
+      *modifiers |= kModifierMeta;
+    }
+  }
+  *keysym = XStringToKeysym(g_strstrip(parts[count - 1]));
+  return *keysym != NoSymbol;
+}
+
+// Tells Dart the HUD chord was pressed (platform thread).
+static gboolean send_hud_toggle_idle(gpointer user_data) {
+  InputCapturePlugin* self = INPUT_CAPTURE_PLUGIN(user_data);
+  if (g_atomic_int_get(&self->hud_listening) && self->hud_channel) {
+    g_autoptr(FlValue) toggle = fl_value_new_null();
+    fl_event_channel_send(self->hud_channel, toggle, nullptr, nullptr);
+  }
+  return G_SOURCE_REMOVE;
+}
+
+// Checks a key press against the HUD chord (any thread).
+static void check_hud_chord(InputCapturePlugin* self,
+                            const CapturedEvent* event) {
+  const guint keysym = static_cast<guint>(g_atomic_int_get(&self->hud_keysym));
+  const guint modifiers =
+      static_cast<guint>(g_atomic_int_get(&self->hud_modifiers));
+  if (event->keysym == keysym && event->modifiers == modifiers) {
+    LOG_DEBUG("InputCapture", "HUD chord pressed");
+    g_idle_add(send_hud_toggle_idle, self);
+  }
+}
+
+// Handles the "setLogLevel" method call.
+//
+// Arguments: {"level": int, "console": int}, both optional, as LogLevel
+// values. Returns the runtime level now in effect.
+static FlMethodResponse* set_log_level(FlValue* args) {
+  if (args != nullptr && fl_value_get_type(args) == FL_VALUE_TYPE_MAP) {
+    FlValue* level = fl_value_lookup_string(args, "level");
+    if (level != nullptr && fl_value_get_type(level) == FL_VALUE_TYPE_INT) {
+      log_set_level(static_cast<LogLevel>(fl_value_get_int(level)));
+    }
+    FlValue* console = fl_value_lookup_string(args, "console");
+    if (console != nullptr && fl_value_get_type(console) == FL_VALUE_TYPE_INT) {
+      log_set_console_level(static_cast<LogLevel>(fl_value_get_int(console)));
+    }
+  }
+  g_autoptr(FlValue) result = fl_value_new_int(log_level());
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+}
+
+// Handles the "dumpLog" method call.
+//
+// Returns the native log ring, oldest first, as a list of
+// {"sequence", "timeUs", "level", "message"} maps.
+static FlMethodResponse* dump_log() {
+  std::vector<LogEntry> entries;
+  log_dump(&entries);
+
+  g_autoptr(FlValue) result = fl_value_new_list();
+  for (const LogEntry& entry : entries) {
+    FlValue* map = fl_value_new_map();
+    fl_value_set_string_take(map, "sequence",
+                             fl_value_new_int(static_cast<int64_t>(entry.sequence)));
+    fl_value_set_string_take(map, "timeUs", fl_value_new_int(entry.time_us));
+    fl_value_set_string_take(map, "level", fl_value_new_int(entry.level));
+    fl_value_set_string_take(map, "message",
+                             fl_value_new_string(entry.text.c_str()));
+    fl_value_append_take(result, map);
+  }
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+}
+
+// Stream handlers tracking whether Dart listens on the map event channel.
+static FlMethodErrorResponse* event_listen_cb(FlEventChannel* channel,
+                                              FlValue* args,
+                                              gpointer user_data) {
+  g_atomic_int_set(&INPUT_CAPTURE_PLUGIN(user_data)->event_listening, 1);
+  return nullptr;
+}
+
+static FlMethodErrorResponse* event_cancel_cb(FlEventChannel* channel,
+                                              FlValue* args,
+                                              gpointer user_data) {
+  g_atomic_int_set(&INPUT_CAPTURE_PLUGIN(user_data)->event_listening, 0);
+  return nullptr;
+}
+
+// Stream handlers for the batch channel.
+//
+// Listen arguments: {"credits": int, "generation": int}, the number of
+// batches Dart accepts before it grants more, and the generation its grants
+// carry. Without credits, batches are sent without flow control.
+static FlMethodErrorResponse* batch_listen_cb(FlEventChannel* channel,
+                                              FlValue* args,
+                                              gpointer user_data) {
+  InputCapturePlugin* self = INPUT_CAPTURE_PLUGIN(user_data);
+  const bool has_args =
+      args != nullptr && fl_value_get_type(args) == FL_VALUE_TYPE_MAP;
+  FlValue* credits_value =
+      has_args ? fl_value_lookup_string(args, "credits") : nullptr;
+  FlValue* generation_value =
+      has_args ? fl_value_lookup_string(args, "generation") : nullptr;
+
+  g_mutex_lock(&self->batch_lock);
+  self->batch_generation =
+      generation_value != nullptr &&
+              fl_value_get_type(generation_value) == FL_VALUE_TYPE_INT
+          ? fl_value_get_int(generation_value)
+          : 0;
+  self->batch_credits =
+      credits_value != nullptr &&
+              fl_value_get_type(credits_value) == FL_VALUE_TYPE_INT
+          ? static_cast<gint>(fl_value_get_int(credits_value))
+          : -1;
+  self->batch->clear();
+  g_mutex_unlock(&self->batch_lock);
+
+  g_atomic_int_set(&self->batch_listening, 1);
+  return nullptr;
+}
+
+static FlMethodErrorResponse* batch_cancel_cb(FlEventChannel* channel,
+                                              FlValue* args,
+                                              gpointer user_data) {
+  InputCapturePlugin* self = INPUT_CAPTURE_PLUGIN(user_data);
+  g_atomic_int_set(&self->batch_listening, 0);
+
+  g_mutex_lock(&self->batch_lock);
+  self->batch->clear();
+  g_mutex_unlock(&self->batch_lock);
+  return nullptr;
+}
+
+// Stream handlers for the gesture channel. The recognizer only runs while
+// Dart listens.
+static FlMethodErrorResponse* gesture_listen_cb(FlEventChannel* channel,
+                                                FlValue* args,
+                                                gpointer user_data) {
+  InputCapturePlugin* self = INPUT_CAPTURE_PLUGIN(user_data);
+  g_mutex_lock(&self->gesture_lock);
+  self->gestures->reset();
+  g_mutex_unlock(&self->gesture_lock);
+
+  g_atomic_int_set(&self->gesture_listening, 1);
+  return nullptr;
+}
+
+static FlMethodErrorResponse* gesture_cancel_cb(FlEventChannel* channel,
+                                                FlValue* args,
+                                                gpointer user_data) {
+  g_atomic_int_set(&INPUT_CAPTURE_PLUGIN(user_data)->gesture_listening, 0);
+  return nullptr;
+}
+
+// Stream handlers for the HUD toggle channel. The chord is only checked
+// while Dart listens.
+static FlMethodErrorResponse* hud_listen_cb(FlEventChannel* channel,
+                                            FlValue* args,
+                                            gpointer user_data) {
+  g_atomic_int_set(&INPUT_CAPTURE_PLUGIN(user_data)->hud_listening, 1);
+  return nullptr;
+}
+
+static FlMethodErrorResponse* hud_cancel_cb(FlEventChannel* channel,
+                                            FlValue* args,
+                                            gpointer user_data) {
+  g_atomic_int_set(&INPUT_CAPTURE_PLUGIN(user_data)->hud_listening, 0);
+  return nullptr;
+}
+
+// How often the thermal and power state is sampled.
+static const guint kPowerPollIntervalS = 2;
+
+// Polls without input after which power polling pauses while capturing.
+static const guint kIdlePowerPolls = 3;
+
+// Encodes the monitor's last readings.
+//
+// Power status map: {"tier": int (PerformanceTier), "throttle": 0..1,
+// "onBattery": bool, "temperature"/"headroom": °C (with thermal zones),
+// "batteryPercent": int (with a battery)}.
+static FlValue* power_status_to_fl_value(InputCapturePlugin* self) {
+  const PowerReadings& readings = self->power_monitor->readings();
+  FlValue* map = fl_value_new_map();
+  fl_value_set_string_take(map, "tier",
+                           fl_value_new_int(self->power_monitor->tier()));
+  fl_value_set_string_take(map, "throttle",
+                           fl_value_new_float(readings.throttle_ratio));
+  fl_value_set_string_take(map, "onBattery",
+                           fl_value_new_bool(readings.on_battery));
+  if (readings.has_thermal) {
+    fl_value_set_string_take(map, "temperature",
+                             fl_value_new_float(readings.max_temp_c));
+    fl_value_set_string_take(map, "headroom",
+                             fl_value_new_float(readings.headroom_c));
+  }
+  if (readings.has_battery && readings.battery_percent >= 0) {
+    fl_value_set_string_take(map, "batteryPercent",
+                             fl_value_new_int(readings.battery_percent));
+  }
+  return map;
+}
+
+// Samples the thermal and power state and tells Dart about noticeable
+// changes (platform thread).
+static gboolean poll_power_cb(gpointer user_data) {
+  InputCapturePlugin* self = INPUT_CAPTURE_PLUGIN(user_data);
+  const PerformanceTier previous = self->power_monitor->tier();
+  const PerformanceTier tier = self->power_monitor->update();
+  g_atomic_int_set(&self->power_tier, tier);
+  if (tier != previous) {
+    LOG_INFO("PowerMonitor", "Performance tier %d -> %d", previous, tier);
+  }
+
+  if (!g_atomic_int_get(&self->power_listening) || !self->power_channel) {
+    return G_SOURCE_CONTINUE;
+  }
+  const PowerReadings& now = self->power_monitor->readings();
+  const PowerReadings& sent = self->power_sent;
+  const bool changed =
+      !self->power_sent_valid || tier != previous ||
+      now.on_battery != sent.on_battery ||
+      now.battery_percent != sent.battery_percent ||
+      now.max_temp_c - sent.max_temp_c >= 1 ||
+      sent.max_temp_c - now.max_temp_c >= 1;
+  if (changed) {
+    g_autoptr(FlValue) status = power_status_to_fl_value(self);
+    fl_event_channel_send(self->power_channel, status, nullptr, nullptr);
+    self->power_sent = now;
+    self->power_sent_valid = true;
+  }
+  return G_SOURCE_CONTINUE;
+}
+
+// Timer callback of the power polling: polls, or pauses polling once
+// capture has seen no input for kIdlePowerPolls polls (platform thread).
+static gboolean power_timer_cb(gpointer user_data) {
+  InputCapturePlugin* self = INPUT_CAPTURE_PLUGIN(user_data);
+  if (self->is_capturing) {
+    if (g_atomic_int_compare_and_exchange(&self->input_seen, 1, 0)) {
+      self->idle_power_polls = 0;
+    } else if (++self->idle_power_polls >= kIdlePowerPolls) {
+      LOG_DEBUG("PowerMonitor", "No input, pausing power polling");
+      g_atomic_int_set(&self->input_idle, 1);
+      self->power_timer = 0;
+      return G_SOURCE_REMOVE;
+    }
+  }
+  return poll_power_cb(self);
+}
+
+static gboolean resume_power_polling_idle(gpointer user_data) {
+  update_power_polling(INPUT_CAPTURE_PLUGIN(user_data));
+  return G_SOURCE_REMOVE;
+}
+
+// Records that input arrived, resuming paused polling and probing (record
+// thread, every event, so two atomic loads in the common case).
+static void note_input_activity(InputCapturePlugin* self) {
+  self->server_probe->note_activity();
+  if (!g_atomic_int_get(&self->input_seen)) {
+    g_atomic_int_set(&self->input_seen, 1);
+  }
+  if (g_atomic_int_get(&self->input_idle) &&
+      g_atomic_int_compare_and_exchange(&self->input_idle, 1, 0)) {
+    g_idle_add(resume_power_polling_idle, self);
+  }
+}
+
+// Polls the power state only while capturing with recent input or while
+// Dart listens, so an idle app does not wake up for it (platform thread).
+static void update_power_polling(InputCapturePlugin* self) {
+  const bool wanted =
+      (self->is_capturing || g_atomic_int_get(&self->power_listening)) &&
+      !g_atomic_int_get(&self->input_idle);
+  if (wanted && self->power_timer == 0) {
+    poll_power_cb(self);
+    self->power_timer =
+        g_timeout_add_seconds(kPowerPollIntervalS, power_timer_cb, self);
+  } else if (!wanted && self->power_timer != 0) {
+    g_source_remove(self->power_timer);
+    self->power_timer = 0;
+  }
+}
+
+// Stream handlers for the power status channel.
+static FlMethodErrorResponse* power_listen_cb(FlEventChannel* channel,
+                                              FlValue* args,
+                                              gpointer user_data) {
+  InputCapturePlugin* self = INPUT_CAPTURE_PLUGIN(user_data);
+  g_atomic_int_set(&self->power_listening, 1);
+  // The first sample after listening is always sent, also while polling
+  // is paused for lack of input.
+  self->power_sent_valid = false;
+  if (self->power_timer != 0 || g_atomic_int_get(&self->input_idle)) {
+    poll_power_cb(self);
+  }
+  update_power_polling(self);
+  return nullptr;
+}
+
+static FlMethodErrorResponse* power_cancel_cb(FlEventChannel* channel,
+                                              FlValue* args,
+                                              gpointer user_data) {
+  InputCapturePlugin* self = INPUT_CAPTURE_PLUGIN(user_data);
+  g_atomic_int_set(&self->power_listening, 0);
+  update_power_polling(self);
+  return nullptr;
+}
+
 // Convert X11 KeySym to string
 static const char* keycode_to_string(KeySym keysym) {
   // Common printable characters
@@ -383,11 +2130,66 @@ static void input_capture_plugin_dispose(GObject* object) {
     stop_capture(self);
   }
 
+  // Close the journal so its index is written
+  g_mutex_lock(&self->journal_lock);
+  JournalWriter* journal = self->journal;
+  self->journal = nullptr;
+  g_mutex_unlock(&self->journal_lock);
+  if (journal != nullptr) {
+    journal->close();
+    delete journal;
+  }
+  g_mutex_clear(&self->journal_lock);
+
+  // A replay thread pushes into the merger: cancel and join it first. Its
+  // finished callback still runs to answer the call and drop its reference.
+  if (self->replay_running) {
+    g_atomic_int_set(&self->replay_cancel, 1);
+    pthread_join(self->replay_thread, nullptr);
+    self->replay_running = false;
+  }
+
+  // Capture and replay are stopped, so nothing pushes any more.
+  delete self->merger;
+  self->merger = nullptr;
+
+  delete self->pipeline;
+  self->pipeline = nullptr;
+
+  // The self-benchmark's finished callback still runs to drop its
+  // reference; it sees that backend_selection is gone.
+  if (self->backend_selecting) {
+    pthread_join(self->backend_thread, nullptr);
+    self->backend_selecting = false;
+  }
+  delete self->backend_selection;
+  self->backend_selection = nullptr;
+
+  delete self->server_probe;
+  self->server_probe = nullptr;
+
+  delete self->batch;
+  self->batch = nullptr;
+  g_mutex_clear(&self->batch_lock);
+
+  delete self->gestures;
+  self->gestures = nullptr;
+  g_mutex_clear(&self->gesture_lock);
+
+  if (self->power_timer != 0) {
+    g_source_remove(self->power_timer);
+    self->power_timer = 0;
+  }
+  delete self->power_monitor;
+  self->power_monitor = nullptr;
+
   // Clean up display connection
   if (self->display) {
     XCloseDisplay(self->display);
     self->display = nullptr;
   }
+  delete self->startup_cache;
+  self->startup_cache = nullptr;
 
   G_OBJECT_CLASS(input_capture_plugin_parent_class)->dispose(object);
 }
@@ -397,17 +2199,93 @@ static void input_capture_plugin_class_init(InputCapturePluginClass* klass) {
 }
 
 static void input_capture_plugin_init(InputCapturePlugin* self) {
+  self->view = nullptr;
   self->display = XOpenDisplay(nullptr);
+  self->startup_cache = new StartupCache(StartupCache::default_path());
+  self->startup_cache->load(self->display);
   self->record_display = nullptr;
   self->record_context = 0;
   self->is_capturing = false;
-  self->thread_running = false;
+  self->backend_selection = new BackendSelection(capture_backend_default());
+  self->capture_backend = self->backend_selection->backend;
+  self->backend_selecting = false;
+  self->backend_rerun = false;
+  self->backend_result = nullptr;
+  self->backend_call = nullptr;
+  self->session_call = nullptr;
+  self->session_fullscreen = false;
+  self->session_capture = false;
+  self->session_start_us = 0;
+  self->server_probe = new XLatencyProbe();
+  self->realtime_offset_us = g_get_real_time() - g_get_monotonic_time();
+  g_mutex_init(&self->journal_lock);
+  self->journal = nullptr;
+  self->merger = new EventMerger(
+      [self](const CapturedEvent& event, int64_t dispatch_us, int) {
+        dispatch_event(self, &event, dispatch_us);
+      });
+  self->live_source = -1;
+  self->replay_source = -1;
+  self->pipeline = new EventPipeline();
+  build_pipeline(self);
+  self->replay_running = false;
+  self->replay_cancel = 0;
+  self->replay_path = nullptr;
+  self->replay_error = nullptr;
+  self->replay_call = nullptr;
+  self->event_listening = 0;
+  self->batch_listening = 0;
+  g_mutex_init(&self->batch_lock);
+  self->batch = new std::vector<uint8_t>();
+  self->batch_flush_scheduled = false;
+  self->batch_credits = -1;
+  self->batch_generation = 0;
+  self->batch_coalesced = 0;
+  self->batch_dropped = 0;
+  self->gesture_listening = 0;
+  g_mutex_init(&self->gesture_lock);
+  self->gestures = new GestureRecognizer();
+  self->power_listening = 0;
+  self->hud_listening = 0;
+  // Control+Alt+Shift+F12 unless the kiosk configures another chord, here
+  // or later from Dart ("setHudChord").
+  self->hud_keysym = XK_F12;
+  self->hud_modifiers = kModifierControl | kModifierAlt | kModifierShift;
+  const gchar* hud_chord = g_getenv("KEYBOARD_PLAYGROUND_HUD_CHORD");
+  guint hud_keysym = 0;
+  guint hud_modifiers = 0;
+  if (hud_chord != nullptr) {
+    if (parse_hud_chord(hud_chord, &hud_keysym, &hud_modifiers)) {
+      self->hud_keysym = static_cast<gint>(hud_keysym);
+      self->hud_modifiers = static_cast<gint>(hud_modifiers);
+    } else {
+      LOG_WARNING("InputCapture", "Ignoring unknown HUD chord '%s'",
+                  hud_chord);
+    }
+  }
+  // Tests and kiosks without a real sysfs can point the monitor at a fake
+  // tree.
+  const gchar* sysfs_root = g_getenv("KEYBOARD_PLAYGROUND_SYSFS_ROOT");
+  self->power_monitor =
+      new PowerMonitor(sysfs_root != nullptr ? sysfs_root : "/sys");
+  self->power_timer = 0;
+  self->power_tier = kTierFull;
+  self->power_sent_valid = false;
+  self->input_seen = 0;
+  self->input_idle = 0;
+  self->idle_power_polls = 0;
 }
 
 void input_capture_plugin_register_with_registrar(FlPluginRegistrar* registrar) {
   InputCapturePlugin* plugin = INPUT_CAPTURE_PLUGIN(
       g_object_new(input_capture_plugin_get_type(), nullptr));
 
+  plugin->view = fl_plugin_registrar_get_view(registrar);
+  if (plugin->view != nullptr) {
+    g_object_add_weak_pointer(G_OBJECT(plugin->view),
+                              reinterpret_cast<gpointer*>(&plugin->view));
+  }
+
   // Create method channel
   g_autoptr(FlStandardMethodCodec) codec = fl_standard_method_codec_new();
   plugin->method_channel = fl_method_channel_new(
@@ -422,6 +2300,41 @@ void input_capture_plugin_register_with_registrar(FlPluginRegistrar* registrar)
       fl_plugin_registrar_get_messenger(registrar),
       "com.keyboardplayground/input_events",
       FL_METHOD_CODEC(codec));
+  fl_event_channel_set_stream_handlers(plugin->event_channel, event_listen_cb,
+                                       event_cancel_cb, plugin, nullptr);
+
+  // Create event channel for packed event batches
+  plugin->batch_channel = fl_event_channel_new(
+      fl_plugin_registrar_get_messenger(registrar),
+      "com.keyboardplayground/input_event_batches",
+      FL_METHOD_CODEC(codec));
+  fl_event_channel_set_stream_handlers(plugin->batch_channel, batch_listen_cb,
+                                       batch_cancel_cb, plugin, nullptr);
+
+  // Create event channel for recognized pointer gestures
+  plugin->gesture_channel = fl_event_channel_new(
+      fl_plugin_registrar_get_messenger(registrar),
+      "com.keyboardplayground/input_gestures",
+      FL_METHOD_CODEC(codec));
+  fl_event_channel_set_stream_handlers(plugin->gesture_channel,
+                                       gesture_listen_cb, gesture_cancel_cb,
+                                       plugin, nullptr);
+
+  // Create event channel for thermal and power status
+  plugin->power_channel = fl_event_channel_new(
+      fl_plugin_registrar_get_messenger(registrar),
+      "com.keyboardplayground/power_status",
+      FL_METHOD_CODEC(codec));
+  fl_event_channel_set_stream_handlers(plugin->power_channel, power_listen_cb,
+                                       power_cancel_cb, plugin, nullptr);
+
+  // Create event channel for performance HUD toggles
+  plugin->hud_channel = fl_event_channel_new(
+      fl_plugin_registrar_get_messenger(registrar),
+      "com.keyboardplayground/hud_toggles",
+      FL_METHOD_CODEC(codec));
+  fl_event_channel_set_stream_handlers(plugin->hud_channel, hud_listen_cb,
+                                       hud_cancel_cb, plugin, nullptr);
 
   // Keep the plugin alive for the lifetime of the application
   // Don't unref - let it live for the entire app lifecycle
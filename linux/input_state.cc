@@ -0,0 +1,166 @@
+#include "input_state.h"
+
+#include <cstring>
+
+namespace {
+
+// Keysyms of the modifier keys themselves (X11 keysymdef.h).
+constexpr uint32_t kKeysymShiftL = 0xffe1;
+constexpr uint32_t kKeysymShiftR = 0xffe2;
+constexpr uint32_t kKeysymControlL = 0xffe3;
+constexpr uint32_t kKeysymControlR = 0xffe4;
+constexpr uint32_t kKeysymAltL = 0xffe9;
+constexpr uint32_t kKeysymAltR = 0xffea;
+constexpr uint32_t kKeysymSuperL = 0xffeb;
+constexpr uint32_t kKeysymSuperR = 0xffec;
+
+// Modifier bit changed by pressing or releasing [keysym], or 0.
+uint32_t modifier_for_keysym(uint32_t keysym) {
+  switch (keysym) {
+    case kKeysymShiftL:
+    case kKeysymShiftR:
+      return kModifierShift;
+    case kKeysymControlL:
+    case kKeysymControlR:
+      return kModifierControl;
+    case kKeysymAltL:
+    case kKeysymAltR:
+      return kModifierAlt;
+    case kKeysymSuperL:
+    case kKeysymSuperR:
+      return kModifierMeta;
+    default:
+      return 0;
+  }
+}
+
+}  // namespace
+
+void SeqlockSequence::begin_write() {
+  const uint32_t seq = seq_.load(std::memory_order_relaxed);
+  seq_.store(seq + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+}
+
+void SeqlockSequence::end_write() {
+  const uint32_t seq = seq_.load(std::memory_order_relaxed);
+  seq_.store(seq + 1, std::memory_order_release);
+}
+
+uint32_t SeqlockSequence::read_begin() const {
+  return seq_.load(std::memory_order_acquire);
+}
+
+bool SeqlockSequence::read_retry(uint32_t begin) const {
+  std::atomic_thread_fence(std::memory_order_acquire);
+  return (begin & 1) != 0 || seq_.load(std::memory_order_relaxed) != begin;
+}
+
+InputState::InputState() {
+  memset(&state_, 0, sizeof(state_));
+  for (auto& word : words_) {
+    word.store(0, std::memory_order_relaxed);
+  }
+}
+
+void InputState::apply(const CapturedEvent& event, int64_t time_us) {
+  std::lock_guard<std::mutex> lock(write_lock_);
+
+  switch (event.type) {
+    case kCapturedKeyDown:
+    case kCapturedKeyUp: {
+      const bool down = event.type == kCapturedKeyDown;
+      const uint64_t bit = uint64_t{1} << (event.code & 63);
+      uint64_t& word = state_.keys[(event.code >> 6) & 3];
+      word = down ? word | bit : word & ~bit;
+
+      // X reports the modifier state from before the event, so a modifier
+      // key's own press or release is applied on top.
+      uint32_t modifiers = event.modifiers;
+      const uint32_t own = modifier_for_keysym(event.keysym);
+      modifiers = down ? modifiers | own : modifiers & ~own;
+      state_.modifiers = modifiers;
+      break;
+    }
+
+    case kCapturedMouseDown:
+    case kCapturedMouseUp:
+      if (event.code >= 1 && event.code <= 32) {
+        const uint32_t bit = 1u << (event.code - 1);
+        state_.buttons = event.type == kCapturedMouseDown
+                             ? state_.buttons | bit
+                             : state_.buttons & ~bit;
+      }
+      state_.pointer_x = event.x;
+      state_.pointer_y = event.y;
+      break;
+
+    case kCapturedMouseMove:
+      state_.pointer_x = event.x;
+      state_.pointer_y = event.y;
+      break;
+
+    case kCapturedMouseScroll:
+      // Scrolling has no lasting state.
+      break;
+  }
+
+  state_.sequence++;
+  state_.last_event_time_us = time_us;
+  publish();
+}
+
+void InputState::release_all() {
+  std::lock_guard<std::mutex> lock(write_lock_);
+  state_.buttons = 0;
+  state_.modifiers = 0;
+  memset(state_.keys, 0, sizeof(state_.keys));
+  state_.sequence++;
+  publish();
+}
+
+void InputState::publish() {
+  uint64_t words[kWords];
+  memcpy(words, &state_, sizeof(words));
+
+  seq_.begin_write();
+  for (size_t i = 0; i < kWords; i++) {
+    words_[i].store(words[i], std::memory_order_relaxed);
+  }
+  seq_.end_write();
+}
+
+void InputState::read(InputStateSnapshot* out) const {
+  while (!try_read(out)) {
+  }
+}
+
+bool InputState::try_read(InputStateSnapshot* out) const {
+  uint64_t words[kWords];
+  const uint32_t begin = seq_.read_begin();
+  for (size_t i = 0; i < kWords; i++) {
+    words[i] = words_[i].load(std::memory_order_relaxed);
+  }
+  if (seq_.read_retry(begin)) {
+    return false;
+  }
+  memcpy(out, words, sizeof(words));
+  return true;
+}
+
+InputState* input_state_instance() {
+  static InputState state;
+  return &state;
+}
+
+InputStateSnapshot* keyboard_playground_input_state_new() {
+  return new InputStateSnapshot();
+}
+
+void keyboard_playground_input_state_free(InputStateSnapshot* snapshot) {
+  delete snapshot;
+}
+
+void keyboard_playground_read_input_state(InputStateSnapshot* out) {
+  input_state_instance()->read(out);
+}
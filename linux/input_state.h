@@ -0,0 +1,133 @@
+#ifndef INPUT_STATE_H_
+#define INPUT_STATE_H_
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+
+#include "captured_event.h"
+
+/// Latest input state, for consumers that poll once per frame instead of
+/// following the event stream.
+///
+/// The layout is shared with Dart (`NativeInputState` in
+/// lib/platform/input_state.dart) and must stay in sync with it. All fields
+/// are little-endian; the struct is exactly 64 bytes.
+struct InputStateSnapshot {
+  /// Number of events applied so far. Changes whenever the state does.
+  uint64_t sequence;
+
+  /// Wall-clock time of the last applied event, in microseconds.
+  int64_t last_event_time_us;
+
+  /// Last known pointer position in root coordinates.
+  int32_t pointer_x;
+  int32_t pointer_y;
+
+  /// Held mouse buttons: bit n-1 is set while button n is down.
+  uint32_t buttons;
+
+  /// Held modifiers as [CapturedModifier] bits.
+  uint32_t modifiers;
+
+  /// Held keys: bit k of the 256-bit map is set while X keycode k is down.
+  uint64_t keys[4];
+};
+
+static_assert(sizeof(InputStateSnapshot) == 64,
+              "InputStateSnapshot layout is shared with Dart");
+
+/// Sequence counter of a seqlock: odd while a write is in progress.
+///
+/// A writer brackets its stores with [begin_write] and [end_write]. A reader
+/// takes [read_begin] before copying and checks [read_retry] afterwards,
+/// which is true if a write was in progress or overlapped the copy. The
+/// protected data is kept in relaxed atomics by the user.
+class SeqlockSequence {
+ public:
+  SeqlockSequence() : seq_(0) {}
+
+  SeqlockSequence(const SeqlockSequence&) = delete;
+  SeqlockSequence& operator=(const SeqlockSequence&) = delete;
+
+  /// Makes the sequence odd. Writers must be serialized by the caller.
+  void begin_write();
+
+  /// Makes the sequence even again, publishing the stores in between.
+  void end_write();
+
+  /// Sequence to pass to [read_retry] after copying.
+  uint32_t read_begin() const;
+
+  /// Whether the copy made since [read_begin] returned [begin] may be torn.
+  bool read_retry(uint32_t begin) const;
+
+ private:
+  std::atomic<uint32_t> seq_;
+};
+
+/// Seqlock-protected [InputStateSnapshot].
+///
+/// Writers (the capture and replay threads) serialize on a mutex and
+/// publish the whole state after every event. Readers never block and never
+/// make a writer wait: they copy the state and retry if a write overlapped
+/// the copy, so reading costs the same however fast input arrives.
+///
+/// The state is kept in relaxed atomic words rather than plain fields so
+/// the racy copy in [read] is well defined.
+class InputState {
+ public:
+  InputState();
+
+  InputState(const InputState&) = delete;
+  InputState& operator=(const InputState&) = delete;
+
+  /// Applies [event], which happened at wall-clock time [time_us].
+  void apply(const CapturedEvent& event, int64_t time_us);
+
+  /// Releases all keys and buttons, e.g. when capture stops and releases
+  /// would be missed. Keeps the pointer position and sequence.
+  void release_all();
+
+  /// Copies a consistent snapshot into [out], retrying while a write is in
+  /// progress or overlaps the copy.
+  void read(InputStateSnapshot* out) const;
+
+  /// Copies the state into [out] once. Returns false, leaving [out]
+  /// untouched, if a write was in progress or overlapped the copy.
+  bool try_read(InputStateSnapshot* out) const;
+
+ private:
+  static constexpr size_t kWords = sizeof(InputStateSnapshot) / sizeof(uint64_t);
+
+  void publish();
+
+  std::mutex write_lock_;
+  InputStateSnapshot state_;  // Writer's copy, guarded by write_lock_.
+
+  SeqlockSequence seq_;
+  std::atomic<uint64_t> words_[kWords];
+};
+
+/// The process-wide input state fed by the input capture plugin.
+InputState* input_state_instance();
+
+// Entry points exported for Dart FFI.
+extern "C" {
+
+/// Allocates a zeroed snapshot for [keyboard_playground_read_input_state].
+__attribute__((visibility("default"))) InputStateSnapshot*
+keyboard_playground_input_state_new();
+
+/// Frees a snapshot allocated by [keyboard_playground_input_state_new].
+__attribute__((visibility("default"))) void
+keyboard_playground_input_state_free(InputStateSnapshot* snapshot);
+
+/// Copies the current input state into [out]. Safe to call from any thread
+/// and never blocks.
+__attribute__((visibility("default"))) void
+keyboard_playground_read_input_state(InputStateSnapshot* out);
+
+}  // extern "C"
+
+#endif  // INPUT_STATE_H_
@@ -0,0 +1,216 @@
+#include "journal_analysis.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+/// Raw latency histogram range, in 1 ms buckets either side of the first
+/// event's clock offset.
+constexpr int64_t kRawLatencyRangeMs = 60000;
+constexpr size_t kRawLatencyBuckets = 2 * kRawLatencyRangeMs + 1;
+
+constexpr int64_t kMicrosecondsPerSecond = 1000000;
+
+bool is_pointer_position(uint8_t type) {
+  return type == kCapturedMouseMove || type == kCapturedMouseDown ||
+         type == kCapturedMouseUp;
+}
+
+}  // namespace
+
+LatencyHistogram::LatencyHistogram() : buckets_(kBuckets, 0), count_(0) {}
+
+void LatencyHistogram::add(size_t bucket, uint64_t count) {
+  buckets_[std::min(bucket, kBuckets - 1)] += count;
+  count_ += count;
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& other) {
+  for (size_t i = 0; i < kBuckets; i++) buckets_[i] += other.buckets_[i];
+  count_ += other.count_;
+}
+
+uint64_t LatencyHistogram::percentile(double q) const {
+  if (count_ == 0) return 0;
+  uint64_t rank = static_cast<uint64_t>(std::ceil(q * count_));
+  if (rank == 0) rank = 1;
+  uint64_t seen = 0;
+  for (size_t i = 0; i < kBuckets; i++) {
+    seen += buckets_[i];
+    if (seen >= rank) return i;
+  }
+  return kBuckets - 1;
+}
+
+uint64_t LatencyHistogram::max() const {
+  for (size_t i = kBuckets; i > 0; i--) {
+    if (buckets_[i - 1] != 0) return i - 1;
+  }
+  return 0;
+}
+
+JournalAnalysis::JournalAnalysis()
+    : journals(0),
+      file_bytes(0),
+      blocks(0),
+      events(0),
+      dropped(0),
+      counts(),
+      duration_us(0),
+      peak_events_per_second(0),
+      pointer_distance_px(0),
+      scroll_x(0),
+      scroll_y(0),
+      stalls(0),
+      longest_stall_us(0) {}
+
+void JournalAnalysis::merge(const JournalAnalysis& other) {
+  journals += other.journals;
+  file_bytes += other.file_bytes;
+  blocks += other.blocks;
+  events += other.events;
+  dropped += other.dropped;
+  for (size_t i = 0; i < 6; i++) counts[i] += other.counts[i];
+  duration_us += other.duration_us;
+  peak_events_per_second =
+      std::max(peak_events_per_second, other.peak_events_per_second);
+  pointer_distance_px += other.pointer_distance_px;
+  scroll_x += other.scroll_x;
+  scroll_y += other.scroll_y;
+  for (const auto& entry : other.key_presses) {
+    key_presses[entry.first] += entry.second;
+  }
+  if (heatmap.size() < other.heatmap.size()) {
+    heatmap.resize(other.heatmap.size(), 0);
+  }
+  for (size_t i = 0; i < other.heatmap.size(); i++) {
+    heatmap[i] += other.heatmap[i];
+  }
+  latency.merge(other.latency);
+  stalls += other.stalls;
+  longest_stall_us = std::max(longest_stall_us, other.longest_stall_us);
+}
+
+JournalAnalysis analyze_journal(const std::string& path,
+                                const AnalysisOptions& options,
+                                AnalysisScratch* scratch) {
+  JournalAnalysis result;
+  result.path = path;
+
+  JournalReader reader;
+  if (!reader.open(path.c_str(), &result.error)) return result;
+
+  result.journals = 1;
+  result.file_bytes = reader.file_size();
+  result.blocks = reader.block_count();
+  result.duration_us = reader.end_time_us() - reader.start_time_us();
+  result.heatmap.assign(
+      static_cast<size_t>(options.grid_width) * options.grid_height, 0);
+
+  scratch->raw_latency.assign(kRawLatencyBuckets, 0);
+
+  bool have_previous = false;
+  CapturedEvent previous = {};
+  bool have_pointer = false;
+  int32_t pointer_x = 0;
+  int32_t pointer_y = 0;
+  int64_t server_ms = 0;
+  int64_t first_offset_ms = 0;
+  int64_t second = 0;
+  uint64_t events_this_second = 0;
+
+  for (size_t b = 0; b < reader.block_count(); b++) {
+    result.dropped += reader.dropped_before(b);
+    scratch->events.clear();
+    if (!reader.decode_block(b, &scratch->block, &scratch->events)) {
+      result.error = "corrupt block " + std::to_string(b);
+      break;
+    }
+
+    for (const CapturedEvent& event : scratch->events) {
+      result.events++;
+      if (event.type < 6) result.counts[event.type]++;
+
+      // Throughput in one-second windows.
+      int64_t event_second = event.timestamp_us / kMicrosecondsPerSecond;
+      if (event_second != second) {
+        second = event_second;
+        events_this_second = 0;
+      }
+      events_this_second++;
+      result.peak_events_per_second =
+          std::max(result.peak_events_per_second, events_this_second);
+
+      // Server time wraps at 2^32 ms; follow it through signed deltas.
+      if (have_previous) {
+        server_ms += static_cast<int32_t>(event.server_time_ms -
+                                          previous.server_time_ms);
+      } else {
+        server_ms = event.server_time_ms;
+      }
+
+      int64_t offset_ms = event.timestamp_us / 1000 - server_ms;
+      if (!have_previous) first_offset_ms = offset_ms;
+      int64_t bucket = std::max(
+          -kRawLatencyRangeMs,
+          std::min(kRawLatencyRangeMs, offset_ms - first_offset_ms));
+      scratch->raw_latency[bucket + kRawLatencyRangeMs]++;
+
+      if (have_previous) {
+        int64_t capture_gap = event.timestamp_us - previous.timestamp_us;
+        int64_t server_gap =
+            1000 * static_cast<int64_t>(static_cast<int32_t>(
+                       event.server_time_ms - previous.server_time_ms));
+        int64_t stall = capture_gap - server_gap;
+        if (stall > options.stall_threshold_us) {
+          result.stalls++;
+          result.longest_stall_us = std::max(result.longest_stall_us, stall);
+        }
+      }
+
+      if (event.type == kCapturedKeyDown) {
+        result.key_presses[event.keysym]++;
+      } else if (event.type == kCapturedMouseScroll) {
+        result.scroll_x += event.x;
+        result.scroll_y += event.y;
+      }
+
+      if (is_pointer_position(event.type)) {
+        if (have_pointer) {
+          double dx = event.x - pointer_x;
+          double dy = event.y - pointer_y;
+          result.pointer_distance_px += std::sqrt(dx * dx + dy * dy);
+        }
+        have_pointer = true;
+        pointer_x = event.x;
+        pointer_y = event.y;
+
+        int64_t col = static_cast<int64_t>(event.x) * options.grid_width /
+                      options.screen_width;
+        int64_t row = static_cast<int64_t>(event.y) * options.grid_height /
+                      options.screen_height;
+        col = std::max<int64_t>(0, std::min<int64_t>(col, options.grid_width - 1));
+        row =
+            std::max<int64_t>(0, std::min<int64_t>(row, options.grid_height - 1));
+        result.heatmap[row * options.grid_width + col]++;
+      }
+
+      previous = event;
+      have_previous = true;
+    }
+  }
+
+  // Rebase latency on the fastest delivery seen in this journal.
+  size_t fastest = 0;
+  while (fastest < kRawLatencyBuckets && scratch->raw_latency[fastest] == 0) {
+    fastest++;
+  }
+  for (size_t i = fastest; i < kRawLatencyBuckets; i++) {
+    if (scratch->raw_latency[i] != 0) {
+      result.latency.add(i - fastest, scratch->raw_latency[i]);
+    }
+  }
+
+  return result;
+}
@@ -0,0 +1,111 @@
+#ifndef JOURNAL_ANALYSIS_H_
+#define JOURNAL_ANALYSIS_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "session_journal.h"
+
+/// Tunables shared by every journal of one analysis run.
+struct AnalysisOptions {
+  /// Heatmap resolution in cells.
+  int grid_width = 64;
+  int grid_height = 36;
+
+  /// Screen size the heatmap grid is laid over, in pixels.
+  int screen_width = 1920;
+  int screen_height = 1080;
+
+  /// A delivery gap this much longer than the matching X server gap counts
+  /// as a stall.
+  int64_t stall_threshold_us = 50000;
+};
+
+/// Distribution of capture latency relative to the fastest event of the
+/// same journal, in 1 ms buckets.
+///
+/// X server timestamps and capture timestamps use unrelated clocks, so only
+/// the variation of their difference is meaningful: the event that reached
+/// the capture thread fastest is taken as zero.
+class LatencyHistogram {
+ public:
+  static constexpr size_t kBuckets = 10001;
+
+  LatencyHistogram();
+
+  void add(size_t bucket, uint64_t count);
+  void merge(const LatencyHistogram& other);
+
+  uint64_t count() const { return count_; }
+
+  /// Latency in milliseconds at quantile [q] (0..1); values beyond the last
+  /// bucket are reported as the last bucket.
+  uint64_t percentile(double q) const;
+  uint64_t max() const;
+
+ private:
+  std::vector<uint64_t> buckets_;
+  uint64_t count_;
+};
+
+/// Statistics computed for one journal, or merged over several.
+struct JournalAnalysis {
+  JournalAnalysis();
+
+  std::string path;
+  std::string error;
+
+  uint64_t journals;
+  uint64_t file_bytes;
+  uint64_t blocks;
+  uint64_t events;
+
+  /// Events the writer dropped because its thread fell behind.
+  uint64_t dropped;
+
+  /// Event counts indexed by [CapturedEventType].
+  uint64_t counts[6];
+
+  /// Sum of journal durations, in microseconds.
+  int64_t duration_us;
+  uint64_t peak_events_per_second;
+
+  double pointer_distance_px;
+  int64_t scroll_x;
+  int64_t scroll_y;
+
+  /// Key presses by keysym.
+  std::unordered_map<uint32_t, uint64_t> key_presses;
+
+  /// Pointer positions (moves and clicks), row-major.
+  std::vector<uint64_t> heatmap;
+
+  LatencyHistogram latency;
+  uint64_t stalls;
+  int64_t longest_stall_us;
+
+  /// Folds [other] into this analysis. Per-journal maxima stay maxima.
+  void merge(const JournalAnalysis& other);
+};
+
+/// Reusable per-thread buffers, so analysing many files does not allocate
+/// per block.
+struct AnalysisScratch {
+  std::vector<uint8_t> block;
+  std::vector<CapturedEvent> events;
+  std::vector<uint64_t> raw_latency;
+};
+
+/// Streams every block of the journal at [path] through the analysis.
+///
+/// Blocks are decoded one at a time from the memory-mapped file, so memory
+/// use does not grow with journal size. Failures are reported in
+/// [JournalAnalysis::error].
+JournalAnalysis analyze_journal(const std::string& path,
+                                const AnalysisOptions& options,
+                                AnalysisScratch* scratch);
+
+#endif  // JOURNAL_ANALYSIS_H_
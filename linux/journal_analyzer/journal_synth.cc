@@ -0,0 +1,254 @@
+// Writes deterministic synthetic session journals.
+//
+// Usage: journal_synth --profile typing|mash [--seconds N] [--seed N] <out>
+//
+// The profiles model a child playing normally (typing plus a 125 Hz mouse)
+// and the worst case the games must survive (a 1000 Hz mouse while keys are
+// mashed several at a time). They are used as replay input by the frame
+// performance integration tests, so the same file always yields the same
+// events. Pointer activity stays away from the screen corners and no
+// modifier other than shift is pressed, so replay never triggers an exit
+// sequence.
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "session_journal.h"
+
+namespace {
+
+constexpr int kScreenWidth = 1920;
+constexpr int kScreenHeight = 1080;
+constexpr int kCornerMargin = 120;
+constexpr double kPi = 3.14159265358979323846;
+
+// X keycodes and keysyms of the keys the profiles type, US layout.
+struct Key {
+  uint16_t keycode;
+  uint32_t keysym;
+};
+
+const Key kKeys[] = {
+    {38, 'a'}, {56, 'b'}, {54, 'c'}, {40, 'd'}, {26, 'e'}, {41, 'f'},
+    {42, 'g'}, {43, 'h'}, {31, 'i'}, {44, 'j'}, {45, 'k'}, {46, 'l'},
+    {58, 'm'}, {57, 'n'}, {32, 'o'}, {33, 'p'}, {24, 'q'}, {27, 'r'},
+    {39, 's'}, {28, 't'}, {30, 'u'}, {55, 'v'}, {25, 'w'}, {53, 'x'},
+    {29, 'y'}, {52, 'z'}, {10, '1'}, {11, '2'}, {12, '3'}, {13, '4'},
+    {14, '5'}, {15, '6'}, {16, '7'}, {17, '8'}, {18, '9'}, {19, '0'},
+    {65, ' '},
+};
+constexpr size_t kKeyCount = sizeof(kKeys) / sizeof(kKeys[0]);
+
+struct Profile {
+  const char* name;
+  int64_t motion_interval_us;
+  int64_t key_interval_us;
+  int max_held_keys;
+  int64_t click_interval_us;
+  int64_t scroll_interval_us;
+  double pointer_speed;
+};
+
+const Profile kProfiles[] = {
+    {"typing", 8000, 160000, 1, 2000000, 3000000, 1.0},
+    {"mash", 1000, 40000, 4, 200000, 250000, 8.0},
+};
+
+// Small deterministic generator; output must not depend on the C library.
+class Random {
+ public:
+  explicit Random(uint64_t seed) : state_(seed * 2862933555777941757ULL + 1) {}
+
+  uint32_t next() {
+    state_ = state_ * 6364136223846793005ULL + 1442695040888963407ULL;
+    return static_cast<uint32_t>(state_ >> 33);
+  }
+
+  int64_t range(int64_t low, int64_t high) {
+    return low + static_cast<int64_t>(next() % (high - low + 1));
+  }
+
+ private:
+  uint64_t state_;
+};
+
+struct HeldKey {
+  Key key;
+  int64_t release_us;
+};
+
+class Synthesizer {
+ public:
+  Synthesizer(const Profile& profile, uint64_t seed, JournalWriter* writer)
+      : profile_(profile), random_(seed), writer_(writer) {}
+
+  void run(int64_t duration_us) {
+    int64_t next_motion = 0;
+    int64_t next_key = profile_.key_interval_us;
+    int64_t next_click = profile_.click_interval_us;
+    int64_t next_scroll = profile_.scroll_interval_us;
+
+    for (int64_t now = 0; now < duration_us; now += 500) {
+      release_keys(now);
+      release_button(now);
+      if (now >= next_motion) {
+        move_pointer(now);
+        next_motion = now + profile_.motion_interval_us;
+      }
+      if (now >= next_key) {
+        press_key(now);
+        next_key = now + jitter(profile_.key_interval_us);
+      }
+      if (now >= next_click) {
+        click(now);
+        next_click = now + jitter(profile_.click_interval_us);
+      }
+      if (now >= next_scroll) {
+        emit(now, kCapturedMouseScroll, 0, 0, 0, random_.range(-3, 3));
+        next_scroll = now + jitter(profile_.scroll_interval_us);
+      }
+    }
+    release_keys(INT64_MAX);
+    release_button(INT64_MAX);
+  }
+
+ private:
+  int64_t jitter(int64_t interval) {
+    return random_.range(interval / 2, interval * 3 / 2);
+  }
+
+  // Sweeps the pointer along a slowly changing Lissajous curve.
+  void move_pointer(int64_t now) {
+    double t = now / 1e6 * profile_.pointer_speed;
+    double cx = kScreenWidth / 2.0;
+    double cy = kScreenHeight / 2.0;
+    double rx = cx - kCornerMargin;
+    double ry = cy - kCornerMargin;
+    x_ = static_cast<int32_t>(cx + rx * std::sin(2 * kPi * 0.13 * t) *
+                                       std::cos(2 * kPi * 0.05 * t));
+    y_ = static_cast<int32_t>(cy + ry * std::sin(2 * kPi * 0.21 * t + 1));
+    emit(now, kCapturedMouseMove, 0, 0, x_, y_);
+  }
+
+  void press_key(int64_t now) {
+    if (static_cast<int>(held_.size()) >= profile_.max_held_keys) return;
+    const Key& key = kKeys[random_.next() % kKeyCount];
+    for (const HeldKey& held : held_) {
+      if (held.key.keycode == key.keycode) return;
+    }
+    modifiers_ = random_.next() % 8 == 0 ? kModifierShift : 0;
+    emit(now, kCapturedKeyDown, key.keycode, key.keysym, 0, 0);
+    held_.push_back({key, now + random_.range(50000, 150000)});
+  }
+
+  void release_keys(int64_t now) {
+    for (size_t i = 0; i < held_.size();) {
+      if (held_[i].release_us <= now) {
+        int64_t at = now == INT64_MAX ? last_us_ : now;
+        emit(at, kCapturedKeyUp, held_[i].key.keycode, held_[i].key.keysym, 0,
+             0);
+        held_.erase(held_.begin() + i);
+      } else {
+        i++;
+      }
+    }
+    if (held_.empty()) modifiers_ = 0;
+  }
+
+  void click(int64_t now) {
+    if (button_ != 0) return;
+    button_ = static_cast<uint16_t>(random_.range(1, 3));
+    button_release_us_ = now + random_.range(40000, 120000);
+    emit(now, kCapturedMouseDown, button_, 0, x_, y_);
+  }
+
+  void release_button(int64_t now) {
+    if (button_ == 0 || button_release_us_ > now) return;
+    emit(now == INT64_MAX ? last_us_ : now, kCapturedMouseUp,
+         button_, 0, x_, y_);
+    button_ = 0;
+  }
+
+  void emit(int64_t at, uint8_t type, uint16_t code, uint32_t keysym,
+            int32_t x, int32_t y) {
+    last_us_ = at;
+
+    CapturedEvent event = {};
+    event.timestamp_us = kStartUs + at;
+    event.server_time_ms = static_cast<uint32_t>(
+        (kStartUs + at - random_.range(200, 2000)) / 1000);
+    event.keysym = keysym;
+    event.x = x;
+    event.y = y;
+    event.code = code;
+    event.type = type;
+    event.modifiers = modifiers_;
+    writer_->append(event);
+  }
+
+  static constexpr int64_t kStartUs = 1000000;
+
+  const Profile& profile_;
+  Random random_;
+  JournalWriter* writer_;
+  std::vector<HeldKey> held_;
+  int32_t x_ = kScreenWidth / 2;
+  int32_t y_ = kScreenHeight / 2;
+  uint16_t button_ = 0;
+  int64_t button_release_us_ = 0;
+  uint8_t modifiers_ = 0;
+  int64_t last_us_ = 0;
+};
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const Profile* profile = nullptr;
+  int seconds = 10;
+  uint64_t seed = 1;
+  const char* output = nullptr;
+
+  for (int i = 1; i < argc; i++) {
+    bool has_value = i + 1 < argc;
+    if (strcmp(argv[i], "--profile") == 0 && has_value) {
+      const char* name = argv[++i];
+      for (const Profile& candidate : kProfiles) {
+        if (strcmp(candidate.name, name) == 0) profile = &candidate;
+      }
+    } else if (strcmp(argv[i], "--seconds") == 0 && has_value) {
+      seconds = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "--seed") == 0 && has_value) {
+      seed = strtoull(argv[++i], nullptr, 10);
+    } else if (argv[i][0] != '-') {
+      output = argv[i];
+    }
+  }
+  if (profile == nullptr || output == nullptr || seconds <= 0) {
+    fprintf(stderr,
+            "Usage: journal_synth --profile typing|mash [--seconds N] "
+            "[--seed N] <out>\n");
+    return 2;
+  }
+
+  JournalWriter writer;
+  std::string error;
+  if (!writer.open(output, kJournalCodecNone, 0, &error)) {
+    fprintf(stderr, "%s: %s\n", output, error.c_str());
+    return 1;
+  }
+  Synthesizer(*profile, seed, &writer).run(seconds * 1000000LL);
+  JournalStats stats = writer.close();
+  if (stats.dropped != 0) {
+    fprintf(stderr, "%s: %llu events dropped\n", output,
+            static_cast<unsigned long long>(stats.dropped));
+    return 1;
+  }
+  printf("%s: %llu events, %llu bytes\n", output,
+         static_cast<unsigned long long>(stats.events),
+         static_cast<unsigned long long>(stats.file_bytes));
+  return 0;
+}
@@ -0,0 +1,384 @@
+// Offline analysis of recorded session journals.
+//
+// Usage: journal_analyzer [options] <journal or directory>...
+//
+// Every *.kpj file found (directories are searched recursively) is analysed
+// on a pool of worker threads and a summary JSON document is written to
+// stdout or to --output.
+
+#include <dirent.h>
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "journal_analysis.h"
+
+namespace {
+
+constexpr char kJournalExtension[] = ".kpj";
+
+/// Number of keysyms listed in the "topKeys" section.
+constexpr size_t kTopKeys = 20;
+
+const char* const kEventTypeNames[6] = {
+    "keyDown", "keyUp", "mouseMove", "mouseDown", "mouseUp", "mouseScroll",
+};
+
+struct Options {
+  AnalysisOptions analysis;
+  unsigned jobs = 0;
+  bool per_journal = true;
+  const char* output = nullptr;
+  std::vector<std::string> inputs;
+};
+
+struct JournalFile {
+  std::string path;
+  off_t size;
+};
+
+void print_usage(FILE* out) {
+  fprintf(out,
+          "Usage: journal_analyzer [options] <journal or directory>...\n"
+          "\n"
+          "Options:\n"
+          "  --jobs N          worker threads (default: all cores)\n"
+          "  --grid WxH        heatmap cells (default: 64x36)\n"
+          "  --screen WxH      screen size in pixels (default: 1920x1080)\n"
+          "  --stall-ms N      delivery stall threshold (default: 50)\n"
+          "  --no-per-journal  only emit totals\n"
+          "  --output FILE     write JSON to FILE instead of stdout\n");
+}
+
+bool parse_size(const char* text, int* width, int* height) {
+  return sscanf(text, "%dx%d", width, height) == 2 && *width > 0 &&
+         *height > 0;
+}
+
+bool parse_options(int argc, char** argv, Options* options) {
+  for (int i = 1; i < argc; i++) {
+    const char* arg = argv[i];
+    bool has_value = i + 1 < argc;
+    if (strcmp(arg, "--help") == 0 || strcmp(arg, "-h") == 0) {
+      print_usage(stdout);
+      exit(0);
+    } else if (strcmp(arg, "--jobs") == 0 && has_value) {
+      options->jobs = static_cast<unsigned>(atoi(argv[++i]));
+    } else if (strcmp(arg, "--grid") == 0 && has_value) {
+      if (!parse_size(argv[++i], &options->analysis.grid_width,
+                      &options->analysis.grid_height)) {
+        return false;
+      }
+    } else if (strcmp(arg, "--screen") == 0 && has_value) {
+      if (!parse_size(argv[++i], &options->analysis.screen_width,
+                      &options->analysis.screen_height)) {
+        return false;
+      }
+    } else if (strcmp(arg, "--stall-ms") == 0 && has_value) {
+      options->analysis.stall_threshold_us = 1000LL * atoi(argv[++i]);
+    } else if (strcmp(arg, "--no-per-journal") == 0) {
+      options->per_journal = false;
+    } else if (strcmp(arg, "--output") == 0 && has_value) {
+      options->output = argv[++i];
+    } else if (arg[0] == '-') {
+      return false;
+    } else {
+      options->inputs.push_back(arg);
+    }
+  }
+  return !options->inputs.empty();
+}
+
+bool has_journal_extension(const std::string& path) {
+  size_t n = strlen(kJournalExtension);
+  return path.size() > n &&
+         path.compare(path.size() - n, n, kJournalExtension) == 0;
+}
+
+// Collects journals below [path]. Explicitly named files are accepted
+// regardless of their extension. Symlinks found while walking are followed
+// to files only, so a link back up the tree cannot recurse forever.
+void find_journals(const std::string& path, bool explicit_path,
+                   std::vector<JournalFile>* out) {
+  struct stat st;
+  if (lstat(path.c_str(), &st) != 0) {
+    if (explicit_path) fprintf(stderr, "Cannot access %s\n", path.c_str());
+    return;
+  }
+  if (S_ISLNK(st.st_mode)) {
+    if (stat(path.c_str(), &st) != 0) {
+      if (explicit_path) fprintf(stderr, "Cannot access %s\n", path.c_str());
+      return;
+    }
+    if (!explicit_path && !S_ISREG(st.st_mode)) return;
+  }
+
+  if (S_ISREG(st.st_mode)) {
+    if (explicit_path || has_journal_extension(path)) {
+      out->push_back({path, st.st_size});
+    }
+    return;
+  }
+  if (!S_ISDIR(st.st_mode)) return;
+
+  DIR* dir = opendir(path.c_str());
+  if (dir == nullptr) {
+    fprintf(stderr, "Cannot open directory %s\n", path.c_str());
+    return;
+  }
+  while (struct dirent* entry = readdir(dir)) {
+    if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) {
+      continue;
+    }
+    find_journals(path + "/" + entry->d_name, false, out);
+  }
+  closedir(dir);
+}
+
+// Analyses [files] on [jobs] threads. Each worker claims the next file from
+// a shared counter; files are sorted largest first so one big journal does
+// not end up alone at the tail of the run.
+std::vector<JournalAnalysis> analyze_all(const std::vector<JournalFile>& files,
+                                         const AnalysisOptions& options,
+                                         unsigned jobs) {
+  std::vector<JournalAnalysis> results(files.size());
+  std::atomic<size_t> next(0);
+
+  auto worker = [&]() {
+    AnalysisScratch scratch;
+    for (size_t i = next++; i < files.size(); i = next++) {
+      results[i] = analyze_journal(files[i].path, options, &scratch);
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (unsigned i = 1; i < jobs; i++) threads.emplace_back(worker);
+  worker();
+  for (std::thread& thread : threads) thread.join();
+  return results;
+}
+
+void write_json_string(FILE* out, const std::string& value) {
+  fputc('"', out);
+  for (char c : value) {
+    switch (c) {
+      case '"':
+        fputs("\\\"", out);
+        break;
+      case '\\':
+        fputs("\\\\", out);
+        break;
+      case '\n':
+        fputs("\\n", out);
+        break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20) {
+          fprintf(out, "\\u%04x", c);
+        } else {
+          fputc(c, out);
+        }
+    }
+  }
+  fputc('"', out);
+}
+
+void write_top_keys(FILE* out, const JournalAnalysis& analysis) {
+  std::vector<std::pair<uint32_t, uint64_t>> keys(
+      analysis.key_presses.begin(), analysis.key_presses.end());
+  std::sort(keys.begin(), keys.end(),
+            [](const std::pair<uint32_t, uint64_t>& a,
+               const std::pair<uint32_t, uint64_t>& b) {
+              return a.second != b.second ? a.second > b.second
+                                          : a.first < b.first;
+            });
+  if (keys.size() > kTopKeys) keys.resize(kTopKeys);
+
+  fputs("[", out);
+  for (size_t i = 0; i < keys.size(); i++) {
+    fprintf(out, "%s{\"keysym\": %u, \"presses\": %llu}", i == 0 ? "" : ", ",
+            keys[i].first, static_cast<unsigned long long>(keys[i].second));
+  }
+  fputs("]", out);
+}
+
+// Writes the statistics shared by per-journal entries and the totals.
+void write_stats(FILE* out, const JournalAnalysis& a, const char* indent) {
+  double seconds = a.duration_us / 1e6;
+  fprintf(out, "%s\"fileBytes\": %llu,\n", indent,
+          static_cast<unsigned long long>(a.file_bytes));
+  fprintf(out, "%s\"blocks\": %llu,\n", indent,
+          static_cast<unsigned long long>(a.blocks));
+  fprintf(out, "%s\"events\": %llu,\n", indent,
+          static_cast<unsigned long long>(a.events));
+  fprintf(out, "%s\"durationSeconds\": %.3f,\n", indent, seconds);
+  fprintf(out, "%s\"eventsPerSecond\": %.1f,\n", indent,
+          seconds > 0 ? a.events / seconds : 0.0);
+  fprintf(out, "%s\"peakEventsPerSecond\": %llu,\n", indent,
+          static_cast<unsigned long long>(a.peak_events_per_second));
+  fprintf(out, "%s\"bytesPerEvent\": %.2f,\n", indent,
+          a.events > 0 ? static_cast<double>(a.file_bytes) / a.events : 0.0);
+
+  fprintf(out, "%s\"counts\": {", indent);
+  for (size_t i = 0; i < 6; i++) {
+    fprintf(out, "%s\"%s\": %llu", i == 0 ? "" : ", ", kEventTypeNames[i],
+            static_cast<unsigned long long>(a.counts[i]));
+  }
+  fputs("},\n", out);
+
+  fprintf(out, "%s\"pointerDistancePx\": %.0f,\n", indent,
+          a.pointer_distance_px);
+  fprintf(out, "%s\"scroll\": {\"x\": %lld, \"y\": %lld},\n", indent,
+          static_cast<long long>(a.scroll_x),
+          static_cast<long long>(a.scroll_y));
+
+  fprintf(out, "%s\"topKeys\": ", indent);
+  write_top_keys(out, a);
+  fputs(",\n", out);
+
+  fprintf(out,
+          "%s\"latencyMs\": {\"samples\": %llu, \"p50\": %llu, "
+          "\"p90\": %llu, \"p99\": %llu, \"max\": %llu},\n",
+          indent, static_cast<unsigned long long>(a.latency.count()),
+          static_cast<unsigned long long>(a.latency.percentile(0.5)),
+          static_cast<unsigned long long>(a.latency.percentile(0.9)),
+          static_cast<unsigned long long>(a.latency.percentile(0.99)),
+          static_cast<unsigned long long>(a.latency.max()));
+  fprintf(out,
+          "%s\"drops\": {\"writerDropped\": %llu, \"stalls\": %llu, "
+          "\"longestStallMs\": %.1f}",
+          indent, static_cast<unsigned long long>(a.dropped),
+          static_cast<unsigned long long>(a.stalls),
+          a.longest_stall_us / 1000.0);
+}
+
+void write_heatmap(FILE* out, const JournalAnalysis& totals,
+                   const AnalysisOptions& options) {
+  fprintf(out,
+          "  \"heatmap\": {\n"
+          "    \"width\": %d,\n"
+          "    \"height\": %d,\n"
+          "    \"screenWidth\": %d,\n"
+          "    \"screenHeight\": %d,\n"
+          "    \"cells\": [\n",
+          options.grid_width, options.grid_height, options.screen_width,
+          options.screen_height);
+  for (int row = 0; row < options.grid_height; row++) {
+    fputs("      [", out);
+    for (int col = 0; col < options.grid_width; col++) {
+      size_t i = static_cast<size_t>(row) * options.grid_width + col;
+      uint64_t value = i < totals.heatmap.size() ? totals.heatmap[i] : 0;
+      fprintf(out, "%s%llu", col == 0 ? "" : ", ",
+              static_cast<unsigned long long>(value));
+    }
+    fprintf(out, "]%s\n", row + 1 < options.grid_height ? "," : "");
+  }
+  fputs("    ]\n  }", out);
+}
+
+void write_report(FILE* out, const Options& options, unsigned jobs,
+                  double elapsed_seconds,
+                  const std::vector<JournalAnalysis>& results,
+                  const JournalAnalysis& totals, size_t failed) {
+  fputs("{\n", out);
+  fprintf(out, "  \"journals\": %zu,\n", results.size());
+  fprintf(out, "  \"failed\": %zu,\n", failed);
+  fprintf(out, "  \"jobs\": %u,\n", jobs);
+  fprintf(out, "  \"elapsedSeconds\": %.3f,\n", elapsed_seconds);
+  fprintf(out, "  \"decodedEventsPerSecond\": %.0f,\n",
+          elapsed_seconds > 0 ? totals.events / elapsed_seconds : 0.0);
+
+  fputs("  \"totals\": {\n", out);
+  write_stats(out, totals, "    ");
+  fputs("\n  },\n", out);
+
+  write_heatmap(out, totals, options.analysis);
+
+  if (options.per_journal) {
+    fputs(",\n  \"perJournal\": [\n", out);
+    for (size_t i = 0; i < results.size(); i++) {
+      const JournalAnalysis& result = results[i];
+      fputs("    {\n      \"path\": ", out);
+      write_json_string(out, result.path);
+      if (!result.error.empty()) {
+        fputs(",\n      \"error\": ", out);
+        write_json_string(out, result.error);
+      }
+      fputs(",\n", out);
+      write_stats(out, result, "      ");
+      fprintf(out, "\n    }%s\n", i + 1 < results.size() ? "," : "");
+    }
+    fputs("  ]", out);
+  }
+  fputs("\n}\n", out);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  Options options;
+  if (!parse_options(argc, argv, &options)) {
+    print_usage(stderr);
+    return 2;
+  }
+
+  std::vector<JournalFile> files;
+  for (const std::string& input : options.inputs) {
+    find_journals(input, true, &files);
+  }
+  if (files.empty()) {
+    fprintf(stderr, "No journals found\n");
+    return 1;
+  }
+  std::sort(files.begin(), files.end(),
+            [](const JournalFile& a, const JournalFile& b) {
+              return a.size != b.size ? a.size > b.size : a.path < b.path;
+            });
+
+  unsigned jobs = options.jobs;
+  if (jobs == 0) jobs = std::max(1u, std::thread::hardware_concurrency());
+  jobs = std::min<unsigned>(jobs, files.size());
+
+  auto start = std::chrono::steady_clock::now();
+  std::vector<JournalAnalysis> results =
+      analyze_all(files, options.analysis, jobs);
+  double elapsed = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+
+  // Merge in path order so the report does not depend on scheduling.
+  std::sort(results.begin(), results.end(),
+            [](const JournalAnalysis& a, const JournalAnalysis& b) {
+              return a.path < b.path;
+            });
+  JournalAnalysis totals;
+  size_t failed = 0;
+  for (const JournalAnalysis& result : results) {
+    if (!result.error.empty()) {
+      fprintf(stderr, "%s: %s\n", result.path.c_str(), result.error.c_str());
+      failed++;
+    }
+    totals.merge(result);
+  }
+
+  FILE* out = stdout;
+  if (options.output != nullptr) {
+    out = fopen(options.output, "w");
+    if (out == nullptr) {
+      fprintf(stderr, "Cannot write %s\n", options.output);
+      return 1;
+    }
+  }
+  write_report(out, options, jobs, elapsed, results, totals, failed);
+  if (out != stdout) fclose(out);
+
+  return failed == results.size() ? 1 : 0;
+}
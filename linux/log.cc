@@ -0,0 +1,132 @@
+#include "log.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+
+namespace log_internal {
+#ifdef NDEBUG
+std::atomic<int> g_level(kLogInfo);
+#else
+std::atomic<int> g_level(kLogDebug);
+#endif
+}  // namespace log_internal
+
+namespace {
+
+constexpr size_t kWords = kLogMessageSize / sizeof(uint64_t);
+
+static_assert(kLogMessageSize % sizeof(uint64_t) == 0,
+              "Messages are stored as whole words");
+
+// One ring entry. All fields are relaxed atomics so a dump racing with a
+// writer is well defined; [seq] tells the reader whether its copy is whole.
+struct Slot {
+  // 0: never written. Odd: write in progress. Otherwise 2 * (n + 1) for
+  // the n-th message.
+  std::atomic<uint64_t> seq;
+  std::atomic<int64_t> time_us;
+  std::atomic<int> level;
+  std::atomic<uint64_t> words[kWords];
+};
+
+Slot g_slots[kLogCapacity];
+std::atomic<uint64_t> g_next(0);
+std::atomic<int> g_console_level(kLogInfo);
+
+const char* level_name(LogLevel level) {
+  switch (level) {
+    case kLogTrace: return "TRACE";
+    case kLogDebug: return "DEBUG";
+    case kLogInfo: return "INFO";
+    case kLogWarning: return "WARN";
+    case kLogError: return "ERROR";
+    default: return "?";
+  }
+}
+
+int64_t now_us() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::system_clock::now().time_since_epoch())
+      .count();
+}
+
+}  // namespace
+
+void log_set_level(LogLevel level) {
+  log_internal::g_level.store(level, std::memory_order_relaxed);
+}
+
+LogLevel log_level() {
+  return static_cast<LogLevel>(
+      log_internal::g_level.load(std::memory_order_relaxed));
+}
+
+void log_set_console_level(LogLevel level) {
+  g_console_level.store(level, std::memory_order_relaxed);
+}
+
+void log_write(LogLevel level, const char* tag, const char* format, ...) {
+  uint64_t words[kWords];
+  char* text = reinterpret_cast<char*>(words);
+  memset(words, 0, sizeof(words));
+
+  int length = snprintf(text, kLogMessageSize, "%s: ", tag);
+  if (length < 0) length = 0;
+  if (static_cast<size_t>(length) < kLogMessageSize) {
+    va_list args;
+    va_start(args, format);
+    vsnprintf(text + length, kLogMessageSize - length, format, args);
+    va_end(args);
+  }
+  const int64_t time_us = now_us();
+
+  const uint64_t n = g_next.fetch_add(1, std::memory_order_relaxed);
+  Slot& slot = g_slots[n % kLogCapacity];
+  slot.seq.store(2 * n + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  slot.time_us.store(time_us, std::memory_order_relaxed);
+  slot.level.store(level, std::memory_order_relaxed);
+  for (size_t i = 0; i < kWords; i++) {
+    slot.words[i].store(words[i], std::memory_order_relaxed);
+  }
+  slot.seq.store(2 * n + 2, std::memory_order_release);
+
+  if (level >= g_console_level.load(std::memory_order_relaxed)) {
+    fprintf(stderr, "[%s] %s\n", level_name(level), text);
+  }
+}
+
+void log_dump(std::vector<LogEntry>* out) {
+  out->clear();
+  out->reserve(kLogCapacity);
+
+  for (Slot& slot : g_slots) {
+    const uint64_t before = slot.seq.load(std::memory_order_acquire);
+    if (before == 0 || (before & 1) != 0) continue;
+
+    uint64_t words[kWords];
+    const int64_t time_us = slot.time_us.load(std::memory_order_relaxed);
+    const int level = slot.level.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < kWords; i++) {
+      words[i] = slot.words[i].load(std::memory_order_relaxed);
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot.seq.load(std::memory_order_relaxed) != before) continue;
+
+    const char* text = reinterpret_cast<const char*>(words);
+    LogEntry entry;
+    entry.sequence = before / 2 - 1;
+    entry.time_us = time_us;
+    entry.level = static_cast<LogLevel>(level);
+    entry.text.assign(text, strnlen(text, kLogMessageSize));
+    out->push_back(std::move(entry));
+  }
+
+  std::sort(out->begin(), out->end(),
+            [](const LogEntry& a, const LogEntry& b) {
+              return a.sequence < b.sequence;
+            });
+}
@@ -0,0 +1,98 @@
+#ifndef LOG_H_
+#define LOG_H_
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/// Severity of a log message.
+///
+/// The values mirror the order of the Dart `LogLevel` enum.
+enum LogLevel : int {
+  kLogTrace = 0,
+  kLogDebug = 1,
+  kLogInfo = 2,
+  kLogWarning = 3,
+  kLogError = 4,
+  kLogOff = 5,
+};
+
+/// Lowest level compiled in. Calls below it are removed by the compiler,
+/// arguments included, so trace logging on hot paths costs nothing in
+/// release builds. Override with -DKP_LOG_COMPILED_LEVEL=<level>.
+#ifndef KP_LOG_COMPILED_LEVEL
+#ifdef NDEBUG
+#define KP_LOG_COMPILED_LEVEL kLogInfo
+#else
+#define KP_LOG_COMPILED_LEVEL kLogTrace
+#endif
+#endif
+
+/// Maximum length of a stored message, including the tag.
+constexpr size_t kLogMessageSize = 120;
+
+/// Number of messages kept in the in-memory ring.
+constexpr size_t kLogCapacity = 512;
+
+/// A message read back from the ring by [log_dump].
+struct LogEntry {
+  /// Position in the log; increases by one per message.
+  uint64_t sequence;
+
+  /// Wall-clock time of the message, in microseconds.
+  int64_t time_us;
+
+  LogLevel level;
+
+  /// "tag: message", truncated to [kLogMessageSize] - 1 bytes.
+  std::string text;
+};
+
+namespace log_internal {
+extern std::atomic<int> g_level;
+}  // namespace log_internal
+
+/// Whether messages at [level] are recorded. A single relaxed load.
+inline bool log_enabled(LogLevel level) {
+  return level >= log_internal::g_level.load(std::memory_order_relaxed);
+}
+
+/// Sets the lowest level recorded at runtime. Levels below
+/// [KP_LOG_COMPILED_LEVEL] stay disabled.
+void log_set_level(LogLevel level);
+
+/// The lowest level recorded at runtime.
+LogLevel log_level();
+
+/// Sets the lowest level that is also printed to stderr. Defaults to
+/// [kLogInfo].
+void log_set_console_level(LogLevel level);
+
+/// Records a message. Use the LOG_* macros instead, which skip formatting
+/// when [level] is disabled.
+///
+/// Safe to call from any thread; never blocks. Writers claim ring slots
+/// with a single atomic increment and publish them with a per-slot
+/// sequence number, so the capture thread never waits on a reader.
+void log_write(LogLevel level, const char* tag, const char* format, ...)
+    __attribute__((format(printf, 3, 4)));
+
+/// Copies the messages currently in the ring into [out], oldest first.
+/// Messages overwritten while being copied are skipped.
+void log_dump(std::vector<LogEntry>* out);
+
+#define KP_LOG(level, tag, ...)                                   \
+  do {                                                            \
+    if ((level) >= KP_LOG_COMPILED_LEVEL && log_enabled(level)) { \
+      log_write((level), (tag), __VA_ARGS__);                     \
+    }                                                             \
+  } while (0)
+
+#define LOG_TRACE(tag, ...) KP_LOG(kLogTrace, tag, __VA_ARGS__)
+#define LOG_DEBUG(tag, ...) KP_LOG(kLogDebug, tag, __VA_ARGS__)
+#define LOG_INFO(tag, ...) KP_LOG(kLogInfo, tag, __VA_ARGS__)
+#define LOG_WARNING(tag, ...) KP_LOG(kLogWarning, tag, __VA_ARGS__)
+#define LOG_ERROR(tag, ...) KP_LOG(kLogError, tag, __VA_ARGS__)
+
+#endif  // LOG_H_
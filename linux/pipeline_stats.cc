@@ -0,0 +1,221 @@
+#include "pipeline_stats.h"
+
+#include <time.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+// Minimum interval between capture thread CPU samples.
+constexpr int64_t kCpuSampleIntervalUs = 10 * 1000;
+
+int64_t steady_now_us() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+// Resident set size from /proc/self/statm, or 0 if unavailable.
+int64_t read_rss_bytes() {
+  FILE* file = fopen("/proc/self/statm", "r");
+  if (file == nullptr) return 0;
+  long long size = 0;
+  long long resident = 0;
+  const int fields = fscanf(file, "%lld %lld", &size, &resident);
+  fclose(file);
+  if (fields != 2) return 0;
+  return resident * sysconf(_SC_PAGESIZE);
+}
+
+}  // namespace
+
+PipelineStats::PipelineStats()
+    : queue_depth_(0),
+      merge_buffered_(0),
+      coalesced_(0),
+      dropped_(0),
+      merge_late_(0),
+      capture_cpu_us_(0),
+      cpu_sampled_at_us_(0),
+      sequence_(0),
+      window_start_us_(steady_now_us()),
+      window_cpu_us_(0),
+      cpu_permille_(0),
+      rss_bytes_(read_rss_bytes()) {
+  for (auto& count : events_) count.store(0, std::memory_order_relaxed);
+  for (auto& histogram : histograms_) {
+    for (auto& bucket : histogram) bucket.store(0, std::memory_order_relaxed);
+  }
+  memset(seen_, 0, sizeof(seen_));
+  memset(current_, 0, sizeof(current_));
+  memset(previous_, 0, sizeof(previous_));
+  memset(window_events_, 0, sizeof(window_events_));
+  memset(events_per_s_, 0, sizeof(events_per_s_));
+}
+
+size_t PipelineStats::bucket_for(uint64_t us) {
+  if (us < 4) return static_cast<size_t>(us);
+  const int octave = 63 - __builtin_clzll(us);
+  const size_t sub = (us >> (octave - 2)) & 3;
+  const size_t bucket = 4 * static_cast<size_t>(octave - 1) + sub;
+  return bucket < kBuckets ? bucket : kBuckets - 1;
+}
+
+uint32_t PipelineStats::bucket_value(size_t bucket) {
+  if (bucket < 4) return static_cast<uint32_t>(bucket);
+  const int octave = static_cast<int>(bucket / 4) + 1;
+  const uint64_t sub = bucket % 4;
+  // Middle of the bucket's range.
+  const uint64_t low = (4 + sub) << (octave - 2);
+  const uint64_t high = (5 + sub) << (octave - 2);
+  const uint64_t value = (low + high) / 2;
+  return value > UINT32_MAX ? UINT32_MAX : static_cast<uint32_t>(value);
+}
+
+void PipelineStats::count_event(uint8_t type) {
+  if (type >= kPipelineEventTypes) return;
+  events_[type].fetch_add(1, std::memory_order_relaxed);
+}
+
+void PipelineStats::record_latency(PipelineStage stage, int64_t latency_us) {
+  if (stage >= kStageCount || latency_us < 0) return;
+  histograms_[stage][bucket_for(static_cast<uint64_t>(latency_us))].fetch_add(
+      1, std::memory_order_relaxed);
+}
+
+void PipelineStats::set_batch(size_t queue_depth, uint64_t coalesced,
+                              uint64_t dropped) {
+  queue_depth_.store(static_cast<uint32_t>(queue_depth),
+                     std::memory_order_relaxed);
+  coalesced_.store(coalesced, std::memory_order_relaxed);
+  dropped_.store(dropped, std::memory_order_relaxed);
+}
+
+void PipelineStats::set_merge(size_t buffered, uint64_t late) {
+  merge_buffered_.store(static_cast<uint32_t>(buffered),
+                        std::memory_order_relaxed);
+  merge_late_.store(late, std::memory_order_relaxed);
+}
+
+void PipelineStats::sample_capture_cpu() {
+  const int64_t now_us = steady_now_us();
+  if (now_us - cpu_sampled_at_us_.load(std::memory_order_relaxed) <
+      kCpuSampleIntervalUs) {
+    return;
+  }
+  cpu_sampled_at_us_.store(now_us, std::memory_order_relaxed);
+
+  struct timespec cpu;
+  if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &cpu) == 0) {
+    capture_cpu_us_.store(
+        static_cast<int64_t>(cpu.tv_sec) * 1000000 + cpu.tv_nsec / 1000,
+        std::memory_order_relaxed);
+  }
+}
+
+void PipelineStats::roll_window_locked(int64_t now_us) {
+  const int64_t elapsed_us = now_us - window_start_us_;
+  if (elapsed_us < kWindowUs) return;
+
+  memcpy(previous_, current_, sizeof(previous_));
+  memset(current_, 0, sizeof(current_));
+
+  for (size_t type = 0; type < kPipelineEventTypes; type++) {
+    const uint64_t count = events_[type].load(std::memory_order_relaxed);
+    events_per_s_[type] = static_cast<uint32_t>(
+        (count - window_events_[type]) * 1000000 / elapsed_us);
+    window_events_[type] = count;
+  }
+
+  // A new capture thread starts from zero.
+  const int64_t cpu_us = capture_cpu_us_.load(std::memory_order_relaxed);
+  const int64_t used_us =
+      cpu_us >= window_cpu_us_ ? cpu_us - window_cpu_us_ : cpu_us;
+  cpu_permille_ = static_cast<uint32_t>(used_us * 1000 / elapsed_us);
+  window_cpu_us_ = cpu_us;
+
+  rss_bytes_ = read_rss_bytes();
+  window_start_us_ = now_us;
+}
+
+void PipelineStats::read(PipelineStatsSnapshot* out) {
+  std::lock_guard<std::mutex> lock(read_lock_);
+  const int64_t now_us = steady_now_us();
+
+  // Move what was recorded since the last read into the current window.
+  for (size_t stage = 0; stage < kStageCount; stage++) {
+    for (size_t bucket = 0; bucket < kBuckets; bucket++) {
+      const uint32_t count =
+          histograms_[stage][bucket].load(std::memory_order_relaxed);
+      current_[stage][bucket] += count - seen_[stage][bucket];
+      seen_[stage][bucket] = count;
+    }
+  }
+  roll_window_locked(now_us);
+
+  memset(out, 0, sizeof(*out));
+  out->sequence = ++sequence_;
+  out->sampled_at_us = now_us;
+  for (size_t type = 0; type < kPipelineEventTypes; type++) {
+    out->events[type] = events_[type].load(std::memory_order_relaxed);
+    out->events_per_s[type] = events_per_s_[type];
+  }
+  out->queue_depth = queue_depth_.load(std::memory_order_relaxed);
+  out->merge_buffered = merge_buffered_.load(std::memory_order_relaxed);
+  out->coalesced = coalesced_.load(std::memory_order_relaxed);
+  out->dropped = dropped_.load(std::memory_order_relaxed);
+  out->merge_late = merge_late_.load(std::memory_order_relaxed);
+  out->capture_cpu_us = capture_cpu_us_.load(std::memory_order_relaxed);
+  out->rss_bytes = rss_bytes_;
+  out->capture_cpu_permille = cpu_permille_;
+  out->window_ms = static_cast<uint32_t>(kWindowUs / 1000);
+
+  // Percentiles over the previous and the current (partial) window.
+  static const double kRanks[kPipelinePercentiles - 1] = {0.50, 0.95, 0.99};
+  for (size_t stage = 0; stage < kStageCount; stage++) {
+    uint64_t counts[kBuckets];
+    uint64_t total = 0;
+    size_t highest = 0;
+    for (size_t bucket = 0; bucket < kBuckets; bucket++) {
+      counts[bucket] = static_cast<uint64_t>(current_[stage][bucket]) +
+                       previous_[stage][bucket];
+      total += counts[bucket];
+      if (counts[bucket] != 0) highest = bucket;
+    }
+    if (total == 0) continue;
+
+    for (size_t p = 0; p < kPipelinePercentiles - 1; p++) {
+      const uint64_t rank =
+          static_cast<uint64_t>(kRanks[p] * static_cast<double>(total - 1)) + 1;
+      uint64_t seen = 0;
+      for (size_t bucket = 0; bucket < kBuckets; bucket++) {
+        seen += counts[bucket];
+        if (seen >= rank) {
+          out->latency_us[stage][p] = bucket_value(bucket);
+          break;
+        }
+      }
+    }
+    out->latency_us[stage][kPipelinePercentiles - 1] = bucket_value(highest);
+  }
+}
+
+PipelineStats* pipeline_stats_instance() {
+  static PipelineStats stats;
+  return &stats;
+}
+
+PipelineStatsSnapshot* keyboard_playground_pipeline_stats_new() {
+  return new PipelineStatsSnapshot();
+}
+
+void keyboard_playground_pipeline_stats_free(PipelineStatsSnapshot* snapshot) {
+  delete snapshot;
+}
+
+void keyboard_playground_read_pipeline_stats(PipelineStatsSnapshot* out) {
+  pipeline_stats_instance()->read(out);
+}
@@ -0,0 +1,189 @@
+#ifndef PIPELINE_STATS_H_
+#define PIPELINE_STATS_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+/// Stages of the native input pipeline whose latency is tracked.
+///
+/// The values mirror the order of the Dart `PipelineStage` enum.
+enum PipelineStage : uint8_t {
+  /// X server to the capture thread. Derived from the server timestamp,
+  /// so millisecond resolution, and only where the server's clock is the
+  /// monotonic clock (Xorg, Xwayland).
+  kStageCapture = 0,
+
+  /// Capture thread to dispatch, i.e. time spent in the event merger.
+  kStageMerge = 1,
+
+  /// Dispatch to the batch being sent to Dart, for the oldest event of
+  /// each batch.
+  kStageFlush = 2,
+
+  /// XSync round trip on a side connection, measured by [XLatencyProbe]
+  /// about once a second while input arrives. High values mean a busy X
+  /// server.
+  kStageServerRoundTrip = 3,
+
+  /// X server to a client, for the probe's own events: the server's slice
+  /// of [kStageCapture], without the capture pipeline. Millisecond
+  /// resolution, monotonic server clocks only.
+  kStageServerEvent = 4,
+
+  kStageCount = 5,
+};
+
+/// Number of [CapturedEventType] values counted separately.
+constexpr size_t kPipelineEventTypes = 6;
+
+/// Latency percentiles reported per stage: p50, p95, p99 and max.
+constexpr size_t kPipelinePercentiles = 4;
+
+/// Live statistics of the native input pipeline, for the performance HUD.
+///
+/// The layout is shared with Dart (`NativePipelineStats` in
+/// lib/platform/pipeline_stats.dart) and must stay in sync with it. All
+/// fields are little-endian; the struct is exactly 224 bytes.
+struct PipelineStatsSnapshot {
+  /// Number of reads so far, including this one.
+  uint64_t sequence;
+
+  /// Monotonic time of this read, in microseconds.
+  int64_t sampled_at_us;
+
+  /// Events dispatched since start, by [CapturedEventType].
+  uint64_t events[kPipelineEventTypes];
+
+  /// Events per second in the last full window, by [CapturedEventType].
+  uint32_t events_per_s[kPipelineEventTypes];
+
+  /// Records waiting for the next batch flush.
+  uint32_t queue_depth;
+
+  /// Events buffered in the merger.
+  uint32_t merge_buffered;
+
+  /// Events merged into others, or dropped, for lack of credits or under
+  /// power pressure.
+  uint64_t coalesced;
+  uint64_t dropped;
+
+  /// Events the merger emitted out of order.
+  uint64_t merge_late;
+
+  /// Latency percentiles per [PipelineStage] over the last one to two
+  /// seconds, in microseconds. 0 without samples.
+  uint32_t latency_us[kStageCount][kPipelinePercentiles];
+
+  /// CPU time used by the current capture thread.
+  int64_t capture_cpu_us;
+
+  /// Resident set size of the process.
+  int64_t rss_bytes;
+
+  /// Capture thread CPU usage in the last full window, in per mille of
+  /// one core.
+  uint32_t capture_cpu_permille;
+
+  /// Length of the window rates and percentiles are computed over.
+  uint32_t window_ms;
+};
+
+static_assert(sizeof(PipelineStatsSnapshot) == 224,
+              "PipelineStatsSnapshot layout is shared with Dart");
+
+/// Counters, gauges and latency histograms of the input pipeline.
+///
+/// Writers (capture, merger and platform threads) only do relaxed atomic
+/// increments and stores and never wait. Readers serialize among
+/// themselves: a read turns the cumulative histograms into windowed
+/// percentiles and rates, so a HUD reading once per frame costs the
+/// pipeline nothing but the read itself.
+class PipelineStats {
+ public:
+  /// Length of a rate and percentile window.
+  static constexpr int64_t kWindowUs = 1000 * 1000;
+
+  PipelineStats();
+
+  PipelineStats(const PipelineStats&) = delete;
+  PipelineStats& operator=(const PipelineStats&) = delete;
+
+  /// Counts a dispatched event of [type] (a [CapturedEventType]).
+  void count_event(uint8_t type);
+
+  /// Records a [stage] latency of [latency_us]. Negative values are
+  /// ignored.
+  void record_latency(PipelineStage stage, int64_t latency_us);
+
+  /// Publishes the batch queue state.
+  void set_batch(size_t queue_depth, uint64_t coalesced, uint64_t dropped);
+
+  /// Publishes the merger state.
+  void set_merge(size_t buffered, uint64_t late);
+
+  /// Samples the calling thread's CPU time as the capture thread's, at
+  /// most every few milliseconds. Call from the capture thread.
+  void sample_capture_cpu();
+
+  /// Fills [out] with the current statistics.
+  void read(PipelineStatsSnapshot* out);
+
+ private:
+  /// Log-linear latency buckets: four per power of two, up to ~2^31 us.
+  static constexpr size_t kBuckets = 128;
+
+  static size_t bucket_for(uint64_t us);
+  static uint32_t bucket_value(size_t bucket);
+
+  /// Rolls the window over if it is complete. Requires read_lock_.
+  void roll_window_locked(int64_t now_us);
+
+  std::atomic<uint64_t> events_[kPipelineEventTypes];
+  std::atomic<uint32_t> histograms_[kStageCount][kBuckets];
+  std::atomic<uint32_t> queue_depth_;
+  std::atomic<uint32_t> merge_buffered_;
+  std::atomic<uint64_t> coalesced_;
+  std::atomic<uint64_t> dropped_;
+  std::atomic<uint64_t> merge_late_;
+  std::atomic<int64_t> capture_cpu_us_;
+  std::atomic<int64_t> cpu_sampled_at_us_;
+
+  // Reader state, guarded by read_lock_.
+  std::mutex read_lock_;
+  uint64_t sequence_;
+  int64_t window_start_us_;
+  uint32_t seen_[kStageCount][kBuckets];
+  uint32_t current_[kStageCount][kBuckets];
+  uint32_t previous_[kStageCount][kBuckets];
+  uint64_t window_events_[kPipelineEventTypes];
+  uint32_t events_per_s_[kPipelineEventTypes];
+  int64_t window_cpu_us_;
+  uint32_t cpu_permille_;
+  int64_t rss_bytes_;
+};
+
+/// The process-wide pipeline statistics fed by the input capture plugin.
+PipelineStats* pipeline_stats_instance();
+
+// Entry points exported for Dart FFI.
+extern "C" {
+
+/// Allocates a zeroed snapshot for [keyboard_playground_read_pipeline_stats].
+__attribute__((visibility("default"))) PipelineStatsSnapshot*
+keyboard_playground_pipeline_stats_new();
+
+/// Frees a snapshot allocated by [keyboard_playground_pipeline_stats_new].
+__attribute__((visibility("default"))) void
+keyboard_playground_pipeline_stats_free(PipelineStatsSnapshot* snapshot);
+
+/// Copies the current pipeline statistics into [out]. Never makes the
+/// pipeline wait.
+__attribute__((visibility("default"))) void
+keyboard_playground_read_pipeline_stats(PipelineStatsSnapshot* out);
+
+}  // extern "C"
+
+#endif  // PIPELINE_STATS_H_
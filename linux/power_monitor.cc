@@ -0,0 +1,229 @@
+#include "power_monitor.h"
+
+#include <dirent.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+// Thermal zones reporting outside this range are broken or unused sensors.
+constexpr double kMinPlausibleTempC = 1;
+constexpr double kMaxPlausibleTempC = 150;
+
+// Throttling point assumed for zones without a passive or hot trip point.
+constexpr double kDefaultTripC = 90;
+// Margin kept below the critical trip point when that is the only one.
+constexpr double kCriticalMarginC = 15;
+
+// Tier thresholds.
+constexpr double kReducedHeadroomC = 15;
+constexpr double kMinimalHeadroomC = 5;
+constexpr double kMinimalThrottleRatio = 0.5;
+constexpr int kMinimalBatteryPercent = 10;
+
+// Reads the first line of a small sysfs file, without the newline.
+bool read_line(const std::string& path, std::string* out) {
+  FILE* file = fopen(path.c_str(), "re");
+  if (file == nullptr) {
+    return false;
+  }
+  char buffer[128];
+  const bool ok = fgets(buffer, sizeof(buffer), file) != nullptr;
+  fclose(file);
+  if (!ok) {
+    return false;
+  }
+  size_t length = strlen(buffer);
+  while (length > 0 && (buffer[length - 1] == '\n' || buffer[length - 1] == ' ')) {
+    length--;
+  }
+  out->assign(buffer, length);
+  return true;
+}
+
+bool read_long(const std::string& path, long* out) {
+  std::string line;
+  if (!read_line(path, &line) || line.empty()) {
+    return false;
+  }
+  char* end = nullptr;
+  errno = 0;
+  const long value = strtol(line.c_str(), &end, 10);
+  // The whole line, so a truncated or garbled file is not read as a
+  // plausible prefix of itself.
+  if (end == line.c_str() || *end != '\0' || errno == ERANGE) {
+    return false;
+  }
+  *out = value;
+  return true;
+}
+
+// Names of the entries in [dir] starting with [prefix].
+std::vector<std::string> list_entries(const std::string& dir,
+                                      const char* prefix) {
+  std::vector<std::string> names;
+  DIR* handle = opendir(dir.c_str());
+  if (handle == nullptr) {
+    return names;
+  }
+  const size_t prefix_length = strlen(prefix);
+  while (struct dirent* entry = readdir(handle)) {
+    if (entry->d_name[0] != '.' &&
+        strncmp(entry->d_name, prefix, prefix_length) == 0) {
+      names.push_back(entry->d_name);
+    }
+  }
+  closedir(handle);
+  std::sort(names.begin(), names.end());
+  return names;
+}
+
+// Temperature at which [zone] starts throttling.
+double zone_trip_c(const std::string& zone) {
+  double passive = 0;
+  double critical = 0;
+  for (int i = 0;; i++) {
+    const std::string trip = zone + "/trip_point_" + std::to_string(i);
+    std::string type;
+    long temp = 0;
+    if (!read_line(trip + "_type", &type)) {
+      break;
+    }
+    if (!read_long(trip + "_temp", &temp) || temp <= 0) {
+      continue;
+    }
+    const double temp_c = temp / 1000.0;
+    if (type == "passive" || type == "hot") {
+      passive = passive > 0 ? std::min(passive, temp_c) : temp_c;
+    } else if (type == "critical") {
+      critical = critical > 0 ? std::min(critical, temp_c) : temp_c;
+    }
+  }
+  if (passive > 0) return passive;
+  if (critical > 0) return critical - kCriticalMarginC;
+  return kDefaultTripC;
+}
+
+// Whether a cooling device limits the processor (as opposed to a fan).
+bool is_processor_cooling(const std::string& type) {
+  return type.compare(0, 9, "Processor") == 0 ||
+         type.find("cpufreq") != std::string::npos ||
+         type.find("powerclamp") != std::string::npos ||
+         type.find("devfreq") != std::string::npos;
+}
+
+}  // namespace
+
+PowerMonitor::PowerMonitor(const std::string& sysfs_root)
+    : root_(sysfs_root), tier_(kTierFull), better_samples_(0) {
+  memset(&readings_, 0, sizeof(readings_));
+  readings_.battery_percent = -1;
+}
+
+PowerReadings PowerMonitor::read() const {
+  PowerReadings readings;
+  memset(&readings, 0, sizeof(readings));
+  readings.battery_percent = -1;
+
+  const std::string thermal = root_ + "/class/thermal";
+  for (const std::string& name : list_entries(thermal, "thermal_zone")) {
+    const std::string zone = thermal + "/" + name;
+    long temp = 0;
+    if (!read_long(zone + "/temp", &temp)) {
+      continue;
+    }
+    const double temp_c = temp / 1000.0;
+    if (temp_c < kMinPlausibleTempC || temp_c > kMaxPlausibleTempC) {
+      continue;
+    }
+    const double headroom = zone_trip_c(zone) - temp_c;
+    if (!readings.has_thermal) {
+      readings.has_thermal = true;
+      readings.max_temp_c = temp_c;
+      readings.headroom_c = headroom;
+    } else {
+      readings.max_temp_c = std::max(readings.max_temp_c, temp_c);
+      readings.headroom_c = std::min(readings.headroom_c, headroom);
+    }
+  }
+
+  for (const std::string& name : list_entries(thermal, "cooling_device")) {
+    const std::string device = thermal + "/" + name;
+    std::string type;
+    long current = 0;
+    long maximum = 0;
+    if (!read_line(device + "/type", &type) || !is_processor_cooling(type) ||
+        !read_long(device + "/cur_state", &current) ||
+        !read_long(device + "/max_state", &maximum) || maximum <= 0) {
+      continue;
+    }
+    readings.throttle_ratio = std::max(
+        readings.throttle_ratio,
+        std::min(1.0, std::max(0.0, static_cast<double>(current) / maximum)));
+  }
+
+  const std::string power = root_ + "/class/power_supply";
+  for (const std::string& name : list_entries(power, "")) {
+    const std::string supply = power + "/" + name;
+    std::string type;
+    if (!read_line(supply + "/type", &type) || type != "Battery") {
+      continue;
+    }
+    // Peripherals (mice, keyboards) report batteries with scope "Device".
+    std::string scope;
+    if (read_line(supply + "/scope", &scope) && scope == "Device") {
+      continue;
+    }
+    readings.has_battery = true;
+
+    std::string status;
+    if (read_line(supply + "/status", &status) && status == "Discharging") {
+      readings.on_battery = true;
+    }
+    long capacity = 0;
+    if (read_long(supply + "/capacity", &capacity) && capacity >= 0) {
+      const int percent = static_cast<int>(std::min(100L, capacity));
+      readings.battery_percent = readings.battery_percent < 0
+                                     ? percent
+                                     : std::min(readings.battery_percent, percent);
+    }
+  }
+
+  return readings;
+}
+
+PerformanceTier PowerMonitor::recommend(const PowerReadings& readings) {
+  const bool low_battery = readings.on_battery &&
+                           readings.battery_percent >= 0 &&
+                           readings.battery_percent <= kMinimalBatteryPercent;
+  if ((readings.has_thermal && readings.headroom_c <= kMinimalHeadroomC) ||
+      readings.throttle_ratio >= kMinimalThrottleRatio || low_battery) {
+    return kTierMinimal;
+  }
+  if ((readings.has_thermal && readings.headroom_c <= kReducedHeadroomC) ||
+      readings.throttle_ratio > 0 || readings.on_battery) {
+    return kTierReduced;
+  }
+  return kTierFull;
+}
+
+PerformanceTier PowerMonitor::update() {
+  readings_ = read();
+  const PerformanceTier recommended = recommend(readings_);
+
+  if (recommended >= tier_) {
+    // Back off immediately.
+    tier_ = recommended;
+    better_samples_ = 0;
+  } else if (++better_samples_ >= kRecoverSamples) {
+    // Recover one tier at a time.
+    tier_ = static_cast<PerformanceTier>(tier_ - 1);
+    better_samples_ = 0;
+  }
+  return tier_;
+}
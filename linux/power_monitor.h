@@ -0,0 +1,90 @@
+#ifndef POWER_MONITOR_H_
+#define POWER_MONITOR_H_
+
+#include <cstdint>
+#include <string>
+
+/// How much work the machine can take right now.
+///
+/// The values mirror the order of the Dart `PerformanceTier` enum.
+enum PerformanceTier : uint8_t {
+  /// No thermal or power pressure.
+  kTierFull = 0,
+
+  /// Warm, throttling lightly, or on battery: reduce effects and coalesce
+  /// pointer motion.
+  kTierReduced = 1,
+
+  /// Close to throttling, or low battery: minimal effects and input rate.
+  kTierMinimal = 2,
+};
+
+/// One sample of the thermal and power state.
+struct PowerReadings {
+  /// Whether any usable thermal zone was found.
+  bool has_thermal;
+
+  /// Hottest thermal zone, in degrees Celsius.
+  double max_temp_c;
+
+  /// Smallest distance of any zone to its first passive (throttling) trip
+  /// point, in degrees Celsius. Negative once a zone is past it.
+  double headroom_c;
+
+  /// Highest cur_state / max_state of the processor cooling devices (CPU
+  /// frequency limits, idle injection), from 0 (not throttled) to 1.
+  double throttle_ratio;
+
+  /// Whether a battery was found.
+  bool has_battery;
+
+  /// Whether the battery is discharging.
+  bool on_battery;
+
+  /// Battery charge in percent, or -1 if unknown.
+  int battery_percent;
+};
+
+/// Reads thermal zones, cooling devices and power supplies from sysfs and
+/// recommends a [PerformanceTier].
+///
+/// The sysfs root is configurable so the monitor can run against a fake
+/// tree (`<root>/class/thermal/...`, `<root>/class/power_supply/...`).
+/// A sample reads a few dozen small files and takes well under a
+/// millisecond; poll it every few seconds.
+///
+/// The tier gets worse as soon as a sample calls for it, so the app backs
+/// off before the hardware throttles it into stutter, but only improves
+/// after [kRecoverSamples] samples in a row allow it.
+///
+/// Not thread-safe.
+class PowerMonitor {
+ public:
+  /// Consecutive better samples needed before the tier improves.
+  static constexpr int kRecoverSamples = 3;
+
+  explicit PowerMonitor(const std::string& sysfs_root = "/sys");
+
+  /// Takes a sample and updates [tier]. Returns the new tier.
+  PerformanceTier update();
+
+  /// The current tier, with hysteresis.
+  PerformanceTier tier() const { return tier_; }
+
+  /// The readings of the last [update].
+  const PowerReadings& readings() const { return readings_; }
+
+  /// Reads the current state without updating the tier.
+  PowerReadings read() const;
+
+  /// Tier suggested by a single sample, without hysteresis.
+  static PerformanceTier recommend(const PowerReadings& readings);
+
+ private:
+  std::string root_;
+  PowerReadings readings_;
+  PerformanceTier tier_;
+  int better_samples_;
+};
+
+#endif  // POWER_MONITOR_H_
@@ -7,6 +7,7 @@
 
 #include "flutter/generated_plugin_registrant.h"
 #include "input_capture_plugin.h"
+#include "view_input_filter.h"
 #include "window_control_plugin.h"
 
 struct _MyApplication {
@@ -61,6 +62,13 @@ static void my_application_activate(GApplication* application) {
 
   fl_register_plugins(FL_PLUGIN_REGISTRY(view));
 
+  // While input capture runs, keys and motion over the window already reach
+  // Dart through XRecord; keep GTK from handing the engine a second copy.
+  // KEYBOARD_PLAYGROUND_VIEW_INPUT=engine delivers everything as usual.
+  if (g_strcmp0(g_getenv("KEYBOARD_PLAYGROUND_VIEW_INPUT"), "engine") != 0) {
+    view_input_filter_install(view);
+  }
+
   // Register custom input capture plugin
   input_capture_plugin_register_with_registrar(
       fl_plugin_registry_get_registrar_for_plugin(FL_PLUGIN_REGISTRY(view), "InputCapturePlugin"));
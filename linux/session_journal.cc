@@ -0,0 +1,735 @@
+#include "session_journal.h"
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#ifdef KP_JOURNAL_HAVE_LZ4
+#include <lz4.h>
+#endif
+#ifdef KP_JOURNAL_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+namespace {
+
+constexpr char kFileMagic[4] = {'K', 'P', 'J', '1'};
+constexpr char kBlockMagic[4] = {'K', 'P', 'J', 'B'};
+constexpr char kTrailerMagic[4] = {'K', 'P', 'J', 'X'};
+constexpr uint16_t kFormatVersion = 1;
+
+constexpr size_t kFileHeaderSize = 32;
+constexpr size_t kBlockHeaderSize = 40;
+constexpr size_t kIndexEntrySize = 24;
+constexpr size_t kTrailerSize = 16;
+
+/// Upper bound for one encoded event: header byte plus six varints.
+constexpr size_t kMaxEventSize = 1 + 6 * 10;
+
+/// Number of block buffers shared between the capture and writer threads.
+constexpr size_t kBlockPoolSize = 8;
+
+/// zstd level used for blocks; favours speed, blocks are small anyway.
+constexpr int kZstdLevel = 3;
+
+void put_u16(uint8_t* p, uint16_t v) {
+  p[0] = static_cast<uint8_t>(v);
+  p[1] = static_cast<uint8_t>(v >> 8);
+}
+
+void put_u32(uint8_t* p, uint32_t v) {
+  for (int i = 0; i < 4; i++) p[i] = static_cast<uint8_t>(v >> (8 * i));
+}
+
+void put_u64(uint8_t* p, uint64_t v) {
+  for (int i = 0; i < 8; i++) p[i] = static_cast<uint8_t>(v >> (8 * i));
+}
+
+uint16_t get_u16(const uint8_t* p) {
+  return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+uint32_t get_u32(const uint8_t* p) {
+  uint32_t v = 0;
+  for (int i = 0; i < 4; i++) v |= static_cast<uint32_t>(p[i]) << (8 * i);
+  return v;
+}
+
+uint64_t get_u64(const uint8_t* p) {
+  uint64_t v = 0;
+  for (int i = 0; i < 8; i++) v |= static_cast<uint64_t>(p[i]) << (8 * i);
+  return v;
+}
+
+uint64_t zigzag(int64_t v) {
+  return (static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63);
+}
+
+int64_t unzigzag(uint64_t v) {
+  return static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1);
+}
+
+size_t put_varint(uint8_t* p, uint64_t v) {
+  size_t n = 0;
+  while (v >= 0x80) {
+    p[n++] = static_cast<uint8_t>(v | 0x80);
+    v >>= 7;
+  }
+  p[n++] = static_cast<uint8_t>(v);
+  return n;
+}
+
+bool get_varint(const uint8_t** p, const uint8_t* end, uint64_t* out) {
+  uint64_t v = 0;
+  for (int shift = 0; shift < 64; shift += 7) {
+    if (*p >= end) return false;
+    uint8_t byte = *(*p)++;
+    v |= static_cast<uint64_t>(byte & 0x7F) << shift;
+    if ((byte & 0x80) == 0) {
+      *out = v;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool write_all(int fd, const uint8_t* data, size_t size) {
+  while (size > 0) {
+    ssize_t n = write(fd, data, size);
+    if (n < 0) {
+      if (errno == EINTR) continue;
+      return false;
+    }
+    data += n;
+    size -= static_cast<size_t>(n);
+  }
+  return true;
+}
+
+/// Compresses [src] into [dst] with [codec]. Returns the compressed size, or
+/// 0 if the codec is unavailable or compression did not save space.
+size_t compress_block(JournalCodec codec, const uint8_t* src, size_t size,
+                      std::vector<uint8_t>* dst) {
+  switch (codec) {
+#ifdef KP_JOURNAL_HAVE_LZ4
+    case kJournalCodecLz4: {
+      dst->resize(LZ4_compressBound(static_cast<int>(size)));
+      int n = LZ4_compress_default(reinterpret_cast<const char*>(src),
+                                   reinterpret_cast<char*>(dst->data()),
+                                   static_cast<int>(size),
+                                   static_cast<int>(dst->size()));
+      return n > 0 && static_cast<size_t>(n) < size ? n : 0;
+    }
+#endif
+#ifdef KP_JOURNAL_HAVE_ZSTD
+    case kJournalCodecZstd: {
+      dst->resize(ZSTD_compressBound(size));
+      size_t n = ZSTD_compress(dst->data(), dst->size(), src, size, kZstdLevel);
+      return !ZSTD_isError(n) && n < size ? n : 0;
+    }
+#endif
+    default:
+      (void)src;
+      (void)size;
+      (void)dst;
+      return 0;
+  }
+}
+
+bool decompress_block(JournalCodec codec, const uint8_t* src, size_t size,
+                      uint8_t* dst, size_t raw_size) {
+  switch (codec) {
+    case kJournalCodecNone:
+      if (size != raw_size) return false;
+      memcpy(dst, src, size);
+      return true;
+#ifdef KP_JOURNAL_HAVE_LZ4
+    case kJournalCodecLz4:
+      return LZ4_decompress_safe(reinterpret_cast<const char*>(src),
+                                 reinterpret_cast<char*>(dst),
+                                 static_cast<int>(size),
+                                 static_cast<int>(raw_size)) ==
+             static_cast<int>(raw_size);
+#endif
+#ifdef KP_JOURNAL_HAVE_ZSTD
+    case kJournalCodecZstd:
+      return ZSTD_decompress(dst, raw_size, src, size) == raw_size;
+#endif
+    default:
+      return false;
+  }
+}
+
+}  // namespace
+
+bool journal_codec_available(JournalCodec codec) {
+  switch (codec) {
+    case kJournalCodecNone:
+      return true;
+    case kJournalCodecLz4:
+#ifdef KP_JOURNAL_HAVE_LZ4
+      return true;
+#else
+      return false;
+#endif
+    case kJournalCodecZstd:
+#ifdef KP_JOURNAL_HAVE_ZSTD
+      return true;
+#else
+      return false;
+#endif
+  }
+  return false;
+}
+
+JournalCodec journal_codec_best() {
+  if (journal_codec_available(kJournalCodecZstd)) return kJournalCodecZstd;
+  if (journal_codec_available(kJournalCodecLz4)) return kJournalCodecLz4;
+  return kJournalCodecNone;
+}
+
+JournalCodec journal_codec_from_name(const char* name) {
+  if (name == nullptr) return kJournalCodecNone;
+  if (strcmp(name, "lz4") == 0) return kJournalCodecLz4;
+  if (strcmp(name, "zstd") == 0) return kJournalCodecZstd;
+  return kJournalCodecNone;
+}
+
+// ---------------------------------------------------------------------------
+// JournalWriter
+
+JournalWriter::JournalWriter()
+    : fd_(-1),
+      codec_(kJournalCodecNone),
+      current_(nullptr),
+      prev_ts_us_(0),
+      prev_x_(0),
+      prev_y_(0),
+      prev_server_time_(0),
+      pending_drops_(0),
+      events_(0),
+      dropped_(0),
+      stopping_(false),
+      failed_(false),
+      file_offset_(0),
+      raw_bytes_(0),
+      lost_events_(0),
+      error_(0),
+      tail_damaged_(false) {}
+
+JournalWriter::~JournalWriter() {
+  close();
+  for (Block* block : all_) delete block;
+}
+
+bool JournalWriter::open(const char* path, JournalCodec codec,
+                         int64_t realtime_offset_us, std::string* error) {
+  if (fd_ >= 0) {
+    if (error) *error = "journal already open";
+    return false;
+  }
+
+  fd_ = ::open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if (fd_ < 0) {
+    if (error) *error = std::string("cannot create journal: ") + strerror(errno);
+    return false;
+  }
+
+  codec_ = journal_codec_available(codec) ? codec : kJournalCodecNone;
+
+  uint8_t header[kFileHeaderSize] = {};
+  memcpy(header, kFileMagic, 4);
+  put_u16(header + 4, kFormatVersion);
+  put_u16(header + 6, kFileHeaderSize);
+  put_u32(header + 8, kBlockSize);
+  put_u32(header + 12, 0);  // flags
+  put_u64(header + 16, static_cast<uint64_t>(realtime_offset_us));
+  put_u64(header + 24, 0);  // reserved
+  if (!write_all(fd_, header, sizeof(header))) {
+    if (error) *error = std::string("cannot write journal: ") + strerror(errno);
+    ::close(fd_);
+    fd_ = -1;
+    return false;
+  }
+  file_offset_ = kFileHeaderSize;
+  raw_bytes_ = 0;
+  lost_events_ = 0;
+  error_ = 0;
+  tail_damaged_ = false;
+  failed_.store(false, std::memory_order_relaxed);
+  index_.clear();
+
+  if (all_.empty()) {
+    for (size_t i = 0; i < kBlockPoolSize; i++) {
+      Block* block = new Block();
+      block->data.resize(kBlockSize);
+      all_.push_back(block);
+    }
+  }
+  free_ = all_;
+  full_.clear();
+  events_ = 0;
+  dropped_ = 0;
+  pending_drops_ = 0;
+  stopping_ = false;
+
+  current_ = nullptr;
+  begin_block();
+
+  thread_ = std::thread(&JournalWriter::writer_loop, this);
+  return true;
+}
+
+void JournalWriter::begin_block() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (free_.empty()) {
+    current_ = nullptr;
+    return;
+  }
+  current_ = free_.back();
+  free_.pop_back();
+  current_->size = 0;
+  current_->event_count = 0;
+  current_->dropped_before = pending_drops_;
+  current_->first_ts_us = 0;
+  current_->last_ts_us = 0;
+  pending_drops_ = 0;
+}
+
+void JournalWriter::submit_block() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    full_.push_back(current_);
+  }
+  cv_.notify_one();
+  current_ = nullptr;
+}
+
+void JournalWriter::append(const CapturedEvent& event) {
+  if (fd_ < 0) return;
+  if (failed_.load(std::memory_order_relaxed)) {
+    dropped_++;
+    return;
+  }
+
+  if (current_ != nullptr && current_->size + kMaxEventSize > kBlockSize) {
+    submit_block();
+  }
+  if (current_ == nullptr) {
+    begin_block();
+    if (current_ == nullptr) {
+      // Writer thread is behind and every buffer is in flight.
+      pending_drops_++;
+      dropped_++;
+      return;
+    }
+  }
+
+  Block* block = current_;
+  if (block->event_count == 0) {
+    // Every block starts from a fresh delta state so it decodes on its own.
+    block->first_ts_us = event.timestamp_us;
+    prev_ts_us_ = event.timestamp_us;
+    prev_x_ = 0;
+    prev_y_ = 0;
+    prev_server_time_ = 0;
+  }
+
+  uint8_t* p = block->data.data() + block->size;
+  uint8_t* start = p;
+
+  *p++ = static_cast<uint8_t>((event.type & 0x07) |
+                              ((event.modifiers & 0x0F) << 3));
+  int64_t dt = std::max<int64_t>(0, event.timestamp_us - prev_ts_us_);
+  p += put_varint(p, static_cast<uint64_t>(dt));
+  p += put_varint(p, zigzag(static_cast<int32_t>(event.server_time_ms -
+                                                 prev_server_time_)));
+
+  switch (event.type) {
+    case kCapturedKeyDown:
+    case kCapturedKeyUp:
+      p += put_varint(p, event.code);
+      p += put_varint(p, event.keysym);
+      break;
+    case kCapturedMouseDown:
+    case kCapturedMouseUp:
+      p += put_varint(p, event.code);
+      p += put_varint(p, zigzag(static_cast<int64_t>(event.x) - prev_x_));
+      p += put_varint(p, zigzag(static_cast<int64_t>(event.y) - prev_y_));
+      prev_x_ = event.x;
+      prev_y_ = event.y;
+      break;
+    case kCapturedMouseMove:
+      p += put_varint(p, zigzag(static_cast<int64_t>(event.x) - prev_x_));
+      p += put_varint(p, zigzag(static_cast<int64_t>(event.y) - prev_y_));
+      prev_x_ = event.x;
+      prev_y_ = event.y;
+      break;
+    case kCapturedMouseScroll:
+      // Scroll deltas are not positions, so they do not update prev_x/y.
+      p += put_varint(p, zigzag(event.x));
+      p += put_varint(p, zigzag(event.y));
+      break;
+  }
+
+  block->size += static_cast<size_t>(p - start);
+  block->event_count++;
+  block->last_ts_us = event.timestamp_us;
+  prev_ts_us_ = event.timestamp_us;
+  prev_server_time_ = event.server_time_ms;
+  events_++;
+}
+
+void JournalWriter::writer_loop() {
+  pthread_setname_np(pthread_self(), "kp-journal");
+  std::vector<uint8_t> scratch;
+  for (;;) {
+    Block* block = nullptr;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      cv_.wait(lock, [this] { return stopping_ || !full_.empty(); });
+      if (full_.empty()) return;
+      block = full_.front();
+      full_.pop_front();
+    }
+
+    write_block(block, &scratch);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    free_.push_back(block);
+  }
+}
+
+void JournalWriter::write_block(Block* block, std::vector<uint8_t>* scratch) {
+  if (error_ != 0) {
+    // Already failed; the block is only recycled.
+    lost_events_ += block->event_count;
+    return;
+  }
+
+  const uint8_t* payload = block->data.data();
+  size_t stored = block->size;
+  JournalCodec codec = kJournalCodecNone;
+
+  if (codec_ != kJournalCodecNone) {
+    size_t n = compress_block(codec_, payload, block->size, scratch);
+    if (n > 0) {
+      payload = scratch->data();
+      stored = n;
+      codec = codec_;
+    }
+  }
+
+  uint8_t header[kBlockHeaderSize] = {};
+  memcpy(header, kBlockMagic, 4);
+  header[4] = codec;
+  put_u32(header + 8, static_cast<uint32_t>(block->size));
+  put_u32(header + 12, static_cast<uint32_t>(stored));
+  put_u32(header + 16, block->event_count);
+  put_u32(header + 20, block->dropped_before);
+  put_u64(header + 24, static_cast<uint64_t>(block->first_ts_us));
+  put_u64(header + 32, static_cast<uint64_t>(block->last_ts_us));
+
+  if (!write_all(fd_, header, sizeof(header)) ||
+      !write_all(fd_, payload, stored)) {
+    error_ = errno != 0 ? errno : EIO;
+    // Drop the partial block, so the file ends on a complete one and the
+    // index written by close() still matches it.
+    tail_damaged_ =
+        ftruncate(fd_, static_cast<off_t>(file_offset_)) != 0 ||
+        lseek(fd_, static_cast<off_t>(file_offset_), SEEK_SET) < 0;
+    failed_.store(true, std::memory_order_relaxed);
+    lost_events_ += block->event_count;
+    return;
+  }
+
+  index_.push_back({block->first_ts_us, block->last_ts_us, file_offset_});
+  file_offset_ += kBlockHeaderSize + stored;
+  raw_bytes_ += block->size;
+}
+
+JournalStats JournalWriter::close() {
+  JournalStats stats = {};
+  if (fd_ < 0) return stats;
+
+  if (current_ != nullptr && current_->event_count > 0) {
+    submit_block();
+  } else if (current_ != nullptr) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    free_.push_back(current_);
+    current_ = nullptr;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  cv_.notify_one();
+  thread_.join();
+
+  // With a partial block left at the end, the file offsets in the index
+  // would be wrong; readers rebuild the index by scanning the blocks.
+  std::vector<uint8_t> index;
+  if (!tail_damaged_) {
+    index.resize(index_.size() * kIndexEntrySize + kTrailerSize);
+    uint8_t* p = index.data();
+    for (const JournalBlockInfo& info : index_) {
+      put_u64(p, static_cast<uint64_t>(info.first_ts_us));
+      put_u64(p + 8, static_cast<uint64_t>(info.last_ts_us));
+      put_u64(p + 16, info.offset);
+      p += kIndexEntrySize;
+    }
+    put_u64(p, file_offset_);
+    put_u32(p + 8, static_cast<uint32_t>(index_.size()));
+    memcpy(p + 12, kTrailerMagic, 4);
+    if (!write_all(fd_, index.data(), index.size()) && error_ == 0) {
+      error_ = errno != 0 ? errno : EIO;
+    }
+  }
+
+  stats.events = events_ - lost_events_;
+  stats.dropped = dropped_ + lost_events_;
+  stats.blocks = index_.size();
+  stats.raw_bytes = raw_bytes_;
+  stats.file_bytes = file_offset_ + index.size();
+  stats.error = error_;
+
+  ::close(fd_);
+  fd_ = -1;
+  return stats;
+}
+
+// ---------------------------------------------------------------------------
+// JournalReader
+
+JournalReader::JournalReader()
+    : fd_(-1), data_(nullptr), size_(0), realtime_offset_us_(0) {}
+
+JournalReader::~JournalReader() { close(); }
+
+bool JournalReader::open(const char* path, std::string* error) {
+  close();
+
+  fd_ = ::open(path, O_RDONLY | O_CLOEXEC);
+  if (fd_ < 0) {
+    if (error) *error = std::string("cannot open journal: ") + strerror(errno);
+    return false;
+  }
+
+  struct stat st;
+  if (fstat(fd_, &st) != 0 ||
+      static_cast<size_t>(st.st_size) < kFileHeaderSize) {
+    if (error) *error = "not a journal (too small)";
+    close();
+    return false;
+  }
+  size_ = static_cast<size_t>(st.st_size);
+
+  void* map = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd_, 0);
+  if (map == MAP_FAILED) {
+    if (error) *error = std::string("cannot map journal: ") + strerror(errno);
+    size_ = 0;
+    close();
+    return false;
+  }
+  data_ = static_cast<const uint8_t*>(map);
+  // Blocks are mostly read front to back during replay and analysis.
+  madvise(map, size_, MADV_SEQUENTIAL);
+
+  if (memcmp(data_, kFileMagic, 4) != 0 ||
+      get_u16(data_ + 4) != kFormatVersion) {
+    if (error) *error = "not a journal (bad magic or version)";
+    close();
+    return false;
+  }
+  realtime_offset_us_ = static_cast<int64_t>(get_u64(data_ + 16));
+
+  if (!load_index() && !scan_blocks()) {
+    if (error) *error = "journal is corrupt";
+    close();
+    return false;
+  }
+  return true;
+}
+
+void JournalReader::close() {
+  if (data_ != nullptr) {
+    munmap(const_cast<uint8_t*>(data_), size_);
+    data_ = nullptr;
+  }
+  if (fd_ >= 0) {
+    ::close(fd_);
+    fd_ = -1;
+  }
+  size_ = 0;
+  index_.clear();
+}
+
+bool JournalReader::load_index() {
+  if (size_ < kFileHeaderSize + kTrailerSize) return false;
+  const uint8_t* trailer = data_ + size_ - kTrailerSize;
+  if (memcmp(trailer + 12, kTrailerMagic, 4) != 0) return false;
+
+  uint64_t index_offset = get_u64(trailer);
+  uint32_t count = get_u32(trailer + 8);
+  if (index_offset + static_cast<uint64_t>(count) * kIndexEntrySize !=
+      size_ - kTrailerSize) {
+    return false;
+  }
+
+  index_.resize(count);
+  const uint8_t* p = data_ + index_offset;
+  for (uint32_t i = 0; i < count; i++, p += kIndexEntrySize) {
+    index_[i].first_ts_us = static_cast<int64_t>(get_u64(p));
+    index_[i].last_ts_us = static_cast<int64_t>(get_u64(p + 8));
+    index_[i].offset = get_u64(p + 16);
+    if (index_[i].offset + kBlockHeaderSize > index_offset) return false;
+  }
+  return true;
+}
+
+bool JournalReader::scan_blocks() {
+  // Recovery path for journals whose writer never reached close(). Such a
+  // writer cuts the file back to its last complete block, so anything but
+  // whole blocks up to the end of the file means the journal is damaged.
+  index_.clear();
+  size_t offset = kFileHeaderSize;
+  while (offset + kBlockHeaderSize <= size_) {
+    const uint8_t* header = data_ + offset;
+    if (memcmp(header, kBlockMagic, 4) != 0) break;
+    uint32_t stored = get_u32(header + 12);
+    if (offset + kBlockHeaderSize + stored > size_) break;
+    index_.push_back({static_cast<int64_t>(get_u64(header + 24)),
+                      static_cast<int64_t>(get_u64(header + 32)), offset});
+    offset += kBlockHeaderSize + stored;
+  }
+  if (offset != size_ || index_.empty()) {
+    index_.clear();
+    return false;
+  }
+  return true;
+}
+
+uint32_t JournalReader::dropped_before(size_t i) const {
+  return get_u32(data_ + index_[i].offset + 20);
+}
+
+int64_t JournalReader::start_time_us() const {
+  return index_.empty() ? 0 : index_.front().first_ts_us;
+}
+
+int64_t JournalReader::end_time_us() const {
+  return index_.empty() ? 0 : index_.back().last_ts_us;
+}
+
+size_t JournalReader::find_block(int64_t timestamp_us) const {
+  if (index_.empty()) return 0;
+  // First block whose range ends at or after the timestamp.
+  auto it = std::lower_bound(
+      index_.begin(), index_.end(), timestamp_us,
+      [](const JournalBlockInfo& info, int64_t ts) {
+        return info.last_ts_us < ts;
+      });
+  if (it == index_.end()) return index_.size() - 1;
+  return static_cast<size_t>(it - index_.begin());
+}
+
+bool JournalReader::decode_block(size_t i, std::vector<uint8_t>* scratch,
+                                 std::vector<CapturedEvent>* out) const {
+  if (i >= index_.size()) return false;
+  const uint8_t* header = data_ + index_[i].offset;
+  JournalCodec codec = static_cast<JournalCodec>(header[4]);
+  uint32_t raw_size = get_u32(header + 8);
+  uint32_t stored = get_u32(header + 12);
+  uint32_t count = get_u32(header + 16);
+  int64_t ts = static_cast<int64_t>(get_u64(header + 24));
+
+  const uint8_t* payload = header + kBlockHeaderSize;
+  if (payload + stored > data_ + size_) return false;
+  // The writer never fills more than one block buffer; a larger size is a
+  // damaged header and must not size the scratch buffer.
+  if (raw_size > JournalWriter::kBlockSize) return false;
+  if (codec != kJournalCodecNone) {
+    scratch->resize(raw_size);
+    if (!decompress_block(codec, payload, stored, scratch->data(), raw_size)) {
+      return false;
+    }
+    payload = scratch->data();
+  } else if (stored != raw_size) {
+    return false;
+  }
+
+  const uint8_t* p = payload;
+  const uint8_t* end = payload + raw_size;
+  int64_t x = 0;
+  int64_t y = 0;
+  uint32_t server_time = 0;
+  out->reserve(out->size() + count);
+
+  for (uint32_t n = 0; n < count; n++) {
+    if (p >= end) return false;
+    CapturedEvent event = {};
+    uint8_t head = *p++;
+    event.type = head & 0x07;
+    event.modifiers = (head >> 3) & 0x0F;
+
+    uint64_t v0 = 0;
+    uint64_t v1 = 0;
+    uint64_t v2 = 0;
+    if (!get_varint(&p, end, &v0)) return false;
+    ts += static_cast<int64_t>(v0);
+    event.timestamp_us = ts;
+    if (!get_varint(&p, end, &v0)) return false;
+    server_time += static_cast<uint32_t>(unzigzag(v0));
+    event.server_time_ms = server_time;
+
+    switch (event.type) {
+      case kCapturedKeyDown:
+      case kCapturedKeyUp:
+        if (!get_varint(&p, end, &v0) || !get_varint(&p, end, &v1)) {
+          return false;
+        }
+        event.code = static_cast<uint16_t>(v0);
+        event.keysym = static_cast<uint32_t>(v1);
+        break;
+      case kCapturedMouseDown:
+      case kCapturedMouseUp:
+        if (!get_varint(&p, end, &v0) || !get_varint(&p, end, &v1) ||
+            !get_varint(&p, end, &v2)) {
+          return false;
+        }
+        event.code = static_cast<uint16_t>(v0);
+        x += unzigzag(v1);
+        y += unzigzag(v2);
+        event.x = static_cast<int32_t>(x);
+        event.y = static_cast<int32_t>(y);
+        break;
+      case kCapturedMouseMove:
+        if (!get_varint(&p, end, &v1) || !get_varint(&p, end, &v2)) {
+          return false;
+        }
+        x += unzigzag(v1);
+        y += unzigzag(v2);
+        event.x = static_cast<int32_t>(x);
+        event.y = static_cast<int32_t>(y);
+        break;
+      case kCapturedMouseScroll:
+        if (!get_varint(&p, end, &v1) || !get_varint(&p, end, &v2)) {
+          return false;
+        }
+        event.x = static_cast<int32_t>(unzigzag(v1));
+        event.y = static_cast<int32_t>(unzigzag(v2));
+        break;
+      default:
+        return false;
+    }
+    out->push_back(event);
+  }
+  return true;
+}
@@ -0,0 +1,35 @@
+# Session journal library, shared by the runner and the offline tools.
+#
+# Included both from the Flutter project and from standalone tool builds, so
+# it must only depend on files next to it.
+if(NOT TARGET session_journal)
+  find_package(PkgConfig REQUIRED)
+  find_package(Threads REQUIRED)
+
+  add_library(session_journal STATIC
+    "${CMAKE_CURRENT_LIST_DIR}/session_journal.cc"
+  )
+  if(COMMAND apply_standard_settings)
+    apply_standard_settings(session_journal)
+  else()
+    target_compile_features(session_journal PUBLIC cxx_std_14)
+    target_compile_options(session_journal PRIVATE -Wall -Werror)
+  endif()
+  set_target_properties(session_journal PROPERTIES
+    POSITION_INDEPENDENT_CODE ON)
+  target_include_directories(session_journal PUBLIC "${CMAKE_CURRENT_LIST_DIR}")
+  target_link_libraries(session_journal PUBLIC Threads::Threads)
+
+  # Optional per-block compression. Journals stay readable without them;
+  # blocks written with an unavailable codec are stored raw.
+  pkg_check_modules(LZ4 IMPORTED_TARGET liblz4)
+  if(LZ4_FOUND)
+    target_compile_definitions(session_journal PRIVATE KP_JOURNAL_HAVE_LZ4)
+    target_link_libraries(session_journal PUBLIC PkgConfig::LZ4)
+  endif()
+  pkg_check_modules(ZSTD IMPORTED_TARGET libzstd)
+  if(ZSTD_FOUND)
+    target_compile_definitions(session_journal PRIVATE KP_JOURNAL_HAVE_ZSTD)
+    target_link_libraries(session_journal PUBLIC PkgConfig::ZSTD)
+  endif()
+endif()
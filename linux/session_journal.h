@@ -0,0 +1,207 @@
+#ifndef SESSION_JOURNAL_H_
+#define SESSION_JOURNAL_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "captured_event.h"
+
+/// Compact, seekable on-disk format for recorded input sessions.
+///
+/// Layout of a journal file (all integers little-endian):
+///
+///   file header   32 bytes  "KPJ1", version, block size, clock offsets
+///   block 0       40-byte block header + payload (optionally compressed)
+///   block 1       ...
+///   index         one {first_ts, last_ts, offset} entry per block
+///   trailer       16 bytes  index offset, block count, "KPJX"
+///
+/// Events inside a block are delta-encoded against the previous event of the
+/// same block (timestamp, pointer position, server time) and packed as
+/// varints, so every block decodes independently. The index allows seeking
+/// to any timestamp with a binary search; a journal that was not closed
+/// cleanly (no trailer) is still readable by scanning the block headers.
+
+/// Per-block payload compression.
+enum JournalCodec : uint8_t {
+  kJournalCodecNone = 0,
+  kJournalCodecLz4 = 1,
+  kJournalCodecZstd = 2,
+};
+
+/// Returns true if [codec] was compiled into this build.
+bool journal_codec_available(JournalCodec codec);
+
+/// Parses a codec name ("none", "lz4", "zstd"). Unknown names map to none.
+JournalCodec journal_codec_from_name(const char* name);
+
+/// The most compact codec compiled into this build: zstd, else LZ4, else
+/// none. Uncompressed blocks take about 6 bytes per event, roughly 21 MB per
+/// hour of 1000 Hz motion; compressed ones a fraction of that.
+JournalCodec journal_codec_best();
+
+/// Location and time range of one block, as stored in the index.
+struct JournalBlockInfo {
+  int64_t first_ts_us;
+  int64_t last_ts_us;
+  uint64_t offset;
+};
+
+/// Counters reported when a journal is closed.
+struct JournalStats {
+  uint64_t events;
+  uint64_t dropped;
+  uint64_t blocks;
+  uint64_t raw_bytes;
+  uint64_t file_bytes;
+  /// errno of the write that failed, or 0 if every block was written.
+  int error;
+};
+
+/// Streams captured events into a journal file.
+///
+/// [append] is meant to be called from the capture thread: it only encodes
+/// into a preallocated block buffer and, once per full block, hands the
+/// buffer to a background thread that compresses and writes it. If the
+/// background thread falls behind and no spare buffer is available, events
+/// are dropped and the count is recorded in the next block header rather
+/// than stalling capture.
+///
+/// If a block cannot be written (disk full, I/O error), the writer fails:
+/// the file is cut back to the last complete block, the events of unwritten
+/// blocks and all later ones are counted as dropped, and [close] reports the
+/// error.
+class JournalWriter {
+ public:
+  /// Raw payload capacity of one block.
+  static constexpr size_t kBlockSize = 16 * 1024;
+
+  JournalWriter();
+  ~JournalWriter();
+
+  JournalWriter(const JournalWriter&) = delete;
+  JournalWriter& operator=(const JournalWriter&) = delete;
+
+  /// Creates [path] and starts the writer thread. [realtime_offset_us] maps
+  /// monotonic event timestamps to wall-clock time and is stored in the
+  /// header for tools that want absolute dates.
+  bool open(const char* path, JournalCodec codec, int64_t realtime_offset_us,
+            std::string* error);
+
+  /// Encodes one event. Must always be called from the same thread.
+  void append(const CapturedEvent& event);
+
+  /// Flushes the partial block, writes the index and closes the file.
+  JournalStats close();
+
+  bool is_open() const { return fd_ >= 0; }
+
+  /// Whether a block write failed; see [JournalStats.error].
+  bool failed() const { return failed_.load(std::memory_order_relaxed); }
+
+ private:
+  struct Block {
+    std::vector<uint8_t> data;
+    size_t size;
+    uint32_t event_count;
+    uint32_t dropped_before;
+    int64_t first_ts_us;
+    int64_t last_ts_us;
+  };
+
+  void begin_block();
+  void submit_block();
+  void writer_loop();
+  void write_block(Block* block, std::vector<uint8_t>* scratch);
+
+  int fd_;
+  JournalCodec codec_;
+
+  // Capture-thread state.
+  Block* current_;
+  int64_t prev_ts_us_;
+  int32_t prev_x_;
+  int32_t prev_y_;
+  uint32_t prev_server_time_;
+  uint32_t pending_drops_;
+  uint64_t events_;
+  uint64_t dropped_;
+
+  // Shared with the writer thread.
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::deque<Block*> full_;
+  std::vector<Block*> free_;
+  std::vector<Block*> all_;
+  bool stopping_;
+  std::atomic<bool> failed_;
+  std::thread thread_;
+
+  // Writer-thread state.
+  std::vector<JournalBlockInfo> index_;
+  uint64_t file_offset_;
+  uint64_t raw_bytes_;
+  uint64_t lost_events_;
+  int error_;
+  bool tail_damaged_;
+};
+
+/// Memory-mapped, read-only view of a journal.
+///
+/// Decoding methods are const and take caller-owned scratch buffers, so a
+/// single reader can be shared by several threads.
+class JournalReader {
+ public:
+  JournalReader();
+  ~JournalReader();
+
+  JournalReader(const JournalReader&) = delete;
+  JournalReader& operator=(const JournalReader&) = delete;
+
+  /// Maps [path] and loads the block index, or rebuilds it by scanning
+  /// the blocks of a journal that was never closed. Fails, reporting
+  /// [error], if the file is not a journal, or if neither the index nor
+  /// the blocks up to the end of the file are intact.
+  bool open(const char* path, std::string* error);
+  void close();
+
+  size_t block_count() const { return index_.size(); }
+  const JournalBlockInfo& block(size_t i) const { return index_[i]; }
+  int64_t realtime_offset_us() const { return realtime_offset_us_; }
+  size_t file_size() const { return size_; }
+
+  /// Events dropped by the writer right before block [i].
+  uint32_t dropped_before(size_t i) const;
+
+  /// Timestamp of the first and last event, or 0 for an empty journal.
+  int64_t start_time_us() const;
+  int64_t end_time_us() const;
+
+  /// Index of the block that contains [timestamp_us], found by binary search.
+  /// Returns 0 for timestamps before the first block and the last block for
+  /// timestamps after the end.
+  size_t find_block(int64_t timestamp_us) const;
+
+  /// Decodes block [i], appending its events to [out].
+  bool decode_block(size_t i, std::vector<uint8_t>* scratch,
+                    std::vector<CapturedEvent>* out) const;
+
+ private:
+  bool load_index();
+  bool scan_blocks();
+
+  int fd_;
+  const uint8_t* data_;
+  size_t size_;
+  int64_t realtime_offset_us_;
+  std::vector<JournalBlockInfo> index_;
+};
+
+#endif  // SESSION_JOURNAL_H_
@@ -0,0 +1,268 @@
+#include "startup_cache.h"
+
+#include <X11/XKBlib.h>
+#include <X11/extensions/record.h>
+#include <fcntl.h>
+#include <glib.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#include "log.h"
+
+#ifndef FLUTTER_VERSION
+#define FLUTTER_VERSION "unknown"
+#endif
+
+namespace {
+
+constexpr char kMagic[4] = {'K', 'P', 'S', 'C'};
+
+/// Header of the cache file, followed by the [StartupProbes] payload.
+struct CacheHeader {
+  char magic[4];
+  uint32_t format_version;
+  uint64_t key_hash;
+  uint32_t payload_size;
+  uint32_t checksum;
+};
+
+static_assert(sizeof(CacheHeader) == 24, "CacheHeader is stored on disk");
+
+int64_t steady_now_us() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+/// FNV-1a, 64 bit.
+uint64_t hash64(const void* data, size_t size) {
+  const unsigned char* bytes = static_cast<const unsigned char*>(data);
+  uint64_t hash = 0xcbf29ce484222325ULL;
+  for (size_t i = 0; i < size; i++) {
+    hash = (hash ^ bytes[i]) * 0x100000001b3ULL;
+  }
+  return hash;
+}
+
+/// FNV-1a, 32 bit.
+uint32_t hash32(const void* data, size_t size) {
+  const unsigned char* bytes = static_cast<const unsigned char*>(data);
+  uint32_t hash = 0x811c9dc5U;
+  for (size_t i = 0; i < size; i++) {
+    hash = (hash ^ bytes[i]) * 0x01000193U;
+  }
+  return hash;
+}
+
+/// Hash of the core keyboard mapping of [display]: every keysym of every
+/// keycode, as XGetKeyboardMapping returns them. xmodmap and xkbcomp
+/// change it without touching the XKB rules names, so the key covers the
+/// mapping itself. 0 if the server does not answer.
+uint64_t keymap_hash(Display* display) {
+  int min_keycode = 0;
+  int max_keycode = 0;
+  XDisplayKeycodes(display, &min_keycode, &max_keycode);
+  int keysyms_per_keycode = 0;
+  KeySym* keysyms =
+      XGetKeyboardMapping(display, static_cast<KeyCode>(min_keycode),
+                          max_keycode - min_keycode + 1, &keysyms_per_keycode);
+  if (keysyms == nullptr) {
+    return 0;
+  }
+
+  // Keysyms are 29 bits; hashed as 32 bit values so the key does not
+  // depend on the width of KeySym.
+  const size_t count =
+      static_cast<size_t>(max_keycode - min_keycode + 1) * keysyms_per_keycode;
+  std::vector<uint32_t> values;
+  values.reserve(count + 3);
+  values.push_back(static_cast<uint32_t>(min_keycode));
+  values.push_back(static_cast<uint32_t>(max_keycode));
+  values.push_back(static_cast<uint32_t>(keysyms_per_keycode));
+  for (size_t i = 0; i < count; i++) {
+    values.push_back(static_cast<uint32_t>(keysyms[i]));
+  }
+  XFree(keysyms);
+  return hash64(values.data(), values.size() * sizeof(uint32_t));
+}
+
+/// Identifies the server, keymap and app the probes of [display] are
+/// valid for.
+uint64_t cache_key_hash(Display* display) {
+  const std::string key = std::string(DisplayString(display)) + "/" +
+                          ServerVendor(display) + "/" +
+                          std::to_string(VendorRelease(display)) + "/" +
+                          std::to_string(keymap_hash(display)) +
+                          "/" FLUTTER_VERSION;
+  return hash64(key.data(), key.size());
+}
+
+void probe(Display* display, StartupProbes* probes) {
+  memset(probes, 0, sizeof(*probes));
+
+  int major = 0;
+  int minor = 0;
+  if (XRecordQueryVersion(display, &major, &minor)) {
+    probes->has_record = 1;
+    probes->record_major = major;
+    probes->record_minor = minor;
+  }
+
+  int min_keycode = 0;
+  int max_keycode = 0;
+  XDisplayKeycodes(display, &min_keycode, &max_keycode);
+  for (int keycode = min_keycode; keycode <= max_keycode && keycode < 256;
+       keycode++) {
+    probes->keysyms[keycode] = static_cast<uint32_t>(
+        XkbKeycodeToKeysym(display, static_cast<KeyCode>(keycode), 0, 0));
+  }
+}
+
+}  // namespace
+
+StartupCache::StartupCache(std::string path)
+    : path_(std::move(path)),
+      mapping_(nullptr),
+      mapping_size_(0),
+      probed_(),
+      probes_(&probed_),
+      key_hash_(0),
+      hit_(false),
+      elapsed_us_(0) {}
+
+StartupCache::~StartupCache() { unmap(); }
+
+std::string StartupCache::default_path() {
+  gchar* path = g_build_filename(g_get_user_cache_dir(), "keyboard_playground",
+                                 "startup.cache", nullptr);
+  std::string result(path);
+  g_free(path);
+  return result;
+}
+
+void StartupCache::load(Display* display) {
+  if (display == nullptr) {
+    return;
+  }
+  const int64_t start_us = steady_now_us();
+  load_keyed(display, cache_key_hash(display), start_us);
+}
+
+bool StartupCache::refresh(Display* display) {
+  if (display == nullptr) {
+    return false;
+  }
+  const int64_t start_us = steady_now_us();
+  const uint64_t key_hash = cache_key_hash(display);
+  if (key_hash == key_hash_) {
+    return false;
+  }
+  LOG_INFO("StartupCache", "Keymap changed, probing again");
+  load_keyed(display, key_hash, start_us);
+  return true;
+}
+
+void StartupCache::load_keyed(Display* display, uint64_t key_hash,
+                              int64_t start_us) {
+  key_hash_ = key_hash;
+  const StartupProbes* cached = map_file(key_hash);
+  hit_ = cached != nullptr;
+  if (hit_) {
+    probes_ = cached;
+  } else {
+    probe(display, &probed_);
+    probes_ = &probed_;
+    save(key_hash);
+  }
+  elapsed_us_ = steady_now_us() - start_us;
+  LOG_DEBUG("StartupCache", "%s in %lld us", hit_ ? "Hit" : "Probed",
+            static_cast<long long>(elapsed_us_));
+}
+
+const StartupProbes* StartupCache::map_file(uint64_t key_hash) {
+  unmap();
+  probes_ = &probed_;
+
+  const int fd = open(path_.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return nullptr;
+  }
+  constexpr size_t kFileSize = sizeof(CacheHeader) + sizeof(StartupProbes);
+  struct stat st;
+  void* mapping = MAP_FAILED;
+  if (fstat(fd, &st) == 0 && static_cast<size_t>(st.st_size) == kFileSize) {
+    mapping = mmap(nullptr, kFileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+  }
+  close(fd);
+  if (mapping == MAP_FAILED) {
+    return nullptr;
+  }
+  mapping_ = mapping;
+  mapping_size_ = kFileSize;
+
+  const CacheHeader* header = static_cast<const CacheHeader*>(mapping);
+  const StartupProbes* probes = reinterpret_cast<const StartupProbes*>(
+      static_cast<const unsigned char*>(mapping) + sizeof(CacheHeader));
+  if (memcmp(header->magic, kMagic, sizeof(kMagic)) != 0 ||
+      header->format_version != kFormatVersion ||
+      header->payload_size != sizeof(StartupProbes) ||
+      header->key_hash != key_hash ||
+      header->checksum != hash32(probes, sizeof(StartupProbes))) {
+    unmap();
+    return nullptr;
+  }
+  return probes;
+}
+
+void StartupCache::save(uint64_t key_hash) {
+  CacheHeader header;
+  memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.format_version = kFormatVersion;
+  header.key_hash = key_hash;
+  header.payload_size = sizeof(StartupProbes);
+  header.checksum = hash32(&probed_, sizeof(StartupProbes));
+
+  std::vector<unsigned char> contents(sizeof(header) + sizeof(StartupProbes));
+  memcpy(contents.data(), &header, sizeof(header));
+  memcpy(contents.data() + sizeof(header), &probed_, sizeof(StartupProbes));
+
+  // Written next to the cache and renamed over it, so a concurrent start
+  // maps either the old or the new file, never a partial one.
+  gchar* dir = g_path_get_dirname(path_.c_str());
+  const std::string temp_path = path_ + "." + std::to_string(getpid());
+  bool saved = false;
+  if (g_mkdir_with_parents(dir, 0755) == 0) {
+    const int fd = open(temp_path.c_str(),
+                        O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd >= 0) {
+      const ssize_t written = write(fd, contents.data(), contents.size());
+      saved = close(fd) == 0 &&
+              written == static_cast<ssize_t>(contents.size()) &&
+              rename(temp_path.c_str(), path_.c_str()) == 0;
+      if (!saved) {
+        unlink(temp_path.c_str());
+      }
+    }
+  }
+  if (!saved) {
+    LOG_WARNING("StartupCache", "Could not write %s: %s", path_.c_str(),
+                strerror(errno));
+  }
+  g_free(dir);
+}
+
+void StartupCache::unmap() {
+  if (mapping_ != nullptr) {
+    munmap(mapping_, mapping_size_);
+    mapping_ = nullptr;
+    mapping_size_ = 0;
+  }
+}
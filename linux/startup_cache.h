@@ -0,0 +1,104 @@
+#ifndef STARTUP_CACHE_H_
+#define STARTUP_CACHE_H_
+
+#include <X11/Xlib.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/// Results of the X server probes the plugin needs at startup.
+///
+/// Stored verbatim in the cache file, so the layout is versioned by
+/// [StartupCache::kFormatVersion]: change one, bump the other.
+struct StartupProbes {
+  /// Whether the RECORD extension is available, and its version.
+  uint8_t has_record;
+  uint8_t reserved[3];
+  int32_t record_major;
+  int32_t record_minor;
+
+  /// Unshifted keysym of every keycode, NoSymbol outside the server's
+  /// keycode range.
+  uint32_t keysyms[256];
+};
+
+/// Persistent, memory-mapped cache of [StartupProbes].
+///
+/// Probing means querying the RECORD extension and building the keysym
+/// table through XKB, which fetches the server's XKB keymap. The results
+/// only change with the X server, its keymap or the app, so they are kept
+/// in a small file under the user cache directory, keyed by display name,
+/// server vendor and release, a hash of the core keyboard mapping and the
+/// app version. The time a load took is logged at debug level.
+///
+/// A later start maps the file and checks its header (magic, format
+/// version, key hash, payload checksum); the key costs one
+/// XGetKeyboardMapping round trip. Any mismatch, or a missing or damaged
+/// file, falls back to probing, and the file is rewritten atomically.
+///
+/// Permission checks query RECORD themselves; [StartupProbes::has_record]
+/// only describes the capabilities.
+///
+/// Not thread-safe: load and refresh while nothing reads [keysym].
+class StartupCache {
+ public:
+  /// Bump when [StartupProbes] or the way it is computed changes.
+  static constexpr uint32_t kFormatVersion = 1;
+
+  /// Uses the cache file at [path].
+  explicit StartupCache(std::string path);
+
+  /// Unmaps the cache file.
+  ~StartupCache();
+
+  StartupCache(const StartupCache&) = delete;
+  StartupCache& operator=(const StartupCache&) = delete;
+
+  /// $XDG_CACHE_HOME/keyboard_playground/startup.cache.
+  static std::string default_path();
+
+  /// Loads the probes for [display] from the cache, or probes it and
+  /// updates the cache.
+  void load(Display* display);
+
+  /// Probes again if the keymap of [display] changed since [load], e.g.
+  /// after setxkbmap or xmodmap. Returns whether it did.
+  bool refresh(Display* display);
+
+  /// The loaded probes; all zero before [load] or without a display.
+  const StartupProbes& probes() const { return *probes_; }
+
+  /// Unshifted keysym of [keycode].
+  uint32_t keysym(uint8_t keycode) const { return probes_->keysyms[keycode]; }
+
+  /// Whether the last [load] or [refresh] used the cache file.
+  bool hit() const { return hit_; }
+
+  /// Time the last [load] or [refresh] took, in microseconds.
+  int64_t elapsed_us() const { return elapsed_us_; }
+
+ private:
+  /// Loads the probes for the key [key_hash] of [display].
+  void load_keyed(Display* display, uint64_t key_hash, int64_t start_us);
+
+  /// Maps the cache file and returns its probes if it is valid for
+  /// [key_hash], or nullptr.
+  const StartupProbes* map_file(uint64_t key_hash);
+
+  /// Writes [probes_] under [key_hash], replacing the file atomically.
+  void save(uint64_t key_hash);
+
+  void unmap();
+
+  std::string path_;
+  void* mapping_;
+  size_t mapping_size_;
+  StartupProbes probed_;
+  const StartupProbes* probes_;
+  uint64_t key_hash_;
+  bool hit_;
+  int64_t elapsed_us_;
+};
+
+#endif  // STARTUP_CACHE_H_
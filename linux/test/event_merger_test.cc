@@ -0,0 +1,248 @@
+#include "event_merger.h"
+
+#include <atomic>
+#include <cstring>
+#include <mutex>
+#include <vector>
+
+#include "native_test.h"
+
+namespace {
+
+struct Emitted {
+  int64_t timestamp_us;
+  int64_t dispatch_us;
+  int source;
+  uint16_t code;
+};
+
+/// A merger on a clock set by the test, recording what it emits.
+class MergerFixture {
+ public:
+  MergerFixture()
+      : now_us_(1000000),
+        merger_(
+            [this](const CapturedEvent& event, int64_t dispatch_us,
+                   int source) {
+              std::lock_guard<std::mutex> lock(mutex_);
+              emitted_.push_back(
+                  {event.timestamp_us, dispatch_us, source, event.code});
+            },
+            [this] { return now_us_.load(); }) {}
+
+  EventMerger& merger() { return merger_; }
+
+  int64_t now() const { return now_us_.load(); }
+
+  void set_now(int64_t now_us) { now_us_.store(now_us); }
+
+  /// Pushes an event from [source] stamped [timestamp_us], tagged [code].
+  void push(int source, int64_t timestamp_us, uint16_t code) {
+    CapturedEvent event;
+    memset(&event, 0, sizeof(event));
+    event.type = kCapturedKeyDown;
+    event.timestamp_us = timestamp_us;
+    event.code = code;
+    merger_.push(source, event, timestamp_us + 7);
+  }
+
+  std::vector<Emitted> emitted() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return emitted_;
+  }
+
+  /// The codes emitted so far, in order.
+  std::vector<uint16_t> codes() {
+    std::vector<uint16_t> codes;
+    for (const Emitted& event : emitted()) codes.push_back(event.code);
+    return codes;
+  }
+
+ private:
+  std::atomic<int64_t> now_us_;
+  std::mutex mutex_;
+  std::vector<Emitted> emitted_;
+  EventMerger merger_;
+};
+
+std::string join(const std::vector<uint16_t>& codes) {
+  std::string joined;
+  for (uint16_t code : codes) {
+    if (!joined.empty()) joined += ",";
+    joined += std::to_string(code);
+  }
+  return joined;
+}
+
+#define EXPECT_CODES(fixture, expected)                                \
+  do {                                                                 \
+    const std::string native_test_codes = join((fixture).codes());     \
+    if (native_test_codes != (expected)) {                             \
+      native_test::fail(__FILE__, __LINE__,                            \
+                        "expected codes " expected ", got " +          \
+                            native_test_codes);                        \
+    }                                                                  \
+  } while (0)
+
+}  // namespace
+
+NATIVE_TEST(emits_a_single_source_immediately) {
+  MergerFixture fixture;
+  const int source = fixture.merger().add_source("live", 2000);
+
+  fixture.push(source, fixture.now(), 1);
+  fixture.push(source, fixture.now() + 10, 2);
+
+  EXPECT_CODES(fixture, "1,2");
+  const std::vector<Emitted> emitted = fixture.emitted();
+  EXPECT_EQ(emitted[0].dispatch_us, fixture.now() + 7);
+  EXPECT_EQ(emitted[1].source, source);
+  EXPECT_EQ(fixture.merger().stats().buffered, 0u);
+}
+
+NATIVE_TEST(orders_events_across_sources) {
+  MergerFixture fixture;
+  fixture.merger().set_window_us(1000000);
+  const int live = fixture.merger().add_source("live", 0);
+  const int replay = fixture.merger().add_source("replay", 0);
+  const int64_t t = fixture.now();
+
+  // Each waits until the other source has caught up with it; a source
+  // with buffered events has caught up with its oldest one.
+  fixture.push(live, t + 30, 3);
+  EXPECT_CODES(fixture, "");
+  fixture.push(replay, t + 10, 1);
+  fixture.push(replay, t + 40, 4);
+  EXPECT_CODES(fixture, "1,3");
+  fixture.push(live, t + 20, 2);  // Steps back: re-stamped to t + 30.
+  fixture.push(live, t + 50, 5);
+  EXPECT_CODES(fixture, "1,3,2,4");
+
+  fixture.merger().advance(replay, t + 60);
+  EXPECT_CODES(fixture, "1,3,2,4,5");
+
+  const EventMergerStats stats = fixture.merger().stats();
+  EXPECT_EQ(stats.emitted, 5u);
+  EXPECT_EQ(stats.late, 0u);
+  EXPECT_EQ(stats.buffered, 0u);
+}
+
+NATIVE_TEST(breaks_ties_by_source_id) {
+  MergerFixture fixture;
+  fixture.merger().set_window_us(1000000);
+  const int first = fixture.merger().add_source("first", 0);
+  const int second = fixture.merger().add_source("second", 0);
+  const int64_t t = fixture.now() + 100;
+
+  fixture.push(second, t, 2);
+  fixture.push(first, t, 1);
+  fixture.merger().advance(first, t + 1);
+  fixture.merger().advance(second, t + 1);
+
+  EXPECT_CODES(fixture, "1,2");
+}
+
+NATIVE_TEST(idle_sources_are_covered_by_their_delay) {
+  MergerFixture fixture;
+  fixture.merger().set_window_us(1000000);
+  const int live = fixture.merger().add_source("live", 2000);
+  fixture.merger().add_source("idle", 2000);
+  const int64_t t = fixture.now();
+
+  fixture.push(live, t + 100, 1);
+  EXPECT_CODES(fixture, "");
+
+  // The idle source cannot deliver anything older than now - 2 ms.
+  fixture.set_now(t + 2100);
+  fixture.push(live, t + 2100, 2);
+  EXPECT_CODES(fixture, "1");
+}
+
+NATIVE_TEST(expires_events_after_the_window) {
+  MergerFixture fixture;
+  fixture.merger().set_window_us(8000);
+  const int live = fixture.merger().add_source("live", 0);
+  fixture.merger().add_source("stalled", 1000000);
+  const int64_t t = fixture.now();
+
+  fixture.push(live, t, 1);
+  fixture.push(live, t + 5000, 2);
+  EXPECT_CODES(fixture, "");
+
+  fixture.set_now(t + 8000);
+  fixture.merger().set_window_us(8000);  // Drains at the new time.
+  EXPECT_CODES(fixture, "1");
+
+  fixture.set_now(t + 13000);
+  fixture.merger().set_window_us(8000);
+  EXPECT_CODES(fixture, "1,2");
+  EXPECT_EQ(fixture.merger().stats().expired, 2u);
+}
+
+NATIVE_TEST(releases_the_oldest_events_on_overflow) {
+  MergerFixture fixture;
+  fixture.merger().set_window_us(1000000);
+  fixture.merger().set_source_capacity(2);
+  const int live = fixture.merger().add_source("live", 0);
+  fixture.merger().add_source("stalled", 1000000);
+  const int64_t t = fixture.now();
+
+  fixture.push(live, t + 1, 1);
+  fixture.push(live, t + 2, 2);
+  EXPECT_CODES(fixture, "");
+  fixture.push(live, t + 3, 3);
+  EXPECT_CODES(fixture, "1");
+  fixture.push(live, t + 4, 4);
+  EXPECT_CODES(fixture, "1,2");
+
+  const EventMergerStats stats = fixture.merger().stats();
+  EXPECT_EQ(stats.overflowed, 2u);
+  EXPECT_EQ(stats.buffered, 2u);
+  EXPECT_EQ(stats.max_buffered, 3u);
+}
+
+NATIVE_TEST(counts_late_events) {
+  MergerFixture fixture;
+  fixture.merger().set_window_us(1000);
+  const int live = fixture.merger().add_source("live", 0);
+  const int slow = fixture.merger().add_source("slow", 1000000);
+  const int64_t t = fixture.now();
+
+  fixture.push(live, t, 1);
+  fixture.set_now(t + 1000);
+  fixture.push(live, t + 1000, 2);  // Event 1 expires.
+  EXPECT_CODES(fixture, "1");
+
+  // Older than event 1, which is already out: emitted late once its
+  // window runs out too.
+  fixture.push(slow, t - 500, 3);
+  fixture.set_now(t + 2000);
+  fixture.merger().set_window_us(1000);
+  EXPECT_CODES(fixture, "1,3,2");
+  EXPECT_EQ(fixture.merger().stats().late, 1u);
+}
+
+NATIVE_TEST(removing_a_source_flushes_it_and_unblocks_others) {
+  MergerFixture fixture;
+  fixture.merger().set_window_us(1000000);
+  const int live = fixture.merger().add_source("live", 0);
+  const int replay = fixture.merger().add_source("replay", 0);
+  fixture.merger().add_source("idle", 1000000);
+  const int64_t t = fixture.now();
+
+  fixture.push(live, t + 20, 2);
+  fixture.push(replay, t + 10, 1);
+  fixture.push(replay, t + 30, 3);
+  EXPECT_CODES(fixture, "");
+
+  // The replay's events go out in merge order, up to its last one.
+  fixture.merger().remove_source(replay);
+  EXPECT_CODES(fixture, "1,2,3");
+  EXPECT_EQ(fixture.merger().source_count(), 2u);
+
+  // Ignored after removal.
+  fixture.push(replay, t + 40, 4);
+  EXPECT_CODES(fixture, "1,2,3");
+}
+
+NATIVE_TEST_MAIN()
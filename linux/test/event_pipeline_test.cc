@@ -0,0 +1,112 @@
+#include "event_pipeline.h"
+
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "native_test.h"
+
+namespace {
+
+CapturedEvent make_event(uint8_t type, int64_t timestamp_us) {
+  CapturedEvent event;
+  memset(&event, 0, sizeof(event));
+  event.type = type;
+  event.timestamp_us = timestamp_us;
+  return event;
+}
+
+/// Pipeline of a recording stage, motion coalescing and another recording
+/// stage, in that order.
+struct PipelineFixture {
+  PipelineFixture() {
+    pipeline.add_stage(
+        std::unique_ptr<EventStage>(new CallbackStage(
+            "before",
+            [this](CapturedEvent* event, int64_t dispatch_us) {
+              before.push_back(event->timestamp_us);
+              return true;
+            })),
+        true);
+    pipeline.add_stage(std::unique_ptr<EventStage>(new MotionCoalesceStage()),
+                       true);
+    pipeline.add_stage(
+        std::unique_ptr<EventStage>(new CallbackStage(
+            "after",
+            [this](CapturedEvent* event, int64_t dispatch_us) {
+              after.push_back(event->timestamp_us);
+              return true;
+            })),
+        true);
+  }
+
+  /// Runs motion events every [step_us] from 0 to [end_us].
+  void run_motion(int64_t step_us, int64_t end_us) {
+    for (int64_t t = 0; t <= end_us; t += step_us) {
+      pipeline.run(make_event(kCapturedMouseMove, t), t);
+    }
+  }
+
+  StageInfo stage(size_t index) { return pipeline.describe(false)[index]; }
+
+  EventPipeline pipeline;
+  std::vector<int64_t> before;
+  std::vector<int64_t> after;
+};
+
+}  // namespace
+
+NATIVE_TEST(stages_before_coalescing_see_every_event) {
+  PipelineFixture fixture;
+  // 2 ms apart against the default 8 ms interval.
+  fixture.run_motion(2000, 20000);
+
+  EXPECT_EQ(fixture.before.size(), 11u);
+  EXPECT_EQ(fixture.after.size(), 3u);
+  EXPECT_EQ(fixture.after[1], 8000);
+}
+
+NATIVE_TEST(timing_is_off_by_default) {
+  PipelineFixture fixture;
+  fixture.run_motion(2000, 20000);
+
+  EXPECT_FALSE(fixture.pipeline.timing());
+  for (const StageInfo& info : fixture.pipeline.describe(false)) {
+    EXPECT_EQ(info.timing.calls, 0u);
+    EXPECT_EQ(info.timing.dropped, 0u);
+    EXPECT_EQ(info.timing.total_ns, 0);
+  }
+}
+
+NATIVE_TEST(timing_counts_calls_and_drops_while_on) {
+  PipelineFixture fixture;
+  fixture.pipeline.set_timing(true);
+  fixture.run_motion(2000, 20000);
+
+  EXPECT_TRUE(fixture.pipeline.timing());
+  EXPECT_EQ(fixture.stage(0).timing.calls, 11u);
+  EXPECT_EQ(fixture.stage(1).timing.calls, 11u);
+  EXPECT_EQ(fixture.stage(1).timing.dropped, 8u);
+  EXPECT_EQ(fixture.stage(2).timing.calls, 3u);
+  EXPECT_TRUE(fixture.stage(1).timing.max_ns <= fixture.stage(1).timing.total_ns);
+
+  // Off keeps what was measured; on again starts over.
+  fixture.pipeline.set_timing(false);
+  fixture.run_motion(2000, 4000);
+  EXPECT_EQ(fixture.stage(0).timing.calls, 11u);
+  fixture.pipeline.set_timing(true);
+  EXPECT_EQ(fixture.stage(0).timing.calls, 0u);
+}
+
+NATIVE_TEST(disabled_stages_are_skipped_untimed) {
+  PipelineFixture fixture;
+  fixture.pipeline.set_timing(true);
+  EXPECT_TRUE(fixture.pipeline.set_enabled("coalesce", false));
+  fixture.run_motion(2000, 20000);
+
+  EXPECT_EQ(fixture.after.size(), 11u);
+  EXPECT_EQ(fixture.stage(1).timing.calls, 0u);
+  EXPECT_FALSE(fixture.pipeline.set_enabled("unknown", true));
+}
+
+NATIVE_TEST_MAIN()
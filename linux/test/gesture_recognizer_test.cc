@@ -0,0 +1,151 @@
+#include "gesture_recognizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "native_test.h"
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+
+/// Sample interval of a 125 Hz mouse.
+constexpr int64_t kSampleUs = 8000;
+
+struct Point {
+  double x;
+  double y;
+};
+
+/// Feeds [points], one per [kSampleUs], and returns the gestures found.
+std::vector<GestureEvent> feed(const std::vector<Point>& points) {
+  GestureRecognizer recognizer;
+  std::vector<GestureEvent> gestures;
+  int64_t timestamp_us = 1000000;
+  for (const Point& point : points) {
+    GestureEvent event;
+    if (recognizer.add_sample(static_cast<int32_t>(std::lround(point.x)),
+                              static_cast<int32_t>(std::lround(point.y)),
+                              timestamp_us, &event)) {
+      gestures.push_back(event);
+    }
+    timestamp_us += kSampleUs;
+  }
+  return gestures;
+}
+
+/// Samples [position] over [duration_us], with t running from 0 to 1.
+template <typename Position>
+std::vector<Point> trace(int64_t duration_us, Position position) {
+  std::vector<Point> points;
+  const int64_t samples = duration_us / kSampleUs;
+  for (int64_t i = 0; i <= samples; i++) {
+    points.push_back(position(static_cast<double>(i) / samples));
+  }
+  return points;
+}
+
+/// Deterministic noise in [-1, 1].
+double noise(uint32_t* state) {
+  *state = *state * 1664525u + 1013904223u;
+  return static_cast<double>(*state >> 8) / (1 << 23) - 1;
+}
+
+}  // namespace
+
+NATIVE_TEST(recognizes_a_circle) {
+  const auto gestures = feed(trace(900000, [](double t) {
+    const double angle = 2 * kPi * 1.1 * t;
+    return Point{500 + 150 * std::cos(angle), 400 + 150 * std::sin(angle)};
+  }));
+
+  EXPECT_EQ(gestures.size(), 1u);
+  if (gestures.empty()) return;
+  EXPECT_EQ(gestures[0].kind, kGestureCircle);
+  EXPECT_NEAR(gestures[0].x, 500, 30);
+  EXPECT_NEAR(gestures[0].y, 400, 30);
+}
+
+NATIVE_TEST(recognizes_a_swipe) {
+  const auto gestures = feed(trace(160000, [](double t) {
+    return Point{200 + 700 * t, 300 + 10 * t};
+  }));
+
+  EXPECT_EQ(gestures.size(), 1u);
+  if (gestures.empty()) return;
+  EXPECT_EQ(gestures[0].kind, kGestureSwipe);
+  EXPECT_EQ(gestures[0].direction, kSwipeRight);
+}
+
+NATIVE_TEST(recognizes_a_shake) {
+  const auto gestures = feed(trace(1000000, [](double t) {
+    return Point{600 + 120 * std::sin(2 * kPi * 3 * t), 300 + 8 * t};
+  }));
+
+  EXPECT_EQ(gestures.size(), 1u);
+  if (gestures.empty()) return;
+  EXPECT_EQ(gestures[0].kind, kGestureShake);
+  EXPECT_NEAR(gestures[0].x, 600, 60);
+}
+
+NATIVE_TEST(recognizes_a_tangled_scribble) {
+  // A hand chasing random points in a 250 px square at 1500 px/s, turning
+  // at most 30 degrees per sample: strokes that curve and cross in every
+  // direction. Checked for a circle or a shake first, this one passed for
+  // a shake twice and then for a circle.
+  uint32_t state = 25;
+  Point position = {425, 425};
+  Point target = position;
+  double heading = 0;
+  std::vector<Point> points;
+  for (int i = 0; i < 150; i++) {
+    if (std::hypot(target.x - position.x, target.y - position.y) < 60) {
+      target = {425 + 125 * noise(&state), 425 + 125 * noise(&state)};
+    }
+    const double wanted =
+        std::atan2(target.y - position.y, target.x - position.x);
+    const double turn = std::remainder(wanted - heading, 2 * kPi);
+    heading += std::max(-kPi / 6, std::min(kPi / 6, turn));
+    position.x += 12 * std::cos(heading);
+    position.y += 12 * std::sin(heading);
+    points.push_back(position);
+  }
+  const auto gestures = feed(points);
+
+  EXPECT_TRUE(!gestures.empty());
+  for (const GestureEvent& gesture : gestures) {
+    EXPECT_EQ(gesture.kind, kGestureScribble);
+  }
+}
+
+NATIVE_TEST(ignores_jitter) {
+  uint32_t state = 42;
+  const auto gestures = feed(trace(3000000, [&state](double) {
+    return Point{700 + 3 * noise(&state), 500 + 3 * noise(&state)};
+  }));
+
+  EXPECT_EQ(gestures.size(), 0u);
+}
+
+NATIVE_TEST(reset_forgets_motion) {
+  GestureRecognizer recognizer;
+  GestureEvent event;
+  int64_t timestamp_us = 0;
+  for (int i = 0; i < 10; i++) {
+    recognizer.add_sample(100 + i * 40, 100, timestamp_us, &event);
+    timestamp_us += kSampleUs;
+  }
+  recognizer.reset();
+
+  // The rest of the stroke alone is too short for a swipe.
+  bool recognized = false;
+  for (int i = 10; i < 14; i++) {
+    recognized |= recognizer.add_sample(100 + i * 40, 100, timestamp_us, &event);
+    timestamp_us += kSampleUs;
+  }
+  EXPECT_FALSE(recognized);
+}
+
+NATIVE_TEST_MAIN()
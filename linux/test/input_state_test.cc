@@ -0,0 +1,134 @@
+#include "input_state.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <thread>
+
+#include "native_test.h"
+
+namespace {
+
+CapturedEvent make_event(uint8_t type, uint16_t code, int32_t x, int32_t y) {
+  CapturedEvent event;
+  memset(&event, 0, sizeof(event));
+  event.type = type;
+  event.code = code;
+  event.x = x;
+  event.y = y;
+  return event;
+}
+
+}  // namespace
+
+NATIVE_TEST(snapshot_layout_matches_dart) {
+  // Offsets read by NativeInputState in lib/platform/input_state.dart.
+  EXPECT_EQ(offsetof(InputStateSnapshot, sequence), 0u);
+  EXPECT_EQ(offsetof(InputStateSnapshot, last_event_time_us), 8u);
+  EXPECT_EQ(offsetof(InputStateSnapshot, pointer_x), 16u);
+  EXPECT_EQ(offsetof(InputStateSnapshot, pointer_y), 20u);
+  EXPECT_EQ(offsetof(InputStateSnapshot, buttons), 24u);
+  EXPECT_EQ(offsetof(InputStateSnapshot, modifiers), 28u);
+  EXPECT_EQ(offsetof(InputStateSnapshot, keys), 32u);
+}
+
+NATIVE_TEST(applies_keys_buttons_and_motion) {
+  InputState state;
+  state.apply(make_event(kCapturedKeyDown, 38, 0, 0), 1000);
+  state.apply(make_event(kCapturedKeyDown, 200, 0, 0), 2000);
+  state.apply(make_event(kCapturedMouseDown, 3, 10, 20), 3000);
+  state.apply(make_event(kCapturedMouseMove, 0, 30, 40), 4000);
+  state.apply(make_event(kCapturedKeyUp, 38, 0, 0), 5000);
+
+  InputStateSnapshot snapshot;
+  state.read(&snapshot);
+  EXPECT_EQ(snapshot.sequence, 5u);
+  EXPECT_EQ(snapshot.last_event_time_us, 5000);
+  EXPECT_EQ(snapshot.pointer_x, 30);
+  EXPECT_EQ(snapshot.pointer_y, 40);
+  EXPECT_EQ(snapshot.buttons, 0x4u);
+  EXPECT_EQ(snapshot.keys[0], 0u);
+  EXPECT_EQ(snapshot.keys[3], uint64_t{1} << (200 - 192));
+
+  state.release_all();
+  state.read(&snapshot);
+  EXPECT_EQ(snapshot.buttons, 0u);
+  EXPECT_EQ(snapshot.keys[3], 0u);
+  EXPECT_EQ(snapshot.pointer_x, 30);
+}
+
+NATIVE_TEST(read_retries_while_a_write_is_in_progress) {
+  SeqlockSequence seq;
+  std::atomic<uint64_t> word(1);
+
+  seq.begin_write();
+  const uint32_t odd = seq.read_begin();
+  EXPECT_EQ(odd & 1, 1u);
+  EXPECT_TRUE(seq.read_retry(odd));
+
+  // A reader that starts now has to wait for the write to end.
+  std::atomic<uint64_t> read_value(0);
+  std::thread reader([&] {
+    for (;;) {
+      const uint32_t begin = seq.read_begin();
+      const uint64_t value = word.load(std::memory_order_relaxed);
+      if (!seq.read_retry(begin)) {
+        read_value.store(value);
+        return;
+      }
+    }
+  });
+  word.store(2, std::memory_order_relaxed);
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  EXPECT_EQ(read_value.load(), 0u);
+  seq.end_write();
+  reader.join();
+  EXPECT_EQ(read_value.load(), 2u);
+}
+
+NATIVE_TEST(read_retries_after_an_overlapping_write) {
+  SeqlockSequence seq;
+  const uint32_t begin = seq.read_begin();
+  EXPECT_EQ(begin & 1, 0u);
+  EXPECT_FALSE(seq.read_retry(begin));
+
+  seq.begin_write();
+  seq.end_write();
+  EXPECT_TRUE(seq.read_retry(begin));
+  EXPECT_FALSE(seq.read_retry(seq.read_begin()));
+}
+
+NATIVE_TEST(snapshots_are_never_torn) {
+  // The writer keeps x == y and the key map equal to x, so any mix of two
+  // states shows up as a mismatch.
+  InputState state;
+  std::atomic<bool> done(false);
+  std::thread writer([&] {
+    for (int32_t i = 1; i <= 200000; i++) {
+      state.apply(make_event(kCapturedMouseMove, 0, i, i), i);
+    }
+    done.store(true);
+  });
+
+  int reads = 0;
+  int torn = 0;
+  while (!done.load()) {
+    InputStateSnapshot snapshot;
+    if (!state.try_read(&snapshot)) {
+      continue;
+    }
+    reads++;
+    if (snapshot.pointer_x != snapshot.pointer_y ||
+        snapshot.sequence != static_cast<uint64_t>(snapshot.pointer_x) ||
+        snapshot.last_event_time_us != snapshot.pointer_x) {
+      torn++;
+    }
+  }
+  writer.join();
+
+  EXPECT_TRUE(reads > 0);
+  EXPECT_EQ(torn, 0);
+}
+
+NATIVE_TEST_MAIN()
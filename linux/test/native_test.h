@@ -0,0 +1,110 @@
+#ifndef NATIVE_TEST_H_
+#define NATIVE_TEST_H_
+
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+/// Minimal test harness for the native modules, so they can be tested
+/// without GTK, Flutter or a test framework.
+///
+/// Each test file is its own executable with a [NATIVE_TEST_MAIN]:
+///
+///   NATIVE_TEST(merges_in_order) {
+///     EXPECT_EQ(merged.size(), 3u);
+///   }
+///
+///   NATIVE_TEST_MAIN()
+///
+/// A failed expectation reports its location and fails the test, which
+/// keeps running; the executable exits non-zero if any test failed.
+namespace native_test {
+
+struct TestCase {
+  const char* name;
+  std::function<void()> body;
+};
+
+inline std::vector<TestCase>& registry() {
+  static std::vector<TestCase> tests;
+  return tests;
+}
+
+inline int& failures() {
+  static int count = 0;
+  return count;
+}
+
+struct Registrar {
+  Registrar(const char* name, std::function<void()> body) {
+    registry().push_back({name, std::move(body)});
+  }
+};
+
+inline void fail(const char* file, int line, const std::string& message) {
+  fprintf(stderr, "  %s:%d: %s\n", file, line, message.c_str());
+  failures()++;
+}
+
+inline int run_all() {
+  int failed_tests = 0;
+  for (const TestCase& test : registry()) {
+    const int before = failures();
+    test.body();
+    const bool passed = failures() == before;
+    printf("%s %s\n", passed ? "PASS" : "FAIL", test.name);
+    if (!passed) failed_tests++;
+  }
+  printf("%zu tests, %d failed\n", registry().size(), failed_tests);
+  return failed_tests == 0 ? 0 : 1;
+}
+
+}  // namespace native_test
+
+#define NATIVE_TEST(name)                                \
+  static void native_test_##name();                      \
+  static native_test::Registrar native_test_registrar_##name( \
+      #name, native_test_##name);                        \
+  static void native_test_##name()
+
+#define NATIVE_TEST_MAIN() \
+  int main() { return native_test::run_all(); }
+
+#define EXPECT_TRUE(condition)                                         \
+  do {                                                                 \
+    if (!(condition)) {                                                \
+      native_test::fail(__FILE__, __LINE__, "expected " #condition);   \
+    }                                                                  \
+  } while (0)
+
+#define EXPECT_FALSE(condition) EXPECT_TRUE(!(condition))
+
+#define EXPECT_EQ(actual, expected)                                    \
+  do {                                                                 \
+    const auto native_test_actual = (actual);                          \
+    const auto native_test_expected = (expected);                      \
+    if (!(native_test_actual == native_test_expected)) {               \
+      native_test::fail(                                               \
+          __FILE__, __LINE__,                                          \
+          "expected " #actual " == " #expected ", got " +              \
+              std::to_string(native_test_actual) + " and " +           \
+              std::to_string(native_test_expected));                   \
+    }                                                                  \
+  } while (0)
+
+#define EXPECT_NEAR(actual, expected, tolerance)                       \
+  do {                                                                 \
+    const double native_test_actual = (actual);                        \
+    const double native_test_expected = (expected);                    \
+    if (native_test_actual < native_test_expected - (tolerance) ||     \
+        native_test_actual > native_test_expected + (tolerance)) {     \
+      native_test::fail(                                               \
+          __FILE__, __LINE__,                                          \
+          "expected " #actual " near " #expected ", got " +            \
+              std::to_string(native_test_actual));                     \
+    }                                                                  \
+  } while (0)
+
+#endif  // NATIVE_TEST_H_
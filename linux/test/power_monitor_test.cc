@@ -0,0 +1,240 @@
+#include "power_monitor.h"
+
+#include <ftw.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <string>
+
+#include "native_test.h"
+
+namespace {
+
+/// A fake sysfs tree in a temporary directory, removed on destruction.
+class FakeSysfs {
+ public:
+  FakeSysfs() {
+    char path[] = "/tmp/power_monitor_test.XXXXXX";
+    root_ = mkdtemp(path) != nullptr ? path : "";
+  }
+
+  ~FakeSysfs() {
+    nftw(root_.c_str(),
+         [](const char* path, const struct stat*, int, struct FTW*) {
+           return remove(path);
+         },
+         16, FTW_DEPTH | FTW_PHYS);
+  }
+
+  const std::string& root() const { return root_; }
+
+  /// Writes [contents] to [path] under the root, creating its directories.
+  void write(const std::string& path, const std::string& contents) {
+    for (size_t slash = path.find('/'); slash != std::string::npos;
+         slash = path.find('/', slash + 1)) {
+      mkdir((root_ + "/" + path.substr(0, slash)).c_str(), 0755);
+    }
+    FILE* file = fopen((root_ + "/" + path).c_str(), "w");
+    if (file == nullptr) {
+      native_test::fail(__FILE__, __LINE__, "cannot write " + path);
+      return;
+    }
+    fputs(contents.c_str(), file);
+    fclose(file);
+  }
+
+  void remove_file(const std::string& path) {
+    unlink((root_ + "/" + path).c_str());
+  }
+
+  /// A thermal zone at [temp_c] with a passive trip point at [trip_c].
+  void zone(int index, double temp_c, double trip_c) {
+    const std::string zone =
+        "class/thermal/thermal_zone" + std::to_string(index);
+    write(zone + "/temp", millidegrees(temp_c));
+    write(zone + "/trip_point_0_type", "passive\n");
+    write(zone + "/trip_point_0_temp", millidegrees(trip_c));
+  }
+
+  void cooling(int index, const std::string& type, int current, int maximum) {
+    const std::string device =
+        "class/thermal/cooling_device" + std::to_string(index);
+    write(device + "/type", type + "\n");
+    write(device + "/cur_state", std::to_string(current) + "\n");
+    write(device + "/max_state", std::to_string(maximum) + "\n");
+  }
+
+  void battery(const std::string& name, const std::string& status,
+               int capacity) {
+    const std::string supply = "class/power_supply/" + name;
+    write(supply + "/type", "Battery\n");
+    write(supply + "/status", status + "\n");
+    write(supply + "/capacity", std::to_string(capacity) + "\n");
+  }
+
+ private:
+  static std::string millidegrees(double celsius) {
+    return std::to_string(static_cast<long>(celsius * 1000)) + "\n";
+  }
+
+  std::string root_;
+};
+
+}  // namespace
+
+NATIVE_TEST(reads_nothing_from_an_empty_tree) {
+  FakeSysfs sysfs;
+  PowerMonitor monitor(sysfs.root());
+
+  const PowerReadings readings = monitor.read();
+  EXPECT_FALSE(readings.has_thermal);
+  EXPECT_FALSE(readings.has_battery);
+  EXPECT_FALSE(readings.on_battery);
+  EXPECT_EQ(readings.battery_percent, -1);
+  EXPECT_NEAR(readings.throttle_ratio, 0, 1e-9);
+  EXPECT_EQ(monitor.update(), kTierFull);
+}
+
+NATIVE_TEST(reads_the_hottest_zone_and_the_smallest_headroom) {
+  FakeSysfs sysfs;
+  sysfs.zone(0, 45, 95);
+  sysfs.zone(1, 70, 80);
+  // Only a critical trip point: throttling assumed 15 degrees below it.
+  sysfs.write("class/thermal/thermal_zone2/temp", "60000\n");
+  sysfs.write("class/thermal/thermal_zone2/trip_point_0_type", "critical\n");
+  sysfs.write("class/thermal/thermal_zone2/trip_point_0_temp", "100000\n");
+  // No trip points: throttling assumed at 90 degrees.
+  sysfs.write("class/thermal/thermal_zone3/temp", "50000\n");
+
+  const PowerReadings readings = PowerMonitor(sysfs.root()).read();
+  EXPECT_TRUE(readings.has_thermal);
+  EXPECT_NEAR(readings.max_temp_c, 70, 1e-9);
+  EXPECT_NEAR(readings.headroom_c, 10, 1e-9);
+}
+
+NATIVE_TEST(skips_missing_malformed_and_implausible_zones) {
+  FakeSysfs sysfs;
+  sysfs.zone(0, 40, 90);
+  // No temp file.
+  sysfs.write("class/thermal/thermal_zone1/type", "acpitz\n");
+  // Garbled, truncated, empty and out of range readings.
+  sysfs.write("class/thermal/thermal_zone2/temp", "hot\n");
+  sysfs.write("class/thermal/thermal_zone3/temp", "85000x\n");
+  sysfs.write("class/thermal/thermal_zone4/temp", "");
+  sysfs.write("class/thermal/thermal_zone5/temp", "-273000\n");
+  sysfs.write("class/thermal/thermal_zone6/temp", "200000\n");
+  // A malformed trip point falls back to the default.
+  sysfs.write("class/thermal/thermal_zone7/temp", "50000\n");
+  sysfs.write("class/thermal/thermal_zone7/trip_point_0_type", "passive\n");
+  sysfs.write("class/thermal/thermal_zone7/trip_point_0_temp", "n/a\n");
+
+  const PowerReadings readings = PowerMonitor(sysfs.root()).read();
+  EXPECT_TRUE(readings.has_thermal);
+  EXPECT_NEAR(readings.max_temp_c, 50, 1e-9);
+  EXPECT_NEAR(readings.headroom_c, 40, 1e-9);
+}
+
+NATIVE_TEST(reads_processor_cooling_devices_only) {
+  FakeSysfs sysfs;
+  sysfs.cooling(0, "Fan", 5, 5);
+  sysfs.cooling(1, "cpufreq-cpu0", 3, 12);
+  sysfs.cooling(2, "Processor", 1, 10);
+  sysfs.cooling(3, "intel_powerclamp", 0, 0);
+  sysfs.write("class/thermal/cooling_device4/type", "cpufreq-cpu4\n");
+  sysfs.write("class/thermal/cooling_device4/cur_state", "many\n");
+  sysfs.write("class/thermal/cooling_device4/max_state", "10\n");
+
+  const PowerReadings readings = PowerMonitor(sysfs.root()).read();
+  EXPECT_NEAR(readings.throttle_ratio, 0.25, 1e-9);
+}
+
+NATIVE_TEST(reads_system_batteries_only) {
+  FakeSysfs sysfs;
+  sysfs.write("class/power_supply/AC/type", "Mains\n");
+  sysfs.write("class/power_supply/AC/online", "0\n");
+  sysfs.battery("BAT0", "Discharging", 64);
+  sysfs.battery("BAT1", "Unknown", 80);
+  sysfs.battery("hidpp_battery_0", "Discharging", 5);
+  sysfs.write("class/power_supply/hidpp_battery_0/scope", "Device\n");
+
+  const PowerReadings readings = PowerMonitor(sysfs.root()).read();
+  EXPECT_TRUE(readings.has_battery);
+  EXPECT_TRUE(readings.on_battery);
+  EXPECT_EQ(readings.battery_percent, 64);
+}
+
+NATIVE_TEST(ignores_a_malformed_battery_capacity) {
+  FakeSysfs sysfs;
+  sysfs.battery("BAT0", "Discharging", 0);
+  sysfs.write("class/power_supply/BAT0/capacity", "5%\n");
+
+  const PowerReadings readings = PowerMonitor(sysfs.root()).read();
+  EXPECT_TRUE(readings.on_battery);
+  EXPECT_EQ(readings.battery_percent, -1);
+  EXPECT_EQ(PowerMonitor::recommend(readings), kTierReduced);
+}
+
+NATIVE_TEST(backs_off_at_once_and_recovers_one_tier_at_a_time) {
+  FakeSysfs sysfs;
+  sysfs.zone(0, 50, 90);
+  PowerMonitor monitor(sysfs.root());
+  EXPECT_EQ(monitor.update(), kTierFull);
+
+  // 3 degrees of headroom.
+  sysfs.zone(0, 87, 90);
+  EXPECT_EQ(monitor.update(), kTierMinimal);
+  EXPECT_NEAR(monitor.readings().headroom_c, 3, 1e-9);
+
+  sysfs.zone(0, 50, 90);
+  for (int i = 1; i < PowerMonitor::kRecoverSamples; i++) {
+    EXPECT_EQ(monitor.update(), kTierMinimal);
+  }
+  EXPECT_EQ(monitor.update(), kTierReduced);
+  for (int i = 1; i < PowerMonitor::kRecoverSamples; i++) {
+    EXPECT_EQ(monitor.update(), kTierReduced);
+  }
+  EXPECT_EQ(monitor.update(), kTierFull);
+}
+
+NATIVE_TEST(a_worse_sample_restarts_recovery) {
+  FakeSysfs sysfs;
+  sysfs.battery("BAT0", "Discharging", 50);
+  PowerMonitor monitor(sysfs.root());
+  EXPECT_EQ(monitor.update(), kTierReduced);
+
+  sysfs.write("class/power_supply/BAT0/status", "Charging\n");
+  EXPECT_EQ(monitor.update(), kTierReduced);
+  EXPECT_EQ(monitor.update(), kTierReduced);
+  sysfs.write("class/power_supply/BAT0/status", "Discharging\n");
+  EXPECT_EQ(monitor.update(), kTierReduced);
+
+  sysfs.write("class/power_supply/BAT0/status", "Charging\n");
+  for (int i = 1; i < PowerMonitor::kRecoverSamples; i++) {
+    EXPECT_EQ(monitor.update(), kTierReduced);
+  }
+  EXPECT_EQ(monitor.update(), kTierFull);
+}
+
+NATIVE_TEST(low_battery_and_heavy_throttling_are_minimal) {
+  FakeSysfs sysfs;
+  sysfs.battery("BAT0", "Discharging", 8);
+  PowerMonitor monitor(sysfs.root());
+  EXPECT_EQ(monitor.update(), kTierMinimal);
+
+  FakeSysfs throttled;
+  throttled.cooling(0, "Processor", 6, 10);
+  EXPECT_EQ(PowerMonitor(throttled.root()).update(), kTierMinimal);
+
+  // A zone that disappears stops counting.
+  FakeSysfs hot;
+  hot.zone(0, 88, 90);
+  PowerMonitor hot_monitor(hot.root());
+  EXPECT_EQ(hot_monitor.update(), kTierMinimal);
+  hot.remove_file("class/thermal/thermal_zone0/temp");
+  hot_monitor.update();
+  EXPECT_FALSE(hot_monitor.readings().has_thermal);
+}
+
+NATIVE_TEST_MAIN()
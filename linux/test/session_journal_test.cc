@@ -0,0 +1,190 @@
+#include "session_journal.h"
+
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "native_test.h"
+
+namespace {
+
+/// Size of the file header, where the first block starts.
+constexpr size_t kFirstBlockOffset = 32;
+
+/// A temporary file, removed on destruction.
+class TempFile {
+ public:
+  TempFile() {
+    char path[] = "/tmp/session_journal_test.XXXXXX";
+    const int fd = mkstemp(path);
+    if (fd >= 0) {
+      ::close(fd);
+      path_ = path;
+    }
+  }
+
+  ~TempFile() { unlink(path_.c_str()); }
+
+  const char* path() const { return path_.c_str(); }
+
+  std::vector<uint8_t> read() const {
+    std::vector<uint8_t> bytes;
+    FILE* file = fopen(path(), "rb");
+    if (file == nullptr) return bytes;
+    uint8_t buffer[4096];
+    size_t n;
+    while ((n = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+      bytes.insert(bytes.end(), buffer, buffer + n);
+    }
+    fclose(file);
+    return bytes;
+  }
+
+  void write(const std::vector<uint8_t>& bytes) const {
+    FILE* file = fopen(path(), "wb");
+    if (file == nullptr) return;
+    fwrite(bytes.data(), 1, bytes.size(), file);
+    fclose(file);
+  }
+
+ private:
+  std::string path_;
+};
+
+int sample_x(uint32_t i) { return (i * 7919) % 1920; }
+
+/// Writes [events] pointer moves, enough for several blocks, uncompressed.
+/// Event i has server time i and x [sample_x](i).
+bool write_journal(const TempFile& file, int events,
+                   JournalStats* stats = nullptr) {
+  JournalWriter writer;
+  std::string error;
+  if (!writer.open(file.path(), kJournalCodecNone, 0, &error)) return false;
+  for (int i = 0; i < events; i++) {
+    CapturedEvent event;
+    memset(&event, 0, sizeof(event));
+    event.type = kCapturedMouseMove;
+    event.timestamp_us = 1000 + i * 1000;
+    event.server_time_ms = static_cast<uint32_t>(i);
+    event.x = sample_x(i);
+    event.y = (i * 104729) % 1080;
+    writer.append(event);
+  }
+  const JournalStats closed = writer.close();
+  if (stats != nullptr) *stats = closed;
+  return closed.error == 0;
+}
+
+/// Offset of the index of a closed journal, i.e. the end of its blocks.
+size_t index_offset(const std::vector<uint8_t>& bytes) {
+  size_t offset = 0;
+  for (int i = 0; i < 8; i++) {
+    offset |= static_cast<size_t>(bytes[bytes.size() - 16 + i]) << (8 * i);
+  }
+  return offset;
+}
+
+}  // namespace
+
+NATIVE_TEST(reads_a_closed_journal) {
+  TempFile file;
+  JournalStats stats;
+  EXPECT_TRUE(write_journal(file, 20000, &stats));
+  // The writer drops events rather than stall when its thread falls behind.
+  EXPECT_EQ(stats.events + stats.dropped, 20000u);
+
+  JournalReader reader;
+  std::string error;
+  EXPECT_TRUE(reader.open(file.path(), &error));
+  EXPECT_TRUE(reader.block_count() > 1);
+
+  std::vector<uint8_t> scratch;
+  std::vector<CapturedEvent> events;
+  uint64_t dropped = 0;
+  for (size_t i = 0; i < reader.block_count(); i++) {
+    EXPECT_TRUE(reader.decode_block(i, &scratch, &events));
+    dropped += reader.dropped_before(i);
+  }
+  EXPECT_EQ(events.size(), stats.events);
+  EXPECT_TRUE(dropped <= stats.dropped);
+  for (const CapturedEvent& event : events) {
+    EXPECT_EQ(event.x, sample_x(event.server_time_ms));
+  }
+}
+
+NATIVE_TEST(rebuilds_the_index_of_an_unclosed_journal) {
+  TempFile file;
+  EXPECT_TRUE(write_journal(file, 20000));
+  std::vector<uint8_t> bytes = file.read();
+  JournalReader closed;
+  EXPECT_TRUE(closed.open(file.path(), nullptr));
+  const size_t blocks = closed.block_count();
+
+  // What a writer that never reached close() leaves: blocks only.
+  bytes.resize(index_offset(bytes));
+  file.write(bytes);
+
+  JournalReader reader;
+  EXPECT_TRUE(reader.open(file.path(), nullptr));
+  EXPECT_EQ(reader.block_count(), blocks);
+}
+
+NATIVE_TEST(rejects_garbage_after_the_header) {
+  TempFile file;
+  EXPECT_TRUE(write_journal(file, 10));
+  std::vector<uint8_t> bytes = file.read();
+  bytes.resize(kFirstBlockOffset);
+  for (int i = 0; i < 4096; i++) {
+    bytes.push_back(static_cast<uint8_t>(i * 31 + 7));
+  }
+  file.write(bytes);
+
+  JournalReader reader;
+  std::string error;
+  EXPECT_FALSE(reader.open(file.path(), &error));
+  EXPECT_TRUE(error == "journal is corrupt");
+}
+
+NATIVE_TEST(rejects_a_header_without_blocks) {
+  TempFile file;
+  EXPECT_TRUE(write_journal(file, 10));
+  std::vector<uint8_t> bytes = file.read();
+  bytes.resize(kFirstBlockOffset);
+  file.write(bytes);
+
+  JournalReader reader;
+  EXPECT_FALSE(reader.open(file.path(), nullptr));
+}
+
+NATIVE_TEST(rejects_a_truncated_block) {
+  TempFile file;
+  EXPECT_TRUE(write_journal(file, 20000));
+  std::vector<uint8_t> bytes = file.read();
+  bytes.resize(index_offset(bytes) - 100);
+  file.write(bytes);
+
+  JournalReader reader;
+  EXPECT_FALSE(reader.open(file.path(), nullptr));
+}
+
+NATIVE_TEST(rejects_an_oversized_block) {
+  TempFile file;
+  EXPECT_TRUE(write_journal(file, 10));
+  std::vector<uint8_t> bytes = file.read();
+  // Raw size of the first block.
+  bytes[kFirstBlockOffset + 11] = 0xFF;
+  file.write(bytes);
+
+  JournalReader reader;
+  EXPECT_TRUE(reader.open(file.path(), nullptr));
+  std::vector<uint8_t> scratch;
+  std::vector<CapturedEvent> events;
+  EXPECT_FALSE(reader.decode_block(0, &scratch, &events));
+  EXPECT_EQ(scratch.capacity(), 0u);
+}
+
+NATIVE_TEST_MAIN()
@@ -0,0 +1,123 @@
+#include "view_input_filter.h"
+
+#include <gtk/gtk.h>
+
+#include <bitset>
+
+#include "log.h"
+
+namespace {
+
+/// Filter state. Only touched on the GTK main thread.
+struct ViewInputFilter {
+  /// The filtered view; cleared by a weak pointer when it is destroyed.
+  GtkWidget* view = nullptr;
+  bool capture_active = false;
+  guint exemptions = 0;
+  /// Hardware keycodes whose press was delivered to the view.
+  std::bitset<256> delivered_keys;
+  /// Events dropped since capture last started.
+  guint64 swallowed = 0;
+};
+
+ViewInputFilter* filter = nullptr;
+
+/// Whether [event] targets the window that contains the view.
+bool targets_view(GdkEvent* event) {
+  GtkWidget* widget = gtk_get_event_widget(event);
+  return widget != nullptr && filter->view != nullptr &&
+         gtk_widget_get_toplevel(widget) ==
+             gtk_widget_get_toplevel(filter->view);
+}
+
+/// Whether input of [kind] is currently kept from the view.
+bool filters(guint kind) {
+  return filter->capture_active && (filter->exemptions & kind) == 0;
+}
+
+/// Decides whether [event] is dropped, tracking delivered key presses.
+bool should_swallow(GdkEvent* event) {
+  GdkEventType type = gdk_event_get_event_type(event);
+  if (type != GDK_KEY_PRESS && type != GDK_KEY_RELEASE &&
+      type != GDK_MOTION_NOTIFY) {
+    return false;
+  }
+  if (!targets_view(event)) {
+    return false;
+  }
+
+  if (type == GDK_MOTION_NOTIFY) {
+    return filters(VIEW_INPUT_POINTER);
+  }
+
+  guint16 keycode = 0;
+  gdk_event_get_keycode(event, &keycode);
+  keycode &= 0xff;
+  if (type == GDK_KEY_PRESS) {
+    if (filters(VIEW_INPUT_KEYS)) {
+      return true;
+    }
+    filter->delivered_keys.set(keycode);
+    return false;
+  }
+
+  // Releases follow their press, so the engine never sees one without
+  // the other.
+  bool delivered = filter->delivered_keys.test(keycode);
+  filter->delivered_keys.reset(keycode);
+  return !delivered;
+}
+
+/// GDK event handler replacing gtk_main_do_event.
+void handle_event(GdkEvent* event, gpointer user_data) {
+  if (should_swallow(event)) {
+    filter->swallowed++;
+    return;
+  }
+  gtk_main_do_event(event);
+}
+
+}  // namespace
+
+void view_input_filter_install(FlView* view) {
+  if (filter != nullptr) {
+    LOG_WARNING("ViewInputFilter", "Already installed");
+    return;
+  }
+
+  filter = new ViewInputFilter();
+  filter->view = GTK_WIDGET(view);
+  g_object_add_weak_pointer(G_OBJECT(view),
+                            reinterpret_cast<gpointer*>(&filter->view));
+  gdk_event_handler_set(handle_event, nullptr, nullptr);
+  LOG_DEBUG("ViewInputFilter", "Installed");
+}
+
+gboolean view_input_filter_is_installed() {
+  return filter != nullptr;
+}
+
+void view_input_filter_set_capture_active(gboolean active) {
+  if (filter == nullptr || filter->capture_active == (active != FALSE)) {
+    return;
+  }
+
+  filter->capture_active = active != FALSE;
+  if (filter->capture_active) {
+    filter->swallowed = 0;
+  } else {
+    LOG_DEBUG("ViewInputFilter", "Dropped %llu in-window events during capture",
+              static_cast<unsigned long long>(filter->swallowed));
+  }
+}
+
+void view_input_filter_set_exemptions(guint kinds) {
+  if (filter == nullptr) {
+    return;
+  }
+
+  filter->exemptions = kinds & (VIEW_INPUT_KEYS | VIEW_INPUT_POINTER);
+  LOG_DEBUG("ViewInputFilter", "Exempted keys: %s, pointer: %s",
+            (filter->exemptions & VIEW_INPUT_KEYS) != 0 ? "yes" : "no",
+            (filter->exemptions & VIEW_INPUT_POINTER) != 0 ? "yes" : "no");
+}
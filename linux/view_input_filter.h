@@ -0,0 +1,51 @@
+#ifndef VIEW_INPUT_FILTER_H_
+#define VIEW_INPUT_FILTER_H_
+
+#include <flutter_linux/flutter_linux.h>
+
+G_BEGIN_DECLS
+
+/// Kinds of in-window input that can be exempted from the view input filter.
+typedef enum {
+  /// Key presses and releases.
+  VIEW_INPUT_KEYS = 1 << 0,
+  /// Pointer motion. Button and scroll events are never filtered.
+  VIEW_INPUT_POINTER = 1 << 1,
+} ViewInputKind;
+
+/// Keeps GTK from delivering input to the Flutter view while capture runs.
+///
+/// While XRecord capture is active every keystroke and pointer move over
+/// our own window already reaches Dart through the input capture channels.
+/// GTK would also hand it to the focused view, which runs it through the
+/// engine's keyboard and pointer pipeline a second time. Once installed,
+/// the filter drops key and motion events for the view's window while
+/// capture is active, except for the kinds exempted with
+/// view_input_filter_set_exemptions().
+///
+/// Key releases whose press reached the engine are always delivered, so
+/// the engine's pressed-key state never goes stale.
+///
+/// Installs a process-wide GDK event handler; call once from the runner.
+///
+/// @param view The Flutter view to filter input for.
+void view_input_filter_install(FlView* view);
+
+/// Whether view_input_filter_install() has been called.
+gboolean view_input_filter_is_installed();
+
+/// Turns filtering on or off. Called by the input capture plugin when
+/// capture starts and stops; a no-op if the filter is not installed.
+///
+/// @param active Whether input capture is active.
+void view_input_filter_set_capture_active(gboolean active);
+
+/// Sets the kinds of input delivered to the view even while capture is
+/// active, e.g. for menus that need hover and keyboard focus.
+///
+/// @param kinds Bitwise OR of #ViewInputKind values; 0 filters everything.
+void view_input_filter_set_exemptions(guint kinds);
+
+G_END_DECLS
+
+#endif  // VIEW_INPUT_FILTER_H_
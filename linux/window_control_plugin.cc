@@ -2,6 +2,14 @@
 
 #include <flutter_linux/flutter_linux.h>
 #include <gtk/gtk.h>
+#ifdef GDK_WINDOWING_X11
+#include <X11/Xatom.h>
+#include <X11/Xlib.h>
+#include <gdk/gdkx.h>
+#endif
+
+#include "log.h"
+#include "view_input_filter.h"
 
 /// Plugin structure.
 struct _WindowControlPlugin {
@@ -14,13 +22,13 @@ G_DEFINE_TYPE(WindowControlPlugin, window_control_plugin, G_TYPE_OBJECT)
 /// Method channel name.
 static constexpr char kChannelName[] = "com.keyboardplayground/window_control";
 
-/// Gets the GTK window from the Flutter view.
-static GtkWindow* get_window(WindowControlPlugin* self) {
-  if (self->view == nullptr) {
+/// Gets the GTK window containing [view].
+static GtkWindow* get_view_window(FlView* view) {
+  if (view == nullptr) {
     return nullptr;
   }
 
-  GtkWidget* widget = GTK_WIDGET(self->view);
+  GtkWidget* widget = GTK_WIDGET(view);
   GtkWidget* toplevel = gtk_widget_get_toplevel(widget);
 
   if (GTK_IS_WINDOW(toplevel)) {
@@ -30,19 +38,142 @@ static GtkWindow* get_window(WindowControlPlugin* self) {
   return nullptr;
 }
 
-/// Handles the "enterFullscreen" method call.
-static FlMethodResponse* enter_fullscreen(WindowControlPlugin* self) {
-  GtkWindow* window = get_window(self);
+/// Gets the GTK window from the Flutter view.
+static GtkWindow* get_window(WindowControlPlugin* self) {
+  return get_view_window(self->view);
+}
+
+#ifdef GDK_WINDOWING_X11
+/// Window properties asking the compositor to unredirect a window, so its
+/// frames go to the screen without a compositing pass. Both are CARDINALs
+/// where 1 requests the bypass. _NET_WM_BYPASS_COMPOSITOR is the EWMH hint;
+/// _KDE_NET_WM_BLOCK_COMPOSITING is its predecessor, still read by KWin.
+static constexpr const char* kBypassCompositorHints[] = {
+    "_NET_WM_BYPASS_COMPOSITOR",
+    "_KDE_NET_WM_BLOCK_COMPOSITING",
+};
+
+/// Gets the realized X11 window of [window], or nullptr.
+static GdkWindow* get_x11_window(GtkWindow* window) {
+  GdkWindow* gdk_window = gtk_widget_get_window(GTK_WIDGET(window));
+  if (gdk_window == nullptr || !GDK_IS_X11_WINDOW(gdk_window)) {
+    return nullptr;
+  }
+  return gdk_window;
+}
+#endif
+
+/// Sets or clears the compositor bypass hints on [window].
+///
+/// Compositors honor them for fullscreen windows, which then skip a frame
+/// of compositing latency and a full-screen copy.
+static void set_compositor_bypass(GtkWindow* window, bool bypass) {
+#ifdef GDK_WINDOWING_X11
+  GdkWindow* gdk_window = get_x11_window(window);
+  if (gdk_window == nullptr) {
+    return;
+  }
+
+  GdkDisplay* gdk_display = gdk_window_get_display(gdk_window);
+  Display* display = gdk_x11_display_get_xdisplay(gdk_display);
+  Window xid = gdk_x11_window_get_xid(gdk_window);
+  for (const char* name : kBypassCompositorHints) {
+    Atom atom = gdk_x11_get_xatom_by_name_for_display(gdk_display, name);
+    if (bypass) {
+      long value = 1;
+      XChangeProperty(display, xid, atom, XA_CARDINAL, 32, PropModeReplace,
+                      reinterpret_cast<unsigned char*>(&value), 1);
+    } else {
+      XDeleteProperty(display, xid, atom);
+    }
+  }
+  XFlush(display);
+  LOG_DEBUG("WindowControl", "Compositor bypass %s",
+            bypass ? "requested" : "cleared");
+#endif
+}
+
+/// Whether [window] carries the _NET_WM_BYPASS_COMPOSITOR request.
+static bool compositor_bypass_requested(GtkWindow* window) {
+  bool requested = false;
+#ifdef GDK_WINDOWING_X11
+  GdkWindow* gdk_window = get_x11_window(window);
+  if (gdk_window == nullptr) {
+    return false;
+  }
+
+  GdkDisplay* gdk_display = gdk_window_get_display(gdk_window);
+  Atom type = None;
+  int format = 0;
+  unsigned long items = 0;
+  unsigned long remaining = 0;
+  unsigned char* data = nullptr;
+  if (XGetWindowProperty(
+          gdk_x11_display_get_xdisplay(gdk_display),
+          gdk_x11_window_get_xid(gdk_window),
+          gdk_x11_get_xatom_by_name_for_display(gdk_display,
+                                                kBypassCompositorHints[0]),
+          0, 1, False, XA_CARDINAL, &type, &format, &items, &remaining,
+          &data) == Success &&
+      data != nullptr) {
+    requested = format == 32 && items == 1 &&
+                *reinterpret_cast<long*>(data) == 1;
+  }
+  if (data != nullptr) {
+    XFree(data);
+  }
+#endif
+  return requested;
+}
+
+/// Whether the window manager advertises support for the bypass hint.
+static bool compositor_bypass_supported(GtkWindow* window) {
+#ifdef GDK_WINDOWING_X11
+  GdkScreen* screen = gtk_window_get_screen(window);
+  if (GDK_IS_X11_SCREEN(screen)) {
+    return gdk_x11_screen_supports_net_wm_hint(
+        screen, gdk_atom_intern_static_string(kBypassCompositorHints[0]));
+  }
+#endif
+  return false;
+}
+
+gboolean window_control_enter_fullscreen(FlView* view,
+                                         gboolean bypass_compositor) {
+  GtkWindow* window = get_view_window(view);
   if (window == nullptr) {
+    return FALSE;
+  }
+
+  // Set the hints first so the compositor can unredirect as soon as the
+  // window covers the screen.
+  set_compositor_bypass(window, bypass_compositor);
+
+  // Enter fullscreen mode. The window manager applies it asynchronously.
+  gtk_window_fullscreen(window);
+  return TRUE;
+}
+
+/// Handles the "enterFullscreen" method call.
+///
+/// Arguments (optional): {bypassCompositor: bool}, default true.
+static FlMethodResponse* enter_fullscreen(WindowControlPlugin* self,
+                                          FlValue* args) {
+  gboolean bypass_compositor = TRUE;
+  if (args != nullptr && fl_value_get_type(args) == FL_VALUE_TYPE_MAP) {
+    FlValue* value = fl_value_lookup_string(args, "bypassCompositor");
+    if (value != nullptr && fl_value_get_type(value) == FL_VALUE_TYPE_BOOL) {
+      bypass_compositor = fl_value_get_bool(value);
+    }
+  }
+
+  if (!window_control_enter_fullscreen(self->view, bypass_compositor)) {
     return FL_METHOD_RESPONSE(fl_method_error_response_new(
         "NO_WINDOW",
         "Main window not available",
         nullptr));
   }
 
-  // Enter fullscreen mode
-  gtk_window_fullscreen(window);
-
   g_autoptr(FlValue) result = fl_value_new_bool(TRUE);
   return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
 }
@@ -58,6 +189,7 @@ static FlMethodResponse* exit_fullscreen(WindowControlPlugin* self) {
   }
 
   // Exit fullscreen mode
+  set_compositor_bypass(window, false);
   gtk_window_unfullscreen(window);
 
   g_autoptr(FlValue) result = fl_value_new_bool(TRUE);
@@ -65,24 +197,83 @@ static FlMethodResponse* exit_fullscreen(WindowControlPlugin* self) {
 }
 
 /// Handles the "isFullscreen" method call.
-static FlMethodResponse* is_fullscreen(WindowControlPlugin* self) {
+///
+/// Returns a bool, or with {details: true} a map:
+/// {fullscreen, composited, bypassCompositor, unredirected}.
+///
+/// X11 has no query for whether the compositor actually unredirected a
+/// window, so `unredirected` is inferred: the window is fullscreen and
+/// either no compositor runs, or the bypass hint is set and the window
+/// manager advertises support for it.
+static FlMethodResponse* is_fullscreen(WindowControlPlugin* self,
+                                       FlValue* args) {
+  bool details = false;
+  if (args != nullptr && fl_value_get_type(args) == FL_VALUE_TYPE_MAP) {
+    FlValue* value = fl_value_lookup_string(args, "details");
+    details = value != nullptr &&
+              fl_value_get_type(value) == FL_VALUE_TYPE_BOOL &&
+              fl_value_get_bool(value);
+  }
+
   GtkWindow* window = get_window(self);
-  if (window == nullptr) {
-    g_autoptr(FlValue) result = fl_value_new_bool(FALSE);
-    return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+  GdkWindow* gdk_window =
+      window != nullptr ? gtk_widget_get_window(GTK_WIDGET(window)) : nullptr;
+
+  gboolean fullscreen = FALSE;
+  if (gdk_window != nullptr) {
+    GdkWindowState state = gdk_window_get_state(gdk_window);
+    fullscreen = (state & GDK_WINDOW_STATE_FULLSCREEN) != 0;
   }
 
-  // Check if window is in fullscreen
-  GdkWindow* gdk_window = gtk_widget_get_window(GTK_WIDGET(window));
-  if (gdk_window == nullptr) {
-    g_autoptr(FlValue) result = fl_value_new_bool(FALSE);
+  if (!details) {
+    g_autoptr(FlValue) result = fl_value_new_bool(fullscreen);
     return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
   }
 
-  GdkWindowState state = gdk_window_get_state(gdk_window);
-  gboolean fullscreen = (state & GDK_WINDOW_STATE_FULLSCREEN) != 0;
+  bool composited = false;
+  bool bypass = false;
+  bool supported = false;
+  if (gdk_window != nullptr) {
+    composited = gdk_screen_is_composited(gtk_window_get_screen(window));
+    bypass = compositor_bypass_requested(window);
+    supported = compositor_bypass_supported(window);
+  }
+
+  g_autoptr(FlValue) result = fl_value_new_map();
+  fl_value_set_string_take(result, "fullscreen", fl_value_new_bool(fullscreen));
+  fl_value_set_string_take(result, "composited", fl_value_new_bool(composited));
+  fl_value_set_string_take(result, "bypassCompositor",
+                           fl_value_new_bool(bypass));
+  fl_value_set_string_take(
+      result, "unredirected",
+      fl_value_new_bool(fullscreen && (!composited || (bypass && supported))));
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+}
+
+/// Handles the "setViewInputExemptions" method call.
+///
+/// Arguments: {keys: bool, pointer: bool}. Returns whether the view input
+/// filter is installed, i.e. whether the exemptions have any effect.
+static FlMethodResponse* set_view_input_exemptions(FlValue* args) {
+  guint kinds = 0;
+  if (args != nullptr && fl_value_get_type(args) == FL_VALUE_TYPE_MAP) {
+    FlValue* keys = fl_value_lookup_string(args, "keys");
+    FlValue* pointer = fl_value_lookup_string(args, "pointer");
+    if (keys != nullptr && fl_value_get_type(keys) == FL_VALUE_TYPE_BOOL &&
+        fl_value_get_bool(keys)) {
+      kinds |= VIEW_INPUT_KEYS;
+    }
+    if (pointer != nullptr &&
+        fl_value_get_type(pointer) == FL_VALUE_TYPE_BOOL &&
+        fl_value_get_bool(pointer)) {
+      kinds |= VIEW_INPUT_POINTER;
+    }
+  }
+
+  view_input_filter_set_exemptions(kinds);
 
-  g_autoptr(FlValue) result = fl_value_new_bool(fullscreen);
+  g_autoptr(FlValue) result =
+      fl_value_new_bool(view_input_filter_is_installed());
   return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
 }
 
@@ -134,20 +325,23 @@ static void method_call_cb(FlMethodChannel* channel,
   FlMethodResponse* response = nullptr;
 
   if (strcmp(method, "enterFullscreen") == 0) {
-    response = enter_fullscreen(self);
+    response = enter_fullscreen(self, fl_method_call_get_args(method_call));
   } else if (strcmp(method, "exitFullscreen") == 0) {
     response = exit_fullscreen(self);
   } else if (strcmp(method, "isFullscreen") == 0) {
-    response = is_fullscreen(self);
+    response = is_fullscreen(self, fl_method_call_get_args(method_call));
   } else if (strcmp(method, "getScreenSize") == 0) {
     response = get_screen_size(self);
+  } else if (strcmp(method, "setViewInputExemptions") == 0) {
+    response = set_view_input_exemptions(fl_method_call_get_args(method_call));
   } else {
     response = FL_METHOD_RESPONSE(fl_method_not_implemented_response_new());
   }
 
   g_autoptr(GError) error = nullptr;
   if (!fl_method_call_respond(method_call, response, &error)) {
-    g_warning("Failed to send method call response: %s", error->message);
+    LOG_WARNING("WindowControl", "Failed to send method call response: %s",
+                error->message);
   }
 }
 
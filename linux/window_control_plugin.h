@@ -26,6 +26,18 @@ WindowControlPlugin* window_control_plugin_new(FlView* view);
 /// @param registrar The plugin registrar.
 void window_control_plugin_register_with_registrar(FlPluginRegistrar* registrar);
 
+/// Requests fullscreen for the window containing the Flutter view.
+///
+/// Also used by the input capture plugin, which enters fullscreen as part
+/// of its one-call session start.
+///
+/// @param view The Flutter view.
+/// @param bypass_compositor Whether to ask the compositor to unredirect the
+///     window (_NET_WM_BYPASS_COMPOSITOR) while it is fullscreen.
+/// @return TRUE if fullscreen was requested, FALSE if there is no window.
+gboolean window_control_enter_fullscreen(FlView* view,
+                                         gboolean bypass_compositor);
+
 G_END_DECLS
 
 #endif  // WINDOW_CONTROL_PLUGIN_H_
@@ -0,0 +1,179 @@
+#include "x_latency_probe.h"
+
+#include <X11/Xatom.h>
+#include <poll.h>
+#include <pthread.h>
+
+#include <chrono>
+
+#include "log.h"
+#include "pipeline_stats.h"
+
+namespace {
+
+/// Property changed on the probe window to make the server send an event.
+constexpr char kProbeAtom[] = "_KEYBOARD_PLAYGROUND_PROBE";
+
+/// Server to client delays beyond this are clock mismatches, not delays.
+constexpr int32_t kMaxEventAgeMs = 10000;
+
+int64_t steady_now_us() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+}  // namespace
+
+XLatencyProbe::XLatencyProbe()
+    : stopping_(false),
+      activity_(false),
+      paused_(false),
+      summary_(),
+      total_round_trip_us_(0) {}
+
+XLatencyProbe::~XLatencyProbe() { stop(); }
+
+void XLatencyProbe::start(int64_t interval_ms) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (thread_.joinable()) {
+    return;
+  }
+  stopping_ = false;
+  paused_ = false;
+  summary_ = XLatencyProbeSummary();
+  total_round_trip_us_ = 0;
+  thread_ = std::thread(&XLatencyProbe::run, this, interval_ms);
+}
+
+XLatencyProbeSummary XLatencyProbe::stop() {
+  std::thread thread;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+    thread.swap(thread_);
+  }
+  cv_.notify_all();
+  if (thread.joinable()) {
+    thread.join();
+  }
+
+  XLatencyProbeSummary summary = summary_;
+  if (summary.probes > 0) {
+    summary.mean_round_trip_us =
+        total_round_trip_us_ / static_cast<int64_t>(summary.probes);
+  }
+  return summary;
+}
+
+bool XLatencyProbe::running() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return thread_.joinable();
+}
+
+void XLatencyProbe::note_activity() {
+  // Already noted since the last probe: one relaxed load per event.
+  if (activity_.load(std::memory_order_relaxed)) {
+    return;
+  }
+  // Sequentially consistent with the probe thread's store of paused_ and
+  // load of activity_, so either it sees the activity or we see it paused.
+  activity_.store(true);
+  if (paused_.load()) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    cv_.notify_all();
+  }
+}
+
+void XLatencyProbe::run(int64_t interval_ms) {
+  pthread_setname_np(pthread_self(), "kp-probe");
+
+  // A connection of its own: Xlib connections are not shared between
+  // threads here, and a probe stuck on a busy server must not hold up the
+  // capture or the UI.
+  Display* display = XOpenDisplay(nullptr);
+  if (display == nullptr) {
+    LOG_WARNING("XLatencyProbe", "Cannot open display; server probe off");
+    return;
+  }
+
+  const Window window = XCreateSimpleWindow(
+      display, DefaultRootWindow(display), 0, 0, 1, 1, 0, 0, 0);
+  XSelectInput(display, window, PropertyChangeMask);
+  const Atom atom = XInternAtom(display, kProbeAtom, False);
+  XSync(display, False);
+
+  // Starts out active, so a capture start is probed even without input.
+  int idle_probes = 0;
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (!stopping_) {
+    lock.unlock();
+    const bool ok = probe(display, window, atom);
+    lock.lock();
+    if (!ok) {
+      LOG_WARNING("XLatencyProbe", "Probe connection failed; server probe off");
+      break;
+    }
+    cv_.wait_for(lock, std::chrono::milliseconds(interval_ms),
+                 [this] { return stopping_; });
+
+    idle_probes = activity_.exchange(false) ? 0 : idle_probes + 1;
+    if (idle_probes >= kIdleProbes) {
+      // No timeout: only input or stop() wakes the thread.
+      paused_.store(true);
+      cv_.wait(lock, [this] { return stopping_ || activity_.load(); });
+      paused_.store(false);
+      activity_.store(false);
+      idle_probes = 0;
+    }
+  }
+  lock.unlock();
+
+  XDestroyWindow(display, window);
+  XCloseDisplay(display);
+}
+
+bool XLatencyProbe::probe(Display* display, Window window, Atom atom) {
+  PipelineStats* stats = pipeline_stats_instance();
+
+  const int64_t sync_start_us = steady_now_us();
+  XSync(display, False);
+  const int64_t round_trip_us = steady_now_us() - sync_start_us;
+  stats->record_latency(kStageServerRoundTrip, round_trip_us);
+  summary_.probes++;
+  total_round_trip_us_ += round_trip_us;
+  if (round_trip_us > summary_.max_round_trip_us) {
+    summary_.max_round_trip_us = round_trip_us;
+  }
+
+  // The PropertyNotify carries the server time of the change. Xorg and
+  // Xwayland use the monotonic clock in ms for it, like for input events.
+  const long value = static_cast<long>(summary_.probes);
+  XChangeProperty(display, window, atom, XA_INTEGER, 32, PropModeReplace,
+                  reinterpret_cast<const unsigned char*>(&value), 1);
+  XFlush(display);
+
+  const int64_t deadline_us = sync_start_us + kEventTimeoutMs * 1000;
+  XEvent event;
+  while (!XCheckTypedWindowEvent(display, window, PropertyNotify, &event)) {
+    const int64_t remaining_us = deadline_us - steady_now_us();
+    if (remaining_us <= 0) {
+      summary_.timeouts++;
+      return true;
+    }
+    struct pollfd fd = {ConnectionNumber(display), POLLIN, 0};
+    const int ready =
+        poll(&fd, 1, static_cast<int>((remaining_us + 999) / 1000));
+    if (ready > 0 && (fd.revents & (POLLERR | POLLHUP)) != 0) {
+      return false;
+    }
+  }
+
+  const int32_t age_ms = static_cast<int32_t>(
+      static_cast<uint32_t>(steady_now_us() / 1000) -
+      static_cast<uint32_t>(event.xproperty.time));
+  if (age_ms >= 0 && age_ms < kMaxEventAgeMs) {
+    stats->record_latency(kStageServerEvent, int64_t{age_ms} * 1000);
+  }
+  return true;
+}
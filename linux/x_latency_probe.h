@@ -0,0 +1,93 @@
+#ifndef X_LATENCY_PROBE_H_
+#define X_LATENCY_PROBE_H_
+
+#include <X11/Xlib.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+/// Totals of an [XLatencyProbe] run, for logs.
+struct XLatencyProbeSummary {
+  /// Completed probes and probes whose event did not arrive in time.
+  uint64_t probes;
+  uint64_t timeouts;
+
+  /// Mean and longest XSync round trip, in microseconds.
+  int64_t mean_round_trip_us;
+  int64_t max_round_trip_us;
+};
+
+/// Low-rate probe of X server responsiveness on a side connection.
+///
+/// Input lag can come from an overloaded X server as well as from the app.
+/// Every interval the probe times an XSync round trip and the delivery of
+/// a PropertyNotify it causes on a private unmapped window, comparing the
+/// event's server timestamp with the local monotonic clock. Both go into
+/// the pipeline stats (kStageServerRoundTrip, kStageServerEvent), next to
+/// the capture pipeline's own stages, so a report shows whether the server
+/// or the pipeline is slow. At one probe a second the cost is two small
+/// requests and one event per second.
+///
+/// Probing only runs while input arrives ([note_activity]): after
+/// [kIdleProbes] probes without input the thread sleeps until the next
+/// event, so an unused kiosk is not woken up by it.
+///
+/// The probe runs on its own thread and connection, so a stalled server
+/// delays the probe, not the capture.
+class XLatencyProbe {
+ public:
+  /// Default time between probes.
+  static constexpr int64_t kDefaultIntervalMs = 1000;
+
+  /// Time a probe waits for its event before counting a timeout.
+  static constexpr int kEventTimeoutMs = 1000;
+
+  /// Probes without input after which probing pauses.
+  static constexpr int kIdleProbes = 5;
+
+  XLatencyProbe();
+
+  /// Stops the probe.
+  ~XLatencyProbe();
+
+  XLatencyProbe(const XLatencyProbe&) = delete;
+  XLatencyProbe& operator=(const XLatencyProbe&) = delete;
+
+  /// Starts probing the default display every [interval_ms]. Does nothing
+  /// if already running.
+  void start(int64_t interval_ms = kDefaultIntervalMs);
+
+  /// Stops probing and returns the totals since [start].
+  XLatencyProbeSummary stop();
+
+  bool running() const;
+
+  /// Notes that input arrived, resuming paused probing. Cheap enough to
+  /// call for every event, from any thread.
+  void note_activity();
+
+ private:
+  void run(int64_t interval_ms);
+
+  /// Probes once. Returns false if the connection failed.
+  bool probe(Display* display, Window window, Atom atom);
+
+  mutable std::mutex mutex_;
+  std::condition_variable cv_;
+  bool stopping_;
+  std::thread thread_;
+
+  // Set by note_activity(), consumed by the probe thread, which sets
+  // paused_ while it sleeps for lack of input.
+  std::atomic<bool> activity_;
+  std::atomic<bool> paused_;
+
+  // Written by the probe thread, read after join.
+  XLatencyProbeSummary summary_;
+  int64_t total_round_trip_us_;
+};
+
+#endif  // X_LATENCY_PROBE_H_
@@ -0,0 +1,90 @@
+import 'package:flutter_test/flutter_test.dart';
+import 'package:keyboard_playground/core/frame_clock.dart';
+
+void main() {
+  group('FrameClock', () {
+    final clock = FrameClock.instance;
+
+    tearDown(() {
+      clock
+        ..useRealTime()
+        ..detach();
+    });
+
+    group('real time', () {
+      test('falls back to the wall clock when not attached', () {
+        final before = DateTime.now();
+        final now = clock.now;
+        final after = DateTime.now();
+
+        expect(now.isBefore(before), isFalse);
+        expect(now.isAfter(after), isFalse);
+      });
+
+      testWidgets('returns one timestamp per frame', (tester) async {
+        clock.attach(tester.binding);
+        final reads = <DateTime>[];
+
+        tester.binding.scheduleFrameCallback((_) {
+          reads
+            ..add(clock.now)
+            ..add(clock.now);
+        });
+        await tester.pump();
+
+        expect(reads, hasLength(2));
+        expect(reads[1], equals(reads[0]));
+      });
+    });
+
+    group('virtual time', () {
+      test('stays frozen until advanced', () {
+        final start = DateTime(2024);
+        clock.useVirtualTime(start: start);
+
+        expect(clock.isVirtual, isTrue);
+        expect(clock.now, equals(start));
+
+        clock.advance(const Duration(milliseconds: 250));
+
+        expect(clock.now, equals(start.add(const Duration(milliseconds: 250))));
+      });
+
+      testWidgets('advances one step per rendered frame', (tester) async {
+        final start = DateTime(2024);
+        clock
+          ..attach(tester.binding)
+          ..useVirtualTime(start: start, frameStep: kVirtualFrameStep);
+        final reads = <DateTime>[];
+
+        for (var i = 0; i < 3; i++) {
+          tester.binding.scheduleFrameCallback((_) {
+            reads
+              ..add(clock.now)
+              ..add(clock.now);
+          });
+          // The wall-clock duration between frames does not matter.
+          await tester.pump(Duration(milliseconds: 5 + i * 40));
+        }
+
+        expect(reads, [
+          start,
+          start,
+          start.add(kVirtualFrameStep),
+          start.add(kVirtualFrameStep),
+          start.add(kVirtualFrameStep * 2),
+          start.add(kVirtualFrameStep * 2),
+        ]);
+      });
+
+      test('useRealTime returns to the wall clock', () {
+        clock
+          ..useVirtualTime(start: DateTime(2000))
+          ..useRealTime();
+
+        expect(clock.isVirtual, isFalse);
+        expect(clock.now.year, equals(DateTime.now().year));
+      });
+    });
+  });
+}
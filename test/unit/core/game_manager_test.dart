@@ -1,8 +1,11 @@
 import 'package:flutter/widgets.dart';
 import 'package:flutter_test/flutter_test.dart';
 import 'package:keyboard_playground/core/game_manager.dart';
+import 'package:keyboard_playground/core/lazy_game.dart';
 import 'package:keyboard_playground/games/base_game.dart';
+import 'package:keyboard_playground/platform/compact_input_event.dart';
 import 'package:keyboard_playground/platform/input_events.dart' as events;
+import 'package:keyboard_playground/platform/pointer_gesture.dart';
 
 /// Mock game for testing.
 class MockGame extends BaseGame {
@@ -19,7 +22,10 @@ class MockGame extends BaseGame {
 
   final List<events.KeyEvent> keyEvents = [];
   final List<events.InputEvent> mouseEvents = [];
+  final List<PointerGestureEvent> gestures = [];
   bool isDisposed = false;
+  int resumeCount = 0;
+  int suspendCount = 0;
 
   @override
   Widget buildUI() {
@@ -36,6 +42,21 @@ class MockGame extends BaseGame {
     mouseEvents.add(event);
   }
 
+  @override
+  void onGesture(PointerGestureEvent gesture) {
+    gestures.add(gesture);
+  }
+
+  @override
+  void onResume() {
+    resumeCount++;
+  }
+
+  @override
+  void onSuspend() {
+    suspendCount++;
+  }
+
   @override
   void dispose() {
     isDisposed = true;
@@ -43,6 +64,19 @@ class MockGame extends BaseGame {
   }
 }
 
+/// Mock game that takes every event through the compact fast path.
+class _CompactGame extends MockGame {
+  _CompactGame({required super.id});
+
+  int compactEvents = 0;
+
+  @override
+  bool onCompactEvent(CompactInputEvent event) {
+    compactEvents++;
+    return true;
+  }
+}
+
 void main() {
   group('GameManager', () {
     late GameManager gameManager;
@@ -204,6 +238,149 @@ void main() {
       });
     });
 
+    group('Lifecycle', () {
+      test('resumes the game it switches to', () {
+        final game = MockGame(id: 'test-game');
+        gameManager.registerGame(game);
+
+        gameManager.switchGame('test-game');
+
+        expect(game.resumeCount, equals(1));
+        expect(game.suspendCount, equals(0));
+      });
+
+      test('suspends the previous game when switching', () {
+        final game1 = MockGame(id: 'game-1');
+        final game2 = MockGame(id: 'game-2');
+        gameManager
+          ..registerGame(game1)
+          ..registerGame(game2)
+          ..switchGame('game-1')
+          ..switchGame('game-2');
+
+        expect(game1.suspendCount, equals(1));
+        expect(game2.resumeCount, equals(1));
+        expect(game1.isDisposed, isFalse);
+      });
+
+      test('switching to the active game keeps it running', () {
+        final game = MockGame(id: 'test-game');
+        gameManager
+          ..registerGame(game)
+          ..switchGame('test-game');
+
+        expect(gameManager.switchGame('test-game'), isTrue);
+
+        expect(game.resumeCount, equals(1));
+        expect(game.suspendCount, equals(0));
+        expect(gameManager.currentGame, same(game));
+      });
+
+      test('suspends the game when stopping', () {
+        final game = MockGame(id: 'test-game');
+        gameManager
+          ..registerGame(game)
+          ..switchGame('test-game')
+          ..stopCurrentGame();
+
+        expect(game.suspendCount, equals(1));
+      });
+    });
+
+    group('Lazy Games', () {
+      LazyGame lazy(String id, List<MockGame> created) => LazyGame(
+            id: id,
+            name: 'Lazy',
+            description: 'A mock game for testing',
+            create: () {
+              final game = MockGame(id: id, name: 'Lazy');
+              created.add(game);
+              return game;
+            },
+          );
+
+      test('does not construct games on registration', () {
+        final created = <MockGame>[];
+        gameManager.registerGame(lazy('lazy', created));
+
+        expect(created, isEmpty);
+        expect(gameManager.hasGame('lazy'), isTrue);
+        expect(gameManager.getGame('lazy')?.name, equals('Lazy'));
+      });
+
+      test('constructs and resumes the game on first switch', () {
+        final created = <MockGame>[];
+        gameManager
+          ..registerGame(lazy('lazy', created))
+          ..switchGame('lazy');
+
+        expect(created, hasLength(1));
+        expect(created.single.resumeCount, equals(1));
+      });
+
+      test('forwards events to the constructed game', () {
+        final created = <MockGame>[];
+        gameManager
+          ..registerGame(lazy('lazy', created))
+          ..switchGame('lazy')
+          ..handleInputEvent(
+            events.KeyEvent(
+              keyCode: 65,
+              key: 'a',
+              modifiers: const {},
+              isDown: true,
+              timestamp: DateTime.now(),
+            ),
+          );
+
+        expect(created.single.keyEvents, hasLength(1));
+      });
+
+      test('prewarmGame constructs without resuming', () {
+        final created = <MockGame>[];
+        gameManager.registerGame(lazy('lazy', created));
+
+        expect(gameManager.prewarmGame('lazy'), isTrue);
+        expect(created, hasLength(1));
+        expect(created.single.resumeCount, equals(0));
+
+        gameManager.switchGame('lazy');
+        expect(created, hasLength(1));
+      });
+
+      test('asserts that the constructed game has the same metadata', () {
+        gameManager.registerGame(
+          LazyGame(
+            id: 'lazy',
+            name: 'Stale name',
+            description: 'A mock game for testing',
+            create: () => MockGame(id: 'lazy', name: 'Lazy'),
+          ),
+        );
+
+        expect(
+          () => gameManager.switchGame('lazy'),
+          throwsA(isA<AssertionError>()),
+        );
+      });
+
+      test('prewarmGame returns false for unknown games', () {
+        expect(gameManager.prewarmGame('missing'), isFalse);
+      });
+
+      test('disposes the constructed game with the manager', () async {
+        final created = <MockGame>[];
+        gameManager
+          ..registerGame(lazy('lazy', created))
+          ..switchGame('lazy');
+
+        await gameManager.dispose();
+        gameManager = GameManager();
+
+        expect(created.single.isDisposed, isTrue);
+      });
+    });
+
     group('Event Handling', () {
       test('forwards key events to current game', () {
         final game = MockGame(id: 'test-game');
@@ -320,6 +497,60 @@ void main() {
 
         expect(game.mouseEvents.length, equals(3));
       });
+
+      test('handleCompactEvent converts events the game does not take', () {
+        final game = MockGame(id: 'test-game');
+        gameManager
+          ..registerGame(game)
+          ..switchGame('test-game');
+
+        final event = CompactInputEvent()
+          ..type = events.InputEventType.keyDown
+          ..keysym = 0x61
+          ..code = 38
+          ..modifiers = events.KeyModifier.shift.mask;
+        gameManager.handleCompactEvent(event);
+
+        expect(game.keyEvents, hasLength(1));
+        expect(game.keyEvents.single.key, 'a');
+        expect(game.keyEvents.single.modifiers, {events.KeyModifier.shift});
+      });
+
+      test('handleCompactEvent skips conversion when the game handles it',
+          () {
+        final game = _CompactGame(id: 'test-game');
+        gameManager
+          ..registerGame(game)
+          ..switchGame('test-game');
+
+        gameManager.handleCompactEvent(
+          CompactInputEvent()..type = events.InputEventType.mouseMove,
+        );
+
+        expect(game.compactEvents, 1);
+        expect(game.mouseEvents, isEmpty);
+      });
+
+      test('handleGesture forwards gestures to the current game', () {
+        final game = MockGame(id: 'test-game');
+        final gesture = PointerGestureEvent(
+          gesture: PointerGesture.circle,
+          confidence: 0.9,
+          x: 100,
+          y: 200,
+          timestamp: DateTime.now(),
+        );
+
+        // No active game: ignored.
+        gameManager.handleGesture(gesture);
+
+        gameManager
+          ..registerGame(game)
+          ..switchGame('test-game')
+          ..handleGesture(gesture);
+
+        expect(game.gestures, [gesture]);
+      });
     });
 
     group('Disposal', () {
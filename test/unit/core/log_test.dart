@@ -0,0 +1,106 @@
+import 'package:flutter_test/flutter_test.dart';
+import 'package:keyboard_playground/core/log.dart';
+
+void main() {
+  group('LogRing', () {
+    test('keeps records oldest first', () {
+      final ring = LogRing(4);
+      for (var i = 0; i < 3; i++) {
+        ring.add(_record(i));
+      }
+
+      expect(ring.toList().map((r) => r.sequence), [0, 1, 2]);
+    });
+
+    test('overwrites the oldest records when full', () {
+      final ring = LogRing(4);
+      for (var i = 0; i < 10; i++) {
+        ring.add(_record(i));
+      }
+
+      expect(ring.written, 10);
+      expect(ring.toList().map((r) => r.sequence), [6, 7, 8, 9]);
+    });
+
+    test('clear empties the ring', () {
+      final ring = LogRing(4)..add(_record(0));
+      ring.clear();
+
+      expect(ring.toList(), isEmpty);
+      expect(ring.written, 0);
+    });
+  });
+
+  group('Log', () {
+    late LogLevel savedLevel;
+    late LogLevel savedConsoleLevel;
+
+    setUp(() {
+      savedLevel = Log.level;
+      savedConsoleLevel = Log.consoleLevel;
+      Log.consoleLevel = LogLevel.off;
+      Log.ring.clear();
+    });
+
+    tearDown(() {
+      Log.level = savedLevel;
+      Log.consoleLevel = savedConsoleLevel;
+      Log.ring.clear();
+    });
+
+    test('does not build messages below the runtime level', () {
+      Log.level = LogLevel.warning;
+      var built = false;
+
+      Log.debug('test', () {
+        built = true;
+        return 'hidden';
+      });
+
+      expect(built, isFalse);
+      expect(Log.dump(), isEmpty);
+    });
+
+    test('records enabled messages in the ring', () {
+      Log.level = LogLevel.trace;
+
+      Log.trace('test', () => 'first');
+      Log.warning('test', () => 'second');
+
+      final records = Log.dump();
+      expect(records.map((r) => r.message), ['first', 'second']);
+      expect(records.map((r) => r.level), [LogLevel.trace, LogLevel.warning]);
+      expect(records.first.tag, 'test');
+    });
+
+    test('off disables every level', () {
+      Log.level = LogLevel.off;
+
+      Log.error('test', () => 'nothing');
+
+      expect(Log.dump(), isEmpty);
+    });
+
+    test('parses native records', () {
+      final record = LogRecord.fromNativeMap({
+        'sequence': 3,
+        'timeUs': 10,
+        'level': LogLevel.error.index,
+        'message': 'InputCapture: Failed',
+      });
+
+      expect(record.sequence, 3);
+      expect(record.level, LogLevel.error);
+      expect(record.tag, 'native');
+      expect(record.message, 'InputCapture: Failed');
+    });
+  });
+}
+
+LogRecord _record(int sequence) => LogRecord(
+      sequence: sequence,
+      timeUs: sequence,
+      level: LogLevel.info,
+      tag: 'test',
+      message: 'message $sequence',
+    );
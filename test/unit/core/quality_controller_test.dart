@@ -0,0 +1,127 @@
+import 'package:flutter_test/flutter_test.dart';
+import 'package:keyboard_playground/core/quality_controller.dart';
+
+void main() {
+  group('QualityController', () {
+    late QualityController controller;
+
+    setUp(() {
+      controller = QualityController(windowFrames: 10, upgradeWindows: 3);
+    });
+
+    /// Records one window of frames that all cost [ms].
+    void window(double ms, {int count = 1}) {
+      final cost = Duration(microseconds: (ms * 1000).round());
+      for (var i = 0; i < controller.windowFrames * count; i++) {
+        controller.recordFrame(build: cost, raster: const Duration());
+      }
+    }
+
+    test('starts at high quality', () {
+      expect(controller.level.value, QualityLevel.high);
+    });
+
+    test('drops one level per slow window', () {
+      window(20);
+      expect(controller.level.value, QualityLevel.medium);
+
+      window(20);
+      expect(controller.level.value, QualityLevel.low);
+
+      window(20);
+      expect(controller.level.value, QualityLevel.low);
+    });
+
+    test('uses the slower of build and raster time', () {
+      for (var i = 0; i < controller.windowFrames; i++) {
+        controller.recordFrame(
+          build: const Duration(milliseconds: 2),
+          raster: const Duration(milliseconds: 20),
+        );
+      }
+      expect(controller.level.value, QualityLevel.medium);
+    });
+
+    test('ignores occasional slow frames', () {
+      for (var i = 0; i < controller.windowFrames; i++) {
+        controller.recordFrame(
+          build: Duration(milliseconds: i == 0 ? 40 : 4),
+          raster: const Duration(),
+        );
+      }
+      expect(controller.level.value, QualityLevel.high);
+    });
+
+    test('rises only after several fast windows in a row', () {
+      window(20);
+      expect(controller.level.value, QualityLevel.medium);
+
+      window(4, count: 2);
+      expect(controller.level.value, QualityLevel.medium);
+
+      window(4);
+      expect(controller.level.value, QualityLevel.high);
+    });
+
+    test('does not oscillate inside the hysteresis band', () {
+      window(20);
+      expect(controller.level.value, QualityLevel.medium);
+
+      // Between the upgrade and downgrade thresholds: stay put.
+      window(12, count: 10);
+      expect(controller.level.value, QualityLevel.medium);
+    });
+
+    test('a band window resets the upgrade streak', () {
+      window(20);
+      window(4, count: 2);
+      window(12);
+      window(4, count: 2);
+      expect(controller.level.value, QualityLevel.medium);
+    });
+
+    test('pin fixes the level until released', () {
+      controller.pin(QualityLevel.low);
+      window(4, count: 10);
+      expect(controller.level.value, QualityLevel.low);
+
+      controller.pin(null);
+      window(20);
+      expect(controller.level.value, QualityLevel.low);
+      window(4, count: 3);
+      expect(controller.level.value, QualityLevel.medium);
+    });
+
+    test('limit caps the level and keeps adapting below it', () {
+      controller.limit(QualityLevel.medium);
+      expect(controller.level.value, QualityLevel.medium);
+
+      window(4, count: 10);
+      expect(controller.level.value, QualityLevel.medium);
+
+      window(20);
+      expect(controller.level.value, QualityLevel.low);
+    });
+
+    test('lifting the limit recovers one level at a time', () {
+      controller.limit(QualityLevel.low);
+      expect(controller.level.value, QualityLevel.low);
+
+      controller.limit(null);
+      expect(controller.level.value, QualityLevel.low);
+
+      window(4, count: 3);
+      expect(controller.level.value, QualityLevel.medium);
+      window(4, count: 3);
+      expect(controller.level.value, QualityLevel.high);
+    });
+  });
+
+  group('QualityLevel', () {
+    test('scale keeps a minimum', () {
+      expect(QualityLevel.high.scale(25), 25);
+      expect(QualityLevel.low.scale(25, min: 10), 10);
+      expect(QualityLevel.medium.scale(30), 18);
+    });
+  });
+}
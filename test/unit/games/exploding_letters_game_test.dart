@@ -65,6 +65,26 @@ void main() {
       });
     });
 
+    group('lifecycle', () {
+      test('onSuspend releases active letters', () {
+        game
+          ..onKeyEvent(EventBuilder.keyDown('a'))
+          ..onKeyEvent(EventBuilder.keyDown('b'))
+          ..onSuspend();
+
+        expect(game.activeLettersCount, equals(0));
+      });
+
+      test('accepts input again after resume', () {
+        game
+          ..onSuspend()
+          ..onResume()
+          ..onKeyEvent(EventBuilder.keyDown('a'));
+
+        expect(game.activeLettersCount, equals(1));
+      });
+    });
+
     group('onKeyEvent', () {
       test('creates letter entity on key down', () async {
         // Initially no letters
@@ -2,6 +2,7 @@ import 'package:flutter/material.dart';
 import 'package:flutter_test/flutter_test.dart';
 import 'package:keyboard_playground/games/mouse_visualizer_game.dart';
 import 'package:keyboard_playground/platform/input_events.dart' as events;
+import 'package:keyboard_playground/platform/pointer_gesture.dart';
 
 import '../../test_utils/builders/event_builder.dart';
 
@@ -520,6 +521,46 @@ void main() {
       });
     });
 
+    group('Gestures', () {
+      PointerGestureEvent gesture(
+        PointerGesture kind, {
+        double confidence = 0.9,
+        SwipeDirection? direction,
+      }) {
+        return PointerGestureEvent(
+          gesture: kind,
+          confidence: confidence,
+          x: 400,
+          y: 300,
+          timestamp: DateTime.now(),
+          direction: direction,
+        );
+      }
+
+      testWidgets('shows a burst with a label per gesture', (tester) async {
+        await tester.pumpWidget(MaterialApp(home: game.buildUI()));
+
+        game
+          ..onGesture(gesture(PointerGesture.circle))
+          ..onGesture(
+            gesture(PointerGesture.swipe, direction: SwipeDirection.left),
+          );
+        await tester.pump();
+
+        expect(game.gestureLabels, ['Circle!', 'Swipe ←']);
+        expect(find.text('Circle!'), findsOneWidget);
+        expect(find.text('Swipe ←'), findsOneWidget);
+
+        game.dispose();
+        await tester.pump();
+      });
+
+      test('ignores low-confidence gestures', () {
+        game.onGesture(gesture(PointerGesture.shake, confidence: 0.2));
+        expect(game.gestureLabels, isEmpty);
+      });
+    });
+
     group('Integration with Input Events', () {
       testWidgets('handles complete mouse interaction sequence',
           (tester) async {
@@ -0,0 +1,90 @@
+import 'dart:async';
+import 'dart:typed_data';
+
+import 'package:flutter_test/flutter_test.dart';
+import 'package:keyboard_playground/platform/background_event_decoder.dart';
+import 'package:keyboard_playground/platform/compact_input_event.dart';
+import 'package:keyboard_playground/platform/input_events.dart';
+
+/// Packs one record per entry of [types], with x set to the record index.
+Uint8List _batchOf(List<InputEventType> types) {
+  final batch = Uint8List(types.length * kCompactEventSize);
+  final data = ByteData.sublistView(batch);
+  for (var i = 0; i < types.length; i++) {
+    data
+      ..setInt32(i * kCompactEventSize + 12, i, Endian.little)
+      ..setUint8(i * kCompactEventSize + 22, types[i].index);
+  }
+  return batch;
+}
+
+List<InputEventType> _types(Uint8List batch) {
+  final types = <InputEventType>[];
+  CompactEventDecoder().decode(batch, (event) => types.add(event.type));
+  return types;
+}
+
+void main() {
+  group('BackgroundEventDecoder', () {
+    late BackgroundEventDecoder worker;
+    late StreamController<void> processed;
+
+    setUp(() {
+      processed = StreamController<void>.broadcast();
+      worker = BackgroundEventDecoder(onProcessed: () => processed.add(null));
+    });
+
+    tearDown(() async {
+      worker.close();
+      await processed.close();
+    });
+
+    test('delivers each consumer the records passing its filter', () async {
+      final keys = <Uint8List>[];
+      final everything = <Uint8List>[];
+      worker
+        ..addConsumer(CompactEventFilter.keys, keys.add)
+        ..addConsumer(CompactEventFilter.all, everything.add);
+
+      final done = processed.stream.first;
+      worker.add(
+        _batchOf([
+          InputEventType.mouseMove,
+          InputEventType.keyDown,
+          InputEventType.mouseMove,
+        ]),
+      );
+      await done;
+
+      expect(keys.map(_types), [
+        [InputEventType.keyDown],
+      ]);
+      expect(everything.single, hasLength(3 * kCompactEventSize));
+      expect(worker.inFlight, 0);
+    });
+
+    test('reports batches that pass no filter as processed', () async {
+      final keys = <Uint8List>[];
+      worker.addConsumer(CompactEventFilter.keys, keys.add);
+
+      final done = processed.stream.first;
+      worker.add(_batchOf([InputEventType.mouseMove]));
+      await done;
+
+      expect(keys, isEmpty);
+    });
+
+    test('stops delivering to removed consumers', () async {
+      final keys = <Uint8List>[];
+      final id = worker.addConsumer(CompactEventFilter.keys, keys.add);
+      worker.removeConsumer(id);
+      expect(worker.hasConsumers, isFalse);
+
+      final done = processed.stream.first;
+      worker.add(_batchOf([InputEventType.keyDown]));
+      await done;
+
+      expect(keys, isEmpty);
+    });
+  });
+}
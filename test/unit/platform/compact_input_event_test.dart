@@ -0,0 +1,271 @@
+import 'dart:typed_data';
+
+import 'package:flutter_test/flutter_test.dart';
+import 'package:keyboard_playground/platform/compact_input_event.dart';
+import 'package:keyboard_playground/platform/input_events.dart';
+
+/// Packs one record the way the Linux plugin does.
+void _putRecord(
+  ByteData data,
+  int index, {
+  required InputEventType type,
+  int timestampUs = 0,
+  int keysym = 0,
+  int x = 0,
+  int y = 0,
+  int code = 0,
+  int modifiers = 0,
+}) {
+  final offset = index * kCompactEventSize;
+  data
+    ..setInt64(offset, timestampUs, Endian.little)
+    ..setUint32(offset + 8, keysym, Endian.little)
+    ..setInt32(offset + 12, x, Endian.little)
+    ..setInt32(offset + 16, y, Endian.little)
+    ..setUint16(offset + 20, code, Endian.little)
+    ..setUint8(offset + 22, type.index)
+    ..setUint8(offset + 23, modifiers);
+}
+
+void main() {
+  group('CompactEventDecoder', () {
+    late CompactEventDecoder decoder;
+
+    setUp(() {
+      decoder = CompactEventDecoder();
+    });
+
+    test('decodes every field of a record', () {
+      final batch = Uint8List(kCompactEventSize);
+      _putRecord(
+        ByteData.sublistView(batch),
+        0,
+        type: InputEventType.keyDown,
+        timestampUs: 1700000000123456,
+        keysym: 0x41,
+        code: 38,
+        modifiers: KeyModifier.shift.mask | KeyModifier.meta.mask,
+      );
+
+      final decoded = <CompactInputEvent>[];
+      final count = decoder.decode(
+        batch,
+        (event) => decoded.add(CompactInputEvent.copy(event)),
+      );
+
+      expect(count, 1);
+      final event = decoded.single;
+      expect(event.type, InputEventType.keyDown);
+      expect(event.timestampUs, 1700000000123456);
+      expect(event.key, 'A');
+      expect(event.code, 38);
+      expect(event.isDown, isTrue);
+      expect(event.hasModifier(KeyModifier.shift), isTrue);
+      expect(event.hasModifier(KeyModifier.meta), isTrue);
+      expect(event.hasModifier(KeyModifier.control), isFalse);
+    });
+
+    test('reuses one instance for every event', () {
+      final batch = Uint8List(kCompactEventSize * 3);
+      final data = ByteData.sublistView(batch);
+      for (var i = 0; i < 3; i++) {
+        _putRecord(data, i, type: InputEventType.mouseMove, x: i, y: -i);
+      }
+
+      final instances = <CompactInputEvent>{};
+      final positions = <List<double>>[];
+      decoder.decode(batch, (event) {
+        instances.add(event);
+        positions.add([event.x, event.y]);
+      });
+
+      expect(instances, hasLength(1));
+      expect(positions, [
+        [0, 0],
+        [1, -1],
+        [2, -2],
+      ]);
+    });
+
+    test('skips records of unknown type and trailing partial records', () {
+      final batch = Uint8List(kCompactEventSize * 2 + 5);
+      final data = ByteData.sublistView(batch);
+      _putRecord(data, 0, type: InputEventType.mouseMove);
+      _putRecord(data, 1, type: InputEventType.mouseUp);
+      data.setUint8(22, 200);
+
+      final types = <InputEventType>[];
+      final count = decoder.decode(batch, (event) => types.add(event.type));
+
+      expect(count, 1);
+      expect(types, [InputEventType.mouseUp]);
+    });
+
+    test('decodeEvents builds standalone input events', () {
+      final batch = Uint8List(kCompactEventSize * 3);
+      final data = ByteData.sublistView(batch);
+      _putRecord(
+        data,
+        0,
+        type: InputEventType.mouseDown,
+        timestampUs: 5000,
+        x: 10,
+        y: 20,
+        code: 3,
+      );
+      _putRecord(data, 1, type: InputEventType.mouseScroll, y: -1);
+      _putRecord(data, 2, type: InputEventType.keyUp, keysym: 0xff51);
+
+      final events = decoder.decodeEvents(batch);
+
+      expect(events, hasLength(3));
+      final button = events[0] as MouseButtonEvent;
+      expect(button.button, MouseButton.right);
+      expect(button.isDown, isTrue);
+      expect(button.x, 10);
+      expect(button.y, 20);
+      expect(button.timestamp, DateTime.fromMicrosecondsSinceEpoch(5000));
+      expect((events[1] as MouseScrollEvent).deltaY, -1);
+      final key = events[2] as KeyEvent;
+      expect(key.key, 'ArrowLeft');
+      expect(key.isDown, isFalse);
+      expect(key.modifiers, isEmpty);
+    });
+  });
+
+  group('CompactInputEvent', () {
+    test('setFrom copies a regular input event', () {
+      final timestamp = DateTime.fromMicrosecondsSinceEpoch(42);
+      final event = CompactInputEvent()
+        ..setFrom(
+          KeyEvent(
+            keyCode: 65,
+            key: 'Escape',
+            modifiers: const {KeyModifier.control},
+            isDown: true,
+            timestamp: timestamp,
+          ),
+        );
+
+      expect(event.type, InputEventType.keyDown);
+      expect(event.timestampUs, 42);
+      expect(event.key, 'Escape');
+      expect(event.modifiers, KeyModifier.control.mask);
+
+      event.setFrom(
+        MouseButtonEvent(
+          button: MouseButton.middle,
+          x: 1.5,
+          y: 2.5,
+          isDown: false,
+          timestamp: timestamp,
+        ),
+      );
+
+      expect(event.type, InputEventType.mouseUp);
+      expect(event.button, MouseButton.middle);
+      expect(event.x, 1.5);
+      expect(event.modifiers, 0);
+    });
+  });
+
+  group('CompactEventFilter', () {
+    /// Packs records of [types], with x set to the record index.
+    Uint8List batchOf(List<InputEventType> types) {
+      final batch = Uint8List(types.length * kCompactEventSize);
+      final data = ByteData.sublistView(batch);
+      for (var i = 0; i < types.length; i++) {
+        _putRecord(data, i, type: types[i], x: i);
+      }
+      return batch;
+    }
+
+    List<(InputEventType, double)> decodeAll(Uint8List batch) {
+      final decoded = <(InputEventType, double)>[];
+      CompactEventDecoder().decode(batch, (e) => decoded.add((e.type, e.x)));
+      return decoded;
+    }
+
+    test('passes batches through unchanged by default', () {
+      final batch = batchOf([InputEventType.mouseMove]);
+
+      expect(identical(CompactEventFilter.all.apply(batch), batch), isTrue);
+    });
+
+    test('keeps only the selected types, in order', () {
+      final batch = batchOf([
+        InputEventType.mouseMove,
+        InputEventType.keyDown,
+        InputEventType.mouseMove,
+        InputEventType.keyUp,
+      ]);
+
+      expect(decodeAll(CompactEventFilter.keys.apply(batch)), [
+        (InputEventType.keyDown, 1),
+        (InputEventType.keyUp, 3),
+      ]);
+    });
+
+    test('returns an empty batch when nothing passes', () {
+      final batch = batchOf([InputEventType.mouseMove]);
+
+      expect(CompactEventFilter.keys.apply(batch), isEmpty);
+    });
+
+    test('coalesces runs of motion to their last sample', () {
+      const filter = CompactEventFilter(coalesceMotion: true);
+      final batch = batchOf([
+        InputEventType.mouseMove,
+        InputEventType.mouseMove,
+        InputEventType.mouseDown,
+        InputEventType.mouseMove,
+        InputEventType.mouseMove,
+        InputEventType.mouseMove,
+      ]);
+
+      expect(decodeAll(filter.apply(batch)), [
+        (InputEventType.mouseMove, 1),
+        (InputEventType.mouseDown, 2),
+        (InputEventType.mouseMove, 5),
+      ]);
+    });
+
+    test('compares by content', () {
+      expect(
+        const CompactEventFilter(
+          types: {InputEventType.keyUp, InputEventType.keyDown},
+        ),
+        CompactEventFilter.keys,
+      );
+      expect(CompactEventFilter.keys, isNot(CompactEventFilter.all));
+    });
+  });
+
+  group('keyNameForKeysym', () {
+    test('matches the names sent by the native capture', () {
+      expect(keyNameForKeysym(0x20), ' ');
+      expect(keyNameForKeysym(0x7e), '~');
+      expect(keyNameForKeysym(0xff0d), 'Return');
+      expect(keyNameForKeysym(0xff08), 'Backspace');
+      expect(keyNameForKeysym(0xffc9), 'F12');
+      expect(keyNameForKeysym(0xffe2), 'Shift');
+      expect(keyNameForKeysym(0xffeb), 'Meta');
+      expect(keyNameForKeysym(0x1008ff13), 'Key269025043');
+    });
+
+    test('normalizes arrow keys', () {
+      expect(keyNameForKeysym(0xff51), 'ArrowLeft');
+      expect(keyNameForKeysym(0xff52), 'ArrowUp');
+      expect(keyNameForKeysym(0xff53), 'ArrowRight');
+      expect(keyNameForKeysym(0xff54), 'ArrowDown');
+    });
+
+    test('returns cached names', () {
+      expect(identical(keyNameForKeysym(0x61), keyNameForKeysym(0x61)), isTrue);
+      expect(
+        identical(keyNameForKeysym(0x1234), keyNameForKeysym(0x1234)),
+        isTrue,
+      );
+    });
+  });
+}
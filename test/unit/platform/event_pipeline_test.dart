@@ -0,0 +1,57 @@
+import 'package:flutter_test/flutter_test.dart';
+import 'package:keyboard_playground/platform/event_pipeline.dart';
+import 'package:keyboard_playground/platform/input_events.dart';
+
+void main() {
+  group('EventStageConfig', () {
+    test('types sets the filter mask', () {
+      final config = EventStageConfig.types(
+        {InputEventType.keyDown, InputEventType.keyUp},
+      );
+
+      expect(config.toMap(), {'enabled': true, 'types': 0x3});
+    });
+
+    test('motionInterval sets the interval in microseconds', () {
+      final config = EventStageConfig.motionInterval(
+        const Duration(milliseconds: 16),
+      );
+
+      expect(config.toMap(), {'enabled': true, 'intervalUs': 16000});
+    });
+
+    test('leaves the enabled state alone unless given', () {
+      const config = EventStageConfig(options: {'intervalUs': 4000});
+
+      expect(config.toMap(), {'intervalUs': 4000});
+    });
+  });
+
+  group('EventStageInfo.fromMap', () {
+    test('parses configuration and timing', () {
+      final info = EventStageInfo.fromMap({
+        'name': 'repeat_collapse',
+        'enabled': true,
+        'options': <Object?, Object?>{},
+        'calls': 4,
+        'dropped': 1,
+        'totalNs': 1000,
+        'maxNs': 400,
+      });
+
+      expect(info.stage, EventPipelineStage.repeatCollapse);
+      expect(info.enabled, isTrue);
+      expect(info.dropped, 1);
+      expect(info.meanNs, 250);
+      expect(info.maxNs, 400);
+    });
+
+    test('keeps stages this version does not know', () {
+      final info = EventStageInfo.fromMap({'name': 'dedupe'});
+
+      expect(info.name, 'dedupe');
+      expect(info.stage, isNull);
+      expect(info.meanNs, 0);
+    });
+  });
+}
@@ -1,8 +1,17 @@
+import 'dart:async';
+
+import 'package:flutter/foundation.dart';
+import 'package:flutter/services.dart' hide KeyEvent;
 import 'package:flutter_test/flutter_test.dart';
+import 'package:keyboard_playground/core/log.dart';
+import 'package:keyboard_playground/platform/compact_input_event.dart';
+import 'package:keyboard_playground/platform/event_pipeline.dart';
 import 'package:keyboard_playground/platform/input_capture.dart';
 import 'package:keyboard_playground/platform/input_events.dart';
 
 void main() {
+  TestWidgetsFlutterBinding.ensureInitialized();
+
   group('InputCapture', () {
     late InputCapture inputCapture;
 
@@ -256,6 +265,723 @@ void main() {
         );
       });
     });
+
+    group('Session Journal', () {
+      const methodChannel =
+          MethodChannel('com.keyboardplayground/input_capture');
+      final calls = <MethodCall>[];
+
+      void mockChannel(Object? Function(MethodCall call) handler) {
+        TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger
+            .setMockMethodCallHandler(methodChannel, (call) async {
+          calls.add(call);
+          return handler(call);
+        });
+      }
+
+      setUp(calls.clear);
+
+      tearDown(() {
+        TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger
+            .setMockMethodCallHandler(methodChannel, null);
+      });
+
+      test('startJournal passes path and compression', () async {
+        mockChannel((_) => true);
+
+        final started = await inputCapture.startJournal(
+          '/tmp/session.kpj',
+          compression: JournalCompression.zstd,
+        );
+
+        expect(started, isTrue);
+        expect(calls.single.method, 'startJournal');
+        expect(calls.single.arguments, {
+          'path': '/tmp/session.kpj',
+          'compression': 'zstd',
+        });
+      });
+
+      test('startJournal leaves the compression to native by default',
+          () async {
+        mockChannel((_) => true);
+
+        await inputCapture.startJournal('/tmp/session.kpj');
+
+        expect(calls.single.arguments, {'path': '/tmp/session.kpj'});
+      });
+
+      test('startJournal returns false on platform error', () async {
+        mockChannel((_) => throw PlatformException(code: 'JOURNAL_FAILED'));
+
+        expect(await inputCapture.startJournal('/nonexistent/x.kpj'), isFalse);
+      });
+
+      test('stopJournal parses statistics', () async {
+        mockChannel(
+          (_) => {
+            'events': 1200,
+            'dropped': 3,
+            'blocks': 2,
+            'rawBytes': 7200,
+            'fileBytes': 7400,
+          },
+        );
+
+        final stats = await inputCapture.stopJournal();
+
+        expect(stats, isNotNull);
+        expect(stats!.events, 1200);
+        expect(stats.dropped, 3);
+        expect(stats.blocks, 2);
+        expect(stats.rawBytes, 7200);
+        expect(stats.fileBytes, 7400);
+        expect(stats.failed, isFalse);
+      });
+
+      test('stopJournal reports a failed write', () async {
+        mockChannel(
+          (_) => {
+            'events': 1200,
+            'dropped': 400,
+            'blocks': 1,
+            'rawBytes': 4800,
+            'fileBytes': 4900,
+            'error': 'No space left on device',
+          },
+        );
+
+        final stats = await inputCapture.stopJournal();
+
+        expect(stats!.failed, isTrue);
+        expect(stats.error, 'No space left on device');
+        expect(stats.dropped, 400);
+      });
+
+      test('stopJournal returns null when no journal was open', () async {
+        mockChannel((_) => <String, Object?>{});
+
+        expect(await inputCapture.stopJournal(), isNull);
+      });
+
+      test('replayJournal passes offset and rate', () async {
+        mockChannel((_) => {'events': 42, 'cancelled': false});
+
+        final replayed = await inputCapture.replayJournal(
+          '/tmp/session.kpj',
+          from: const Duration(seconds: 90),
+          rate: 4,
+        );
+
+        expect(replayed, 42);
+        expect(calls.single.method, 'replayJournal');
+        expect(calls.single.arguments, {
+          'path': '/tmp/session.kpj',
+          'fromUs': 90000000,
+          'rate': 4.0,
+        });
+      });
+
+      test('replayJournal returns null on failure', () async {
+        mockChannel((_) => throw PlatformException(code: 'REPLAY_FAILED'));
+
+        expect(await inputCapture.replayJournal('/tmp/missing.kpj'), isNull);
+      });
+    });
+
+    group('Native Log', () {
+      const methodChannel =
+          MethodChannel('com.keyboardplayground/input_capture');
+      final calls = <MethodCall>[];
+
+      void mockChannel(Object? Function(MethodCall call) handler) {
+        TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger
+            .setMockMethodCallHandler(methodChannel, (call) async {
+          calls.add(call);
+          return handler(call);
+        });
+      }
+
+      setUp(calls.clear);
+
+      tearDown(() {
+        TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger
+            .setMockMethodCallHandler(methodChannel, null);
+      });
+
+      test('setNativeLogLevel passes level indices', () async {
+        mockChannel((_) => LogLevel.trace.index);
+
+        await inputCapture.setNativeLogLevel(
+          LogLevel.trace,
+          console: LogLevel.warning,
+        );
+
+        expect(calls.single.method, 'setLogLevel');
+        expect(calls.single.arguments, {'level': 0, 'console': 3});
+      });
+
+      test('dumpNativeLog parses records', () async {
+        mockChannel(
+          (_) => [
+            {
+              'sequence': 7,
+              'timeUs': 1700000000000000,
+              'level': LogLevel.info.index,
+              'message': 'InputCapture: Started successfully',
+            },
+          ],
+        );
+
+        final records = await inputCapture.dumpNativeLog();
+
+        expect(records, hasLength(1));
+        expect(records.single.sequence, 7);
+        expect(records.single.level, LogLevel.info);
+        expect(records.single.message, 'InputCapture: Started successfully');
+      });
+
+      test('dumpNativeLog returns nothing on platform error', () async {
+        mockChannel((_) => throw PlatformException(code: 'UNAVAILABLE'));
+
+        expect(await inputCapture.dumpNativeLog(), isEmpty);
+      });
+    });
+
+    group('Merge Window', () {
+      const methodChannel =
+          MethodChannel('com.keyboardplayground/input_capture');
+
+      tearDown(() {
+        TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger
+            .setMockMethodCallHandler(methodChannel, null);
+      });
+
+      test('setMergeWindow sends microseconds and returns the window',
+          () async {
+        Object? arguments;
+        TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger
+            .setMockMethodCallHandler(methodChannel, (call) async {
+          arguments = call.arguments;
+          return 12000;
+        });
+
+        final window = await inputCapture.setMergeWindow(
+          const Duration(milliseconds: 12),
+        );
+
+        expect(arguments, {'us': 12000});
+        expect(window, const Duration(milliseconds: 12));
+      });
+
+      test('setMergeWindow returns null on platform error', () async {
+        TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger
+            .setMockMethodCallHandler(methodChannel, (call) async {
+          throw PlatformException(code: 'UNAVAILABLE');
+        });
+
+        expect(
+          await inputCapture.setMergeWindow(const Duration(milliseconds: 4)),
+          isNull,
+        );
+      });
+    });
+
+    group('Pipeline', () {
+      const methodChannel =
+          MethodChannel('com.keyboardplayground/input_capture');
+
+      tearDown(() {
+        TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger
+            .setMockMethodCallHandler(methodChannel, null);
+      });
+
+      test('configurePipeline sends stage ids and parses the stages',
+          () async {
+        Object? arguments;
+        TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger
+            .setMockMethodCallHandler(methodChannel, (call) async {
+          arguments = call.arguments;
+          return [
+            {'name': 'filter', 'enabled': true, 'options': {'types': 3}},
+            {'name': 'deliver', 'enabled': true, 'calls': 2},
+          ];
+        });
+
+        final stages = await inputCapture.configurePipeline({
+          EventPipelineStage.filter: EventStageConfig.types(
+            {InputEventType.keyDown, InputEventType.keyUp},
+          ),
+          EventPipelineStage.repeatCollapse:
+              const EventStageConfig(enabled: false),
+        });
+
+        expect(arguments, {
+          'stages': {
+            'filter': {'enabled': true, 'types': 3},
+            'repeat_collapse': {'enabled': false},
+          },
+        });
+        expect(stages?.map((stage) => stage.stage), [
+          EventPipelineStage.filter,
+          EventPipelineStage.deliver,
+        ]);
+        expect(stages?.first.options, {'types': 3});
+      });
+
+      test('configurePipeline returns null for invalid stages', () async {
+        TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger
+            .setMockMethodCallHandler(methodChannel, (call) async {
+          throw PlatformException(code: 'BAD_ARGS');
+        });
+
+        expect(
+          await inputCapture.configurePipeline({
+            EventPipelineStage.coalesce: const EventStageConfig(
+              options: {'intervalUs': -1},
+            ),
+          }),
+          isNull,
+        );
+      });
+
+      test('getPipeline sends resetTimings', () async {
+        Object? arguments;
+        TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger
+            .setMockMethodCallHandler(methodChannel, (call) async {
+          arguments = call.arguments;
+          return <Object?>[];
+        });
+
+        expect(await inputCapture.getPipeline(resetTimings: true), isEmpty);
+        expect(arguments, {'resetTimings': true});
+      });
+
+      test('setPipelineTiming sends enabled', () async {
+        Object? arguments;
+        TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger
+            .setMockMethodCallHandler(methodChannel, (call) async {
+          arguments = call.arguments;
+          return true;
+        });
+
+        expect(await inputCapture.setPipelineTiming(true), isTrue);
+        expect(arguments, {'enabled': true});
+      });
+    });
+
+    group('HUD', () {
+      const methodChannel =
+          MethodChannel('com.keyboardplayground/input_capture');
+
+      tearDown(() {
+        debugDefaultTargetPlatformOverride = null;
+        TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger
+            .setMockMethodCallHandler(methodChannel, null);
+      });
+
+      test('setHudChord sends the key and modifier names', () async {
+        Object? arguments;
+        TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger
+            .setMockMethodCallHandler(methodChannel, (call) async {
+          arguments = call.arguments;
+          return true;
+        });
+
+        final set = await inputCapture.setHudChord(
+          'h',
+          modifiers: {KeyModifier.control, KeyModifier.alt},
+        );
+
+        expect(set, isTrue);
+        expect(arguments, {
+          'key': 'h',
+          'modifiers': ['control', 'alt'],
+        });
+      });
+
+      test('setHudChord returns false on platform error', () async {
+        TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger
+            .setMockMethodCallHandler(methodChannel, (call) async {
+          throw PlatformException(code: 'BAD_ARGS');
+        });
+
+        expect(await inputCapture.setHudChord('F12'), isFalse);
+      });
+
+      test('hudToggles is empty off Linux', () async {
+        debugDefaultTargetPlatformOverride = TargetPlatform.macOS;
+
+        expect(await inputCapture.hudToggles.isEmpty, isTrue);
+      });
+    });
+
+    group('Capture Backend', () {
+      const methodChannel =
+          MethodChannel('com.keyboardplayground/input_capture');
+
+      tearDown(() {
+        TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger
+            .setMockMethodCallHandler(methodChannel, null);
+      });
+
+      test('selectCaptureBackend sends rerun and parses the selection',
+          () async {
+        Object? arguments;
+        TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger
+            .setMockMethodCallHandler(methodChannel, (call) async {
+          arguments = call.arguments;
+          return {'name': 'record_sync', 'cached': true, 'measured': true};
+        });
+
+        final backend = await inputCapture.selectCaptureBackend(rerun: true);
+
+        expect(arguments, {'rerun': true});
+        expect(backend?.name, 'record_sync');
+        expect(backend?.cached, isTrue);
+      });
+
+      test('selectCaptureBackend returns null while capturing', () async {
+        TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger
+            .setMockMethodCallHandler(methodChannel, (call) async {
+          throw PlatformException(code: 'BUSY');
+        });
+
+        expect(await inputCapture.selectCaptureBackend(), isNull);
+      });
+    });
+
+    group('Session', () {
+      const methodChannel =
+          MethodChannel('com.keyboardplayground/input_capture');
+      const windowChannel =
+          MethodChannel('com.keyboardplayground/window_control');
+      final calls = <String>[];
+      var permitted = true;
+
+      setUp(() {
+        calls.clear();
+        permitted = true;
+        TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger
+          ..setMockMethodCallHandler(methodChannel, (call) async {
+            calls.add(call.method);
+            switch (call.method) {
+              case 'initializeSession':
+                return {
+                  'permissions': {'x11_record': true},
+                  'capabilities': {'eventBatches': true, 'gestures': true},
+                  'fullscreen': call.arguments['fullscreen'],
+                  'capturing': true,
+                  'timings': {'probe': 10, 'capture': 200, 'total': 210},
+                };
+              case 'checkPermissions':
+                return {'accessibility': permitted};
+              case 'startCapture':
+                return true;
+            }
+            return null;
+          })
+          ..setMockMethodCallHandler(windowChannel, (call) async {
+            calls.add(call.method);
+            return true;
+          });
+      });
+
+      tearDown(() {
+        debugDefaultTargetPlatformOverride = null;
+        TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger
+          ..setMockMethodCallHandler(methodChannel, null)
+          ..setMockMethodCallHandler(windowChannel, null);
+      });
+
+      test('starts in one native call on Linux', () async {
+        debugDefaultTargetPlatformOverride = TargetPlatform.linux;
+
+        final session = await inputCapture.initializeSession();
+
+        expect(calls, ['initializeSession']);
+        expect(session.capturing, isTrue);
+        expect(session.fullscreen, isTrue);
+        expect(session.timings['total'], const Duration(microseconds: 210));
+      });
+
+      test('asks for backend selection on Linux', () async {
+        debugDefaultTargetPlatformOverride = TargetPlatform.linux;
+        Object? arguments;
+        TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger
+            .setMockMethodCallHandler(methodChannel, (call) async {
+          arguments = call.arguments;
+          return {'capturing': true};
+        });
+
+        await inputCapture.initializeSession(selectBackend: true);
+
+        expect(arguments, {'fullscreen': true, 'selectBackend': true});
+      });
+
+      test('makes the separate calls elsewhere', () async {
+        debugDefaultTargetPlatformOverride = TargetPlatform.macOS;
+
+        final session = await inputCapture.initializeSession();
+
+        expect(
+          calls,
+          containsAll(['checkPermissions', 'enterFullscreen', 'startCapture']),
+        );
+        expect(calls.last, 'startCapture');
+        expect(session.capturing, isTrue);
+        expect(session.timings.keys, containsAll(['probe', 'capture']));
+      });
+
+      test('does not start capture without permissions', () async {
+        debugDefaultTargetPlatformOverride = TargetPlatform.macOS;
+        permitted = false;
+
+        final session = await inputCapture.initializeSession(
+          fullscreen: false,
+        );
+
+        expect(calls, ['checkPermissions']);
+        expect(session.permissionsGranted, isFalse);
+        expect(session.capturing, isFalse);
+      });
+
+      test('waitForPermissions rechecks when asked to', () async {
+        permitted = false;
+        final recheck = StreamController<void>();
+
+        final granted = inputCapture.waitForPermissions(
+          recheck: recheck.stream,
+          interval: const Duration(hours: 1),
+        );
+        await pumpEventQueue();
+        permitted = true;
+        recheck.add(null);
+
+        expect(await granted, isTrue);
+        await recheck.close();
+      });
+
+      test('waitForPermissions stops polling once rechecks arrive', () async {
+        permitted = false;
+        final recheck = StreamController<void>();
+
+        final granted = inputCapture.waitForPermissions(
+          recheck: recheck.stream,
+          interval: const Duration(milliseconds: 5),
+          timeout: const Duration(milliseconds: 200),
+        );
+        await Future<void>.delayed(const Duration(milliseconds: 30));
+        expect(calls.length, greaterThan(1));
+
+        recheck.add(null);
+        await pumpEventQueue();
+        final checks = calls.length;
+        await Future<void>.delayed(const Duration(milliseconds: 50));
+        expect(calls.length, checks);
+
+        expect(await granted, isFalse);
+        await recheck.close();
+      });
+
+      test('waitForPermissions gives up after the timeout', () async {
+        permitted = false;
+
+        final granted = await inputCapture.waitForPermissions(
+          interval: const Duration(milliseconds: 5),
+          timeout: const Duration(milliseconds: 30),
+        );
+
+        expect(granted, isFalse);
+      });
+    });
+
+    group('Event Batches', () {
+      const methodChannel =
+          MethodChannel('com.keyboardplayground/input_capture');
+      const batchChannel =
+          EventChannel('com.keyboardplayground/input_event_batches');
+      final calls = <MethodCall>[];
+      Object? listenArguments;
+      MockStreamHandlerEventSink? batchSink;
+
+      Uint8List moveBatch(int x) {
+        final batch = Uint8List(kCompactEventSize);
+        ByteData.sublistView(batch)
+          ..setInt32(12, x, Endian.little)
+          ..setUint8(22, InputEventType.mouseMove.index);
+        return batch;
+      }
+
+      Uint8List keyBatch(int code) {
+        final batch = Uint8List(kCompactEventSize);
+        ByteData.sublistView(batch)
+          ..setUint16(20, code, Endian.little)
+          ..setUint8(22, InputEventType.keyDown.index);
+        return batch;
+      }
+
+      setUp(() {
+        calls.clear();
+        listenArguments = null;
+        batchSink = null;
+        TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger
+          ..setMockMethodCallHandler(methodChannel, (call) async {
+            calls.add(call);
+            return null;
+          })
+          ..setMockStreamHandler(
+            batchChannel,
+            MockStreamHandler.inline(
+              onListen: (arguments, sink) {
+                listenArguments = arguments;
+                batchSink = sink;
+              },
+            ),
+          );
+      });
+
+      tearDown(() {
+        debugDefaultTargetPlatformOverride = null;
+        TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger
+          ..setMockMethodCallHandler(methodChannel, null)
+          ..setMockStreamHandler(batchChannel, null);
+      });
+
+      test('listens with initial credits', () async {
+        final subscription = inputCapture.eventBatches.listen((_) {});
+        await pumpEventQueue();
+
+        expect(listenArguments, {
+          'credits': InputCapture.eventBatchCredits,
+          'generation': isA<int>(),
+        });
+        await subscription.cancel();
+      });
+
+      test('grants a credit back for every processed batch', () async {
+        final received = <Uint8List>[];
+        final subscription = inputCapture.eventBatches.listen(received.add);
+        await pumpEventQueue();
+
+        batchSink!
+          ..success(moveBatch(1))
+          ..success(moveBatch(2));
+        await pumpEventQueue();
+
+        expect(received, hasLength(2));
+        expect(calls.map((call) => call.method), [
+          'grantEventCredits',
+          'grantEventCredits',
+        ]);
+        expect(calls.first.arguments, {
+          'batches': 1,
+          'generation': (listenArguments! as Map)['generation'],
+        });
+        await subscription.cancel();
+      });
+
+      test('tags grants with the generation of their listen', () async {
+        final first = inputCapture.eventBatches.listen((_) {});
+        await pumpEventQueue();
+        final firstGeneration = (listenArguments! as Map)['generation'];
+        batchSink!.success(moveBatch(1));
+        await first.cancel();
+
+        final second = inputCapture.eventBatches.listen((_) {});
+        await pumpEventQueue();
+        final secondGeneration = (listenArguments! as Map)['generation'];
+        batchSink!.success(moveBatch(2));
+        await pumpEventQueue();
+
+        expect(secondGeneration, isNot(firstGeneration));
+        expect(
+          calls.map((call) => (call.arguments as Map)['generation']),
+          [firstGeneration, secondGeneration],
+        );
+        await second.cancel();
+      });
+
+      test('listenCompact decodes batches on Linux', () async {
+        debugDefaultTargetPlatformOverride = TargetPlatform.linux;
+        final xs = <double>[];
+        final subscription = inputCapture.listenCompact((event) {
+          xs.add(event.x);
+        });
+        await pumpEventQueue();
+
+        batchSink!.success(moveBatch(7));
+        await pumpEventQueue();
+
+        expect(xs, [7]);
+        await subscription.cancel();
+      });
+
+      test('listenCompact drops events the filter rejects', () async {
+        debugDefaultTargetPlatformOverride = TargetPlatform.linux;
+        final types = <InputEventType>[];
+        final subscription = inputCapture.listenCompact(
+          (event) => types.add(event.type),
+          filter: CompactEventFilter.keys,
+        );
+        await pumpEventQueue();
+
+        batchSink!.success(moveBatch(7));
+        await pumpEventQueue();
+
+        expect(types, isEmpty);
+        expect(calls.single.method, 'grantEventCredits');
+        await subscription.cancel();
+      });
+
+      test('filters in the background when asked to', () async {
+        debugDefaultTargetPlatformOverride = TargetPlatform.linux;
+        final capture = InputCapture(decodeInBackground: true);
+        final codes = <int>[];
+        final subscription = capture.listenCompact(
+          (event) => codes.add(event.code),
+          filter: CompactEventFilter.keys,
+        );
+        await pumpEventQueue();
+
+        batchSink!
+          ..success(moveBatch(7))
+          ..success(keyBatch(38));
+
+        // The worker isolate replies asynchronously.
+        for (var i = 0; i < 100 && calls.length < 2; i++) {
+          await Future<void>.delayed(const Duration(milliseconds: 10));
+        }
+        await pumpEventQueue();
+
+        expect(codes, [38]);
+        expect(calls.map((call) => call.method), [
+          'grantEventCredits',
+          'grantEventCredits',
+        ]);
+        await subscription.cancel();
+        capture.dispose();
+      });
+
+      test('keeps pointer listeners off the background worker', () async {
+        debugDefaultTargetPlatformOverride = TargetPlatform.linux;
+        final capture = InputCapture(decodeInBackground: true);
+        final xs = <double>[];
+        final subscription = capture.listenCompact((event) {
+          xs.add(event.x);
+        });
+        await pumpEventQueue();
+
+        batchSink!.success(moveBatch(7));
+        await pumpEventQueue();
+
+        // Decoded on this isolate, without waiting for a worker.
+        expect(xs, [7]);
+        expect(calls.map((call) => call.method), ['grantEventCredits']);
+        await subscription.cancel();
+        capture.dispose();
+      });
+    });
   });
 
   group('KeyEvent', () {
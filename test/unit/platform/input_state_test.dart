@@ -0,0 +1,200 @@
+import 'dart:ffi';
+import 'dart:typed_data';
+
+import 'package:flutter/foundation.dart';
+import 'package:flutter_test/flutter_test.dart';
+import 'package:keyboard_playground/platform/input_events.dart';
+import 'package:keyboard_playground/platform/input_state.dart';
+import 'package:keyboard_playground/widgets/perf_hud.dart';
+
+typedef _CallocNative = Pointer<Void> Function(Size count, Size size);
+typedef _CallocDart = Pointer<Void> Function(int count, int size);
+typedef _FreeNative = Void Function(Pointer<Void> pointer);
+typedef _FreeDart = void Function(Pointer<Void> pointer);
+
+final DynamicLibrary _libc = DynamicLibrary.process();
+final _CallocDart _calloc =
+    _libc.lookupFunction<_CallocNative, _CallocDart>('calloc');
+final _FreeDart _free = _libc.lookupFunction<_FreeNative, _FreeDart>('free');
+
+/// Stand-in for the native `InputState`: a seqlock sequence and the 64-byte
+/// `InputStateSnapshot` it protects, written at the native field offsets.
+class _FakeNativeState {
+  int seq = 0;
+  final ByteData words = ByteData(64);
+  int reads = 0;
+
+  /// Called between the copy and the sequence check of a read, like a
+  /// writer preempting the reader.
+  void Function()? duringCopy;
+
+  void write({
+    required int sequence,
+    int pointerX = 0,
+    int pointerY = 0,
+    int buttons = 0,
+    int modifiers = 0,
+    List<int> keyCodes = const [],
+  }) {
+    beginWrite();
+    words
+      ..setUint64(0, sequence, Endian.host)
+      ..setInt64(8, 1700000000000000, Endian.host)
+      ..setInt32(16, pointerX, Endian.host)
+      ..setInt32(20, pointerY, Endian.host)
+      ..setUint32(24, buttons, Endian.host)
+      ..setUint32(28, modifiers, Endian.host);
+    for (var offset = 32; offset < 64; offset += 8) {
+      words.setUint64(offset, 0, Endian.host);
+    }
+    for (final keyCode in keyCodes) {
+      final offset = 32 + (keyCode >> 6) * 8;
+      words.setUint64(
+        offset,
+        words.getUint64(offset, Endian.host) | (1 << (keyCode & 63)),
+        Endian.host,
+      );
+    }
+    endWrite();
+  }
+
+  void beginWrite() => seq++;
+
+  void endWrite() => seq++;
+
+  /// `keyboard_playground_read_input_state`: copies the words and retries
+  /// while a write is in progress or overlapped the copy.
+  void read(Pointer<NativeInputState> out) {
+    final bytes = out.cast<Uint8>().asTypedList(64);
+    while (true) {
+      reads++;
+      final begin = seq;
+      final copy = Uint8List.fromList(words.buffer.asUint8List());
+      duringCopy?.call();
+      if (begin.isOdd || seq != begin) continue;
+      bytes.setAll(0, copy);
+      return;
+    }
+  }
+}
+
+void main() {
+  group('InputStateReader', () {
+    tearDown(() {
+      debugDefaultTargetPlatformOverride = null;
+    });
+
+    test('snapshot layout matches the native struct', () {
+      expect(sizeOf<NativeInputState>(), 64);
+    });
+
+    test('is unavailable off Linux', () {
+      debugDefaultTargetPlatformOverride = TargetPlatform.macOS;
+
+      expect(InputStateReader.open(), isNull);
+    });
+
+    test('is unavailable without the native runner', () {
+      debugDefaultTargetPlatformOverride = TargetPlatform.linux;
+
+      expect(InputStateReader.open(), isNull);
+    });
+
+    group('reading the native layout', () {
+      late Pointer<NativeInputState> snapshot;
+      late _FakeNativeState native;
+      late InputStateReader reader;
+
+      setUp(() {
+        snapshot = _calloc(1, sizeOf<NativeInputState>()).cast();
+        native = _FakeNativeState();
+        reader = InputStateReader.withReader(snapshot, native.read);
+      });
+
+      tearDown(() {
+        reader.dispose();
+        _free(snapshot.cast());
+      });
+
+      test('decodes every field', () {
+        native.write(
+          sequence: 7,
+          pointerX: -12,
+          pointerY: 840,
+          buttons: 0x5,
+          modifiers: 0x3,
+          keyCodes: [9, 64, 255],
+        );
+
+        final state = reader.poll();
+
+        expect(state.sequence, 7);
+        expect(state.lastEventTimeUs, 1700000000000000);
+        expect(state.pointerX, -12);
+        expect(state.pointerY, 840);
+        expect(state.modifiers, 0x3);
+        expect(reader.isButtonDown(MouseButton.left), isTrue);
+        expect(reader.isButtonDown(MouseButton.middle), isFalse);
+        expect(reader.isButtonDown(MouseButton.right), isTrue);
+        expect(reader.isButtonDown(MouseButton.other), isFalse);
+        expect(reader.isKeyDown(9), isTrue);
+        expect(reader.isKeyDown(64), isTrue);
+        expect(reader.isKeyDown(255), isTrue);
+        expect(reader.isKeyDown(10), isFalse);
+        expect(reader.isKeyDown(256), isFalse);
+        expect(reader.heldKeyCount, 3);
+      });
+
+      test('retries while a write is in progress', () {
+        native
+          ..write(sequence: 1, pointerX: 1)
+          ..beginWrite()
+          ..words.setInt32(16, 2, Endian.host);
+        expect(native.seq.isOdd, isTrue);
+
+        var copies = 0;
+        native.duringCopy = () {
+          if (++copies == 2) native.endWrite();
+        };
+        reader.poll();
+
+        // The copy made with an odd sequence and the one the write ended
+        // under are both discarded.
+        expect(native.reads, 3);
+        expect(reader.state.pointerX, 2);
+      });
+
+      test('retries after an overlapping write', () {
+        native.write(sequence: 1, pointerX: 1);
+
+        var copies = 0;
+        native.duringCopy = () {
+          if (++copies == 1) native.write(sequence: 2, pointerX: 2);
+        };
+        reader.poll();
+
+        expect(native.reads, 2);
+        expect(reader.state.sequence, 2);
+        expect(reader.state.pointerX, 2);
+      });
+
+      test('is described on one HUD line', () {
+        native.write(
+          sequence: 42,
+          pointerX: 100,
+          pointerY: 200,
+          buttons: 0x1,
+          modifiers: 0x1 | 0x8,
+          keyCodes: [38, 50],
+        );
+        reader.poll();
+
+        expect(
+          describeInputState(reader),
+          'input #42  pointer 100,200  keys 2  buttons left  '
+          'mods shift+meta',
+        );
+      });
+    });
+  });
+}
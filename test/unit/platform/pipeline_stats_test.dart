@@ -0,0 +1,33 @@
+import 'dart:ffi';
+
+import 'package:flutter/foundation.dart';
+import 'package:flutter_test/flutter_test.dart';
+import 'package:keyboard_playground/platform/pipeline_stats.dart';
+
+void main() {
+  group('PipelineStatsReader', () {
+    tearDown(() {
+      debugDefaultTargetPlatformOverride = null;
+    });
+
+    test('snapshot layout matches the native struct', () {
+      expect(sizeOf<NativePipelineStats>(), 224);
+      expect(
+        PipelineStage.values.length * LatencyPercentile.values.length,
+        20,
+      );
+    });
+
+    test('is unavailable off Linux', () {
+      debugDefaultTargetPlatformOverride = TargetPlatform.macOS;
+
+      expect(PipelineStatsReader.open(), isNull);
+    });
+
+    test('is unavailable without the native runner', () {
+      debugDefaultTargetPlatformOverride = TargetPlatform.linux;
+
+      expect(PipelineStatsReader.open(), isNull);
+    });
+  });
+}
@@ -0,0 +1,50 @@
+import 'package:flutter_test/flutter_test.dart';
+import 'package:keyboard_playground/platform/pointer_gesture.dart';
+
+void main() {
+  group('PointerGestureEvent.fromMap', () {
+    test('parses a circle', () {
+      final gesture = PointerGestureEvent.fromMap({
+        'gesture': 'circle',
+        'confidence': 0.8,
+        'x': 120.0,
+        'y': 340.0,
+        'timestamp': 1700000000000,
+      })!;
+
+      expect(gesture.gesture, PointerGesture.circle);
+      expect(gesture.confidence, 0.8);
+      expect(gesture.x, 120);
+      expect(gesture.y, 340);
+      expect(gesture.timestamp.millisecondsSinceEpoch, 1700000000000);
+      expect(gesture.direction, isNull);
+    });
+
+    test('parses a swipe direction', () {
+      final gesture = PointerGestureEvent.fromMap({
+        'gesture': 'swipe',
+        'confidence': 1.0,
+        'x': 0.0,
+        'y': 0.0,
+        'timestamp': 0,
+        'direction': 'up',
+      })!;
+
+      expect(gesture.gesture, PointerGesture.swipe);
+      expect(gesture.direction, SwipeDirection.up);
+    });
+
+    test('clamps confidence', () {
+      final gesture = PointerGestureEvent.fromMap({
+        'gesture': 'shake',
+        'confidence': 1.5,
+      })!;
+
+      expect(gesture.confidence, 1);
+    });
+
+    test('returns null for unknown gestures', () {
+      expect(PointerGestureEvent.fromMap({'gesture': 'zigzag'}), isNull);
+    });
+  });
+}
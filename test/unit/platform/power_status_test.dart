@@ -0,0 +1,45 @@
+import 'package:flutter_test/flutter_test.dart';
+import 'package:keyboard_playground/core/quality_controller.dart';
+import 'package:keyboard_playground/platform/power_status.dart';
+
+void main() {
+  group('PowerStatus.fromMap', () {
+    test('parses thermal and battery readings', () {
+      final status = PowerStatus.fromMap({
+        'tier': 1,
+        'temperature': 71.5,
+        'headroom': 8.5,
+        'throttle': 0.2,
+        'onBattery': true,
+        'batteryPercent': 64,
+      });
+
+      expect(status.tier, PerformanceTier.reduced);
+      expect(status.temperature, 71.5);
+      expect(status.headroom, 8.5);
+      expect(status.throttle, 0.2);
+      expect(status.onBattery, isTrue);
+      expect(status.batteryPercent, 64);
+    });
+
+    test('leaves missing sensors null', () {
+      final status = PowerStatus.fromMap({'tier': 0, 'throttle': 0.0});
+
+      expect(status.tier, PerformanceTier.full);
+      expect(status.temperature, isNull);
+      expect(status.headroom, isNull);
+      expect(status.batteryPercent, isNull);
+      expect(status.onBattery, isFalse);
+    });
+
+    test('clamps unknown tiers', () {
+      expect(PowerStatus.fromMap({'tier': 7}).tier, PerformanceTier.minimal);
+    });
+  });
+
+  test('tiers map to quality ceilings', () {
+    expect(PerformanceTier.full.qualityCeiling, QualityLevel.high);
+    expect(PerformanceTier.reduced.qualityCeiling, QualityLevel.medium);
+    expect(PerformanceTier.minimal.qualityCeiling, QualityLevel.low);
+  });
+}
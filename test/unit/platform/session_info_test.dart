@@ -0,0 +1,106 @@
+import 'package:flutter_test/flutter_test.dart';
+import 'package:keyboard_playground/platform/input_capture.dart';
+import 'package:keyboard_playground/platform/session_info.dart';
+
+void main() {
+  group('InputCapabilities.fromMap', () {
+    test('parses backend features', () {
+      final capabilities = InputCapabilities.fromMap({
+        'x11_record': true,
+        'recordVersion': '1.13',
+        'eventBatches': true,
+        'gestures': true,
+        'powerStatus': true,
+        'pipelineStats': true,
+        'startupCached': true,
+        'journalCompression': ['none', 'zstd', 'brotli'],
+      });
+
+      expect(capabilities.recordVersion, '1.13');
+      expect(capabilities.eventBatches, isTrue);
+      expect(capabilities.gestures, isTrue);
+      expect(capabilities.powerStatus, isTrue);
+      expect(capabilities.pipelineStats, isTrue);
+      expect(capabilities.startupCached, isTrue);
+      expect(
+        capabilities.journalCompression,
+        [JournalCompression.none, JournalCompression.zstd],
+      );
+    });
+
+    test('defaults missing features to unsupported', () {
+      final capabilities = InputCapabilities.fromMap({});
+
+      expect(capabilities.recordVersion, isNull);
+      expect(capabilities.eventBatches, isFalse);
+      expect(capabilities.journalCompression, isEmpty);
+      expect(capabilities.captureBackend, isNull);
+      expect(capabilities.startupCached, isFalse);
+    });
+
+    test('parses the capture backend selection', () {
+      final capabilities = InputCapabilities.fromMap({
+        'captureBackend': {
+          'name': 'record_async',
+          'cached': false,
+          'measured': true,
+          'elapsedUs': 95000,
+          'measurements': [
+            {
+              'name': 'record_sync',
+              'available': true,
+              'probes': 32,
+              'delivered': 32,
+              'medianLatencyUs': 410,
+              'p95LatencyUs': 900,
+              'cpuUsPerEvent': 30,
+            },
+            {'name': 'record_async', 'available': true, 'probes': 32},
+          ],
+        },
+      });
+
+      final backend = capabilities.captureBackend!;
+      expect(backend.name, 'record_async');
+      expect(backend.cached, isFalse);
+      expect(backend.measured, isTrue);
+      expect(backend.elapsed, const Duration(milliseconds: 95));
+      expect(backend.measurements, hasLength(2));
+      final sync = backend.measurements.first;
+      expect(sync.name, 'record_sync');
+      expect(sync.delivered, 32);
+      expect(sync.medianLatency, const Duration(microseconds: 410));
+      expect(sync.p95Latency, const Duration(microseconds: 900));
+      expect(sync.cpuPerEvent, const Duration(microseconds: 30));
+      expect(backend.measurements.last.delivered, 0);
+    });
+  });
+
+  group('SessionInfo.fromMap', () {
+    test('parses the session result and step timings', () {
+      final session = SessionInfo.fromMap({
+        'permissions': {'x11_record': true},
+        'capabilities': {'eventBatches': true},
+        'fullscreen': true,
+        'capturing': true,
+        'timings': {'probe': 120, 'fullscreen': 40, 'capture': 900},
+      });
+
+      expect(session.permissionsGranted, isTrue);
+      expect(session.capabilities.eventBatches, isTrue);
+      expect(session.fullscreen, isTrue);
+      expect(session.capturing, isTrue);
+      expect(session.timings['capture'], const Duration(microseconds: 900));
+      expect(session.timings.containsKey('total'), isFalse);
+    });
+
+    test('is not permitted without a granted permission', () {
+      final session = SessionInfo.fromMap({
+        'permissions': {'x11_record': false},
+      });
+
+      expect(session.permissionsGranted, isFalse);
+      expect(session.capturing, isFalse);
+    });
+  });
+}
@@ -306,6 +306,108 @@ void main() {
       });
     });
 
+    group('compositor bypass', () {
+      test('enterFullscreen requests the bypass by default', () async {
+        final calls = <MethodCall>[];
+        TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger
+            .setMockMethodCallHandler(methodChannel,
+                (MethodCall methodCall) async {
+          calls.add(methodCall);
+          return true;
+        });
+
+        await WindowControl.enterFullscreen();
+        await WindowControl.enterFullscreen(bypassCompositor: false);
+
+        expect(calls.map((call) => call.arguments), [
+          {'bypassCompositor': true},
+          {'bypassCompositor': false},
+        ]);
+      });
+
+      test('fullscreenStatus parses the detailed answer', () async {
+        Object? arguments;
+        TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger
+            .setMockMethodCallHandler(methodChannel,
+                (MethodCall methodCall) async {
+          arguments = methodCall.arguments;
+          return <String, bool>{
+            'fullscreen': true,
+            'composited': true,
+            'bypassCompositor': true,
+            'unredirected': true,
+          };
+        });
+
+        final status = await WindowControl.fullscreenStatus();
+        expect(arguments, {'details': true});
+        expect(
+          status,
+          const FullscreenStatus(
+            fullscreen: true,
+            composited: true,
+            bypassCompositor: true,
+            unredirected: true,
+          ),
+        );
+      });
+
+      test('fullscreenStatus falls back to a plain answer', () async {
+        TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger
+            .setMockMethodCallHandler(methodChannel,
+                (MethodCall methodCall) async {
+          if (methodCall.method == 'isFullscreen') return true;
+          return null;
+        });
+
+        final status = await WindowControl.fullscreenStatus();
+        expect(status, const FullscreenStatus(fullscreen: true));
+      });
+
+      test('fullscreenStatus reports not fullscreen without a handler',
+          () async {
+        final status = await WindowControl.fullscreenStatus();
+        expect(status.fullscreen, isFalse);
+        expect(status.unredirected, isFalse);
+      });
+    });
+
+    group('setViewInputExemptions', () {
+      test('sends the exempted kinds', () async {
+        final calls = <MethodCall>[];
+        TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger
+            .setMockMethodCallHandler(methodChannel,
+                (MethodCall methodCall) async {
+          calls.add(methodCall);
+          return true;
+        });
+
+        final result = await WindowControl.setViewInputExemptions(
+          pointer: true,
+        );
+        expect(result, true);
+        expect(calls.single.method, 'setViewInputExemptions');
+        expect(calls.single.arguments, {'keys': false, 'pointer': true});
+      });
+
+      test('returns false when platform channel throws PlatformException',
+          () async {
+        TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger
+            .setMockMethodCallHandler(methodChannel,
+                (MethodCall methodCall) async {
+          throw PlatformException(code: 'UNAVAILABLE');
+        });
+
+        final result = await WindowControl.setViewInputExemptions(keys: true);
+        expect(result, false);
+      });
+
+      test('returns false when no handler is registered', () async {
+        final result = await WindowControl.setViewInputExemptions();
+        expect(result, false);
+      });
+    });
+
     group('isFullscreen', () {
       test('returns true when platform returns true', () async {
         TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger
@@ -1,6 +1,8 @@
 import 'package:flutter/material.dart';
+import 'package:flutter/services.dart';
 import 'package:flutter_test/flutter_test.dart';
 import 'package:keyboard_playground/core/game_manager.dart';
+import 'package:keyboard_playground/core/lazy_game.dart';
 import 'package:keyboard_playground/games/base_game.dart';
 import 'package:keyboard_playground/ui/game_selection_menu.dart';
 
@@ -171,5 +173,48 @@ void main() {
 
       // Test passes if no exception is thrown
     });
+
+    testWidgets('prewarms the focused game', (tester) async {
+      final created = <String>[];
+      LazyGame lazy(String id) => LazyGame(
+            id: id,
+            name: 'Game $id',
+            description: 'Lazy game $id',
+            create: () {
+              created.add(id);
+              return MockGame(
+                id: id,
+                name: 'Game $id',
+                description: 'Lazy game $id',
+              );
+            },
+          );
+
+      gameManager
+        ..registerGame(lazy('first'))
+        ..registerGame(lazy('second'))
+        ..registerGame(lazy('third'));
+
+      await tester.pumpWidget(
+        MaterialApp(
+          home: Scaffold(
+            body: GameSelectionMenu(
+              gameManager: gameManager,
+              onGameSelected: (_) {},
+              onClose: () {},
+            ),
+          ),
+        ),
+      );
+      await tester.pumpAndSettle();
+
+      // The initially selected game is prewarmed, the others are not.
+      expect(created, equals(['first']));
+
+      await tester.sendKeyEvent(LogicalKeyboardKey.arrowRight);
+      await tester.pumpAndSettle();
+
+      expect(created, equals(['first', 'second']));
+    });
   });
 }
@@ -1,4 +1,5 @@
 import 'package:flutter/material.dart';
+import 'package:flutter/rendering.dart';
 import 'package:flutter_test/flutter_test.dart';
 import 'package:keyboard_playground/widgets/animated_background.dart';
 
@@ -69,6 +70,90 @@ void main() {
     });
   });
 
+  group('AnimatedBackground cached frames', () {
+    testWidgets('renders with child', (tester) async {
+      await tester.pumpWidget(
+        const MaterialApp(
+          home: AnimatedBackground(
+            colors: [Colors.red, Colors.orange, Colors.yellow],
+            mode: BackgroundRenderMode.cachedFrames,
+            child: Text('Cached'),
+          ),
+        ),
+      );
+
+      expect(find.text('Cached'), findsOneWidget);
+      expect(
+        find.descendant(
+          of: find.byType(AnimatedBackground),
+          matching: find.byType(RepaintBoundary),
+        ),
+        findsWidgets,
+      );
+    });
+
+    testWidgets('repaints only at the cross-fade rate', (tester) async {
+      await tester.pumpWidget(
+        const MaterialApp(
+          home: AnimatedBackground(
+            colors: [Colors.red, Colors.orange, Colors.yellow],
+            duration: Duration(seconds: 2),
+            mode: BackgroundRenderMode.cachedFrames,
+            frameCount: 4,
+            frameResolution: 16,
+            crossFadeRate: 4,
+          ),
+        ),
+      );
+      final boundary = tester.renderObject<RenderRepaintBoundary>(
+        find
+            .descendant(
+              of: find.byType(AnimatedBackground),
+              matching: find.byType(RepaintBoundary),
+            )
+            .first,
+      );
+      int paints() =>
+          boundary.debugSymmetricPaintCount +
+          boundary.debugAsymmetricPaintCount;
+
+      await _waitForFrames(tester, paints);
+
+      // One second at 40 frames per second: four cross-fade steps.
+      final before = paints();
+      for (var i = 0; i < 40; i++) {
+        await tester.pump(const Duration(milliseconds: 25));
+      }
+
+      expect(paints() - before, 4);
+    });
+
+    test('renders one image per frame', () {
+      const black = 0xFF000000;
+      const white = 0xFFFFFFFF;
+      final pixels = renderBackgroundFrames([1, 4, 2, black, white]);
+
+      expect(pixels, hasLength(4 * 2 * 4));
+      // Top left is near the first color, bottom right near the last.
+      expect(pixels[0], lessThan(64));
+      expect(pixels[pixels.length - 4], greaterThan(192));
+      expect(pixels[3], 0xFF);
+    });
+
+    test('moves the gradient between frames', () {
+      final pixels = renderBackgroundFrames(
+        [2, 8, 8, 0xFFFF0000, 0xFF00FF00, 0xFF0000FF],
+      );
+      const frameBytes = 8 * 8 * 4;
+
+      expect(pixels, hasLength(2 * frameBytes));
+      expect(
+        pixels.sublist(0, frameBytes),
+        isNot(pixels.sublist(frameBytes)),
+      );
+    });
+  });
+
   group('PulsingBackground', () {
     testWidgets('renders with child', (tester) async {
       await tester.pumpWidget(
@@ -155,3 +240,20 @@ void main() {
     });
   });
 }
+
+/// Lets an [AnimatedBackground] in cached frames mode render and decode
+/// its frames, until [paints] shows they were painted.
+///
+/// Rendering runs on an isolate and decoding in the engine, in real time,
+/// which the fake clock of widget tests does not advance; each round lets
+/// them progress and then delivers their results.
+Future<void> _waitForFrames(WidgetTester tester, int Function() paints) async {
+  final before = paints();
+  for (var i = 0; i < 200 && paints() == before; i++) {
+    await tester.runAsync(
+      () => Future<void>.delayed(const Duration(milliseconds: 10)),
+    );
+    await tester.pump();
+  }
+  expect(paints(), greaterThan(before), reason: 'frames were never shown');
+}
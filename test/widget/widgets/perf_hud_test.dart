@@ -0,0 +1,92 @@
+import 'dart:async';
+
+import 'package:flutter/foundation.dart';
+import 'package:flutter/material.dart';
+import 'package:flutter_test/flutter_test.dart';
+import 'package:keyboard_playground/core/quality_controller.dart';
+import 'package:keyboard_playground/widgets/perf_hud.dart';
+
+void main() {
+  group('PerfHud', () {
+    late StreamController<void> toggles;
+    late int readerOpens;
+
+    setUp(() {
+      toggles = StreamController<void>.broadcast();
+      readerOpens = 0;
+    });
+
+    tearDown(() async {
+      await toggles.close();
+    });
+
+    Widget buildHud() {
+      return PerfHud(
+        toggles: toggles.stream,
+        openInputState: () => null,
+        openReader: () {
+          readerOpens++;
+          return null;
+        },
+        quality: ValueNotifier(QualityLevel.medium),
+        child: const Text('content', textDirection: TextDirection.ltr),
+      );
+    }
+
+    testWidgets('is hidden until toggled', (tester) async {
+      await tester.pumpWidget(buildHud());
+
+      expect(find.text('content'), findsOneWidget);
+      expect(find.textContaining('quality'), findsNothing);
+      expect(readerOpens, 0);
+      expect(tester.binding.hasScheduledFrame, isFalse);
+    });
+
+    testWidgets('toggles on and off', (tester) async {
+      await tester.pumpWidget(buildHud());
+
+      toggles.add(null);
+      await tester.pump();
+      await tester.pump();
+      expect(find.textContaining('quality medium'), findsOneWidget);
+      expect(find.textContaining('native stats unavailable'), findsOneWidget);
+
+      toggles.add(null);
+      await tester.pump();
+      expect(find.textContaining('quality'), findsNothing);
+      expect(find.text('content'), findsOneWidget);
+    });
+
+    testWidgets('opens the reader once', (tester) async {
+      await tester.pumpWidget(buildHud());
+
+      for (var i = 0; i < 4; i++) {
+        toggles.add(null);
+        await tester.pump();
+      }
+
+      expect(readerOpens, 1);
+    });
+
+    testWidgets('reads every frame while shown', (tester) async {
+      await tester.pumpWidget(
+        PerfHud(
+          initiallyVisible: true,
+          openReader: () => null,
+          child: const SizedBox(),
+        ),
+      );
+
+      expect(tester.binding.hasScheduledFrame, isTrue);
+
+      await tester.pumpWidget(const SizedBox());
+      expect(tester.binding.hasScheduledFrame, isFalse);
+    });
+  });
+
+  group('describeFrameTimings', () {
+    test('waits for timings', () {
+      expect(describeFrameTimings(const []), ['frames    no timings yet']);
+    });
+  });
+}
@@ -0,0 +1,96 @@
+import 'package:flutter/material.dart';
+import 'package:flutter/services.dart';
+import 'package:flutter_test/flutter_test.dart';
+import 'package:keyboard_playground/widgets/view_input_exemption.dart';
+
+void main() {
+  group('ViewInputExemption', () {
+    const methodChannel =
+        MethodChannel('com.keyboardplayground/window_control');
+    final linux = TargetPlatformVariant.only(TargetPlatform.linux);
+    late List<Object?> sent;
+
+    setUp(() {
+      sent = [];
+      TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger
+          .setMockMethodCallHandler(methodChannel, (call) async {
+        if (call.method == 'setViewInputExemptions') sent.add(call.arguments);
+        return true;
+      });
+    });
+
+    tearDown(() {
+      TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger
+          .setMockMethodCallHandler(methodChannel, null);
+    });
+
+    testWidgets('exempts while mounted', (tester) async {
+      await tester.pumpWidget(
+        const ViewInputExemption(
+          keys: true,
+          pointer: true,
+          child: SizedBox(),
+        ),
+      );
+      expect(ViewInputExemption.keysExempt, isTrue);
+      expect(ViewInputExemption.pointerExempt, isTrue);
+
+      await tester.pumpWidget(const SizedBox());
+      expect(ViewInputExemption.keysExempt, isFalse);
+      expect(ViewInputExemption.pointerExempt, isFalse);
+
+      expect(sent, [
+        {'keys': true, 'pointer': true},
+        {'keys': false, 'pointer': false},
+      ]);
+    }, variant: linux);
+
+    testWidgets('combines nested exemptions', (tester) async {
+      await tester.pumpWidget(
+        const ViewInputExemption(
+          keys: true,
+          child: ViewInputExemption(
+            keys: true,
+            pointer: true,
+            child: SizedBox(),
+          ),
+        ),
+      );
+      await tester.pumpWidget(
+        const ViewInputExemption(keys: true, child: SizedBox()),
+      );
+      expect(ViewInputExemption.keysExempt, isTrue);
+      expect(ViewInputExemption.pointerExempt, isFalse);
+
+      await tester.pumpWidget(const SizedBox());
+      expect(sent, [
+        {'keys': true, 'pointer': true},
+        {'keys': true, 'pointer': false},
+        {'keys': false, 'pointer': false},
+      ]);
+    }, variant: linux);
+
+    testWidgets('follows changed kinds', (tester) async {
+      await tester.pumpWidget(
+        const ViewInputExemption(pointer: true, child: SizedBox()),
+      );
+      await tester.pumpWidget(
+        const ViewInputExemption(keys: true, child: SizedBox()),
+      );
+      expect(ViewInputExemption.keysExempt, isTrue);
+      expect(ViewInputExemption.pointerExempt, isFalse);
+
+      await tester.pumpWidget(const SizedBox());
+      expect(ViewInputExemption.keysExempt, isFalse);
+    }, variant: linux);
+
+    testWidgets('does not call the platform off Linux', (tester) async {
+      await tester.pumpWidget(
+        const ViewInputExemption(keys: true, child: SizedBox()),
+      );
+      await tester.pumpWidget(const SizedBox());
+
+      expect(sent, isEmpty);
+    });
+  });
+}
@@ -0,0 +1,14 @@
+import 'package:integration_test/integration_test_driver.dart';
+
+/// Host side of the frame performance suite.
+///
+/// Writes the per-game metrics reported by
+/// `integration_test/frame_performance_test.dart` to
+/// `build/frame_performance.json`.
+Future<void> main() => integrationDriver(
+      responseDataCallback: (data) async {
+        if (data != null) {
+          await writeResponseData(data, testOutputFilename: 'frame_performance');
+        }
+      },
+    );